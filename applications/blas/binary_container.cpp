@@ -0,0 +1,265 @@
+// binary_container.cpp: round trip and load time of binary containers against text serialization
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <string>
+// enable posit arithmetic exceptions
+#define POSIT_THROW_ARITHMETIC_EXCEPTION 1
+// enable fast posits
+#define POSIT_FAST_SPECIALIZATION
+#include <universal/posit/posit>
+#include <universal/fixpnt/fixpnt>
+#include <universal/blas/blas.hpp>
+#include <universal/blas/binary_container.hpp>
+#include <universal/blas/generators.hpp>
+
+template<typename Scalar>
+bool SameBits(const Scalar& a, const Scalar& b) {
+	return std::memcmp(&a, &b, sizeof(Scalar)) == 0;
+}
+
+// vectors and matrices in both layouts survive the round trip bit for bit, through loads and through mapped views
+template<typename Scalar>
+int VerifyRoundTrip(const std::string& tag) {
+	using namespace sw::unum::blas;
+	int nrOfFailures = 0;
+	const std::string file = "binary_container_" + std::to_string(sizeof(Scalar)) + ".bin";
+	constexpr size_t M = 37, N = 23;
+	matrix<Scalar> A(M, N);
+	for (size_t i = 0; i < M; ++i) for (size_t j = 0; j < N; ++j) A(i, j) = Scalar(double(i) - double(j) / 8.0);
+
+	// row-major matrix
+	save_binary(file, A);
+	matrix<Scalar> B = load_binary_matrix<Scalar>(file);
+	if (num_rows(B) != M || num_cols(B) != N) ++nrOfFailures;
+	for (size_t i = 0; i < M && !nrOfFailures; ++i) for (size_t j = 0; j < N; ++j) if (!SameBits(A(i, j), B(i, j))) ++nrOfFailures;
+	{
+		mapped_container<Scalar> mapped(file);
+		matrix_view<const Scalar> V = mapped.as_matrix();
+		for (size_t i = 0; i < M; ++i) for (size_t j = 0; j < N; ++j) if (!SameBits(A(i, j), V(i, j))) ++nrOfFailures;
+	}
+
+	// column-major matrix streamed a column at a time
+	{
+		binary_writer<Scalar> writer(file, M, layout::column_major);
+		std::vector<Scalar> column(M);
+		for (size_t j = 0; j < N; ++j) {
+			for (size_t i = 0; i < M; ++i) column[i] = A(i, j);
+			writer.write(column.data(), M);
+		}
+	}
+	B = load_binary_matrix<Scalar>(file);
+	for (size_t i = 0; i < M; ++i) for (size_t j = 0; j < N; ++j) if (!SameBits(A(i, j), B(i, j))) ++nrOfFailures;
+	{
+		mapped_container<Scalar> mapped(file);
+		matrix_view<const Scalar> V = mapped.as_matrix();
+		if (!V.is_column_major() || num_rows(V) != M || num_cols(V) != N) ++nrOfFailures;
+		for (size_t i = 0; i < M; ++i) for (size_t j = 0; j < N; ++j) if (!SameBits(A(i, j), V(i, j))) ++nrOfFailures;
+	}
+
+	// vector streamed in chunks of different sizes
+	vector<Scalar> v(M * N);
+	for (size_t i = 0; i < M * N; ++i) v[i] = Scalar(double(i % 97) / 16.0);
+	{
+		binary_writer<Scalar> writer(file);
+		for (size_t i = 0; i < M * N; i += 100) writer.write(v.data() + i, (M * N - i < 100 ? M * N - i : 100));
+	}
+	vector<Scalar> w = load_binary_vector<Scalar>(file);
+	if (size(w) != M * N) ++nrOfFailures;
+	for (size_t i = 0; i < size(w); ++i) if (!SameBits(v[i], w[i])) ++nrOfFailures;
+
+	// reading the file as a different type is detected
+	try {
+		load_binary_vector< sw::unum::posit<24, 1> >(file);
+		++nrOfFailures;
+	}
+	catch (const binary_container_exception&) {}
+	std::remove(file.c_str());
+	std::cout << std::setw(22) << tag << " round trip" << (nrOfFailures ? " FAIL" : " PASS") << '\n';
+	return nrOfFailures;
+}
+
+// a header whose shape or data offset overflows the size computation is rejected as truncated, not read out of bounds
+template<typename Scalar>
+int VerifyOversizedHeader(const std::string& tag) {
+	using namespace sw::unum::blas;
+	int nrOfFailures = 0;
+	const std::string file = "binary_container_oversized.bin";
+	vector<Scalar> v(16);
+	const uint64_t huge = std::numeric_limits<uint64_t>::max();
+	struct shape { uint64_t rows, cols, offset; };
+	// rows * cols * sizeof(Scalar) wraps to a small number, and data_offset + size wraps past zero
+	for (const shape& s : { shape{ uint64_t(1) << 62, 8, 128 }, shape{ huge / 2, 2, 128 }, shape{ 4, 4, huge - 63 }, shape{ 17, 1, 128 } }) {
+		save_binary(file, v);
+		binary_container_header h = read_binary_header(file);
+		h.rows = s.rows;
+		h.cols = s.cols;
+		h.data_offset = s.offset;
+		{
+			std::fstream fs(file, std::ios::binary | std::ios::in | std::ios::out);
+			fs.write(reinterpret_cast<const char*>(&h), sizeof(h));
+		}
+		try {
+			mapped_container<Scalar> mapped(file);
+			++nrOfFailures;
+		}
+		catch (const binary_container_exception&) {}
+		try {
+			load_binary_vector<Scalar>(file);
+			++nrOfFailures;
+		}
+		catch (const binary_container_exception&) {}
+		try {
+			load_binary_matrix<Scalar>(file);
+			++nrOfFailures;
+		}
+		catch (const binary_container_exception&) {}
+	}
+	std::remove(file.c_str());
+	std::cout << std::setw(22) << tag << " oversized header" << (nrOfFailures ? " FAIL" : " PASS") << '\n';
+	return nrOfFailures;
+}
+
+// the elements start at a multiple of 64 bytes: a misaligned offset is rejected even when the elements fit
+template<typename Scalar>
+int VerifyMisalignedHeader(const std::string& tag) {
+	using namespace sw::unum::blas;
+	int nrOfFailures = 0;
+	const std::string file = "binary_container_misaligned.bin";
+	vector<Scalar> v(16);
+	for (size_t i = 0; i < 16; ++i) v[i] = Scalar(double(i));
+	for (uint64_t offset : { uint64_t(136), uint64_t(192) }) {
+		save_binary(file, v);
+		binary_container_header h = read_binary_header(file);
+		h.rows = 8;
+		h.data_offset = offset;
+		{
+			std::fstream fs(file, std::ios::binary | std::ios::in | std::ios::out);
+			fs.write(reinterpret_cast<const char*>(&h), sizeof(h));
+		}
+		bool aligned = (offset % 64 == 0);
+		try {
+			mapped_container<Scalar> mapped(file);
+			if (!aligned || mapped.as_vector()[0] != v[(offset - 128) / sizeof(Scalar)]) ++nrOfFailures;
+		}
+		catch (const binary_container_exception&) { if (aligned) ++nrOfFailures; }
+		try {
+			vector<Scalar> w = load_binary_vector<Scalar>(file);
+			if (!aligned || w[7] != v[15]) ++nrOfFailures;
+		}
+		catch (const binary_container_exception&) { if (aligned) ++nrOfFailures; }
+		try {
+			load_binary_matrix<Scalar>(file);
+			if (!aligned) ++nrOfFailures;
+		}
+		catch (const binary_container_exception&) { if (aligned) ++nrOfFailures; }
+	}
+	std::remove(file.c_str());
+	std::cout << std::setw(22) << tag << " misaligned header" << (nrOfFailures ? " FAIL" : " PASS") << '\n';
+	return nrOfFailures;
+}
+
+// load time of a matrix from text, from a binary container, and through a mapped view
+template<typename Scalar>
+int BenchmarkLoad(const std::string& tag, size_t N) {
+	using namespace std::chrono;
+	using namespace sw::unum::blas;
+	int nrOfFailures = 0;
+	const std::string textFile = "binary_container_benchmark.txt", binaryFile = "binary_container_benchmark.bin";
+	matrix<Scalar> A(N, N);
+	uniform_rand(A, -1.0, 1.0);
+	{
+		std::ofstream ofs(textFile);
+		ofs << std::setprecision(std::numeric_limits<Scalar>::max_digits10);
+		for (size_t i = 0; i < N; ++i) for (size_t j = 0; j < N; ++j) ofs << A(i, j) << '\n';
+	}
+	save_binary(binaryFile, A);
+
+	steady_clock::time_point t1 = steady_clock::now();
+	matrix<Scalar> T(N, N);
+	{
+		std::ifstream ifs(textFile);
+		for (size_t i = 0; i < N; ++i) for (size_t j = 0; j < N; ++j) ifs >> T(i, j);
+	}
+	steady_clock::time_point t2 = steady_clock::now();
+	matrix<Scalar> B = load_binary_matrix<Scalar>(binaryFile);
+	steady_clock::time_point t3 = steady_clock::now();
+	Scalar trace(0);
+	{
+		mapped_container<Scalar> mapped(binaryFile);
+		matrix_view<const Scalar> V = mapped.as_matrix();
+		for (size_t i = 0; i < N; ++i) trace += V(i, i);
+	}
+	steady_clock::time_point t4 = steady_clock::now();
+	if (B != A) ++nrOfFailures;
+	Scalar reference(0);
+	for (size_t i = 0; i < N; ++i) reference += A(i, i);
+	if (trace != reference) ++nrOfFailures;
+	std::remove(textFile.c_str());
+	std::remove(binaryFile.c_str());
+
+	std::cout << std::setw(22) << tag << " " << N << 'x' << N
+		<< "  text " << std::setw(10) << duration_cast<duration<double>>(t2 - t1).count() << " sec"
+		<< "  binary " << std::setw(10) << duration_cast<duration<double>>(t3 - t2).count() << " sec"
+		<< "  mapped trace " << std::setw(10) << duration_cast<duration<double>>(t4 - t3).count() << " sec"
+		<< (nrOfFailures ? "  FAIL" : "  PASS") << '\n';
+	return nrOfFailures;
+}
+
+int main(int argc, char** argv)
+try {
+	using namespace std;
+	using namespace sw::unum;
+
+	// usage: binary_container [N]
+	size_t N = (argc > 1 ? size_t(atol(argv[1])) : size_t(500));
+
+	int nrOfFailedTestCases = 0;
+
+	cout << "Binary containers\n";
+	nrOfFailedTestCases += VerifyRoundTrip<float>("float");
+	nrOfFailedTestCases += VerifyRoundTrip<double>("double");
+	nrOfFailedTestCases += VerifyRoundTrip< posit<16, 1> >("posit<16,1>");
+	nrOfFailedTestCases += VerifyRoundTrip< posit<10, 1> >("posit<10,1>");
+	nrOfFailedTestCases += VerifyRoundTrip< posit<64, 3> >("posit<64,3>");
+	nrOfFailedTestCases += VerifyRoundTrip< fixpnt<16, 8> >("fixpnt<16,8>");
+	nrOfFailedTestCases += VerifyOversizedHeader<double>("double");
+	nrOfFailedTestCases += VerifyMisalignedHeader<double>("double");
+
+	nrOfFailedTestCases += BenchmarkLoad<double>("double", N);
+	nrOfFailedTestCases += BenchmarkLoad< posit<32, 2> >("posit<32,2>", N / 10);
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const std::runtime_error& err) {
+	std::cerr << "Uncaught runtime exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,137 @@
+// blocked_lu.cpp: strong scaling benchmark of the blocked, multi-threaded LU decomposition
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#ifdef _MSC_VER
+#pragma warning(disable : 4514)   // unreferenced inline function has been removed
+#pragma warning(disable : 4710)   // 'int sprintf_s(char *const ,const size_t,const char *const ,...)': function not inlined
+#pragma warning(disable : 4820)   // 'sw::unum::value<23>': '3' bytes padding added after data member 'sw::unum::value<23>::_sign'
+#pragma warning(disable : 5045)   // Compiler will insert Spectre mitigation for memory load if /Qspectre switch specified
+#endif
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <typeinfo>
+// enable posit arithmetic exceptions
+#define POSIT_THROW_ARITHMETIC_EXCEPTION 1
+#include <universal/posit/posit>
+#include <universal/blas/blas.hpp>
+#include <universal/blas/generators.hpp>
+
+// factor A with 1, 2, 4, ..., maxThreads threads and report the speedup relative to a single thread
+// returns the number of failures: a solution that is off, or a factorization that depends on the thread count
+template<typename Scalar>
+int BlockedLUScaling(size_t N, size_t blockSize, unsigned maxThreads, double tolerance) {
+	using namespace std;
+	using namespace std::chrono;
+	using namespace sw::unum::blas;
+	using Vector = sw::unum::blas::vector<Scalar>;
+	using Matrix = sw::unum::blas::matrix<Scalar>;
+
+	Matrix A(N, N);
+	uniform_rand(A, -1.0, 1.0);
+	Vector x(N);
+	x = Scalar(1);
+	Vector b = A * x;
+
+	cout << "blocked LU of a " << N << "x" << N << " uniform random matrix of type " << typeid(Scalar).name() << " with block size " << blockSize << '\n';
+	int nrOfFailures = 0;
+	Matrix reference;
+	sw::unum::blas::vector<size_t> indx;
+	double baseline = 0.0;
+	double nrOps = 2.0 * double(N) * double(N) * double(N) / 3.0;
+	unsigned nrThreads = 1;
+	while (true) {
+		Matrix LU(A);
+		sw::unum::blas::vector<size_t> p;
+		steady_clock::time_point t1 = steady_clock::now();
+		blocked_ludcmp(LU, p, blockSize, nrThreads);
+		steady_clock::time_point t2 = steady_clock::now();
+		double elapsed = duration_cast<duration<double>>(t2 - t1).count();
+		if (nrThreads == 1) {
+			baseline = elapsed;
+			reference = LU;
+			indx = p;
+		}
+		else {
+			// every element is computed by the same sequence of operations regardless of the thread count
+			bool identical = true;
+			for (size_t i = 0; i < N && identical; ++i) {
+				if (p[i] != indx[i]) identical = false;
+				for (size_t j = 0; j < N; ++j) {
+					if (LU(i, j) != reference(i, j)) identical = false;
+				}
+			}
+			if (!identical) {
+				cout << "FAIL: factorization with " << nrThreads << " threads differs from the single threaded factorization\n";
+				++nrOfFailures;
+			}
+		}
+		cout << setw(4) << nrThreads << " threads " << setw(12) << elapsed << " sec " << setw(10) << (uint32_t)(nrOps / (1000.0 * elapsed)) << " KOPS/s"
+			<< "  speedup " << setprecision(3) << baseline / elapsed << setprecision(6) << '\n';
+		if (nrThreads == maxThreads) break;
+		nrThreads = (2 * nrThreads < maxThreads ? 2 * nrThreads : maxThreads);
+	}
+
+	// the factorization has the same representation as ludcmp, so both back substitutions must recover x
+	Vector xb = blocked_lubksb(reference, indx, b);
+	Vector xl = lubksb(reference, indx, b);
+	double maxError = 0.0;
+	for (size_t i = 0; i < N; ++i) {
+		double eb = std::abs(double(xb[i]) - 1.0);
+		double el = std::abs(double(xl[i]) - 1.0);
+		if (eb > maxError) maxError = eb;
+		if (el > maxError) maxError = el;
+	}
+	cout << "max error of the solution " << maxError << (maxError > tolerance ? " FAIL" : " PASS") << "\n\n";
+	if (maxError > tolerance) ++nrOfFailures;
+	return nrOfFailures;
+}
+
+int main(int argc, char** argv)
+try {
+	using namespace std;
+	using namespace sw::unum;
+
+	// usage: blocked_lu [N [blockSize [maxThreads]]]
+	size_t N = 64;
+	size_t blockSize = 32;
+	unsigned maxThreads = hardware_concurrency();
+	if (argc > 1) N = size_t(atoi(argv[1]));
+	if (argc > 2) blockSize = size_t(atoi(argv[2]));
+	if (argc > 3) maxThreads = unsigned(atoi(argv[3]));
+	if (maxThreads == 0) maxThreads = 1;
+
+	int nrOfFailedTestCases = 0;
+
+	nrOfFailedTestCases += BlockedLUScaling<double>(N, blockSize, maxThreads, 1.0e-8);
+	nrOfFailedTestCases += BlockedLUScaling< posit<32, 2> >(N, blockSize, maxThreads, 1.0e-3);
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const std::runtime_error& err) {
+	std::cerr << "Uncaught runtime exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,158 @@
+// expression_templates.cpp: benchmark of fused vector expressions against eager vector operators
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <string>
+// enable posit arithmetic exceptions
+#define POSIT_THROW_ARITHMETIC_EXCEPTION 1
+// enable fast posits
+#define POSIT_FAST_SPECIALIZATION
+#include <universal/posit/posit>
+#include <universal/blas/blas.hpp>
+
+// y = a*x + b*y - z through the eager operators: every operator allocates and fills a temporary
+template<typename Scalar>
+void EagerUpdate(const Scalar& a, const sw::unum::blas::vector<Scalar>& x, const Scalar& b, sw::unum::blas::vector<Scalar>& y, const sw::unum::blas::vector<Scalar>& z) {
+	sw::unum::blas::vector<Scalar> ax(x);
+	ax *= a;
+	sw::unum::blas::vector<Scalar> by(y);
+	by *= b;
+	y = (ax + by) - z;
+}
+
+// y = a*x + b*y - z as a single fused loop
+template<typename Scalar>
+void FusedUpdate(const Scalar& a, const sw::unum::blas::vector<Scalar>& x, const Scalar& b, sw::unum::blas::vector<Scalar>& y, const sw::unum::blas::vector<Scalar>& z) {
+	using sw::unum::blas::expr;
+	y = a * expr(x) + b * expr(y) - z;
+}
+
+template<typename Scalar>
+int BenchmarkExpressions(const std::string& tag, size_t N) {
+	using namespace std;
+	using namespace std::chrono;
+	using namespace sw::unum::blas;
+	using Vector = sw::unum::blas::vector<Scalar>;
+
+	int nrOfFailures = 0;
+	Vector x(N), y(N), z(N);
+	for (size_t i = 0; i < N; ++i) {
+		x[i] = Scalar(1.0 + double(i % 1024) / 1024.0);
+		y[i] = Scalar(0.5 - double(i % 517) / 1024.0);
+		z[i] = Scalar(double(i % 31) / 64.0);
+	}
+	Scalar a(1.5), b(-0.75);
+
+	Vector ye(y), yf(y);
+	steady_clock::time_point t1 = steady_clock::now();
+	EagerUpdate(a, x, b, ye, z);
+	steady_clock::time_point t2 = steady_clock::now();
+	FusedUpdate(a, x, b, yf, z);
+	steady_clock::time_point t3 = steady_clock::now();
+	double eager = duration_cast<duration<double>>(t2 - t1).count();
+	double fused = duration_cast<duration<double>>(t3 - t2).count();
+	// the fused loop performs the same operations per element, so the results are identical
+	for (size_t i = 0; i < N; ++i) {
+		if (ye[i] != yf[i]) {
+			++nrOfFailures;
+			break;
+		}
+	}
+
+	// dot and sum of an expression lower to a single fused reduction without materializing the expression
+	t1 = steady_clock::now();
+	Vector w = a * expr(x) - z;
+	Scalar eagerDot = fused_kernel<Scalar>::dot(0, N, [&](size_t i) { return w[i]; }, [&](size_t i) { return y[i]; });
+	t2 = steady_clock::now();
+	Scalar fusedDot = dot(a * expr(x) - z, y);
+	t3 = steady_clock::now();
+	double eagerReduction = duration_cast<duration<double>>(t2 - t1).count();
+	double fusedReduction = duration_cast<duration<double>>(t3 - t2).count();
+	if (eagerDot != fusedDot) ++nrOfFailures;
+	Scalar s = sum(expr(x) - z);
+	Scalar r = fused_kernel<Scalar>::sum(0, N, [&](size_t i) { return x[i] - z[i]; });
+	if (s != r) ++nrOfFailures;
+
+	cout << setw(14) << tag << " N = " << setw(9) << N
+		<< "  axpby eager " << setw(10) << eager << " sec  fused " << setw(10) << fused << " sec  speedup " << setprecision(3) << eager / fused << setprecision(6)
+		<< "  | dot eager " << setw(10) << eagerReduction << " sec  fused " << setw(10) << fusedReduction << " sec"
+		<< (nrOfFailures ? "  FAIL" : "  PASS") << '\n';
+	return nrOfFailures;
+}
+
+// the scaling operators of a matrix expression: S*E, E*S, and E/S
+template<typename Scalar>
+int VerifyMatrixScaling(const std::string& tag) {
+	using namespace sw::unum::blas;
+	using Matrix = sw::unum::blas::matrix<Scalar>;
+
+	int nrOfFailures = 0;
+	Matrix A(3, 4), B(3, 4);
+	for (size_t i = 0; i < 3; ++i) {
+		for (size_t j = 0; j < 4; ++j) {
+			A(i, j) = Scalar(1.0 + double(i) + double(j) / 8.0);
+			B(i, j) = Scalar(0.25 * double(i * 4 + j) - 1.0);
+		}
+	}
+	Scalar a(1.5);
+	Matrix C = expr(A) * a + 2.0 * expr(B) - expr(A) / a;
+	Matrix D = a * A;   // an element type scalar selects the eager operator in both modes
+	for (size_t i = 0; i < 3; ++i) {
+		for (size_t j = 0; j < 4; ++j) {
+			if (C(i, j) != a * A(i, j) + Scalar(2.0) * B(i, j) - A(i, j) / a) ++nrOfFailures;
+			if (D(i, j) != a * A(i, j)) ++nrOfFailures;
+		}
+	}
+	if (nrOfFailures) std::cout << std::setw(14) << tag << " matrix scaling expressions FAIL\n";
+	return nrOfFailures;
+}
+
+int main(int argc, char** argv)
+try {
+	using namespace std;
+	using namespace sw::unum;
+
+	// usage: expression_templates [N]
+	// the default sizes are kept small enough to run as a regression test, pass 10000000 for the full benchmark
+	size_t N = (argc > 1 ? size_t(atol(argv[1])) : size_t(1000000));
+
+	int nrOfFailedTestCases = 0;
+
+	cout << "Expression templates versus eager vector operators\n";
+	nrOfFailedTestCases += BenchmarkExpressions<float>("float", N);
+	nrOfFailedTestCases += BenchmarkExpressions<double>("double", N);
+	nrOfFailedTestCases += BenchmarkExpressions< posit<16, 1> >("posit<16,1>", N);
+	nrOfFailedTestCases += BenchmarkExpressions< posit<32, 2> >("posit<32,2>", N / 10);
+	nrOfFailedTestCases += VerifyMatrixScaling<float>("float");
+	nrOfFailedTestCases += VerifyMatrixScaling< posit<32, 2> >("posit<32,2>");
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const std::runtime_error& err) {
+	std::cerr << "Uncaught runtime exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
@@ -73,8 +73,8 @@ void Test1() {
 
 	// A = L + D + U decomposition
 	auto D = diag(diag(A));
-	auto L = tril(A) - D;
-	auto U = triu(A) - D;
+	Matrix L = tril(A) - D;
+	Matrix U = triu(A) - D;
 
 	auto I = eye<Scalar>(num_cols(A));
 	L += I;
@@ -158,14 +158,15 @@ void TestNearSingular() {
 	};
 	cout << "eps: " << Aeps(2, 2) << endl;
 	Scalar m = 1024;
-	Matrix B = sw::unum::blas::inv(A + m * Aeps);
-	cout << "Test matrix with poor condition number\n" << (A + m * Aeps) << endl;
+	Matrix Am = A + m * Aeps;
+	Matrix B = sw::unum::blas::inv(Am);
+	cout << "Test matrix with poor condition number\n" << Am << endl;
 	if (num_cols(B) == 0) {
 		cout << "singular matrix\n";
 	}
 	else {
 		cout << "Inverse\n" << B << endl;
-		cout << "Validation to Identity matrix\n" << B * (A + m * Aeps) << endl;
+		cout << "Validation to Identity matrix\n" << B * Am << endl;
 	}
 	cout << "--------------------------------\n\n";
 }
@@ -0,0 +1,121 @@
+// iterative_refinement.cpp: mixed-precision iterative refinement against a direct solve in the working precision
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <string>
+// enable posit arithmetic exceptions
+#define POSIT_THROW_ARITHMETIC_EXCEPTION 1
+// enable fast posits
+#define POSIT_FAST_SPECIALIZATION
+#include <universal/posit/posit>
+#include <universal/blas/blas.hpp>
+#include <universal/blas/generators.hpp>
+
+// largest element-wise error of the solution against the exact solution of all ones
+template<typename Scalar>
+double ForwardError(const sw::unum::blas::vector<Scalar>& x) {
+	double e = 0.0;
+	for (size_t i = 0; i < size(x); ++i) {
+		double d = double(x[i]) - 1.0;
+		if (d < 0) d = -d;
+		if (d > e) e = d;
+	}
+	return e;
+}
+
+// solve A x = b with b = A * 1 directly in the working type and through refinement of a LowScalar factorization
+template<typename LowScalar, typename Scalar>
+int CompareSolvers(const std::string& tag, const std::string& matrixTag, const sw::unum::blas::matrix<Scalar>& A, bool expectConvergence) {
+	using namespace std::chrono;
+	using namespace sw::unum::blas;
+	using std::cout;
+	using std::setw;
+	size_t N = num_rows(A);
+	vector<Scalar> ones(N), b(N);
+	ones = Scalar(1);
+	matvec(A, ones, b);
+
+	steady_clock::time_point t1 = steady_clock::now();
+	vector<Scalar> xd = blocked_solve(A, b);
+	steady_clock::time_point t2 = steady_clock::now();
+	vector<Scalar> xr;
+	refinement_report<Scalar> report = solve_refine<LowScalar>(A, b, xr);
+	steady_clock::time_point t3 = steady_clock::now();
+	double direct = duration_cast<duration<double>>(t2 - t1).count();
+	double refined = duration_cast<duration<double>>(t3 - t2).count();
+
+	bool pass = (report.converged == expectConvergence);
+	cout << setw(26) << tag << setw(12) << matrixTag << " N = " << setw(4) << N
+		<< "  direct " << setw(10) << direct << " sec  error " << setw(12) << ForwardError(xd)
+		<< "  | refined " << setw(10) << refined << " sec  error " << setw(12) << ForwardError(xr)
+		<< "  steps " << setw(2) << report.iterations << "  backward error " << setw(12) << double(report.backward_error)
+		<< (report.converged ? "  converged" : "  stalled  ") << (pass ? "  PASS" : "  FAIL") << '\n';
+	return (pass ? 0 : 1);
+}
+
+template<typename LowScalar, typename Scalar>
+int Benchmark(const std::string& tag, size_t N, size_t hilbertOrder, bool hilbertConverges) {
+	using namespace sw::unum::blas;
+	int nrOfFailures = 0;
+	matrix<Scalar> A(N, N);
+	uniform_rand(A, -1.0, 1.0);
+	for (size_t i = 0; i < N; ++i) A(i, i) += Scalar(1.0);   // keep the random matrix away from singularity
+	nrOfFailures += CompareSolvers<LowScalar>(tag, "uniform", A, true);
+	matrix<Scalar> H(hilbertOrder, hilbertOrder);
+	GenerateHilbertMatrix(H, false);
+	nrOfFailures += CompareSolvers<LowScalar>(tag, "hilbert", H, hilbertConverges);
+	return nrOfFailures;
+}
+
+int main(int argc, char** argv)
+try {
+	using namespace std;
+	using namespace sw::unum;
+
+	// usage: iterative_refinement [N]
+	// the default size is kept small enough to run as a regression test
+	size_t N = (argc > 1 ? size_t(atol(argv[1])) : size_t(64));
+
+	int nrOfFailedTestCases = 0;
+
+	cout << "Mixed-precision iterative refinement: factor in the narrow type, refine in the working type\n";
+	nrOfFailedTestCases += Benchmark<float, double>("float -> double", 4 * N, 6, true);
+	nrOfFailedTestCases += Benchmark< posit<16, 1>, posit<32, 2> >("posit<16,1> -> posit<32,2>", N, 3, true);
+	nrOfFailedTestCases += Benchmark< posit<32, 2>, posit<64, 3> >("posit<32,2> -> posit<64,3>", N / 2, 5, true);
+	// a Hilbert matrix beyond the reach of the narrow factorization: refinement detects that it cannot converge
+	nrOfFailedTestCases += CompareSolvers< posit<16, 1> >("posit<16,1> -> posit<32,2>", "hilbert", [] {
+		sw::unum::blas::matrix< posit<32, 2> > H(8, 8);
+		sw::unum::blas::GenerateHilbertMatrix(H, false);
+		return H;
+	}(), false);
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const std::runtime_error& err) {
+	std::cerr << "Uncaught runtime exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
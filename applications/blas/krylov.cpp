@@ -0,0 +1,166 @@
+// krylov.cpp: preconditioned Krylov solvers on dense, sparse, and matrix-free operators
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <string>
+// enable posit arithmetic exceptions
+#define POSIT_THROW_ARITHMETIC_EXCEPTION 1
+// enable fast posits
+#define POSIT_FAST_SPECIALIZATION
+#include <universal/posit/posit>
+#include <universal/blas/blas.hpp>
+#include <universal/blas/generators.hpp>
+
+// nonsymmetric convection-diffusion operator on an m x n grid: the 2D Laplacian plus an upwind convection term
+template<typename Scalar>
+sw::unum::blas::sparse_matrix<Scalar> ConvectionDiffusion(size_t m, size_t n, double convection) {
+	using namespace sw::unum::blas;
+	std::vector< sparse_entry<Scalar> > entries;
+	for (size_t i = 0; i < m; ++i) {
+		for (size_t j = 0; j < n; ++j) {
+			size_t row = i * n + j;
+			entries.push_back({ row, row, Scalar(4.0 + convection) });
+			if (j > 0)     entries.push_back({ row, row - 1, Scalar(-1.0 - convection) });
+			if (j < n - 1) entries.push_back({ row, row + 1, Scalar(-1.0) });
+			if (i > 0)     entries.push_back({ row, row - n, Scalar(-1.0) });
+			if (i < m - 1) entries.push_back({ row, row + n, Scalar(-1.0) });
+		}
+	}
+	return sparse_matrix<Scalar>(m * n, m * n, entries);
+}
+
+// relative residual ||b - A x|| / ||b|| recomputed from the solution
+template<typename Operator, typename Scalar>
+double TrueResidual(const Operator& A, const sw::unum::blas::vector<Scalar>& b, const sw::unum::blas::vector<Scalar>& x) {
+	using namespace sw::unum::blas;
+	vector<Scalar> r(size(b));
+	matvec(A, x, r);
+	for (size_t i = 0; i < size(b); ++i) r[i] = b[i] - r[i];
+	return double(fused_norm2(r)) / double(fused_norm2(b));
+}
+
+template<typename Operator, typename Scalar, typename Solve>
+int Run(const std::string& tag, const std::string& method, const Operator& A, const sw::unum::blas::vector<Scalar>& b, double tolerance, Solve&& solve) {
+	using namespace std::chrono;
+	sw::unum::blas::vector<Scalar> x(size(b));
+	x = Scalar(0);
+	steady_clock::time_point begin = steady_clock::now();
+	auto report = solve(A, b, x);
+	steady_clock::time_point end = steady_clock::now();
+	double elapsed = duration_cast<duration<double>>(end - begin).count();
+	double residual = TrueResidual(A, b, x);
+	// the recomputed residual may exceed the tracked residual by the rounding error of the updates
+	bool pass = report.converged && residual < 10.0 * tolerance;
+	std::cout << std::setw(14) << tag << std::setw(24) << method << "  iterations " << std::setw(5) << report.iterations
+		<< "  residual " << std::setw(12) << residual << "  " << std::setw(10) << elapsed << " sec" << (pass ? "  PASS" : "  FAIL") << '\n';
+	return (pass ? 0 : 1);
+}
+
+template<typename Scalar>
+int SolveLaplacian(const std::string& tag, size_t gridSize, double tolerance) {
+	using namespace sw::unum::blas;
+	using Vector = sw::unum::blas::vector<Scalar>;
+	int nrOfFailures = 0;
+	sparse_matrix<Scalar> A = sparse_laplace2D<Scalar>(gridSize, gridSize);
+	size_t N = A.rows();
+	Vector b(N);
+	for (size_t i = 0; i < N; ++i) b[i] = Scalar(1.0 + double(i % 5) / 4.0);
+	Scalar tol(tolerance);
+	size_t maxIterations = 10 * N;
+
+	jacobi_preconditioner<Scalar> jacobi(A);
+	ilu0_preconditioner<Scalar> ilu0(A);
+	nrOfFailures += Run(tag, "CG", A, b, tolerance, [&](const auto& A, const Vector& b, Vector& x) { return cg(A, b, x, tol, maxIterations); });
+	nrOfFailures += Run(tag, "CG + Jacobi", A, b, tolerance, [&](const auto& A, const Vector& b, Vector& x) { return cg(A, b, x, jacobi, tol, maxIterations); });
+	nrOfFailures += Run(tag, "CG + ILU(0)", A, b, tolerance, [&](const auto& A, const Vector& b, Vector& x) { return cg(A, b, x, ilu0, tol, maxIterations); });
+
+	// the same operator without storing it: the 5-point stencil applied on the fly
+	auto stencil = make_operator<Scalar>(N, [gridSize](const Vector& x, Vector& y) {
+		size_t n = gridSize;
+		sw::unum::parallel_for(0, n * n, [&](size_t row) {
+			size_t i = row / n, j = row % n;
+			Scalar s = Scalar(4) * x[row];
+			if (i > 0)     s -= x[row - n];
+			if (j > 0)     s -= x[row - 1];
+			if (j < n - 1) s -= x[row + 1];
+			if (i < n - 1) s -= x[row + n];
+			y[row] = s;
+		});
+	});
+	nrOfFailures += Run(tag, "CG matrix-free", stencil, b, tolerance, [&](const auto& A, const Vector& b, Vector& x) { return cg(A, b, x, tol, maxIterations); });
+	return nrOfFailures;
+}
+
+template<typename Scalar>
+int SolveConvectionDiffusion(const std::string& tag, size_t gridSize, double tolerance) {
+	using namespace sw::unum::blas;
+	using Vector = sw::unum::blas::vector<Scalar>;
+	int nrOfFailures = 0;
+	sparse_matrix<Scalar> A = ConvectionDiffusion<Scalar>(gridSize, gridSize, 2.0);
+	size_t N = A.rows();
+	Vector b(N);
+	for (size_t i = 0; i < N; ++i) b[i] = Scalar(1.0 - double(i % 3) / 4.0);
+	Scalar tol(tolerance);
+	size_t maxIterations = 10 * N;
+
+	ilu0_preconditioner<Scalar> ilu0(A);
+	nrOfFailures += Run(tag, "BiCGSTAB", A, b, tolerance, [&](const auto& A, const Vector& b, Vector& x) { return bicgstab(A, b, x, tol, maxIterations); });
+	nrOfFailures += Run(tag, "BiCGSTAB + ILU(0)", A, b, tolerance, [&](const auto& A, const Vector& b, Vector& x) { return bicgstab(A, b, x, ilu0, tol, maxIterations); });
+	nrOfFailures += Run(tag, "GMRES(20)", A, b, tolerance, [&](const auto& A, const Vector& b, Vector& x) { return gmres(A, b, x, 20, tol, maxIterations); });
+	nrOfFailures += Run(tag, "GMRES(20) + ILU(0)", A, b, tolerance, [&](const auto& A, const Vector& b, Vector& x) { return gmres(A, b, x, ilu0, 20, tol, maxIterations); });
+
+	// dense operator of a small system
+	matrix<Scalar> D = ConvectionDiffusion<Scalar>(6, 6, 2.0).dense();
+	Vector d(size_t(36));
+	for (size_t i = 0; i < 36; ++i) d[i] = Scalar(double(i % 7) - 3.0);
+	nrOfFailures += Run(tag, "dense GMRES + Jacobi", D, d, tolerance, [&](const auto& A, const Vector& b, Vector& x) { return gmres(A, b, x, jacobi_preconditioner<Scalar>(A), 10, tol, size_t(200)); });
+	return nrOfFailures;
+}
+
+int main(int argc, char** argv)
+try {
+	using namespace std;
+	using namespace sw::unum;
+
+	// usage: krylov [gridSize]
+	size_t gridSize = (argc > 1 ? size_t(atol(argv[1])) : size_t(32));
+
+	int nrOfFailedTestCases = 0;
+
+	cout << "Krylov solvers on the 2D Laplacian and a convection-diffusion operator\n";
+	// the quire-fused posit kernels are emulated in software, so the posit systems are kept smaller
+	nrOfFailedTestCases += SolveLaplacian<double>("double", gridSize, 1.0e-10);
+	nrOfFailedTestCases += SolveLaplacian< posit<32, 2> >("posit<32,2>", gridSize / 2, 1.0e-5);
+	nrOfFailedTestCases += SolveConvectionDiffusion<double>("double", gridSize, 1.0e-10);
+	nrOfFailedTestCases += SolveConvectionDiffusion< posit<32, 2> >("posit<32,2>", gridSize / 2, 1.0e-5);
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const std::runtime_error& err) {
+	std::cerr << "Uncaught runtime exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
@@ -151,7 +151,7 @@ void FrankMatrixTest() {
 	sw::unum::blas::vector<size_t> p;
 	ludcmp(A, p);
 	auto xx = lubksb(A, p, b);
-	auto e = xx - x;
+	Vector e = xx - x;
 	Scalar infnorm = -1;
 	for (auto v : e) {
 		if (fabs(v) > infnorm) {
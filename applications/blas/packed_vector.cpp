@@ -0,0 +1,153 @@
+// packed_vector.cpp: footprint and throughput of bit-packed posit vectors
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <string>
+// enable posit arithmetic exceptions
+#define POSIT_THROW_ARITHMETIC_EXCEPTION 1
+// enable fast posits
+#define POSIT_FAST_SPECIALIZATION
+#include <universal/posit/posit>
+#include <universal/blas/blas.hpp>
+#include <universal/blas/generators.hpp>
+
+// every access path must reproduce the encodings of the unpacked reference vector
+template<typename Scalar>
+int VerifyAccess(size_t N) {
+	using namespace sw::unum::blas;
+	int nrOfFailures = 0;
+	vector<Scalar> ref(N);
+	for (size_t i = 0; i < N; ++i) ref[i].set_raw_bits(uint64_t(i * 2654435761ull) ^ uint64_t(i >> 3));
+	packed_vector<Scalar> p(ref);
+	// bulk unpack
+	vector<Scalar> u = p.unpack();
+	for (size_t i = 0; i < N; ++i) if (u[i].encoding() != ref[i].encoding()) ++nrOfFailures;
+	// streaming iterators
+	size_t i = 0;
+	for (auto it = p.cbegin(); it != p.cend(); ++it, ++i) if ((*it).encoding() != ref[i].encoding()) ++nrOfFailures;
+	// proxy writes in reverse order must not disturb the neighboring elements
+	packed_vector<Scalar> q(N);
+	for (size_t k = N; k-- > 0; ) q[k] = ref[k];
+	if (q != p) ++nrOfFailures;
+	// proxy arithmetic matches the unpacked arithmetic
+	Scalar a(0.5);
+	for (size_t k = 0; k < N; ++k) {
+		if (ref[k].isnar()) continue;
+		q[k] *= a;
+		if (q[k] != ref[k] * a) ++nrOfFailures;
+	}
+	// shrinking and growing yields zeros
+	q.resize(N / 2);
+	q.resize(N);
+	for (size_t k = N / 2; k < N; ++k) if (!Scalar(q[k]).iszero()) ++nrOfFailures;
+	// standard algorithms through the iterators
+	std::copy(p.begin(), p.end(), q.begin());
+	if (q != p) ++nrOfFailures;
+	return nrOfFailures;
+}
+
+// the L1 and L2 routines on packed vectors produce the results of the unpacked vectors
+template<typename Scalar>
+int VerifyBlas(size_t N) {
+	using namespace sw::unum::blas;
+	int nrOfFailures = 0;
+	vector<Scalar> x(N), y(N);
+	for (size_t i = 0; i < N; ++i) {
+		x[i] = Scalar(double(i % 17) / 16.0 - 0.5);
+		y[i] = Scalar(double(i % 13) / 8.0);
+	}
+	packed_vector<Scalar> px(x), py(y);
+	Scalar d = fused_kernel<Scalar>::dot(0, N, [&](size_t i) { return x[i]; }, [&](size_t i) { return y[i]; });
+	if (dot(px, py) != d) ++nrOfFailures;
+	axpy(N, Scalar(2), x, 1, y, 1);
+	axpy(N, Scalar(2), px, 1, py, 1);
+	for (size_t i = 0; i < N; ++i) if (py[i] != y[i]) ++nrOfFailures;
+	matrix<Scalar> A(N / 4, N);
+	uniform_rand(A, -1.0, 1.0);
+	vector<Scalar> b(N / 4);
+	gemv(matrix_view<const Scalar>(A), vector_view<const Scalar>(x), vector_view<Scalar>(b));
+	packed_vector<Scalar> pb;
+	gemv(A, px, pb);
+	for (size_t i = 0; i < N / 4; ++i) if (pb[i] != b[i]) ++nrOfFailures;
+	return nrOfFailures;
+}
+
+template<typename Scalar>
+int Benchmark(const std::string& tag, size_t N) {
+	using namespace std::chrono;
+	using namespace sw::unum::blas;
+	using std::cout;
+	using std::setw;
+	int nrOfFailures = VerifyAccess<Scalar>(1031) + VerifyBlas<Scalar>(256);
+
+	vector<Scalar> x(N), y(N);
+	for (size_t i = 0; i < N; ++i) {
+		x[i] = Scalar(double(i % 1024) / 1024.0);
+		y[i] = Scalar(1.0 - double(i % 511) / 512.0);
+	}
+	packed_vector<Scalar> px(x), py(y);
+	steady_clock::time_point t1 = steady_clock::now();
+	Scalar d1 = fused_kernel<Scalar>::dot(0, N, [&](size_t i) { return x[i]; }, [&](size_t i) { return y[i]; });
+	steady_clock::time_point t2 = steady_clock::now();
+	Scalar d2 = dot(px, py);
+	steady_clock::time_point t3 = steady_clock::now();
+	if (d1 != d2) ++nrOfFailures;
+	double unpacked = duration_cast<duration<double>>(t2 - t1).count();
+	double packed = duration_cast<duration<double>>(t3 - t2).count();
+	cout << setw(12) << tag << "  N = " << N
+		<< "  vector " << setw(9) << N * sizeof(Scalar) << " bytes  packed " << setw(9) << px.storage() << " bytes ("
+		<< std::setprecision(3) << double(N * sizeof(Scalar)) / double(px.storage()) << "x smaller)"
+		<< "  fused dot " << setw(10) << unpacked << " sec  packed " << setw(10) << packed << " sec"
+		<< (nrOfFailures ? "  FAIL" : "  PASS") << '\n';
+	return nrOfFailures;
+}
+
+int main(int argc, char** argv)
+try {
+	using namespace std;
+	using namespace sw::unum;
+
+	// usage: packed_vector [N]
+	size_t N = (argc > 1 ? size_t(atol(argv[1])) : size_t(100000));
+
+	int nrOfFailedTestCases = 0;
+
+	cout << "Bit-packed posit vectors\n";
+	nrOfFailedTestCases += Benchmark< posit< 8, 0> >("posit<8,0>", N);
+	nrOfFailedTestCases += Benchmark< posit<10, 1> >("posit<10,1>", N);
+	nrOfFailedTestCases += Benchmark< posit<12, 1> >("posit<12,1>", N);
+	nrOfFailedTestCases += Benchmark< posit<14, 1> >("posit<14,1>", N);
+	nrOfFailedTestCases += Benchmark< posit<16, 1> >("posit<16,1>", N);
+	nrOfFailedTestCases += Benchmark< posit<20, 1> >("posit<20,1>", N);
+	nrOfFailedTestCases += Benchmark< posit<32, 2> >("posit<32,2>", N);
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const std::runtime_error& err) {
+	std::cerr << "Uncaught runtime exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
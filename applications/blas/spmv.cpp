@@ -0,0 +1,159 @@
+// spmv.cpp: bandwidth benchmark of sparse matrix-vector products on Laplacian difference operators
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <string>
+// enable posit arithmetic exceptions
+#define POSIT_THROW_ARITHMETIC_EXCEPTION 1
+// enable fast posits
+#define POSIT_FAST_SPECIALIZATION
+#include <universal/posit/posit>
+#include <universal/blas/blas.hpp>
+#include <universal/blas/generators.hpp>
+
+// CSR, sliced ELL, and dense products of a small 2D Laplacian must agree element for element
+template<typename Scalar>
+int VerifyFormats(size_t m, size_t n) {
+	using namespace sw::unum::blas;
+	int nrOfFailures = 0;
+	matrix<Scalar> D;
+	laplace2D(D, m, n);
+	sparse_matrix<Scalar> A = sparse_laplace2D<Scalar>(m, n);
+	sliced_ell_matrix<Scalar, 8> E(A);
+	if (A.nnz() != E.nnz() || A.dense() != D) ++nrOfFailures;
+	if (sparse_matrix<Scalar>(D).row_ptr() != A.row_ptr()) ++nrOfFailures;
+	vector<Scalar> x(m * n);
+	for (size_t i = 0; i < m * n; ++i) x[i] = Scalar(1.0 + double(i % 7) / 8.0);
+	vector<Scalar> yd = D * x;
+	vector<Scalar> ya = A * x;
+	vector<Scalar> ye = E * x;
+	for (size_t i = 0; i < m * n; ++i) if (yd[i] != ya[i] || yd[i] != ye[i]) ++nrOfFailures;
+	// the 3D operator: every row sums to 6 minus the number of neighbors, so A * 1 counts the missing neighbors
+	sparse_matrix<Scalar> L = sparse_laplace3D<Scalar>(3, 4, 5);
+	vector<Scalar> ones(L.cols()), r(L.rows());
+	ones = Scalar(1);
+	spmv(L, ones, r);
+	if (r[0] != Scalar(3) || r[(1 * 4 + 1) * 5 + 1] != Scalar(0) || L.nnz() != 7 * 60 - 2 * (4 * 5 + 3 * 5 + 3 * 4)) ++nrOfFailures;
+	return nrOfFailures;
+}
+
+// duplicate coordinates are summed in the order they are given, independent of the order of the other entries
+int VerifyAssembly() {
+	using namespace sw::unum::blas;
+	constexpr size_t rows = 4;
+	std::vector< sparse_entry<double> > entries;
+	double expected[rows] = { 0.0, 0.0, 0.0, 0.0 };
+	for (size_t k = 0; k < 256; ++k) {
+		// terms of very different magnitude, so that the rounded sums depend on the order of the terms
+		double value = (k % 3 == 0 ? 1.0e16 : (k % 3 == 1 ? 1.0 : -1.0e16)) * (1.0 + double(k) / 256.0);
+		entries.push_back({ rows - 1 - k % rows, 0, value });
+		expected[rows - 1 - k % rows] += value;
+	}
+	sparse_matrix<double> A(rows, 1, entries);
+	int nrOfFailures = (A.nnz() == rows ? 0 : 1);
+	for (size_t i = 0; i < rows; ++i) if (A.dense()(i, 0) != expected[i]) ++nrOfFailures;
+	return nrOfFailures;
+}
+
+template<typename Scalar>
+bool Identical(const sw::unum::blas::vector<Scalar>& a, const sw::unum::blas::vector<Scalar>& b) {
+	if (size(a) != size(b)) return false;
+	for (size_t i = 0; i < size(a); ++i) if (a[i] != b[i]) return false;
+	return true;
+}
+
+template<typename Scalar, typename Matrix>
+double TimeSpmv(const Matrix& A, const sw::unum::blas::vector<Scalar>& x, sw::unum::blas::vector<Scalar>& y, unsigned nrThreads, unsigned reps) {
+	using namespace std::chrono;
+	steady_clock::time_point begin = steady_clock::now();
+	for (unsigned r = 0; r < reps; ++r) spmv(A, x, y, nrThreads);
+	steady_clock::time_point end = steady_clock::now();
+	return duration_cast<duration<double>>(end - begin).count() / reps;
+}
+
+// report time and effective bandwidth: the bytes of the matrix plus one read of x and one write of y
+template<typename Scalar>
+int BenchmarkSpmv(const std::string& tag, size_t gridSize, unsigned reps) {
+	using namespace sw::unum::blas;
+	using std::cout;
+	using std::setw;
+	int nrOfFailures = 0;
+	sparse_matrix<Scalar> A = sparse_laplace2D<Scalar>(gridSize, gridSize);
+	sliced_ell_matrix<Scalar> E(A);
+	size_t N = A.rows();
+	vector<Scalar> x(N), y(N), yref(N);
+	for (size_t i = 0; i < N; ++i) x[i] = Scalar(double(i % 1024) / 512.0 - 1.0);
+	spmv(A, x, yref, 1);
+	size_t vectorBytes = 2 * N * sizeof(Scalar);
+
+	cout << tag << "  grid " << gridSize << 'x' << gridSize << "  N = " << N << "  nnz = " << A.nnz()
+		<< "  CSR " << A.storage() << " bytes  sliced ELL " << E.storage() << " bytes (" << std::setprecision(3) << 100.0 * E.padding() << "% padding)\n";
+	unsigned maxThreads = sw::unum::hardware_concurrency();
+	for (unsigned nrThreads = 1; ; nrThreads = (2 * nrThreads < maxThreads ? 2 * nrThreads : maxThreads)) {
+		double csr = TimeSpmv(A, x, y, nrThreads, reps);
+		if (!Identical(y, yref)) ++nrOfFailures;     // the fused row reductions do not depend on the number of threads
+		double ell = TimeSpmv(E, x, y, nrThreads, reps);
+		if (!Identical(y, yref)) ++nrOfFailures;
+		cout << "  threads " << setw(3) << nrThreads
+			<< "  CSR " << setw(10) << csr << " sec " << setw(8) << double(A.storage() + vectorBytes) / csr / 1.0e9 << " GB/s"
+			<< "  sliced ELL " << setw(10) << ell << " sec " << setw(8) << double(E.storage() + vectorBytes) / ell / 1.0e9 << " GB/s\n";
+		if (nrThreads == maxThreads) break;
+	}
+	return nrOfFailures;
+}
+
+int main(int argc, char** argv)
+try {
+	using namespace std;
+	using namespace sw::unum;
+
+	// usage: spmv [gridSize [repetitions]]
+	// the default grid is kept small enough to run as a regression test, pass 1000 for a 10^6 unknown problem
+	size_t gridSize = (argc > 1 ? size_t(atol(argv[1])) : size_t(256));
+	unsigned reps = (argc > 2 ? unsigned(atoi(argv[2])) : 5u);
+
+	int nrOfFailedTestCases = 0;
+
+	cout << "Sparse matrix-vector product on the 2D Laplacian\n";
+	nrOfFailedTestCases += VerifyFormats<double>(5, 7);
+	nrOfFailedTestCases += VerifyFormats< posit<32, 2> >(6, 5);
+	nrOfFailedTestCases += VerifyFormats< posit<16, 1> >(4, 9);
+	nrOfFailedTestCases += VerifyAssembly();
+	cout << "CSR, sliced ELL, and dense products " << (nrOfFailedTestCases ? "FAIL" : "PASS") << '\n';
+
+	// software posit arithmetic is orders of magnitude slower than native floating-point, so the posit grids are smaller
+	nrOfFailedTestCases += BenchmarkSpmv<float>("float", gridSize, reps);
+	nrOfFailedTestCases += BenchmarkSpmv<double>("double", gridSize, reps);
+	nrOfFailedTestCases += BenchmarkSpmv< posit<16, 1> >("posit<16,1>", gridSize / 2, reps);
+	nrOfFailedTestCases += BenchmarkSpmv< posit<32, 2> >("posit<32,2>", gridSize / 4, reps);
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const std::runtime_error& err) {
+	std::cerr << "Uncaught runtime exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
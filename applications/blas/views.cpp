@@ -0,0 +1,229 @@
+// views.cpp: example program showing zero-copy matrix and vector views over owned and external memory
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <vector>
+// enable posit arithmetic exceptions
+#define POSIT_THROW_ARITHMETIC_EXCEPTION 1
+#include <universal/posit/posit>
+#include <universal/blas/blas.hpp>
+#include <universal/blas/generators.hpp>
+
+// views of submatrices, transposes, rows and columns alias the matrix they were created from
+template<typename Scalar>
+int ViewAliasing(bool bReportIndividualTestCases) {
+	using namespace sw::unum::blas;
+	int nrOfFailedTests = 0;
+	matrix<Scalar> A(4, 5);
+	for (size_t i = 0; i < 4; ++i) for (size_t j = 0; j < 5; ++j) A(i, j) = Scalar(10 * i + j);
+
+	matrix_view<Scalar> V(A);
+	auto S = V.submatrix(1, 2, 2, 3);           // rows 1..2, columns 2..4
+	auto T = V.transpose();
+	if (S(0, 0) != A(1, 2) || S(1, 2) != A(2, 4)) ++nrOfFailedTests;
+	if (T(4, 3) != A(3, 4) || num_rows(T) != 5 || num_cols(T) != 4) ++nrOfFailedTests;
+	S(1, 1) = Scalar(-1);                       // writes through to A(2,3)
+	if (A(2, 3) != Scalar(-1)) ++nrOfFailedTests;
+	auto c = V.column(3);
+	auto r = T.row(3);                          // row 3 of the transpose is column 3 of A
+	for (size_t i = 0; i < 4; ++i) if (c[i] != A(i, 3) || r[i] != A(i, 3)) ++nrOfFailedTests;
+	// a transposed submatrix is a submatrix of the transpose
+	auto ST = S.transpose();
+	auto TS = T.submatrix(2, 1, 3, 2);
+	for (size_t i = 0; i < 3; ++i) for (size_t j = 0; j < 2; ++j) if (ST(i, j) != TS(i, j)) ++nrOfFailedTests;
+	// A[i][j] through a view
+	if (V[3][4] != A(3, 4)) ++nrOfFailedTests;
+	if (bReportIndividualTestCases) std::cout << "submatrix\n" << S << "transpose\n" << T;
+	return nrOfFailedTests;
+}
+
+// wrap a column-major buffer owned by the caller and compute with it without copying
+template<typename Scalar>
+int ExternalColumnMajor(bool bReportIndividualTestCases) {
+	using namespace sw::unum::blas;
+	int nrOfFailedTests = 0;
+	constexpr size_t M = 3, N = 4, LD = 5;      // leading dimension larger than the number of rows
+	std::vector<Scalar> buffer(LD * N, Scalar(0));
+	matrix<Scalar> A(M, N);
+	for (size_t i = 0; i < M; ++i) {
+		for (size_t j = 0; j < N; ++j) {
+			A(i, j) = Scalar(i + 1) / Scalar(j + 2);
+			buffer[j * LD + i] = A(i, j);
+		}
+	}
+	matrix_view<const Scalar> Ext(buffer.data(), M, N, layout::column_major, LD);
+	if (!Ext.is_column_major()) ++nrOfFailedTests;
+	vector<Scalar> x = { 1, -2, 3, -4 };
+	vector<Scalar> y(M);
+	gemv(Ext, vector_view<const Scalar>(x), vector_view<Scalar>(y));
+	vector<Scalar> ref = A * x;
+	for (size_t i = 0; i < M; ++i) if (y[i] != ref[i]) ++nrOfFailedTests;
+
+	// L1 functions take views: the dot product of a row of the external matrix with itself
+	auto row1 = Ext.row(1);
+	Scalar d = dot(row1, row1);
+	Scalar e(0);
+	for (size_t j = 0; j < N; ++j) e += A(1, j) * A(1, j);
+	if (d != e) ++nrOfFailedTests;
+	if (bReportIndividualTestCases) std::cout << "external column-major\n" << Ext << "y = " << y << '\n';
+	return nrOfFailedTests;
+}
+
+// block product C11 = A12 * B21 computed in place on submatrix views
+template<typename Scalar>
+int SubmatrixProduct(bool bReportIndividualTestCases) {
+	using namespace sw::unum::blas;
+	int nrOfFailedTests = 0;
+	constexpr size_t N = 8, NB = 4;
+	matrix<Scalar> A(N, N), B(N, N), C(N, N);
+	uniform_rand(A, -1.0, 1.0);
+	uniform_rand(B, -1.0, 1.0);
+	gemm(make_view(A, 0, NB, NB, NB), make_view(B, NB, 0, NB, NB), make_view(C, 0, 0, NB, NB));
+	// reference: copy the blocks and multiply
+	matrix<Scalar> A12 = to_matrix(make_view(A, 0, NB, NB, NB));
+	matrix<Scalar> B21 = to_matrix(make_view(B, NB, 0, NB, NB));
+	matrix<Scalar> C11 = A12 * B21;
+	for (size_t i = 0; i < N; ++i) {
+		for (size_t j = 0; j < N; ++j) {
+			Scalar expected = (i < NB && j < NB) ? C11(i, j) : Scalar(0);
+			if (C(i, j) != expected) ++nrOfFailedTests;
+		}
+	}
+	// the transposed view computes A^T * A without forming the transpose
+	matrix<Scalar> ATA(N, N);
+	gemm(transpose(matrix_view<const Scalar>(A)), matrix_view<const Scalar>(A), matrix_view<Scalar>(ATA));
+	matrix<Scalar> ref = transpose(A) * A;
+	if (ATA != ref) ++nrOfFailedTests;
+	if (bReportIndividualTestCases) std::cout << "C\n" << C;
+	return nrOfFailedTests;
+}
+
+// factor the leading block of a larger matrix in place, and a column-major copy of the same matrix
+template<typename Scalar>
+int BlockedLUOnViews(bool bReportIndividualTestCases) {
+	using namespace sw::unum::blas;
+	int nrOfFailedTests = 0;
+	constexpr size_t N = 12, LD = 16;
+	matrix<Scalar> A(N, N);
+	uniform_rand(A, -1.0, 1.0);
+	matrix<Scalar> LU(A);
+	vector<size_t> indx;
+	blocked_ludcmp(LU, indx, 4, 2);
+
+	// embed A in the top-left corner of a bigger matrix and factor the view
+	matrix<Scalar> Big(LD, LD);
+	make_view(Big, 0, 0, N, N).assign(A);
+	vector<size_t> p;
+	blocked_ludcmp(make_view(Big, 0, 0, N, N), p, 4, 2);
+	// column-major external storage with a padded leading dimension
+	std::vector<Scalar> buffer(LD * N, Scalar(0));
+	matrix_view<Scalar> ColMajor(buffer.data(), N, N, layout::column_major, LD);
+	ColMajor.assign(A);
+	vector<size_t> q;
+	blocked_ludcmp(ColMajor, q, 4, 2);
+
+	for (size_t i = 0; i < N; ++i) {
+		if (p[i] != indx[i] || q[i] != indx[i]) ++nrOfFailedTests;
+		for (size_t j = 0; j < N; ++j) {
+			if (Big(i, j) != LU(i, j) || ColMajor(i, j) != LU(i, j)) ++nrOfFailedTests;
+		}
+	}
+	// the padding must not have been touched
+	for (size_t j = 0; j < N; ++j) for (size_t i = N; i < LD; ++i) if (buffer[j * LD + i] != Scalar(0)) ++nrOfFailedTests;
+	if (bReportIndividualTestCases) std::cout << "LU of the view\n" << make_view(Big, 0, 0, N, N);
+	return nrOfFailedTests;
+}
+
+// standard algorithms on strided views, including a view that walks down in memory
+template<typename Scalar>
+int StridedIterators(bool bReportIndividualTestCases) {
+	using namespace sw::unum::blas;
+	int nrOfFailedTests = 0;
+	vector<Scalar> v(12);
+	for (size_t i = 0; i < 12; ++i) v[i] = Scalar(double((7 * i) % 12));
+	// the elements 11, 8, 5, 2 in that order
+	vector_view<Scalar> down = make_view(v, 11, 4, -3);
+	std::sort(down.begin(), down.end());
+	for (size_t k = 1; k < 4; ++k) if (v[11 - 3 * k] < v[11 - 3 * (k - 1)]) ++nrOfFailedTests;
+
+	typedef typename vector_view<Scalar>::iterator       iterator;
+	typedef typename vector_view<Scalar>::const_iterator const_iterator;
+	static_assert(std::is_same<typename std::iterator_traits<const_iterator>::reference, const Scalar&>::value, "const_iterator must yield read-only references");
+	iterator first = down.begin(), last = down.end();
+	const_iterator cfirst = down.cbegin(), clast = first + 4;
+	if (!(cfirst == first) || !(clast == last) || clast != 4 + first || last - first != 4) ++nrOfFailedTests;
+	if (!(last > first) || !(first <= first) || !(last >= first + 3) || first + 1 > first + 2) ++nrOfFailedTests;
+	const_iterator found = std::lower_bound(cfirst, clast, down[2]);
+	if (found - cfirst != 2 || &*found != &v[5]) ++nrOfFailedTests;
+	if (bReportIndividualTestCases) std::cout << "sorted strided view " << down << '\n';
+	return nrOfFailedTests;
+}
+
+int ReportTestResult(int nrOfFailedTests, const std::string& description, const std::string& test_operation) {
+	std::cout << description << " " << test_operation << (nrOfFailedTests > 0 ? " FAIL " : " PASS");
+	if (nrOfFailedTests > 0) std::cout << nrOfFailedTests << " failed test cases";
+	std::cout << '\n';
+	return nrOfFailedTests;
+}
+
+#define MANUAL_TESTING 0
+
+int main(int argc, char** argv)
+try {
+	using namespace std;
+	using namespace sw::unum;
+
+	bool bReportIndividualTestCases = false;
+	int nrOfFailedTestCases = 0;
+
+	cout << "BLAS matrix and vector views\n";
+
+#if MANUAL_TESTING
+	bReportIndividualTestCases = true;
+	ViewAliasing<float>(bReportIndividualTestCases);
+	ExternalColumnMajor<float>(bReportIndividualTestCases);
+#else
+	nrOfFailedTestCases += ReportTestResult(ViewAliasing<float>(bReportIndividualTestCases), "float", "view aliasing");
+	nrOfFailedTestCases += ReportTestResult(ViewAliasing< posit<16, 1> >(bReportIndividualTestCases), "posit<16,1>", "view aliasing");
+	nrOfFailedTestCases += ReportTestResult(ExternalColumnMajor<double>(bReportIndividualTestCases), "double", "external column-major");
+	nrOfFailedTestCases += ReportTestResult(ExternalColumnMajor< posit<32, 2> >(bReportIndividualTestCases), "posit<32,2>", "external column-major");
+	nrOfFailedTestCases += ReportTestResult(SubmatrixProduct<double>(bReportIndividualTestCases), "double", "submatrix gemm");
+	nrOfFailedTestCases += ReportTestResult(SubmatrixProduct< posit<32, 2> >(bReportIndividualTestCases), "posit<32,2>", "submatrix gemm");
+	nrOfFailedTestCases += ReportTestResult(BlockedLUOnViews<double>(bReportIndividualTestCases), "double", "blocked LU on views");
+	nrOfFailedTestCases += ReportTestResult(BlockedLUOnViews< posit<32, 2> >(bReportIndividualTestCases), "posit<32,2>", "blocked LU on views");
+	nrOfFailedTestCases += ReportTestResult(StridedIterators<double>(bReportIndividualTestCases), "double", "strided iterators");
+	nrOfFailedTestCases += ReportTestResult(StridedIterators< posit<16, 1> >(bReportIndividualTestCases), "posit<16,1>", "strided iterators");
+#endif // MANUAL_TESTING
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const std::runtime_error& err) {
+	std::cerr << "Uncaught runtime exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
@@ -5,7 +5,15 @@
 //
 // This file is part of the universal numbers project, which is released under an MIT Open Source license.
 #include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <string>
+#include <vector>
+// enable fast posits
+#define POSIT_FAST_POSIT_16_1 1
+#define POSIT_FAST_POSIT_32_2 1
 #include <universal/posit/posit>
+#include <universal/blas/blas.hpp>
 
 /*
 On the relation between reliable computation time, float-point precision and the
@@ -30,14 +38,107 @@ agreement with numerical experimental results, especially the scale factors.
 Keywords: reliable computation time, Lyapunov exponent, float precision
  */
 
+/*
+The experiment integrates an ensemble of trajectories of the Lorenz system with the same RK4 step in
+number systems of increasing precision, and in long double as the reference. The reliable computation
+time of a trajectory is the first time its state deviates from the reference by more than a threshold.
+All number systems use the same discretization, so the deviation is caused by rounding alone, and the
+reliable computation time grows linearly with the number of bits, by ln(2)/lambda time units per bit.
+ */
+
+// Lorenz system: x' = sigma (y - x), y' = x (rho - z) - y, z' = x y - beta z
+template<typename Scalar>
+struct Lorenz {
+	Scalar sigma, rho, beta;
+	Lorenz() : sigma(10.0), rho(28.0), beta(8.0 / 3.0) {}
+	void operator()(const Scalar*, const sw::unum::blas::ensemble<Scalar>& s, sw::unum::blas::ensemble<Scalar>& ds, size_t begin, size_t end) const {
+		const Scalar* x = s.component(0);
+		const Scalar* y = s.component(1);
+		const Scalar* z = s.component(2);
+		Scalar* dx = ds.component(0);
+		Scalar* dy = ds.component(1);
+		Scalar* dz = ds.component(2);
+		for (size_t j = begin; j < end; ++j) {
+			dx[j] = sigma * (y[j] - x[j]);
+			dy[j] = x[j] * (rho - z[j]) - y[j];
+			dz[j] = x[j] * y[j] - beta * z[j];
+		}
+	}
+};
+
+// reliable computation times of an ensemble in number system Scalar against the long double reference
+template<typename Scalar>
+std::vector<double> ReliableComputationTimes(const sw::unum::blas::ensemble<long double>& initial, double T, double dt, size_t stepsPerSample, double threshold) {
+	using namespace sw::unum::blas;
+	size_t m = initial.members();
+	ensemble<Scalar> y(3, m);
+	ensemble<long double> reference(initial);
+	for (size_t c = 0; c < 3; ++c) {
+		for (size_t j = 0; j < m; ++j) y(c, j) = Scalar(double(initial(c, j)));
+	}
+	std::vector<double> Tc(m, T);
+	std::vector<bool> diverged(m, false);
+	double sample = dt * double(stepsPerSample);
+	for (double t = 0.0; t < T; t += sample) {
+		rk4(Lorenz<Scalar>(), Scalar(t), Scalar(t + sample), stepsPerSample, y);
+		rk4(Lorenz<long double>(), (long double)t, (long double)(t + sample), stepsPerSample, reference);
+		for (size_t j = 0; j < m; ++j) {
+			if (diverged[j]) continue;
+			double deviation = 0.0;
+			for (size_t c = 0; c < 3; ++c) deviation = std::max(deviation, std::abs(double(y(c, j)) - double(reference(c, j))));
+			if (!(deviation <= threshold)) {
+				diverged[j] = true;
+				Tc[j] = t + sample;
+			}
+		}
+	}
+	return Tc;
+}
+
+template<typename Scalar>
+double MeanReliableComputationTime(const std::string& tag, int bits, const sw::unum::blas::ensemble<long double>& initial, double T) {
+	std::vector<double> Tc = ReliableComputationTimes<Scalar>(initial, T, 0.01, 10, 1.0);
+	double mean = 0.0;
+	for (double t : Tc) mean += t;
+	mean /= double(Tc.size());
+	std::cout << std::setw(14) << tag << std::setw(8) << bits << std::setw(12) << std::fixed << std::setprecision(2) << mean << '\n';
+	return mean;
+}
+
 int main()
 try {
 	using namespace std;
+	using namespace sw::unum;
+	using namespace sw::unum::blas;
 
 	cout << "Time-Precision Trade-off for Lyaponov exponent\n";
 
-    
-	return EXIT_SUCCESS;
+	// initial states on the attractor: perturb a point and let the transients decay
+	constexpr size_t members = 128;
+	ensemble<long double> initial(3, members);
+	for (size_t j = 0; j < members; ++j) {
+		initial(0, j) = 1.0L + 0.01L * (long double)j;
+		initial(1, j) = 1.0L;
+		initial(2, j) = 20.0L;
+	}
+	rk4(Lorenz<long double>(), 0.0L, 20.0L, 2000, initial);
+
+	// the largest Lyapunov exponent of the Lorenz system
+	const double lambda = 0.906;
+	const double T = 60.0;
+	cout << "mean reliable computation time of " << members << " trajectories, RK4 with step 0.01\n";
+	cout << std::setw(14) << "type" << std::setw(8) << "bits" << std::setw(12) << "Tc" << '\n';
+	// bits are the fraction bits including the hidden bit; posits have the most near 1 and fewer at the scale of the attractor
+	double Tp16 = MeanReliableComputationTime< posit<16, 1> >("posit<16,1>", 12, initial, T);
+	double Tf = MeanReliableComputationTime< float >("float", 24, initial, T);
+	double Tp32 = MeanReliableComputationTime< posit<32, 2> >("posit<32,2>", 27, initial, T);
+	double Td = MeanReliableComputationTime< double >("double", 53, initial, T);
+	cout << "observed time per bit between float and double " << (Td - Tf) / 29.0
+		<< ", predicted ln(2)/lambda " << std::log(2.0) / lambda << '\n';
+
+	// more precision buys more reliable time
+	bool ordered = (Tp16 < Tf) && (Tf < Td) && (Tp32 < Td);
+	return (ordered ? EXIT_SUCCESS : EXIT_FAILURE);
 }
 catch (char const* msg) {
 	std::cerr << msg << std::endl;
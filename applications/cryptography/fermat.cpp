@@ -15,11 +15,6 @@
 #include <universal/integer/integer>
 #include <universal/integer/primes.hpp>
 
-template<size_t nbits, typename BlockType>
-bool miller_rabin(const sw::unum::integer<nbits, BlockType>& a, int reps) {
-	return true;
-}
-
 int main(int argc, char** argv)
 try {
 	using namespace std;
@@ -48,19 +43,17 @@ try {
 
 		try {
 			stack<Integer> factors;
-			Integer a = 1049;
+			Integer a = 1049 * 1051;
 			factors.push(a);
 
 			while (!factors.empty()) {
 				Integer factor = factors.top();
 				factors.pop();
-				/*
 				if (miller_rabin(factor, 25)) {
 					// factor is prime
-					cout << factor << endl;
+					cout << "factor " << factor << " is prime" << endl;
 					continue;
 				}
-				*/
 				Integer result = fermatFactorization(factor);
 				if (result == 1) {
 					cout << "factor " << factor << " exponent " << result << endl;
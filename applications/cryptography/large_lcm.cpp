@@ -13,13 +13,14 @@
 #define INTEGER_THROW_ARITHMETIC_EXCEPTION 1
 #include <universal/integer/integer>
 
+// the least common multiple by a subproduct tree on all hardware threads
 template<size_t nbits, typename BlockType>
 void MeasureLCM(const std::vector<sw::unum::integer<nbits, BlockType>>& v) {
 	using namespace std;
 	chrono::steady_clock::time_point begin, end;
 	begin = chrono::steady_clock::now();
 	using Integer = sw::unum::integer<nbits, BlockType>;
-	Integer least_common_multple = lcm(v);
+	Integer least_common_multple = lcm(v, 0);
 	end = chrono::steady_clock::now();
 	using TimeReal = float;
 	chrono::duration<TimeReal> time_span = chrono::duration_cast<chrono::duration<TimeReal >> (end - begin);
@@ -128,6 +129,30 @@ try {
 		}
 	}
 
+	{
+		// lcm(1, ..., n) = prod p^floor(log_p n) has about n / ln(2) bits
+		constexpr size_t n = 20000;
+		constexpr size_t nbits = 32768;
+		using Integer = integer<nbits, uint32_t>;
+		vector<Integer> v;
+		for (size_t i = 1; i <= n; ++i) v.push_back(Integer(i));
+		chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+		Integer treeLcm = lcm(v, 0);
+		double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+		// the same value from the prime powers
+		vector<uint64_t> primes;
+		segmented_sieve(2, n + 1, primes);
+		vector<Integer> powers;
+		for (uint64_t p : primes) {
+			uint64_t q = p;
+			while (q <= n / p) q *= p;
+			powers.push_back(Integer(q));
+		}
+		bool pass = (treeLcm == product(powers, 0));
+		cout << "In " << elapsed << " seconds calculated LCM of 1 through " << n << " with " << findMsb(treeLcm) + 1 << " bits" << (pass ? "  PASS" : "  FAIL") << endl;
+		if (!pass) ++nrOfFailedTestCases;
+	}
+
 	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
 }
 catch (char const* msg) {
@@ -6,20 +6,126 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <stack>
 #include <random>
 #include <typeinfo>
 #include <chrono>
+#include <algorithm>
+#include <iomanip>
 // include the number system we want to use, and configure overflow exceptions so we can capture failures
-#define INTEGER_THROW_ARITHMETIC_EXCEPTION 1
+#define INTEGER_THROW_ARITHMETIC_EXCEPTION 0
 #include <universal/integer/integer>
 
+// 2^p
+template<typename Integer>
+Integer PowerOfTwo(int p) {
+	Integer r(1);
+	r <<= p;
+	return r;
+}
+
+/*
+Pollard's rho method iterates x -> x^2 + c modulo N: modulo an unknown prime factor p of N the sequence
+enters a cycle after about sqrt(p) steps, which shows as gcd(x_i - x_j, N) > 1. Brent's cycle detection
+compares against the iterate at the last power of two, and accumulates the differences in a product so that
+it takes a gcd once per batch. The iteration runs in the Montgomery domain of N, and Miller-Rabin decides
+when a factor is prime.
+ */
+
+// split a number into its prime factors, in increasing order
+template<size_t nbits, typename BlockType>
+std::vector< sw::unum::integer<nbits, BlockType> > Factor(const sw::unum::integer<nbits, BlockType>& number) {
+	using namespace sw::unum;
+	using Integer = integer<nbits, BlockType>;
+	std::vector<Integer> primes;
+	std::stack<Integer> factors;
+	factors.push(number);
+	while (!factors.empty()) {
+		Integer factor = factors.top();
+		factors.pop();
+		if (factor.isone()) continue;
+		if (miller_rabin(factor)) {
+			primes.push_back(factor);
+			continue;
+		}
+		Integer result = pollardRhoFactorization(factor);
+		if (result.isone()) throw "pollard rho did not find a factor";
+		factors.push(result);
+		factors.push(factor / result);
+	}
+	std::sort(primes.begin(), primes.end());
+	return primes;
+}
+
+// factor the number and check that the factors are prime and multiply to the number
+template<size_t nbits, typename BlockType>
+int FactorAndVerify(const sw::unum::integer<nbits, BlockType>& number) {
+	using namespace sw::unum;
+	using Integer = integer<nbits, BlockType>;
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	std::vector<Integer> primes = Factor(number);
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	Integer product(1);
+	bool pass = true;
+	std::cout << number << " =";
+	for (size_t i = 0; i < primes.size(); ++i) {
+		std::cout << (i == 0 ? " " : " * ") << primes[i];
+		product *= primes[i];
+		pass = pass && miller_rabin(primes[i]);
+	}
+	pass = pass && (product == number);
+	std::cout << "  (" << elapsed << " sec)" << (pass ? "  PASS" : "  FAIL") << '\n';
+	return (pass ? 0 : 1);
+}
+
 int main(int argc, char** argv)
 try {
 	using namespace std;
 	using namespace sw::unum;
 
+	int nrOfFailedTestCases = 0;
+
+	{
+		constexpr size_t nbits = 256;
+		using Integer = integer<nbits, uint32_t>;
+		Integer one(1);
+
+		cout << "Pollard rho with Brent's cycle detection\n";
+		nrOfFailedTestCases += FactorAndVerify(Integer(8051));
+		nrOfFailedTestCases += FactorAndVerify(Integer(1049));
+		nrOfFailedTestCases += FactorAndVerify(Integer(600851475143ll));
+		nrOfFailedTestCases += FactorAndVerify(Integer(3825123056546413051ll));
+		nrOfFailedTestCases += FactorAndVerify(PowerOfTwo<Integer>(67) - one);
+		nrOfFailedTestCases += FactorAndVerify(PowerOfTwo<Integer>(64) + one);
+		nrOfFailedTestCases += FactorAndVerify(Integer(1000000007) * Integer(998244353) * Integer(1000003));
+		nrOfFailedTestCases += FactorAndVerify(PowerOfTwo<Integer>(101) - one);
+	}
+
+	{
+		// the 1024-bit and 2048-bit candidates of key validation
+		constexpr size_t nbits = 2304;
+		using Integer = integer<nbits, uint32_t>;
+		Integer one(1);
+		cout << "\nMiller-Rabin primality of large candidates\n";
+		struct Candidate { Integer n; const char* name; bool prime; };
+		vector<Candidate> candidates = {
+			{ PowerOfTwo<Integer>(1279) - one, "2^1279 - 1", true },
+			{ PowerOfTwo<Integer>(1277) - one, "2^1277 - 1", false },
+			{ PowerOfTwo<Integer>(2203) - one, "2^2203 - 1", true },
+			{ PowerOfTwo<Integer>(2048) + one, "2^2048 + 1", false },
+			{ (PowerOfTwo<Integer>(1279) - one) * (PowerOfTwo<Integer>(607) - one), "(2^1279 - 1)(2^607 - 1)", false },
+		};
+		for (const Candidate& c : candidates) {
+			chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+			bool prime = miller_rabin(c.n);
+			double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+			bool pass = (prime == c.prime);
+			cout << setw(26) << c.name << (prime ? " is probably prime " : " is composite      ") << setw(10) << elapsed << " sec" << (pass ? "  PASS" : "  FAIL") << '\n';
+			if (!pass) ++nrOfFailedTestCases;
+		}
+	}
 
-	return EXIT_SUCCESS;
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
 }
 catch (char const* msg) {
 	std::cerr << msg << std::endl;
@@ -4,21 +4,131 @@
 //
 // This file is part of the universal numbers project, which is released under an MIT Open Source license.
 #include <iostream>
-#include <fstream>
 #include <vector>
-#include <random>
-#include <typeinfo>
+#include <stack>
+#include <string>
 #include <chrono>
+#include <algorithm>
 // include the number system we want to use, and configure overflow exceptions so we can capture failures
-#define INTEGER_THROW_ARITHMETIC_EXCEPTION 1
+#define INTEGER_THROW_ARITHMETIC_EXCEPTION 0
 #include <universal/integer/integer>
 
+/*
+The quadratic sieve collects relations (A x + b)^2 = A g(x) mod N for which g(x) factors over a base of
+small primes, and combines them with Gaussian elimination over GF(2) into a congruence of squares
+X^2 = Y^2 mod N, so that gcd(X - Y, N) is a factor of N. The self-initializing variant switches between
+the polynomials of one A with a single addition per factor base prime, and large primes and multiple
+threads speed up the collection of the relations.
+
+Usage: quadratic_sieve [decimal number ...]
+Without arguments the program factors semiprimes of increasing size as a regression.
+ */
+
+// the smallest prime >= n
+template<size_t nbits, typename BlockType>
+sw::unum::integer<nbits, BlockType> NextPrime(sw::unum::integer<nbits, BlockType> n) {
+	using Integer = sw::unum::integer<nbits, BlockType>;
+	if (n.iseven()) n += Integer(1);
+	while (!sw::unum::miller_rabin(n)) n += Integer(2);
+	return n;
+}
+
+// 10^e
+template<typename Integer>
+Integer PowerOfTen(int e) {
+	Integer r(1);
+	for (int i = 0; i < e; ++i) r *= Integer(10);
+	return r;
+}
+
+// split a number into its prime factors, in increasing order
+template<size_t nbits, typename BlockType>
+std::vector< sw::unum::integer<nbits, BlockType> > Factor(const sw::unum::integer<nbits, BlockType>& number, sw::unum::quadratic_sieve_report& report) {
+	using namespace sw::unum;
+	using Integer = integer<nbits, BlockType>;
+	std::vector<Integer> primes;
+	std::stack<Integer> factors;
+	factors.push(number);
+	while (!factors.empty()) {
+		Integer factor = factors.top();
+		factors.pop();
+		if (factor.isone()) continue;
+		if (miller_rabin(factor)) {
+			primes.push_back(factor);
+			continue;
+		}
+		Integer result = quadraticSieveFactorization(factor, 0, &report);
+		if (result.isone()) throw "quadratic sieve did not find a factor";
+		factors.push(result);
+		factors.push(factor / result);
+	}
+	std::sort(primes.begin(), primes.end());
+	return primes;
+}
+
+// factor the number and check that the factors are prime and multiply to the number
+template<size_t nbits, typename BlockType>
+int FactorAndVerify(const sw::unum::integer<nbits, BlockType>& number) {
+	using namespace sw::unum;
+	using Integer = integer<nbits, BlockType>;
+	quadratic_sieve_report report;
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	std::vector<Integer> primes = Factor(number, report);
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	Integer product(1);
+	bool pass = true;
+	std::cout << number << " =";
+	for (size_t i = 0; i < primes.size(); ++i) {
+		std::cout << (i == 0 ? " " : " * ") << primes[i];
+		product *= primes[i];
+		pass = pass && miller_rabin(primes[i]);
+	}
+	pass = pass && (product == number);
+	std::cout << "  (" << elapsed << " sec)" << (pass ? "  PASS" : "  FAIL") << '\n';
+	if (report.factorBaseSize > 0) {
+		std::cout << "    multiplier " << report.multiplier << ", factor base " << report.factorBaseSize << ", interval " << report.sieveInterval
+			<< ", polynomials " << report.polynomials << ", relations " << report.fullRelations << " full + " << report.combinedRelations << " combined"
+			<< ", sieving " << report.sieveSeconds << " sec, linear algebra " << report.linearAlgebraSeconds << " sec\n";
+	}
+	return (pass ? 0 : 1);
+}
+
 int main(int argc, char** argv)
 try {
 	using namespace std;
 	using namespace sw::unum;
 
-	return EXIT_SUCCESS;
+	constexpr size_t nbits = 512;
+	using Integer = integer<nbits, uint32_t>;
+
+	int nrOfFailedTestCases = 0;
+
+	if (argc > 1) {
+		for (int i = 1; i < argc; ++i) {
+			Integer number;
+			if (!parse(string(argv[i]), number) || number.sign() || number.iszero()) {
+				cerr << argv[i] << " is not a positive decimal number\n";
+				++nrOfFailedTestCases;
+				continue;
+			}
+			nrOfFailedTestCases += FactorAndVerify(number);
+		}
+		return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+	}
+
+	cout << "Self-initializing quadratic sieve on " << hardware_concurrency() << " threads\n";
+	// semiprimes p * q with factors of about half the digits
+	for (int digits : { 24, 30, 36, 40, 45 }) {
+		Integer p = NextPrime(PowerOfTen<Integer>(digits / 2) * Integer(3) + Integer(12345));
+		Integer q = NextPrime(PowerOfTen<Integer>(digits - digits / 2) + Integer(987651));
+		nrOfFailedTestCases += FactorAndVerify(p * q);
+	}
+	// a perfect power and a product of three primes
+	Integer p = NextPrime(PowerOfTen<Integer>(14));
+	nrOfFailedTestCases += FactorAndVerify(p * p * p);
+	nrOfFailedTestCases += FactorAndVerify(NextPrime(PowerOfTen<Integer>(11)) * NextPrime(PowerOfTen<Integer>(12)) * NextPrime(PowerOfTen<Integer>(13)));
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
 }
 catch (char const* msg) {
 	std::cerr << msg << std::endl;
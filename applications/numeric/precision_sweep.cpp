@@ -0,0 +1,191 @@
+// precision_sweep.cpp: run numerical kernels in many number systems concurrently and compare them against a reference
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+// enable fast posits
+#define POSIT_FAST_POSIT_16_1 1
+#define POSIT_FAST_POSIT_32_2 1
+#include <universal/posit/posit>
+#include <universal/fixpnt/fixpnt>
+#include <universal/blas/blas.hpp>
+#include <universal/utility/precision_sweep.hpp>
+
+/*
+Each kernel is a generic lambda that receives a scalar_tag<Scalar>, computes in Scalar, and returns its
+outputs as a std::vector<Scalar>. precision_sweep runs all instantiations on a pool of threads and reports
+the time and the error of every number system against the long double reference.
+ */
+
+// x, y, z of a Lorenz trajectory integrated with RK4, sampled every 0.25 time units up to t = 4
+auto LorenzKernel = [](auto tag) {
+	using Scalar = typename decltype(tag)::type;
+	using namespace sw::unum::blas;
+	auto lorenz = [](const Scalar*, const ensemble<Scalar>& y, ensemble<Scalar>& dydt, size_t begin, size_t end) {
+		const Scalar sigma(10.0), rho(28.0), beta(8.0 / 3.0);
+		for (size_t j = begin; j < end; ++j) {
+			dydt(0, j) = sigma * (y(1, j) - y(0, j));
+			dydt(1, j) = y(0, j) * (rho - y(2, j)) - y(1, j);
+			dydt(2, j) = y(0, j) * y(1, j) - beta * y(2, j);
+		}
+	};
+	ensemble<Scalar> y(3, 1);
+	y(0, 0) = Scalar(1.0); y(1, 0) = Scalar(1.0); y(2, 0) = Scalar(20.0);
+	std::vector<Scalar> samples;
+	for (int s = 0; s < 16; ++s) {
+		rk4(lorenz, Scalar(0.25 * s), Scalar(0.25 * (s + 1)), 25, y, 1);
+		for (size_t c = 0; c < 3; ++c) samples.push_back(y(c, 0));
+	}
+	return samples;
+};
+
+// (x - 1)^7 in its expanded form, evaluated with Horner's rule close to its root, where the terms cancel
+auto PolynomialKernel = [](auto tag) {
+	using Scalar = typename decltype(tag)::type;
+	const double coefficients[8] = { -1.0, 7.0, -21.0, 35.0, -35.0, 21.0, -7.0, 1.0 };
+	std::vector<Scalar> samples;
+	for (int i = 0; i <= 64; ++i) {
+		Scalar x(0.75 + double(i) / 128.0);
+		Scalar p(coefficients[7]);
+		for (int k = 6; k >= 0; --k) p = p * x + Scalar(coefficients[k]);
+		samples.push_back(p);
+	}
+	return samples;
+};
+
+// the solution of the Poisson equation with a point source on a 31 x 31 grid, by multigrid
+auto PoissonKernel = [](auto tag) {
+	using Scalar = typename decltype(tag)::type;
+	using namespace sw::unum::blas;
+	constexpr size_t n = 31;
+	grid<Scalar> u(n, n), f(n, n);
+	f(16, 16) = Scalar(double((n + 1) * (n + 1)));
+	multigrid(u, f, Scalar(1.0 / double(n + 1)), Scalar(1.0e-12), 6, 2, 2, 1);
+	std::vector<Scalar> samples;
+	for (size_t j = 1; j <= n; ++j)
+		for (size_t i = 1; i <= n; ++i) samples.push_back(u(i, j));
+	return samples;
+};
+
+using SweepTypes = sw::unum::type_list<
+	float, double,
+	sw::unum::posit<16, 1>, sw::unum::posit<24, 1>, sw::unum::posit<32, 2>,
+	sw::unum::fixpnt<32, 16> >;
+// the residual norms of the multigrid solver need a square root, which fixpnt does not provide
+using FloatingTypes = sw::unum::type_list<
+	float, double,
+	sw::unum::posit<16, 1>, sw::unum::posit<24, 1>, sw::unum::posit<32, 2> >;
+
+// the number of correct digits ranks the number systems by precision
+int VerifyRanking(const std::string& kernel, const sw::unum::precision_sweep_report& report) {
+	bool pass = report.results[0].valid;
+	for (const sw::unum::precision_sweep_result& r : report.results) pass = pass && r.valid;
+	if (pass) {
+		pass = report["double"].digits > report["float"].digits
+			&& report["posit<32,2>"].digits > report["posit<16,1>"].digits
+			&& report["posit<24,1>"].digits > report["posit<16,1>"].digits;
+	}
+	std::cout << kernel << (pass ? ": PASS" : ": FAIL") << "\n\n";
+	return (pass ? 0 : 1);
+}
+
+// the errors do not depend on the number of worker threads, and a failing instantiation is reported, not thrown
+int VerifySweepMechanics() {
+	using namespace sw::unum;
+	precision_sweep_report serial = precision_sweep<long double>(PolynomialKernel, SweepTypes(), 1);
+	precision_sweep_report concurrent = precision_sweep<long double>(PolynomialKernel, SweepTypes(), 4);
+	bool pass = serial.results.size() == concurrent.results.size();
+	for (size_t t = 0; pass && t < serial.results.size(); ++t) {
+		pass = serial.results[t].type == concurrent.results[t].type && serial.results[t].max_abs_error == concurrent.results[t].max_abs_error;
+	}
+	auto failing = [](auto tag) {
+		using Scalar = typename decltype(tag)::type;
+		if (std::is_same<Scalar, float>::value) throw std::runtime_error("no single precision");
+		return std::vector<Scalar>(3, Scalar(1.0) / Scalar(3.0));
+	};
+	precision_sweep_report partial = precision_sweep<double>(failing, type_list<float, posit<32, 2> >());
+	pass = pass && partial.results[0].valid && !partial["float"].valid && partial["posit<32,2>"].valid
+		&& partial["float"].message.find("no single precision") != std::string::npos;
+	// the reference keeps its own precision: a double output differs from a wider long double reference
+	auto third = [](auto tag) {
+		using Scalar = typename decltype(tag)::type;
+		return std::vector<Scalar>(1, Scalar(1.0) / Scalar(3.0));
+	};
+	precision_sweep_report wide = precision_sweep<long double>(third, type_list<double>());
+	bool wider = std::numeric_limits<long double>::digits > std::numeric_limits<double>::digits;
+	pass = pass && (wide["double"].max_abs_error > 0.0) == wider;
+	std::cout << "1 thread vs 4 threads and failing instantiations" << (pass ? ": PASS" : ": FAIL") << '\n';
+	return (pass ? 0 : 1);
+}
+
+int main(int argc, char** argv)
+try {
+	using namespace std;
+	using namespace sw::unum;
+
+	// usage: precision_sweep [--csv | --json]
+	enum { Table, CSV, JSON } format = Table;
+	if (argc > 1 && strcmp(argv[1], "--csv") == 0) format = CSV;
+	if (argc > 1 && strcmp(argv[1], "--json") == 0) format = JSON;
+
+	int nrOfFailedTestCases = 0;
+
+	// the JSON output is one array with an object per kernel
+	bool first = true;
+	auto emit = [&](const string& kernel, const precision_sweep_report& report) {
+		switch (format) {
+		case CSV:   cout << "# " << kernel << '\n'; report.write_csv(cout); break;
+		case JSON:  cout << (first ? "[\n" : ",\n") << "{ \"kernel\": \"" << kernel << "\", \"results\":\n"; report.write_json(cout); cout << "}"; break;
+		default:    cout << kernel << '\n' << report; break;
+		}
+		first = false;
+	};
+
+	precision_sweep_report lorenz = precision_sweep<long double>(LorenzKernel, SweepTypes());
+	emit("Lorenz trajectory, RK4", lorenz);
+	precision_sweep_report polynomial = precision_sweep<long double>(PolynomialKernel, SweepTypes());
+	emit("(x-1)^7 by Horner's rule", polynomial);
+	precision_sweep_report poisson = precision_sweep<long double>(PoissonKernel, FloatingTypes());
+	emit("Poisson point source, multigrid", poisson);
+	if (format == JSON) cout << "\n]\n";
+
+	if (format == Table) {
+		nrOfFailedTestCases += VerifyRanking("Lorenz trajectory", lorenz);
+		nrOfFailedTestCases += VerifyRanking("Horner", polynomial);
+		nrOfFailedTestCases += VerifyRanking("Poisson", poisson);
+		nrOfFailedTestCases += VerifySweepMechanics();
+	}
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const std::runtime_error& err) {
+	std::cerr << "Uncaught runtime exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
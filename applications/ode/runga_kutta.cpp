@@ -1,48 +1,175 @@
-// runga_kutta.cpp: classic Runga-Kutta method
+// runga_kutta.cpp: classic Runga-Kutta and adaptive Dormand-Prince integration of ensembles of trajectories
 //
 // Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
 //
 // This file is part of the universal numbers project, which is released under an MIT Open Source license.
-
-// Configure the posit library with arithmetic exceptions
-// enable posit arithmetic exceptions
-#define POSIT_THROW_ARITHMETIC_EXCEPTION 1
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <string>
+#include <vector>
+// enable fast posits
+#define POSIT_FAST_POSIT_32_2 1
 #include <universal/posit/posit>
+#include <universal/fixpnt/fixpnt>
+#include <universal/blas/blas.hpp>
 
 /*
+The ensemble integrators of <universal/blas/solvers/runge_kutta.hpp> advance thousands of trajectories
+at once. Each trajectory here is a harmonic oscillator with its own frequency w and the exact solution
+    y0(t) = cos(w t), y1(t) = -w sin(w t)
+which measures the error of the integrators in each number system.
+ */
+
+// y0' = y1, y1' = -w^2 y0, with the frequency of trajectory j in w[j]
+template<typename Scalar>
+struct Oscillators {
+	std::vector<Scalar> w2;
+	explicit Oscillators(const std::vector<double>& w) : w2(w.size()) {
+		for (size_t j = 0; j < w.size(); ++j) w2[j] = Scalar(w[j] * w[j]);
+	}
+	void operator()(const Scalar*, const sw::unum::blas::ensemble<Scalar>& y, sw::unum::blas::ensemble<Scalar>& dydt, size_t begin, size_t end) const {
+		const Scalar* y0 = y.component(0);
+		const Scalar* y1 = y.component(1);
+		Scalar* dy0 = dydt.component(0);
+		Scalar* dy1 = dydt.component(1);
+		for (size_t j = begin; j < end; ++j) {
+			dy0[j] = y1[j];
+			dy1[j] = -(w2[j] * y0[j]);
+		}
+	}
+};
+
+std::vector<double> Frequencies(size_t members) {
+	std::vector<double> w(members);
+	for (size_t j = 0; j < members; ++j) w[j] = 0.5 + double(j % 64) / 64.0;
+	return w;
+}
+
+template<typename Scalar>
+sw::unum::blas::ensemble<Scalar> InitialState(const std::vector<double>& w) {
+	sw::unum::blas::ensemble<Scalar> y(2, w.size());
+	for (size_t j = 0; j < w.size(); ++j) {
+		y(0, j) = Scalar(1.0);
+		y(1, j) = Scalar(0.0);
+	}
+	return y;
+}
+
+// largest deviation from the exact solution at time t
+template<typename Scalar>
+double MaxError(const sw::unum::blas::ensemble<Scalar>& y, const std::vector<double>& w, double t) {
+	double maxError = 0.0;
+	for (size_t j = 0; j < w.size(); ++j) {
+		double e0 = std::abs(double(y(0, j)) - std::cos(w[j] * t));
+		double e1 = std::abs(double(y(1, j)) + w[j] * std::sin(w[j] * t));
+		maxError = std::max(maxError, std::max(e0, e1));
+	}
+	return maxError;
+}
+
+template<typename Scalar>
+int IntegrateOscillators(const std::string& tag, size_t members, size_t nrSteps, double rk4Tolerance, double rtol, double rk45Tolerance) {
+	using namespace sw::unum::blas;
+	using namespace std::chrono;
+	int nrOfFailures = 0;
+	std::vector<double> w = Frequencies(members);
+	Oscillators<Scalar> f(w);
+	const double T = 10.0;
 
-Mathematical 	C++ Symbol	Decimal Representation
-Expression
-pi			M_PI		3.14159265358979323846
-pi/2			M_PI_2		1.57079632679489661923
-pi/4			M_PI_4		0.785398163397448309616
-1/pi			M_1_PI		0.318309886183790671538
-2/pi			M_2_PI		0.636619772367581343076
-2/sqrt(pi)		M_2_SQRTPI	1.12837916709551257390
-sqrt(2)			M_SQRT2		1.41421356237309504880
-1/sqrt(2)		M_SQRT1_2	0.707106781186547524401
-e			M_E		2.71828182845904523536
-log_2(e)		M_LOG2E		1.44269504088896340736
-log_10(e)		M_LOG10E	0.434294481903251827651
-log_e(2)		M_LN2		0.693147180559945309417
-log_e(10)		M_LN10		2.30258509299404568402
-
-*/
-
-constexpr double pi = 3.14159265358979323846;  // best practice for C++
+	ensemble<Scalar> y = InitialState<Scalar>(w);
+	steady_clock::time_point begin = steady_clock::now();
+	rk4(f, Scalar(0.0), Scalar(T), nrSteps, y);
+	double elapsed = duration<double>(steady_clock::now() - begin).count();
+	double error = MaxError(y, w, T);
+	bool pass = error < rk4Tolerance;
+	std::cout << std::setw(14) << tag << "  RK4   steps " << std::setw(6) << nrSteps << "  max error " << std::setw(12) << error
+		<< "  " << std::setw(10) << elapsed << " sec" << (pass ? "  PASS" : "  FAIL") << '\n';
+	if (!pass) ++nrOfFailures;
+
+	y = InitialState<Scalar>(w);
+	begin = steady_clock::now();
+	ode_report report = rk45(f, Scalar(0.0), Scalar(T), y, rtol, rtol, Scalar(0.01));
+	elapsed = duration<double>(steady_clock::now() - begin).count();
+	error = MaxError(y, w, T);
+	pass = report.completed && error < rk45Tolerance;
+	std::cout << std::setw(14) << tag << "  RK45  steps " << std::setw(6) << report.steps / members << "  max error " << std::setw(12) << error
+		<< "  " << std::setw(10) << elapsed << " sec" << (pass ? "  PASS" : "  FAIL") << "   rejected " << report.rejected << '\n';
+	if (!pass) ++nrOfFailures;
+	return nrOfFailures;
+}
+
+// halving the step of RK4 reduces the error by 2^4
+int VerifyConvergenceOrder(size_t members) {
+	using namespace sw::unum::blas;
+	std::vector<double> w = Frequencies(members);
+	Oscillators<double> f(w);
+	double errors[2];
+	for (int i = 0; i < 2; ++i) {
+		ensemble<double> y = InitialState<double>(w);
+		rk4(f, 0.0, 10.0, size_t(200) << i, y);
+		errors[i] = MaxError(y, w, 10.0);
+	}
+	double order = std::log2(errors[0] / errors[1]);
+	bool pass = std::abs(order - 4.0) < 0.3;
+	std::cout << std::setw(14) << "double" << "  RK4   observed order of convergence " << order << (pass ? "  PASS" : "  FAIL") << '\n';
+	return (pass ? 0 : 1);
+}
+
+// every trajectory is integrated on its own: the results do not depend on the number of threads
+template<typename Scalar>
+int VerifyThreadIndependence(const std::string& tag, size_t members) {
+	using namespace sw::unum::blas;
+	std::vector<double> w = Frequencies(members);
+	Oscillators<Scalar> f(w);
+	ensemble<Scalar> y1 = InitialState<Scalar>(w), y5 = InitialState<Scalar>(w);
+	rk45(f, Scalar(0.0), Scalar(5.0), y1, 1.0e-6, 1.0e-6, Scalar(0.1), 100000, 1);
+	rk45(f, Scalar(0.0), Scalar(5.0), y5, 1.0e-6, 1.0e-6, Scalar(0.1), 100000, 5);
+	bool pass = true;
+	for (size_t c = 0; c < 2; ++c) {
+		for (size_t j = 0; j < members; ++j) pass = pass && (y1(c, j) == y5(c, j));
+	}
+	std::cout << std::setw(14) << tag << "  RK45  1 thread vs 5 threads" << (pass ? "  PASS" : "  FAIL") << '\n';
+	return (pass ? 0 : 1);
+}
+
+// a non-autonomous equation, y' = cos(t), checks the time of the stages
+int VerifyTimeDependence() {
+	using namespace sw::unum::blas;
+	auto f = [](const double* t, const ensemble<double>&, ensemble<double>& dydt, size_t begin, size_t end) {
+		for (size_t j = begin; j < end; ++j) dydt(0, j) = std::cos(t[j]);
+	};
+	ensemble<double> y4(1, 16, 0.0), y45(1, 16, 0.0);
+	rk4(f, 0.0, 3.0, 300, y4);
+	ode_report report = rk45(f, 0.0, 3.0, y45, 1.0e-10, 1.0e-10, 0.1);
+	double error = std::max(std::abs(y4(0, 7) - std::sin(3.0)), std::abs(y45(0, 7) - std::sin(3.0)));
+	bool pass = report.completed && error < 1.0e-9;
+	std::cout << std::setw(14) << "double" << "  y' = cos(t)  max error " << error << (pass ? "  PASS" : "  FAIL") << '\n';
+	return (pass ? 0 : 1);
+}
 
 int main(int argc, char** argv)
 try {
 	using namespace std;
 	using namespace sw::unum;
 
-	constexpr size_t nbits = 16;
-	constexpr size_t es = 1;
+	// usage: runga_kutta [members]
+	size_t members = (argc > 1 ? size_t(atol(argv[1])) : size_t(2048));
 
 	int nrOfFailedTestCases = 0;
 
-	posit<nbits, es> p(pi);
-	cout << "PI = " << p << " " << hex_format(p) << endl;
+	cout << "Ensemble integration of " << members << " harmonic oscillators\n";
+	nrOfFailedTestCases += IntegrateOscillators<double>("double", members, 1000, 1.0e-7, 1.0e-9, 1.0e-7);
+	nrOfFailedTestCases += IntegrateOscillators<float>("float", members, 1000, 1.0e-4, 1.0e-6, 1.0e-4);
+	nrOfFailedTestCases += IntegrateOscillators< posit<32, 2> >("posit<32,2>", members, 1000, 1.0e-5, 1.0e-6, 1.0e-4);
+	// the fixed-point and generic posit arithmetic is emulated bit by bit, so these ensembles are kept smaller
+	nrOfFailedTestCases += IntegrateOscillators< posit<24, 1> >("posit<24,1>", members / 64, 250, 1.0e-4, 1.0e-5, 1.0e-3);
+	nrOfFailedTestCases += IntegrateOscillators< fixpnt<32, 24> >("fixpnt<32,24>", members / 64, 250, 1.0e-4, 1.0e-5, 1.0e-3);
+
+	nrOfFailedTestCases += VerifyConvergenceOrder(members / 16);
+	nrOfFailedTestCases += VerifyThreadIndependence<double>("double", members / 4);
+	nrOfFailedTestCases += VerifyThreadIndependence< posit<32, 2> >("posit<32,2>", members / 16);
+	nrOfFailedTestCases += VerifyTimeDependence();
 
 	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
 }
@@ -0,0 +1,222 @@
+// stencil.cpp: matrix-free Jacobi, red-black Gauss-Seidel/SOR, and multigrid solvers of the Poisson equation on 2D and 3D grids
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <string>
+// enable fast posits
+#define POSIT_FAST_POSIT_16_1 1
+#define POSIT_FAST_POSIT_32_2 1
+#include <universal/posit/posit>
+#include <universal/blas/blas.hpp>
+
+/*
+The model problem -Laplace(u) = f on the unit square or cube with zero boundary values and the solution
+    u = sin(pi x) sin(pi y) (sin(pi z)),   f = d pi^2 u
+is discretized with the 5-point and 7-point stencils of <universal/blas/solvers/stencil.hpp>.
+The discretization error is about pi^2 h^2 / 12 * max|u|, so the error of the computed solution against
+the exact one shows where the number system, rather than the grid, limits the accuracy.
+ */
+
+constexpr double pi = 3.14159265358979323846;
+
+template<typename Scalar>
+struct ModelProblem {
+	sw::unum::blas::grid<Scalar> u, f;
+	Scalar h;
+	ModelProblem(size_t dims, size_t n) : h(1.0 / double(n + 1)) {
+		using namespace sw::unum::blas;
+		u = (dims == 3 ? grid<Scalar>(n, n, n) : grid<Scalar>(n, n));
+		f = u;
+		double hd = 1.0 / double(n + 1);
+		f.set_interior([&](size_t i, size_t j, size_t k) {
+			return Scalar(double(dims) * pi * pi * Exact(dims, hd, i, j, k));
+		});
+	}
+	static double Exact(size_t dims, double h, size_t i, size_t j, size_t k) {
+		double value = std::sin(pi * i * h) * std::sin(pi * j * h);
+		return (dims == 3 ? value * std::sin(pi * k * h) : value);
+	}
+	double MaxError() const {
+		double hd = 1.0 / double(u.nx() + 1);
+		double maxError = 0.0;
+		for (size_t k = 1; k <= u.nz(); ++k)
+			for (size_t j = 1; j <= u.ny(); ++j)
+				for (size_t i = 1; i <= u.nx(); ++i) maxError = std::max(maxError, std::abs(double(u(i, j, k)) - Exact(u.dims(), hd, i, j, k)));
+		return maxError;
+	}
+};
+
+// The rounding errors of the stencil grow like 1/h^2, which bounds the attainable relative residual and the
+// accuracy of the solution at about epsilon / (pi^2 h^2). It is the floor below which a finer grid stops paying.
+template<typename Scalar>
+double RoundingFloor(size_t n) {
+	double epsilon = double(std::numeric_limits<Scalar>::epsilon());
+	double h = 1.0 / double(n + 1);
+	return 4.0 * epsilon / (pi * pi * h * h);
+}
+
+enum class Method { Jacobi, GaussSeidel, SOR, Multigrid };
+
+std::string MethodName(Method method) {
+	switch (method) {
+	case Method::Jacobi:      return "Jacobi";
+	case Method::GaussSeidel: return "red-black GS";
+	case Method::SOR:         return "red-black SOR";
+	case Method::Multigrid:   return "multigrid V(2,2)";
+	}
+	return "unknown";
+}
+
+// solve the model problem and compare against the exact solution; a maxError of 0 only reports the accuracy
+template<typename Scalar>
+int SolveModelProblem(const std::string& tag, Method method, size_t dims, size_t n, double tolerance, size_t maxIterations, double maxError, unsigned nrThreads = 0) {
+	using namespace sw::unum::blas;
+	using namespace std::chrono;
+	ModelProblem<Scalar> problem(dims, n);
+	Scalar tol(tolerance);
+	steady_clock::time_point begin = steady_clock::now();
+	stencil_report<Scalar> report{ 0, Scalar(0), false };
+	switch (method) {
+	case Method::Jacobi:
+		report = jacobi(problem.u, problem.f, problem.h, Scalar(1.0), tol, maxIterations, nrThreads);
+		break;
+	case Method::GaussSeidel:
+		report = gauss_seidel(problem.u, problem.f, problem.h, tol, maxIterations, 10, nrThreads);
+		break;
+	case Method::SOR:
+		report = sor(problem.u, problem.f, problem.h, Scalar(optimal_sor_omega(n)), tol, maxIterations, 10, nrThreads);
+		break;
+	case Method::Multigrid:
+		report = multigrid(problem.u, problem.f, problem.h, tol, maxIterations, 2, 2, nrThreads);
+		break;
+	}
+	double elapsed = duration<double>(steady_clock::now() - begin).count();
+	double error = problem.MaxError();
+	bool pass = (maxError == 0.0 || (report.converged && error < maxError));
+	std::cout << std::setw(12) << tag << "  " << std::setw(17) << std::left << MethodName(method) << std::right
+		<< (dims == 3 ? "  3D " : "  2D ") << std::setw(5) << n << "^" << dims
+		<< "  iterations " << std::setw(5) << report.iterations
+		<< "  residual " << std::setw(12) << double(report.residual)
+		<< "  max error " << std::setw(12) << error
+		<< "  " << std::setw(9) << std::setprecision(3) << elapsed << " sec" << std::setprecision(6)
+		<< (maxError == 0.0 ? "  INFO" : (pass ? "  PASS" : "  FAIL")) << '\n';
+	return (pass ? 0 : 1);
+}
+
+// all points of one color are independent: the iterates do not depend on the number of threads,
+// and with posits neither does the quire-fused residual norm
+template<typename Scalar>
+int VerifyThreadIndependence(const std::string& tag, size_t dims, size_t n) {
+	using namespace sw::unum::blas;
+	ModelProblem<Scalar> p1(dims, n), p3(dims, n);
+	multigrid(p1.u, p1.f, p1.h, Scalar(0), 2, 2, 2, 1);
+	multigrid(p3.u, p3.f, p3.h, Scalar(0), 2, 2, 2, 3);
+	Scalar omega(1.5);
+	rb_sor_sweep(p1.u, p1.f, p1.h, omega, 1);
+	rb_sor_sweep(p3.u, p3.f, p3.h, omega, 3);
+	bool pass = true;
+	for (size_t p = 0; p < p1.u.storage_size(); ++p) pass = pass && (p1.u.data()[p] == p3.u.data()[p]);
+	bool sameNorm = (residual_norm(p1.u, p1.f, p1.h, 1) == residual_norm(p1.u, p1.f, p1.h, 3));
+	std::cout << std::setw(12) << tag << (dims == 3 ? "  3D" : "  2D") << "  1 thread vs 3 threads: iterates " << (pass ? "identical" : "DIFFER");
+	if (sw::unum::is_posit<Scalar>) {
+		std::cout << ", fused residual norm " << (sameNorm ? "identical" : "DIFFERS");
+		pass = pass && sameNorm;
+	}
+	std::cout << (pass ? "  PASS" : "  FAIL") << '\n';
+	return (pass ? 0 : 1);
+}
+
+// grids that do not coarsen to at most 3 points per dimension are rejected instead of being relaxed on the finest level
+int VerifyCoarsening() {
+	using namespace sw::unum::blas;
+	int nrOfFailures = 0;
+	struct shape { size_t nx, ny, nz; bool accepted; };
+	for (const shape& s : { shape{ 63, 63, 0, true }, shape{ 15, 31, 0, true }, shape{ 11, 11, 0, true }, shape{ 15, 15, 7, true },
+	                        shape{ 64, 64, 0, false }, shape{ 63, 64, 0, false }, shape{ 9, 9, 0, false }, shape{ 15, 15, 16, false } }) {
+		grid<double> u(s.nz ? grid<double>(s.nx, s.ny, s.nz) : grid<double>(s.nx, s.ny));
+		grid<double> f(u);
+		bool accepted = true;
+		try {
+			multigrid(u, f, 1.0 / double(s.nx + 1), 1.0e-8, 1, 2, 2, 1);
+		}
+		catch (const sw::unum::blas::blas_exception&) {
+			accepted = false;
+		}
+		if (accepted != s.accepted) ++nrOfFailures;
+	}
+	std::cout << "multigrid grid coarsening checks" << (nrOfFailures ? "  FAIL" : "  PASS") << '\n';
+	return nrOfFailures;
+}
+
+int main(int argc, char** argv)
+try {
+	using namespace std;
+	using namespace sw::unum;
+
+	// usage: stencil [n2D n3D]
+	// the multigrid solves use n2D^2 and n3D^3 points, n = 2^k - 1; stencil 4095 215 solves on 1.7e7 and 1.0e7 points
+	size_t n2 = (argc > 1 ? size_t(atol(argv[1])) : size_t(127));
+	size_t n3 = (argc > 2 ? size_t(atol(argv[2])) : size_t(31));
+
+	int nrOfFailedTestCases = 0;
+
+	cout << "Matrix-free stencil solvers of the Poisson equation\n";
+	cout << setprecision(6);
+
+	// the relaxation methods on a small grid
+	constexpr size_t ns = 31;
+	const double discretization = pi * pi / 12.0 / double((ns + 1) * (ns + 1));
+	nrOfFailedTestCases += SolveModelProblem<double>("double", Method::Jacobi, 2, ns, 1.0e-10, 20000, 2.0 * discretization);
+	nrOfFailedTestCases += SolveModelProblem<double>("double", Method::GaussSeidel, 2, ns, 1.0e-10, 20000, 2.0 * discretization);
+	nrOfFailedTestCases += SolveModelProblem<double>("double", Method::SOR, 2, ns, 1.0e-10, 20000, 2.0 * discretization);
+	nrOfFailedTestCases += SolveModelProblem<double>("double", Method::SOR, 3, 15, 1.0e-10, 20000, 2.0 * pi * pi / 12.0 / 256.0);
+	nrOfFailedTestCases += SolveModelProblem< posit<32, 2> >("posit<32,2>", Method::SOR, 2, ns, 1.0e-5, 20000, 2.0 * discretization);
+
+	// multigrid on the larger grids, the precision of the number system shows in the attainable residual
+	for (size_t dims = 2; dims <= 3; ++dims) {
+		size_t n = (dims == 2 ? n2 : n3);
+		double hd = 1.0 / double(n + 1);
+		double bound = 2.0 * pi * pi / 12.0 * hd * hd;
+		nrOfFailedTestCases += SolveModelProblem<double>("double", Method::Multigrid, dims, n, std::max(1.0e-10, RoundingFloor<double>(n)), 30, bound);
+		nrOfFailedTestCases += SolveModelProblem<float>("float", Method::Multigrid, dims, n, RoundingFloor<float>(n), 30, bound + RoundingFloor<float>(n));
+		nrOfFailedTestCases += SolveModelProblem< posit<32, 2> >("posit<32,2>", Method::Multigrid, dims, n, RoundingFloor< posit<32, 2> >(n), 30, bound + RoundingFloor< posit<32, 2> >(n));
+		SolveModelProblem< posit<16, 1> >("posit<16,1>", Method::Multigrid, dims, n, 1.0e-2, 10, 0.0);
+	}
+
+	nrOfFailedTestCases += VerifyThreadIndependence<double>("double", 2, 63);
+	nrOfFailedTestCases += VerifyThreadIndependence<float>("float", 3, 15);
+	nrOfFailedTestCases += VerifyThreadIndependence< posit<32, 2> >("posit<32,2>", 2, 63);
+	nrOfFailedTestCases += VerifyThreadIndependence< posit<32, 2> >("posit<32,2>", 3, 15);
+	nrOfFailedTestCases += VerifyCoarsening();
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const std::runtime_error& err) {
+	std::cerr << "Uncaught runtime exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
@@ -1,42 +1,130 @@
-//  time_precision_lyapunov.cpp : example of the relationship between execution time, floating point precision
-//                                and the Lyaponov exponent in a chaotic system
+//  error_growth_atmospheric_model.cpp : initial error growth and predictability of a low-dimensional atmospheric model
 //
 // Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
 //
 // This file is part of the universal numbers project, which is released under an MIT Open Source license.
 #include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <string>
+#include <vector>
+// enable fast posits
+#define POSIT_FAST_POSIT_32_2 1
 #include <universal/posit/posit>
+#include <universal/blas/blas.hpp>
 
 /*
-On the relation between reliable computation time, float-point precision and the
-Lyapunov exponent in chaotic systems
-Wang PengFei (1,2) and Li JianPing (3)
-1 Center for Monsoon System Research, Institute of Atmospheric Physics, 
-  Chinese Academy of Sciences, Beijing 100190, China
-2 State Key Laboratory of Numerical Modeling for Atmospheric Sciences 
-  and Geophysical Fluid Dynamics, 
-  Institute of Atmospheric Physics, Chinese Academy of Sciences, 
-  Beijing 100029, China
-3 College of Global Change and Earth System Science, 
-  Beijing Normal University, 100875, China
-Corresponding author: wpf@mail.iap.ac.cn
+Lorenz' 1984 low-order model of the general atmospheric circulation
 
-Abstract
- The relation among reliable computation time, Tc, float-point precision, K, and the
-Lyapunov exponent, λ, is obtained as Tc= (lnB/λ)K+C, where B is the base of the float-point
-system and C is a constant dependent only on the chaotic equation. The equation shows good
-agreement with numerical experimental results, especially the scale factors.
+    x' = -y^2 - z^2 - a x + a F
+    y' =  x y - b x z - y + G
+    z' =  b x y + x z - z
 
-Keywords: reliable computation time, Lyapunov exponent, float precision
+x is the strength of the westerly wind, y and z are the cosine and sine phases of a chain of large-scale eddies,
+and F and G are the thermal forcings. An ensemble of initial states perturbed by a small error around a control
+state is integrated with the adaptive Dormand-Prince integrator. The mean error grows exponentially, saturates
+at the size of the attractor, and the time at which it reaches half of the saturation level is the limit of
+predictability. Repeating the experiment in number systems of lower precision shows how the rounding errors of
+the arithmetic add to the initial error.
  */
 
+template<typename Scalar>
+struct Lorenz84 {
+	Scalar a, b, F, G;
+	Lorenz84() : a(0.25), b(4.0), F(8.0), G(1.0) {}
+	void operator()(const Scalar*, const sw::unum::blas::ensemble<Scalar>& s, sw::unum::blas::ensemble<Scalar>& ds, size_t begin, size_t end) const {
+		const Scalar* x = s.component(0);
+		const Scalar* y = s.component(1);
+		const Scalar* z = s.component(2);
+		Scalar* dx = ds.component(0);
+		Scalar* dy = ds.component(1);
+		Scalar* dz = ds.component(2);
+		for (size_t j = begin; j < end; ++j) {
+			dx[j] = a * (F - x[j]) - y[j] * y[j] - z[j] * z[j];
+			dy[j] = x[j] * y[j] - b * x[j] * z[j] - y[j] + G;
+			dz[j] = b * x[j] * y[j] + x[j] * z[j] - z[j];
+		}
+	}
+};
+
+// mean distance of the perturbed members to the control member 0
+template<typename Scalar>
+double MeanError(const sw::unum::blas::ensemble<Scalar>& s) {
+	double sum = 0.0;
+	for (size_t j = 1; j < s.members(); ++j) {
+		double d2 = 0.0;
+		for (size_t c = 0; c < 3; ++c) {
+			double d = double(s(c, j)) - double(s(c, 0));
+			d2 += d * d;
+		}
+		sum += std::sqrt(d2);
+	}
+	return sum / double(s.members() - 1);
+}
+
+// mean error at the sample times of an ensemble integration in number system Scalar
+template<typename Scalar>
+std::vector<double> ErrorGrowth(const std::vector<double>& control, size_t members, double delta, double T, double sample, double rtol) {
+	using namespace sw::unum::blas;
+	ensemble<Scalar> s(3, members);
+	for (size_t j = 0; j < members; ++j) {
+		// perturbations of size delta in directions spread over the sphere
+		double theta = std::acos(1.0 - 2.0 * (double(j) + 0.5) / double(members));
+		double phi = 2.399963229728653 * double(j);
+		double d = (j == 0 ? 0.0 : delta);
+		s(0, j) = Scalar(control[0] + d * std::sin(theta) * std::cos(phi));
+		s(1, j) = Scalar(control[1] + d * std::sin(theta) * std::sin(phi));
+		s(2, j) = Scalar(control[2] + d * std::cos(theta));
+	}
+	std::vector<double> error;
+	error.push_back(MeanError(s));
+	for (double t = 0.0; t + 0.5 * sample < T; t += sample) {
+		ode_report report = rk45(Lorenz84<Scalar>(), Scalar(t), Scalar(t + sample), s, rtol, rtol, Scalar(0.01));
+		if (!report.completed) std::cerr << "integration did not complete at t = " << t << '\n';
+		error.push_back(MeanError(s));
+	}
+	return error;
+}
+
+// first time the mean error exceeds half of its saturation level, the mean over the last quarter of the run
+double PredictabilityLimit(const std::vector<double>& error, double sample) {
+	size_t n = error.size();
+	double saturation = 0.0;
+	for (size_t i = 3 * n / 4; i < n; ++i) saturation += error[i];
+	saturation /= double(n - 3 * n / 4);
+	for (size_t i = 0; i < n; ++i) if (error[i] > 0.5 * saturation) return double(i) * sample;
+	return double(n) * sample;
+}
+
 int main()
 try {
 	using namespace std;
+	using namespace sw::unum;
+	using namespace sw::unum::blas;
+
+	cout << "Initial error growth in Lorenz' 1984 low-order atmospheric model\n";
+
+	// a control state on the attractor
+	ensemble<double> spinup(3, 1);
+	spinup(0, 0) = 1.0; spinup(1, 0) = 0.0; spinup(2, 0) = -0.75;
+	rk45(Lorenz84<double>(), 0.0, 100.0, spinup, 1.0e-10, 1.0e-10, 0.01);
+	std::vector<double> control = { spinup(0, 0), spinup(1, 0), spinup(2, 0) };
+
+	constexpr size_t members = 129;
+	const double delta = 1.0e-6, T = 120.0, sample = 4.0;
+	std::vector<double> ed = ErrorGrowth<double>(control, members, delta, T, sample, 1.0e-10);
+	std::vector<double> ep = ErrorGrowth< posit<32, 2> >(control, members, delta, T, sample, 1.0e-7);
+	std::vector<double> ef = ErrorGrowth<float>(control, members, delta, T, sample, 1.0e-6);
 
-	cout << "Time-Precision Trade-off for Lyaponov exponent\n";
+	cout << "mean error of " << members - 1 << " perturbations of size " << delta << '\n';
+	cout << std::setw(8) << "time" << std::setw(14) << "double" << std::setw(14) << "posit<32,2>" << std::setw(14) << "float" << '\n';
+	for (size_t i = 0; i < ed.size(); ++i) {
+		cout << std::setw(8) << double(i) * sample << std::setw(14) << ed[i] << std::setw(14) << ep[i] << std::setw(14) << ef[i] << '\n';
+	}
+	cout << "limit of predictability: double " << PredictabilityLimit(ed, sample)
+		<< ", posit<32,2> " << PredictabilityLimit(ep, sample)
+		<< ", float " << PredictabilityLimit(ef, sample) << '\n';
 
-    
 	return EXIT_SUCCESS;
 }
 catch (char const* msg) {
@@ -66,7 +66,7 @@ public:
 	areal(float initial_value)              { *this = initial_value; }
 	areal(double initial_value)             { *this = initial_value; }
 	areal(long double initial_value)        { *this = initial_value; }
-	areal(const areal& rhs)                 { *this = rhs; }
+	areal(const areal&) = default;
 
 	// assignment operators
 	areal& operator=(signed char rhs) {
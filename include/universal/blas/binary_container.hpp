@@ -0,0 +1,354 @@
+#pragma once
+// binary_container.hpp: self-describing binary files of vectors and matrices with streaming writes and memory-mapped views
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#if defined(_WIN32)
+// no mmap: mapped_container reads the file into memory
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <universal/posit/posit_fwd.hpp>
+#include <universal/blas/vector.hpp>
+#include <universal/blas/matrix.hpp>
+#include <universal/blas/vector_view.hpp>
+#include <universal/blas/matrix_view.hpp>
+#include <universal/blas/exceptions.hpp>
+
+namespace sw { namespace unum {
+	// number systems that can be stored in a binary container
+	template<size_t nbits, typename BlockType> class integer;
+	template<size_t nbits, size_t rbits, bool arithmetic, typename BlockType> class fixpnt;
+	template<size_t nbits, size_t es, typename BlockType> class areal;
+	template<size_t nbits, typename BlockType> class lns;
+}}
+
+namespace sw { namespace unum { namespace blas {
+
+// Binary container layout, all fields in the byte order of the producer:
+//
+//   offset  size  field
+//        0     8  magic "UNIVBIN"
+//        8     4  format version
+//       12     4  byte order marker 0x01020304
+//       16    16  type tag, such as "posit", "fixpnt", "double"
+//       32    32  four type parameters, such as nbits and es
+//       64     8  element size in bytes
+//       72     4  rank: 1 for a vector, 2 for a matrix
+//       76     4  layout of a matrix: 0 row-major, 1 column-major
+//       80    16  rows and columns; a vector has one column
+//       96     8  offset of the elements, a multiple of 64
+//      104    24  reserved
+//      128        elements, in the memory representation of the type
+//
+// Storing the memory representation lets a reader on the same platform map the file and use the
+// elements in place. The type tag, the parameters, and the element size guard against reading a file
+// as a different type.
+struct binary_container_header {
+	char     magic[8];
+	uint32_t version;
+	uint32_t byte_order;
+	char     tag[16];
+	uint64_t parameters[4];
+	uint64_t element_size;
+	uint32_t rank;
+	uint32_t order;
+	uint64_t rows;
+	uint64_t cols;
+	uint64_t data_offset;
+	uint64_t reserved[3];
+};
+static_assert(sizeof(binary_container_header) == 128, "binary_container_header must be 128 bytes");
+
+constexpr uint32_t binary_container_version = 1;
+constexpr uint32_t binary_container_byte_order = 0x01020304;
+
+// binary_type_descriptor<Scalar> names a type and its parameters in the header
+template<uint64_t p0 = 0, uint64_t p1 = 0, uint64_t p2 = 0, uint64_t p3 = 0>
+struct binary_type_parameters {
+	static constexpr uint64_t parameters[4] = { p0, p1, p2, p3 };
+};
+
+template<typename Scalar> struct binary_type_descriptor;   // no descriptor: the type cannot be stored
+
+template<> struct binary_type_descriptor<float>       : binary_type_parameters<> { static constexpr const char* tag = "float"; };
+template<> struct binary_type_descriptor<double>      : binary_type_parameters<> { static constexpr const char* tag = "double"; };
+template<> struct binary_type_descriptor<long double> : binary_type_parameters<> { static constexpr const char* tag = "long double"; };
+template<typename Int>
+struct binary_integral_descriptor : binary_type_parameters<8 * sizeof(Int), std::is_signed<Int>::value> { static constexpr const char* tag = "int"; };
+template<> struct binary_type_descriptor<int8_t>   : binary_integral_descriptor<int8_t> {};
+template<> struct binary_type_descriptor<int16_t>  : binary_integral_descriptor<int16_t> {};
+template<> struct binary_type_descriptor<int32_t>  : binary_integral_descriptor<int32_t> {};
+template<> struct binary_type_descriptor<int64_t>  : binary_integral_descriptor<int64_t> {};
+template<> struct binary_type_descriptor<uint8_t>  : binary_integral_descriptor<uint8_t> {};
+template<> struct binary_type_descriptor<uint16_t> : binary_integral_descriptor<uint16_t> {};
+template<> struct binary_type_descriptor<uint32_t> : binary_integral_descriptor<uint32_t> {};
+template<> struct binary_type_descriptor<uint64_t> : binary_integral_descriptor<uint64_t> {};
+template<size_t nbits, size_t es>
+struct binary_type_descriptor< posit<nbits, es> > : binary_type_parameters<nbits, es> { static constexpr const char* tag = "posit"; };
+template<size_t nbits, typename BlockType>
+struct binary_type_descriptor< integer<nbits, BlockType> > : binary_type_parameters<nbits, sizeof(BlockType)> { static constexpr const char* tag = "integer"; };
+template<size_t nbits, size_t rbits, bool arithmetic, typename BlockType>
+struct binary_type_descriptor< fixpnt<nbits, rbits, arithmetic, BlockType> > : binary_type_parameters<nbits, rbits, arithmetic, sizeof(BlockType)> { static constexpr const char* tag = "fixpnt"; };
+template<size_t nbits, size_t es, typename BlockType>
+struct binary_type_descriptor< areal<nbits, es, BlockType> > : binary_type_parameters<nbits, es, sizeof(BlockType)> { static constexpr const char* tag = "areal"; };
+template<size_t nbits, typename BlockType>
+struct binary_type_descriptor< lns<nbits, BlockType> > : binary_type_parameters<nbits, sizeof(BlockType)> { static constexpr const char* tag = "lns"; };
+
+// create the header of a container of Scalar elements
+template<typename Scalar>
+binary_container_header make_binary_header(uint32_t rank, layout order, uint64_t rows, uint64_t cols) {
+	static_assert(std::is_trivially_copyable<Scalar>::value, "binary containers store the memory representation of trivially copyable types");
+	using Descriptor = binary_type_descriptor<Scalar>;
+	binary_container_header h;
+	std::memset(&h, 0, sizeof(h));
+	std::memcpy(h.magic, "UNIVBIN", 8);
+	h.version = binary_container_version;
+	h.byte_order = binary_container_byte_order;
+	std::strncpy(h.tag, Descriptor::tag, sizeof(h.tag) - 1);
+	for (int i = 0; i < 4; ++i) h.parameters[i] = Descriptor::parameters[i];
+	h.element_size = sizeof(Scalar);
+	h.rank = rank;
+	h.order = (order == layout::row_major ? 0u : 1u);
+	h.rows = rows;
+	h.cols = cols;
+	h.data_offset = sizeof(binary_container_header);
+	return h;
+}
+
+// throw a binary_container_exception if the header does not describe Scalar elements
+template<typename Scalar>
+void check_binary_header(const binary_container_header& h, const std::string& source) {
+	binary_container_header expected = make_binary_header<Scalar>(1, layout::row_major, 0, 0);
+	if (std::memcmp(h.magic, expected.magic, sizeof(h.magic)) != 0) throw binary_container_exception(source + " is not a binary container");
+	if (h.byte_order != binary_container_byte_order) throw binary_container_exception(source + " was written with a different byte order");
+	if (h.version > binary_container_version) throw binary_container_exception(source + " has format version " + std::to_string(h.version) + ", which is newer than this reader");
+	bool sameType = std::strncmp(h.tag, expected.tag, sizeof(h.tag)) == 0 && h.element_size == expected.element_size;
+	for (int i = 0; i < 4; ++i) sameType = sameType && h.parameters[i] == expected.parameters[i];
+	if (!sameType) {
+		throw binary_container_exception(source + " holds " + std::string(h.tag, strnlen(h.tag, sizeof(h.tag))) + "<" + std::to_string(h.parameters[0]) + ","
+			+ std::to_string(h.parameters[1]) + "> elements of " + std::to_string(h.element_size) + " bytes, not " + expected.tag + "<"
+			+ std::to_string(expected.parameters[0]) + "," + std::to_string(expected.parameters[1]) + ">");
+	}
+	if (h.rank < 1 || h.rank > 2 || h.order > 1 || h.data_offset < sizeof(binary_container_header)) throw binary_container_exception(source + " has an invalid shape description");
+	if (h.data_offset % 64 != 0) throw binary_container_exception(source + " has elements at offset " + std::to_string(h.data_offset) + ", which is not a multiple of 64");
+}
+
+// the rows x cols elements at data_offset fit in a container of length bytes; ordered so that no term can overflow
+template<typename Scalar>
+bool binary_payload_fits(const binary_container_header& h, uint64_t length) {
+	if (h.data_offset > length) return false;
+	return h.rows == 0 || h.cols <= (length - h.data_offset) / sizeof(Scalar) / h.rows;
+}
+
+// the length of the open stream, which is left positioned at offset
+inline uint64_t binary_stream_length(std::ifstream& ifs, uint64_t offset) {
+	ifs.seekg(0, std::ios::end);
+	uint64_t length = uint64_t(ifs.tellg());
+	ifs.seekg(std::streamoff(offset));
+	return length;
+}
+
+inline binary_container_header read_binary_header(const std::string& path) {
+	std::ifstream ifs(path, std::ios::binary);
+	binary_container_header h;
+	if (!ifs.read(reinterpret_cast<char*>(&h), sizeof(h))) throw binary_container_exception("cannot read the header of " + path);
+	return h;
+}
+
+// binary_writer<Scalar> streams elements into a container without holding the data set in memory.
+// A matrix is written a line at a time: rows for the row-major layout, columns for the column-major layout.
+// The number of lines is counted as they arrive and recorded in the header when the writer is closed.
+template<typename Scalar>
+class binary_writer {
+public:
+	// stream a vector
+	explicit binary_writer(const std::string& path) : binary_writer(path, 1, 1, layout::row_major) {}
+	// stream a matrix in lines of lineLength elements
+	binary_writer(const std::string& path, size_t lineLength, layout order) : binary_writer(path, 2, lineLength, order) {}
+	binary_writer(const binary_writer&) = delete;
+	binary_writer& operator=(const binary_writer&) = delete;
+	~binary_writer() {
+		try { close(); } catch (...) {}
+	}
+
+	void write(const Scalar* data, size_t count) {
+		if (!_ofs.write(reinterpret_cast<const char*>(data), std::streamsize(count * sizeof(Scalar)))) throw binary_container_exception("write to " + _path + " failed");
+		_count += count;
+	}
+	void write(const vector<Scalar>& v) { write(v.data(), v.size()); }
+
+	// complete the header with the final shape
+	void close() {
+		if (!_ofs.is_open()) return;
+		if (_count % _lineLength != 0) {
+			_ofs.close();
+			throw binary_container_exception(_path + ": " + std::to_string(_count) + " elements do not form complete lines of " + std::to_string(_lineLength));
+		}
+		uint64_t lines = _count / _lineLength;
+		if (_rank == 1) {
+			_header.rows = _count;
+			_header.cols = 1;
+		}
+		else if (_header.order == 0) {
+			_header.rows = lines;
+			_header.cols = _lineLength;
+		}
+		else {
+			_header.rows = _lineLength;
+			_header.cols = lines;
+		}
+		_ofs.seekp(0);
+		_ofs.write(reinterpret_cast<const char*>(&_header), sizeof(_header));
+		_ofs.close();
+	}
+
+	size_t count() const { return _count; }
+
+private:
+	std::string             _path;
+	std::ofstream           _ofs;
+	binary_container_header _header;
+	uint32_t                _rank;
+	size_t                  _lineLength;
+	size_t                  _count;
+
+	binary_writer(const std::string& path, uint32_t rank, size_t lineLength, layout order)
+		: _path(path), _ofs(path, std::ios::binary | std::ios::trunc), _header(make_binary_header<Scalar>(rank, order, 0, 0)), _rank{ rank }, _lineLength{ lineLength == 0 ? 1 : lineLength }, _count{ 0 } {
+		if (!_ofs) throw binary_container_exception("cannot create " + path);
+		_ofs.write(reinterpret_cast<const char*>(&_header), sizeof(_header));   // placeholder until the shape is known
+	}
+};
+
+template<typename Scalar>
+void save_binary(const std::string& path, const vector<Scalar>& v) {
+	binary_writer<Scalar> writer(path);
+	writer.write(v);
+	writer.close();
+}
+template<typename Scalar>
+void save_binary(const std::string& path, const matrix<Scalar>& A) {
+	binary_writer<Scalar> writer(path, A.cols(), layout::row_major);
+	writer.write(A.data(), A.rows() * A.cols());
+	writer.close();
+}
+
+// load a vector into memory
+template<typename Scalar>
+vector<Scalar> load_binary_vector(const std::string& path) {
+	std::ifstream ifs(path, std::ios::binary);
+	binary_container_header h;
+	if (!ifs.read(reinterpret_cast<char*>(&h), sizeof(h))) throw binary_container_exception("cannot read the header of " + path);
+	check_binary_header<Scalar>(h, path);
+	if (!binary_payload_fits<Scalar>(h, binary_stream_length(ifs, h.data_offset))) throw binary_container_exception(path + " is truncated");
+	vector<Scalar> v(size_t(h.rows * h.cols));
+	if (!ifs.read(reinterpret_cast<char*>(v.data()), std::streamsize(v.size() * sizeof(Scalar)))) throw binary_container_exception(path + " is truncated");
+	return v;
+}
+// load a matrix into memory, a column-major container is transposed into the row-major matrix
+template<typename Scalar>
+matrix<Scalar> load_binary_matrix(const std::string& path) {
+	std::ifstream ifs(path, std::ios::binary);
+	binary_container_header h;
+	if (!ifs.read(reinterpret_cast<char*>(&h), sizeof(h))) throw binary_container_exception("cannot read the header of " + path);
+	check_binary_header<Scalar>(h, path);
+	if (!binary_payload_fits<Scalar>(h, binary_stream_length(ifs, h.data_offset))) throw binary_container_exception(path + " is truncated");
+	size_t m = size_t(h.rows), n = size_t(h.cols);
+	matrix<Scalar> A(m, n);
+	if (h.order == 0) {
+		if (!ifs.read(reinterpret_cast<char*>(A.data()), std::streamsize(m * n * sizeof(Scalar)))) throw binary_container_exception(path + " is truncated");
+	}
+	else {
+		std::vector<Scalar> column(m);
+		for (size_t j = 0; j < n; ++j) {
+			if (!ifs.read(reinterpret_cast<char*>(column.data()), std::streamsize(m * sizeof(Scalar)))) throw binary_container_exception(path + " is truncated");
+			for (size_t i = 0; i < m; ++i) A(i, j) = column[i];
+		}
+	}
+	return A;
+}
+
+// mapped_container<Scalar> maps a container file read-only and presents its elements as views without copying.
+// The mapping lives as long as the mapped_container, views must not outlive it.
+template<typename Scalar>
+class mapped_container {
+public:
+	explicit mapped_container(const std::string& path) : _base{ nullptr }, _length{ 0 } {
+#if defined(_WIN32)
+		std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+		if (!ifs) throw binary_container_exception("cannot open " + path);
+		_length = size_t(ifs.tellg());
+		_buffer.resize((_length + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+		ifs.seekg(0);
+		ifs.read(reinterpret_cast<char*>(_buffer.data()), std::streamsize(_length));
+		_base = reinterpret_cast<const char*>(_buffer.data());
+#else
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) throw binary_container_exception("cannot open " + path);
+		struct stat st;
+		if (::fstat(fd, &st) != 0) { ::close(fd); throw binary_container_exception("cannot stat " + path); }
+		_length = size_t(st.st_size);
+		if (_length < sizeof(binary_container_header)) { ::close(fd); throw binary_container_exception(path + " is not a binary container"); }
+		void* p = ::mmap(nullptr, _length, PROT_READ, MAP_SHARED, fd, 0);
+		::close(fd);     // the mapping keeps the file referenced
+		if (p == MAP_FAILED) throw binary_container_exception("cannot map " + path);
+		_base = static_cast<const char*>(p);
+#endif
+		if (_length < sizeof(binary_container_header)) { release(); throw binary_container_exception(path + " is not a binary container"); }
+		std::memcpy(&_header, _base, sizeof(_header));
+		try {
+			check_binary_header<Scalar>(_header, path);
+		}
+		catch (...) {
+			release();
+			throw;
+		}
+		if (!binary_payload_fits<Scalar>(_header, _length)) {
+			release();
+			throw binary_container_exception(path + " is truncated");
+		}
+	}
+	mapped_container(const mapped_container&) = delete;
+	mapped_container& operator=(const mapped_container&) = delete;
+	~mapped_container() { release(); }
+
+	const binary_container_header& header() const { return _header; }
+	size_t rows() const { return size_t(_header.rows); }
+	size_t cols() const { return size_t(_header.cols); }
+	size_t size() const { return size_t(_header.rows * _header.cols); }
+	const Scalar* data() const { return reinterpret_cast<const Scalar*>(_base + _header.data_offset); }
+
+	// all elements in storage order
+	vector_view<const Scalar> as_vector() const { return vector_view<const Scalar>(data(), size()); }
+	// the matrix in its stored layout
+	matrix_view<const Scalar> as_matrix() const {
+		return matrix_view<const Scalar>(data(), rows(), cols(), (_header.order == 0 ? layout::row_major : layout::column_major));
+	}
+
+private:
+	const char*             _base;
+	size_t                  _length;
+	binary_container_header _header;
+#if defined(_WIN32)
+	std::vector<uint64_t>   _buffer;
+#endif
+
+	void release() {
+#if !defined(_WIN32)
+		if (_base != nullptr) ::munmap(const_cast<char*>(_base), _length);
+#endif
+		_base = nullptr;
+	}
+};
+
+}}} // namespace sw::unum::blas
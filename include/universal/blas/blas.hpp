@@ -7,6 +7,11 @@
 
 #include <universal/blas/vector.hpp>
 #include <universal/blas/matrix.hpp>
+#include <universal/blas/vector_view.hpp>
+#include <universal/blas/matrix_view.hpp>
+#include <universal/blas/vector_expression.hpp>
+#include <universal/blas/sparse_matrix.hpp>
+#include <universal/blas/packed_vector.hpp>
 
 #include <universal/blas/blas_l1.hpp>
 #include <universal/blas/blas_l2.hpp>
@@ -50,7 +55,12 @@ constexpr uint64_t SIZE_512G = 512 * SIZE_1G;
 #include <universal/blas/inverse.hpp>
 // solvers
 #include <universal/blas/solvers/lu.hpp>
+#include <universal/blas/solvers/blocked_lu.hpp>
 #include <universal/blas/solvers/lsq.hpp>
+#include <universal/blas/solvers/preconditioners.hpp>
+#include <universal/blas/solvers/krylov.hpp>
+#include <universal/blas/solvers/runge_kutta.hpp>
+#include <universal/blas/solvers/stencil.hpp>
 
 // Matrix operators
 #include <universal/blas/operators.hpp>
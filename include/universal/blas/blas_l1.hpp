@@ -5,14 +5,67 @@
 //
 // This file is part of the universal numbers project, which is released under an MIT Open Source license.
 #include <cmath>
+#include <type_traits>
 #include <universal/posit/posit>
 #include <universal/blas/vector.hpp>
+#include <universal/functions/reproducible_sum.hpp>
+
+// route asum, sum, and dot of float and double vectors through the reproducible kernels,
+// so that their results do not depend on the order or the partitioning of the accumulation
+#ifndef BLAS_L1_REPRODUCIBLE
+#define BLAS_L1_REPRODUCIBLE 0
+#endif
 
 namespace sw { namespace unum { namespace blas { 
 
+// native scalars that have reproducible kernels
+template<typename Scalar>
+struct is_reproducible_native : std::integral_constant<bool, std::is_same<Scalar, float>::value || std::is_same<Scalar, double>::value> {};
+
+// reproducible 1-norm of a float or double vector, the index range follows asum: ix < n with stride incx
+// The result is bit-identical for any nrThreads, a nrThreads of 0 selects all hardware threads.
+template<typename Vector>
+typename Vector::value_type reproducible_asum(size_t n, const Vector& x, size_t incx = 1, unsigned nrThreads = 1) {
+	using value_type = typename Vector::value_type;
+	static_assert(is_reproducible_native<value_type>::value, "reproducible_asum requires a vector of float or double");
+	size_t count = (n + incx - 1) / incx;
+	return sw::function::reproducible_sum_of<value_type>(count, [&](size_t i) { return std::abs(x[i * incx]); }, nrThreads);
+}
+
+// reproducible sum of the elements of a float or double vector
+template<typename Vector>
+typename Vector::value_type reproducible_sum(const Vector& x, unsigned nrThreads = 1) {
+	using value_type = typename Vector::value_type;
+	static_assert(is_reproducible_native<value_type>::value, "reproducible_sum requires a vector of float or double");
+	return sw::function::reproducible_sum_of<value_type>(size(x), [&](size_t i) { return x[i]; }, nrThreads);
+}
+
+// reproducible dot product of float or double vectors, the index range follows dot
+template<typename Vector>
+typename Vector::value_type reproducible_dot(size_t n, const Vector& x, size_t incx, const Vector& y, size_t incy, unsigned nrThreads = 1) {
+	using value_type = typename Vector::value_type;
+	static_assert(is_reproducible_native<value_type>::value, "reproducible_dot requires vectors of float or double");
+	size_t count = n;
+	size_t nx = (size(x) + incx - 1) / incx, ny = (size(y) + incy - 1) / incy;
+	if (nx < count) count = nx;
+	if (ny < count) count = ny;
+	return sw::function::reproducible_dot_of<value_type>(count, [&](size_t i) { return x[i * incx]; }, [&](size_t i) { return y[i * incy]; }, nrThreads);
+}
+
+template<typename Vector>
+typename Vector::value_type reproducible_dot(const Vector& x, const Vector& y, unsigned nrThreads = 1) {
+	using value_type = typename Vector::value_type;
+	static_assert(is_reproducible_native<value_type>::value, "reproducible_dot requires vectors of float or double");
+	if (size(x) > size(y)) return value_type(0);
+	return sw::function::reproducible_dot_of<value_type>(size(x), [&](size_t i) { return x[i]; }, [&](size_t i) { return y[i]; }, nrThreads);
+}
+
 // 1-norm of a vector: sum of magnitudes of the vector elements, default increment stride is 1
 template<typename Vector>
 typename Vector::value_type asum(size_t n, const Vector& x, size_t incx = 1) {
+#if BLAS_L1_REPRODUCIBLE
+	if constexpr (is_reproducible_native<typename Vector::value_type>::value) return reproducible_asum(n, x, incx);
+#endif
 	typename Vector::value_type sum = 0;
 	size_t ix;
 	for (ix = 0; ix < n; ix += incx) {
@@ -22,8 +75,12 @@ typename Vector::value_type asum(size_t n, const Vector& x, size_t incx = 1) {
 }
 
 // sum of the vector elements, default increment stride is 1
-template<typename Vector>
+// sum of an expression template is fused, see vector_expression.hpp
+template<typename Vector, typename = typename std::enable_if<!is_vector_expression<Vector>::value>::type>
 typename Vector::value_type sum(const Vector& x) {
+#if BLAS_L1_REPRODUCIBLE
+	if constexpr (is_reproducible_native<typename Vector::value_type>::value) return reproducible_sum(x);
+#endif
 	typename Vector::value_type sum = 0;
 	size_t ix;
 	for (ix = 0; ix < size(x); ++ix) {
@@ -60,6 +117,9 @@ template<typename Scalar> auto size(const std::vector<Scalar>& v) { return v.siz
 template<typename Vector>
 typename Vector::value_type dot(size_t n, const Vector& x, size_t incx, const Vector& y, size_t incy) {
 	using value_type = typename Vector::value_type;
+#if BLAS_L1_REPRODUCIBLE
+	if constexpr (is_reproducible_native<value_type>::value) return reproducible_dot(n, x, incx, y, incy);
+#endif
 	value_type sum_of_products = value_type(0);
 	size_t cnt, ix, iy;
 	for (cnt = 0, ix = 0, iy = 0; cnt < n && ix < size(x) && iy < size(y); ++cnt, ix += incx, iy += incy) {
@@ -68,9 +128,13 @@ typename Vector::value_type dot(size_t n, const Vector& x, size_t incx, const Ve
 	return sum_of_products;
 }
 // specialized dot product assuming constant stride
-template<typename Vector>
+// dot product of expression templates is fused, see vector_expression.hpp
+template<typename Vector, typename = typename std::enable_if<!is_vector_expression<Vector>::value>::type>
 typename Vector::value_type dot(const Vector& x, const Vector& y) {
 	using value_type = typename Vector::value_type;
+#if BLAS_L1_REPRODUCIBLE
+	if constexpr (is_reproducible_native<value_type>::value) return reproducible_dot(x, y);
+#endif
 	value_type sum_of_products = value_type(0);
 	size_t nx = size(x);
 	if (nx <= size(y)) {
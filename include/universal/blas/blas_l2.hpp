@@ -4,9 +4,14 @@
 // Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
 //
 // This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <cassert>
 #include <iostream>
+#include <type_traits>
 #include <universal/blas/vector.hpp>
 #include <universal/blas/matrix.hpp>
+#include <universal/blas/vector_view.hpp>
+#include <universal/blas/matrix_view.hpp>
+#include <universal/blas/fused_kernels.hpp>
 
 // compilation flags
 // BLAS_TRACE_ROUNDING_EVENTS
@@ -101,3 +106,22 @@ sw::unum::blas::vector< sw::unum::posit<nbits, es> > fmv(const sw::unum::blas::m
 #endif
 	return b;
 }
+
+namespace sw { namespace unum { namespace blas {
+
+// Matrix-vector product on views: y = A * x
+// The views can reference submatrices, transposes, strided rows/columns, or external memory.
+// Each element of y is a single fused dot product, so posits round once per element.
+template<typename AScalar, typename XScalar, typename YScalar>
+void gemv(const matrix_view<AScalar>& A, const vector_view<XScalar>& x, const vector_view<YScalar>& y) {
+	using Scalar = typename std::remove_const<YScalar>::type;
+	// preconditions
+	assert(num_cols(A) == size(x));
+	assert(num_rows(A) == size(y));
+	size_t nc = num_cols(A);
+	for (size_t i = 0; i < num_rows(A); ++i) {
+		y[i] = fused_kernel<Scalar>::dot(0, nc, [&](size_t j) { return A(i, j); }, [&](size_t j) { return x[j]; });
+	}
+}
+
+}}} // namespace sw::unum::blas
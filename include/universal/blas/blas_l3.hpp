@@ -1,6 +1,33 @@
 #pragma once
-// blas_l1.hpp: BLAS Level 1 functions
+// blas_l3.hpp: BLAS Level 3 functions
 //
 // Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
 //
 // This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <iostream>
+#include <type_traits>
+#include <universal/blas/matrix.hpp>
+#include <universal/blas/matrix_view.hpp>
+#include <universal/blas/fused_kernels.hpp>
+#include <universal/blas/exceptions.hpp>
+
+namespace sw { namespace unum { namespace blas {
+
+// Matrix-matrix product on views: C = A * B
+// The views can reference submatrices, transposes, either layout, or external memory, so blocked
+// algorithms can update a block of a larger matrix in place. C must not alias A or B.
+// Each element of C is a single fused dot product, so posits round once per element.
+template<typename AScalar, typename BScalar, typename CScalar>
+void gemm(const matrix_view<AScalar>& A, const matrix_view<BScalar>& B, const matrix_view<CScalar>& C) {
+	using Scalar = typename std::remove_const<CScalar>::type;
+	if (num_cols(A) != num_rows(B)) throw matmul_incompatible_matrices(incompatible_matrices(num_rows(A), num_cols(A), num_rows(B), num_cols(B), "gemm").what());
+	if (num_rows(C) != num_rows(A) || num_cols(C) != num_cols(B)) throw matmul_incompatible_matrices(incompatible_matrices(num_rows(A), num_cols(B), num_rows(C), num_cols(C), "gemm result").what());
+	size_t dots = num_cols(A);
+	for (size_t i = 0; i < num_rows(C); ++i) {
+		for (size_t j = 0; j < num_cols(C); ++j) {
+			C(i, j) = fused_kernel<Scalar>::dot(0, dots, [&](size_t k) { return A(i, k); }, [&](size_t k) { return B(k, j); });
+		}
+	}
+}
+
+}}} // namespace sw::unum::blas
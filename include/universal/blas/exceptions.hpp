@@ -41,4 +41,13 @@ struct matmul_incompatible_matrices
 	};
 };
 
+// I/O errors and format mismatches of binary containers
+struct binary_container_exception
+	: public blas_exception
+{
+	binary_container_exception(const std::string& error)
+		: blas_exception(std::string("binary container: ") + error) {
+	};
+};
+
 }}} // namespace sw::unum::blas
@@ -0,0 +1,73 @@
+#pragma once
+// fused_kernels.hpp: dot product kernels with a single rounding step for posits and a plain accumulation for other types
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <cstddef>
+#include <universal/posit/posit_fwd.hpp>
+
+namespace sw { namespace unum { namespace blas {
+
+// fused_kernel<Scalar> computes the inner products of the blocked algorithms.
+// The operands are provided through accessors, lhs(p) and rhs(p), so that the same kernel
+// serves row-by-column products, triangular solves, and strided vectors.
+// The generic version accumulates in the Scalar type, the posit specialization accumulates
+// in a quire and rounds only once.
+template<typename Scalar>
+struct fused_kernel {
+	// return c - sum_{p = begin}^{end-1} lhs(p) * rhs(p)
+	template<typename Lhs, typename Rhs>
+	static Scalar sub_dot(const Scalar& c, size_t begin, size_t end, Lhs&& lhs, Rhs&& rhs) {
+		Scalar sum(0);
+		for (size_t p = begin; p < end; ++p) sum += lhs(p) * rhs(p);
+		return c - sum;
+	}
+	// return sum_{p = begin}^{end-1} lhs(p) * rhs(p)
+	template<typename Lhs, typename Rhs>
+	static Scalar dot(size_t begin, size_t end, Lhs&& lhs, Rhs&& rhs) {
+		Scalar sum(0);
+		for (size_t p = begin; p < end; ++p) sum += lhs(p) * rhs(p);
+		return sum;
+	}
+	// return sum_{p = begin}^{end-1} x(p)
+	template<typename Accessor>
+	static Scalar sum(size_t begin, size_t end, Accessor&& x) {
+		Scalar result(0);
+		for (size_t p = begin; p < end; ++p) result += x(p);
+		return result;
+	}
+};
+
+template<size_t nbits, size_t es>
+struct fused_kernel< posit<nbits, es> > {
+	static constexpr size_t capacity = 20; // FDP for vectors < 1,048,576 elements
+	using Scalar = posit<nbits, es>;
+
+	template<typename Lhs, typename Rhs>
+	static Scalar sub_dot(const Scalar& c, size_t begin, size_t end, Lhs&& lhs, Rhs&& rhs) {
+		quire<nbits, es, capacity> q(c);
+		for (size_t p = begin; p < end; ++p) q -= quire_mul(lhs(p), rhs(p));
+		Scalar result;
+		convert(q.to_value(), result);     // one and only rounding step of the fused-dot product
+		return result;
+	}
+	template<typename Lhs, typename Rhs>
+	static Scalar dot(size_t begin, size_t end, Lhs&& lhs, Rhs&& rhs) {
+		quire<nbits, es, capacity> q(0);
+		for (size_t p = begin; p < end; ++p) q += quire_mul(lhs(p), rhs(p));
+		Scalar result;
+		convert(q.to_value(), result);     // one and only rounding step of the fused-dot product
+		return result;
+	}
+	template<typename Accessor>
+	static Scalar sum(size_t begin, size_t end, Accessor&& x) {
+		quire<nbits, es, capacity> q(0);
+		for (size_t p = begin; p < end; ++p) q += Scalar(x(p));
+		Scalar result;
+		convert(q.to_value(), result);     // one and only rounding step of the fused sum
+		return result;
+	}
+};
+
+}}} // namespace sw::unum::blas
@@ -16,3 +16,4 @@
 
 #include <universal/blas/generators/tridiag.hpp>
 #include <universal/blas/generators/laplace2D.hpp>
+#include <universal/blas/generators/sparse_laplace.hpp>
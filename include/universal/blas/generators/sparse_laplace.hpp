@@ -0,0 +1,58 @@
+#pragma once
+// sparse_laplace.hpp: generate sparse 2D and 3D Laplace operator difference matrices
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <utility>
+#include <vector>
+#include <universal/blas/sparse_matrix.hpp>
+
+namespace sw { namespace unum { namespace blas { 
+
+// generate the 5-point 2D Laplacian difference equation matrix on an m x n grid in CSR format
+// row i * n + j holds the stencil of grid point (i, j), same as the dense laplace2D
+template<typename Scalar, typename Index = uint32_t>
+sparse_matrix<Scalar, Index> sparse_laplace2D(size_t m, size_t n) {
+	std::vector< sparse_entry<Scalar> > entries;
+	entries.reserve(5 * m * n);
+	Scalar four(4.0), minus_one(-1.0);
+	for (size_t i = 0; i < m; ++i) {
+		for (size_t j = 0; j < n; ++j) {
+			size_t row = i * n + j;
+			if (i > 0)     entries.push_back({ row, row - n, minus_one });
+			if (j > 0)     entries.push_back({ row, row - 1, minus_one });
+			entries.push_back({ row, row, four });
+			if (j < n - 1) entries.push_back({ row, row + 1, minus_one });
+			if (i < m - 1) entries.push_back({ row, row + n, minus_one });
+		}
+	}
+	return sparse_matrix<Scalar, Index>(m * n, m * n, std::move(entries));
+}
+
+// generate the 7-point 3D Laplacian difference equation matrix on an l x m x n grid in CSR format
+// row (i * m + j) * n + k holds the stencil of grid point (i, j, k)
+template<typename Scalar, typename Index = uint32_t>
+sparse_matrix<Scalar, Index> sparse_laplace3D(size_t l, size_t m, size_t n) {
+	std::vector< sparse_entry<Scalar> > entries;
+	entries.reserve(7 * l * m * n);
+	Scalar six(6.0), minus_one(-1.0);
+	size_t plane = m * n;
+	for (size_t i = 0; i < l; ++i) {
+		for (size_t j = 0; j < m; ++j) {
+			for (size_t k = 0; k < n; ++k) {
+				size_t row = (i * m + j) * n + k;
+				if (i > 0)     entries.push_back({ row, row - plane, minus_one });
+				if (j > 0)     entries.push_back({ row, row - n, minus_one });
+				if (k > 0)     entries.push_back({ row, row - 1, minus_one });
+				entries.push_back({ row, row, six });
+				if (k < n - 1) entries.push_back({ row, row + 1, minus_one });
+				if (j < m - 1) entries.push_back({ row, row + n, minus_one });
+				if (i < l - 1) entries.push_back({ row, row + plane, minus_one });
+			}
+		}
+	}
+	return sparse_matrix<Scalar, Index>(l * plane, l * plane, std::move(entries));
+}
+
+}}} // namespace sw::unum::blas
@@ -8,12 +8,23 @@
 #include <vector>
 #include <initializer_list>
 #include <map>
+#include <type_traits>
 #include <universal/blas/exceptions.hpp>
+#include <universal/blas/vector.hpp>
 #include <universal/posit/posit_fwd.hpp>
 
 namespace sw { namespace unum { namespace blas { 
 
 template<typename Scalar> class matrix;
+
+// base of the expression templates that represent a matrix-valued expression, see vector_expression.hpp
+template<typename E>
+struct matrix_expression {
+	const E& self() const { return static_cast<const E&>(*this); }
+};
+template<typename T>
+struct is_matrix_expression : std::is_base_of<matrix_expression<T>, T> {};
+
 template<typename Scalar>
 class ConstRowProxy {
 public:
@@ -42,18 +53,18 @@ public:
 	typedef const value_type*						const_pointer_type;
 	typedef typename std::vector<Scalar>::size_type size_type;
 
-	matrix() : _m{ 0 }, _n{ 0 }, data(0) {}
-	matrix(size_t m, size_t n) : _m{ m }, _n{ n }, data(m*n, Scalar(0.0)) { }
+	matrix() : _m{ 0 }, _n{ 0 }, _data(0) {}
+	matrix(size_t m, size_t n) : _m{ m }, _n{ n }, _data(m*n, Scalar(0.0)) { }
 	matrix(std::initializer_list< std::initializer_list<Scalar> > values) {
 		size_t nrows = values.size();
 		size_t ncols = values.begin()->size();
-		data.resize(nrows * ncols);
+		_data.resize(nrows * ncols);
 		size_t r = 0;
 		for (auto l : values) {
 			if (l.size() == ncols) {
 				size_t c = 0;
 				for (auto v : l) {
-					data[r*ncols + c] = v;
+					_data[r*ncols + c] = v;
 					++c;
 				}
 				++r;
@@ -62,29 +73,48 @@ public:
 		_m = nrows;
 		_n = ncols;
 	}
-	matrix(const matrix& A) : _m{ A._m }, _n{ A._n }, data(A.data) {}
+	matrix(const matrix& A) : _m{ A._m }, _n{ A._n }, _data(A._data) {}
 
 	// operators
 	matrix& operator=(const matrix& M) = default;
 	matrix& operator=(matrix&& M) = default;
 
+	// evaluate an expression template in a single pass over the elements
+	// expressions are element-wise, so the target may appear in the expression
+	template<typename E>
+	matrix(const matrix_expression<E>& e) : _m{ e.self().rows() }, _n{ e.self().cols() }, _data(e.self().rows() * e.self().cols()) {
+		const E& expr = e.self();
+		for (size_t i = 0; i < _m; ++i) {
+			for (size_t j = 0; j < _n; ++j) _data[i * _n + j] = expr(i, j);
+		}
+	}
+	template<typename E>
+	matrix& operator=(const matrix_expression<E>& e) {
+		const E& expr = e.self();
+		if (expr.rows() != _m || expr.cols() != _n) return *this = matrix(e);
+		for (size_t i = 0; i < _m; ++i) {
+			for (size_t j = 0; j < _n; ++j) _data[i * _n + j] = expr(i, j);
+		}
+		return *this;
+	}
+
 	// Identity matrix operator
 	matrix& operator=(const Scalar& one) {
 		setzero();
 		size_t smallestDimension = (_m < _n ? _m : _n);
-		for (size_t i = 0; i < smallestDimension; ++i) data[i*_n + i] = one;
+		for (size_t i = 0; i < smallestDimension; ++i) _data[i*_n + i] = one;
 		return *this;
 	}
 
-	Scalar operator()(size_t i, size_t j) const { return data[i*_n + j]; }
-	Scalar& operator()(size_t i, size_t j) { return data[i*_n + j]; }
+	Scalar operator()(size_t i, size_t j) const { return _data[i*_n + j]; }
+	Scalar& operator()(size_t i, size_t j) { return _data[i*_n + j]; }
 	RowProxy<Scalar> operator[](size_t i) {
-		typename std::vector<Scalar>::iterator it = data.begin() + int64_t(i) * int64_t(_n);
+		typename std::vector<Scalar>::iterator it = _data.begin() + int64_t(i) * int64_t(_n);
 		RowProxy<Scalar> proxy(it);
 		return proxy;
 	}
 	ConstRowProxy<Scalar> operator[](size_t i) const {
-		typename std::vector<Scalar>::const_iterator it = data.begin() + static_cast<int64_t>(i * _n);
+		typename std::vector<Scalar>::const_iterator it = _data.begin() + static_cast<int64_t>(i * _n);
 		ConstRowProxy<Scalar> proxy(it);
 		return proxy;
 	}
@@ -98,7 +128,7 @@ public:
 			return *this; // return without changing
 		}
 		for (size_type e = 0; e < _m * _n; ++e) {
-			data[e] += rhs.data[e];
+			_data[e] += rhs._data[e];
 		}
 		return *this;
 	}
@@ -111,7 +141,7 @@ public:
 			return *this; // return without changing
 		}
 		for (size_type e = 0; e < _m*_n; ++e) {
-			data[e] -= rhs.data[e];
+			_data[e] -= rhs._data[e];
 		}
 		return *this;
 	}
@@ -120,7 +150,7 @@ public:
 	matrix& operator*=(const Scalar& a) {
 		using size_type = typename matrix<Scalar>::size_type;
 		for (size_type e = 0; e < _m*_n; ++e) {
-			data[e] *= a;
+			_data[e] *= a;
 		}
 		return *this;
 	}
@@ -128,18 +158,21 @@ public:
 	matrix& operator/=(const Scalar& a) {
 		using size_type = typename matrix<Scalar>::size_type;
 		for (size_type e = 0; e < _m * _n; ++e) {
-			data[e] /= a;
+			_data[e] /= a;
 		}
 		return *this;
 	}
 
 	// modifiers
-	inline void setzero() { for (auto& elem : data) elem = Scalar(0); }
-	inline void resize(size_t m, size_t n) { _m = m; _n = n; data.resize(m * n); }
+	inline void setzero() { for (auto& elem : _data) elem = Scalar(0); }
+	inline void resize(size_t m, size_t n) { _m = m; _n = n; _data.resize(m * n); }
 	// selectors
 	inline size_t rows() const { return _m; }
 	inline size_t cols() const { return _n; }
 	inline std::pair<size_t, size_t> size() const { return std::make_pair(_m, _n); }
+	// pointer to the row-major element storage, to create views and to interface with external code
+	inline Scalar* data() noexcept { return _data.data(); }
+	inline const Scalar* data() const noexcept { return _data.data(); }
 
 	// in-place transpose
 	matrix& transpose() {
@@ -154,10 +187,10 @@ public:
 		index = 1;
 		while (index < size) {
 			cycleStart = index;
-			e = data[index];
+			e = _data[index];
 			do {
 				next = (index * _m) % size;
-				std::swap(data[next], e);
+				std::swap(_data[next], e);
 				b[index] = true;
 				index = next;
 			} while (index != cycleStart);
@@ -176,7 +209,7 @@ public:
 
 private:
 	size_t _m, _n; // m rows and n columns
-	std::vector<Scalar> data;
+	std::vector<Scalar> _data;
 
 };
 
@@ -207,6 +240,8 @@ std::ostream& operator<<(std::ostream& ostr, const std::pair<Scalar, Scalar>& p)
 	return ostr << '(' << p.first << " by " << p.second << ')';
 }
 
+#if !BLAS_ENABLE_EXPRESSION_TEMPLATES
+// eager operators: each one returns a new matrix, see vector_expression.hpp for the fused alternative
 // matrix element-wise sum
 template<typename Scalar>
 matrix<Scalar> operator+(const matrix<Scalar>& A, const matrix<Scalar>& B) {
@@ -220,6 +255,10 @@ matrix<Scalar> operator-(const matrix<Scalar>& A, const matrix<Scalar>& B) {
 	matrix<Scalar> Diff(A);
 	return Diff -= B;
 }
+#endif // !BLAS_ENABLE_EXPRESSION_TEMPLATES
+
+// the scaling operators stay eager with BLAS_ENABLE_EXPRESSION_TEMPLATES: partial ordering prefers them
+// over the expression operators for an element type scalar, so a*A remains a matrix
 
 // matrix scaling through Scalar multiply
 template<typename Scalar>
@@ -0,0 +1,153 @@
+#pragma once
+// matrix_view.hpp: non-owning, strided view of a dense matrix in row-major or column-major layout
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <cstddef>
+#include <iostream>
+#include <iomanip>
+#include <type_traits>
+#include <universal/blas/matrix.hpp>
+#include <universal/blas/vector_view.hpp>
+
+namespace sw { namespace unum { namespace blas {
+
+// storage order of a dense matrix
+enum class layout {
+	row_major,      // consecutive elements of a row are adjacent, C convention
+	column_major    // consecutive elements of a column are adjacent, Fortran/LAPACK convention
+};
+
+// matrix_view<Scalar> references an m x n matrix in memory it does not own.
+// Element (i,j) lives at data[i * rowStride + j * colStride], which covers both layouts with a
+// leading dimension, submatrices, and transposes without moving any elements.
+// Use matrix_view<const Scalar> for read-only access. Copying a view copies the reference, not the elements.
+template<typename Scalar>
+class matrix_view {
+public:
+	typedef typename std::remove_const<Scalar>::type value_type;
+	typedef Scalar&                                  reference;
+	typedef const Scalar&                            const_reference;
+	typedef Scalar*                                  pointer;
+	typedef size_t                                   size_type;
+
+	matrix_view() : _data{ nullptr }, _m{ 0 }, _n{ 0 }, _rowStride{ 0 }, _colStride{ 1 } {}
+	// wrap an externally owned buffer with the given layout
+	// ld is the leading dimension: the distance between consecutive rows (row-major) or columns (column-major),
+	// a value of 0 selects a densely packed buffer
+	matrix_view(Scalar* data, size_t m, size_t n, layout order = layout::row_major, size_t ld = 0) : _data{ data }, _m{ m }, _n{ n } {
+		if (order == layout::row_major) {
+			_rowStride = std::ptrdiff_t(ld == 0 ? n : ld);
+			_colStride = 1;
+		}
+		else {
+			_rowStride = 1;
+			_colStride = std::ptrdiff_t(ld == 0 ? m : ld);
+		}
+	}
+	// wrap an externally owned buffer with arbitrary element strides
+	matrix_view(Scalar* data, size_t m, size_t n, std::ptrdiff_t rowStride, std::ptrdiff_t colStride)
+		: _data{ data }, _m{ m }, _n{ n }, _rowStride{ rowStride }, _colStride{ colStride } {}
+	// view all elements of a matrix
+	template<typename S, typename = typename std::enable_if<std::is_convertible<S*, Scalar*>::value>::type>
+	matrix_view(matrix<S>& A) : _data{ A.data() }, _m{ A.rows() }, _n{ A.cols() }, _rowStride{ std::ptrdiff_t(A.cols()) }, _colStride{ 1 } {}
+	template<typename S, typename = typename std::enable_if<std::is_convertible<const S*, Scalar*>::value>::type>
+	matrix_view(const matrix<S>& A) : _data{ A.data() }, _m{ A.rows() }, _n{ A.cols() }, _rowStride{ std::ptrdiff_t(A.cols()) }, _colStride{ 1 } {}
+	// a view to mutable elements converts to a read-only view
+	template<typename S, typename = typename std::enable_if<std::is_convertible<S*, Scalar*>::value && !std::is_same<S, Scalar>::value>::type>
+	matrix_view(const matrix_view<S>& A) : _data{ A.data() }, _m{ A.rows() }, _n{ A.cols() }, _rowStride{ A.row_stride() }, _colStride{ A.col_stride() } {}
+
+	matrix_view(const matrix_view&) = default;
+	matrix_view& operator=(const matrix_view&) = default;
+
+	reference operator()(size_t i, size_t j) const { return _data[std::ptrdiff_t(i) * _rowStride + std::ptrdiff_t(j) * _colStride]; }
+	// A[i][j] indexing through a row view
+	vector_view<Scalar> operator[](size_t i) const { return row(i); }
+
+	// copy the values of a matrix of the same shape into the viewed elements
+	template<typename Matrix>
+	matrix_view& assign(const Matrix& B) {
+		for (size_t i = 0; i < _m; ++i) {
+			for (size_t j = 0; j < _n; ++j) (*this)(i, j) = B(i, j);
+		}
+		return *this;
+	}
+	// set all viewed elements to a value
+	matrix_view& assign(const value_type& val) {
+		for (size_t i = 0; i < _m; ++i) {
+			for (size_t j = 0; j < _n; ++j) (*this)(i, j) = val;
+		}
+		return *this;
+	}
+
+	// zero-copy views
+	// m x n submatrix with its top-left element at (row, col)
+	matrix_view submatrix(size_t row, size_t col, size_t m, size_t n) const {
+		return matrix_view(&(*this)(row, col), m, n, _rowStride, _colStride);
+	}
+	matrix_view transpose() const { return matrix_view(_data, _n, _m, _colStride, _rowStride); }
+	vector_view<Scalar> row(size_t i) const { return vector_view<Scalar>(_data + std::ptrdiff_t(i) * _rowStride, _n, _colStride); }
+	vector_view<Scalar> column(size_t j) const { return vector_view<Scalar>(_data + std::ptrdiff_t(j) * _colStride, _m, _rowStride); }
+	vector_view<Scalar> diagonal() const { return vector_view<Scalar>(_data, (_m < _n ? _m : _n), _rowStride + _colStride); }
+
+	// selectors
+	size_t rows() const { return _m; }
+	size_t cols() const { return _n; }
+	std::pair<size_t, size_t> size() const { return std::make_pair(_m, _n); }
+	std::ptrdiff_t row_stride() const { return _rowStride; }
+	std::ptrdiff_t col_stride() const { return _colStride; }
+	pointer data() const { return _data; }
+	bool is_row_major() const { return _colStride == 1; }
+	bool is_column_major() const { return _rowStride == 1; }
+
+private:
+	Scalar*        _data;
+	size_t         _m, _n;
+	std::ptrdiff_t _rowStride, _colStride;
+};
+
+template<typename Scalar>
+inline size_t num_rows(const matrix_view<Scalar>& A) { return A.rows(); }
+template<typename Scalar>
+inline size_t num_cols(const matrix_view<Scalar>& A) { return A.cols(); }
+template<typename Scalar>
+inline std::pair<size_t, size_t> size(const matrix_view<Scalar>& A) { return A.size(); }
+
+// zero-copy transposed view
+template<typename Scalar>
+matrix_view<Scalar> transpose(const matrix_view<Scalar>& A) { return A.transpose(); }
+
+// create a view of the m x n submatrix of A with its top-left element at (row, col)
+template<typename Scalar>
+matrix_view<Scalar> make_view(matrix<Scalar>& A, size_t row, size_t col, size_t m, size_t n) {
+	return matrix_view<Scalar>(A).submatrix(row, col, m, n);
+}
+template<typename Scalar>
+matrix_view<const Scalar> make_view(const matrix<Scalar>& A, size_t row, size_t col, size_t m, size_t n) {
+	return matrix_view<const Scalar>(A).submatrix(row, col, m, n);
+}
+
+// copy the elements of a view into a new matrix
+template<typename Scalar>
+matrix<typename std::remove_const<Scalar>::type> to_matrix(const matrix_view<Scalar>& A) {
+	matrix<typename std::remove_const<Scalar>::type> B(A.rows(), A.cols());
+	for (size_t i = 0; i < A.rows(); ++i) {
+		for (size_t j = 0; j < A.cols(); ++j) B(i, j) = A(i, j);
+	}
+	return B;
+}
+
+template<typename Scalar>
+std::ostream& operator<<(std::ostream& ostr, const matrix_view<Scalar>& A) {
+	auto width = ostr.width();
+	for (size_t i = 0; i < A.rows(); ++i) {
+		for (size_t j = 0; j < A.cols(); ++j) {
+			ostr << std::fixed << std::setw(width) << A(i, j) << " ";
+		}
+		ostr << '\n';
+	}
+	return ostr;
+}
+
+}}} // namespace sw::unum::blas
@@ -0,0 +1,282 @@
+#pragma once
+// packed_vector.hpp: vector of posits stored densely at exactly nbits per element
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <cstdint>
+#include <cstddef>
+#include <iostream>
+#include <iomanip>
+#include <iterator>
+#include <initializer_list>
+#include <type_traits>
+#include <vector>
+#include <universal/posit/posit_fwd.hpp>
+#include <universal/blas/vector.hpp>
+#include <universal/blas/matrix_view.hpp>
+#include <universal/blas/exceptions.hpp>
+#include <universal/blas/fused_kernels.hpp>
+
+namespace sw { namespace unum { namespace blas {
+
+template<typename Scalar> class packed_vector;
+
+// packed_vector< posit<nbits, es> > stores the encodings of its elements back to back in 64-bit words,
+// so a posit<10,1> occupies 10 bits instead of the bytes of a posit object.
+// Element i occupies bits [i * nbits, (i + 1) * nbits) of the word array and may straddle two words.
+//
+// Access paths, from fastest to most convenient:
+//   unpack/pack     convert a range of elements to and from an array of posits in one sequential pass
+//   const_iterator  streams the elements in order, decoding each one on dereference
+//   operator[]      random access through a proxy reference that reads and writes the packed bits
+// The L1 routines that are written against size(x), x[i] and value_type accept a packed_vector directly.
+template<size_t nbits, size_t es>
+class packed_vector< posit<nbits, es> > {
+	static_assert(nbits <= 64, "packed_vector supports posits of up to 64 bits");
+	static constexpr size_t   word_bits = 64;
+	static constexpr uint64_t mask = (nbits == 64 ? ~uint64_t(0) : (uint64_t(1) << nbits) - 1);
+public:
+	typedef posit<nbits, es> value_type;
+	typedef size_t           size_type;
+	static constexpr size_t  bits_per_element = nbits;
+
+	// proxy reference to a packed element
+	class reference {
+	public:
+		reference(packed_vector& v, size_t i) : _v(v), _i(i) {}
+		reference(const reference&) = default;
+		operator value_type() const { return _v.get(_i); }
+		reference& operator=(const value_type& p) { _v.set(_i, p); return *this; }
+		reference& operator=(const reference& r) { _v.set(_i, value_type(r)); return *this; }
+		reference& operator+=(const value_type& p) { _v.set(_i, _v.get(_i) + p); return *this; }
+		reference& operator-=(const value_type& p) { _v.set(_i, _v.get(_i) - p); return *this; }
+		reference& operator*=(const value_type& p) { _v.set(_i, _v.get(_i) * p); return *this; }
+		reference& operator/=(const value_type& p) { _v.set(_i, _v.get(_i) / p); return *this; }
+		// the posit comparison operators are templates, which do not consider the conversion of the proxy
+		friend bool operator==(const reference& r, const value_type& p) { return value_type(r) == p; }
+		friend bool operator!=(const reference& r, const value_type& p) { return value_type(r) != p; }
+		friend bool operator< (const reference& r, const value_type& p) { return value_type(r) <  p; }
+		friend bool operator> (const reference& r, const value_type& p) { return value_type(r) >  p; }
+		friend bool operator<=(const reference& r, const value_type& p) { return value_type(r) <= p; }
+		friend bool operator>=(const reference& r, const value_type& p) { return value_type(r) >= p; }
+	private:
+		packed_vector& _v;
+		size_t         _i;
+	};
+
+	// random access iterators: the const_iterator yields values, the iterator yields proxy references
+	template<bool IsConst>
+	class basic_iterator {
+		using container = typename std::conditional<IsConst, const packed_vector, packed_vector>::type;
+	public:
+		typedef std::random_access_iterator_tag                                  iterator_category;
+		typedef typename packed_vector::value_type                               value_type;
+		typedef std::ptrdiff_t                                                   difference_type;
+		typedef typename std::conditional<IsConst, value_type, typename packed_vector::reference>::type reference;
+		typedef void                                                             pointer;
+
+		basic_iterator() : _v{ nullptr }, _i{ 0 } {}
+		basic_iterator(container* v, size_t i) : _v{ v }, _i{ i } {}
+		operator basic_iterator<true>() const { return basic_iterator<true>(_v, _i); }
+
+		reference operator*() const { return (*_v)[_i]; }
+		reference operator[](difference_type n) const { return (*_v)[size_t(std::ptrdiff_t(_i) + n)]; }
+		basic_iterator& operator++() { ++_i; return *this; }
+		basic_iterator operator++(int) { basic_iterator tmp(*this); ++_i; return tmp; }
+		basic_iterator& operator--() { --_i; return *this; }
+		basic_iterator operator--(int) { basic_iterator tmp(*this); --_i; return tmp; }
+		basic_iterator& operator+=(difference_type n) { _i = size_t(std::ptrdiff_t(_i) + n); return *this; }
+		basic_iterator& operator-=(difference_type n) { _i = size_t(std::ptrdiff_t(_i) - n); return *this; }
+		basic_iterator operator+(difference_type n) const { return basic_iterator(_v, size_t(std::ptrdiff_t(_i) + n)); }
+		basic_iterator operator-(difference_type n) const { return basic_iterator(_v, size_t(std::ptrdiff_t(_i) - n)); }
+		difference_type operator-(const basic_iterator& rhs) const { return std::ptrdiff_t(_i) - std::ptrdiff_t(rhs._i); }
+		bool operator==(const basic_iterator& rhs) const { return _i == rhs._i; }
+		bool operator!=(const basic_iterator& rhs) const { return _i != rhs._i; }
+		bool operator< (const basic_iterator& rhs) const { return _i < rhs._i; }
+		bool operator> (const basic_iterator& rhs) const { return _i > rhs._i; }
+		bool operator<=(const basic_iterator& rhs) const { return _i <= rhs._i; }
+		bool operator>=(const basic_iterator& rhs) const { return _i >= rhs._i; }
+	private:
+		container* _v;
+		size_t     _i;
+	};
+	typedef basic_iterator<false> iterator;
+	typedef basic_iterator<true>  const_iterator;
+
+	packed_vector() : _n{ 0 } {}
+	explicit packed_vector(size_t n, const value_type& init = value_type(0)) : _n{ n }, _words(words_for(n), 0) {
+		if (init.encoding() != 0) for (size_t i = 0; i < n; ++i) set(i, init);
+	}
+	packed_vector(std::initializer_list<value_type> iList) : _n{ iList.size() }, _words(words_for(iList.size()), 0) {
+		size_t i = 0;
+		for (const value_type& p : iList) set(i++, p);
+	}
+	explicit packed_vector(const vector<value_type>& v) : _n{ v.size() }, _words(words_for(v.size()), 0) {
+		pack(0, _n, v.data());
+	}
+
+	// new elements are zero
+	void resize(size_t n) {
+		if (n < _n) {
+			// clear the bits of the removed elements that share the last word, so that growing again yields zeros
+			size_t used = (n * nbits) % word_bits;
+			_words.resize(words_for(n));
+			if (used) _words.back() &= (uint64_t(1) << used) - 1;
+		}
+		else {
+			_words.resize(words_for(n), 0);
+		}
+		_n = n;
+	}
+
+	// element access
+	value_type operator[](size_t i) const { return get(i); }
+	reference operator[](size_t i) { return reference(*this, i); }
+	value_type operator()(size_t i) const { return get(i); }
+	reference operator()(size_t i) { return reference(*this, i); }
+
+	value_type get(size_t i) const {
+		value_type p;
+		p.set_raw_bits(bits(i));
+		return p;
+	}
+	void set(size_t i, const value_type& p) { set_bits(i, uint64_t(p.encoding())); }
+
+	// bulk conversion of the elements [first, first + count) from and to an array of posits
+	// both walk the word array sequentially, carrying the bit position forward instead of recomputing it
+	void unpack(size_t first, size_t count, value_type* out) const {
+		size_t offset = first * nbits;
+		size_t w = offset / word_bits, b = offset % word_bits;
+		for (size_t k = 0; k < count; ++k) {
+			uint64_t raw = _words[w] >> b;
+			if (b + nbits > word_bits) raw |= _words[w + 1] << (word_bits - b);
+			out[k].set_raw_bits(raw & mask);
+			b += nbits;
+			if (b >= word_bits) { b -= word_bits; ++w; }
+		}
+	}
+	void pack(size_t first, size_t count, const value_type* in) {
+		size_t offset = first * nbits;
+		size_t w = offset / word_bits, b = offset % word_bits;
+		for (size_t k = 0; k < count; ++k) {
+			uint64_t raw = uint64_t(in[k].encoding()) & mask;
+			_words[w] = (_words[w] & ~(mask << b)) | (raw << b);
+			if (b + nbits > word_bits) {
+				size_t spill = word_bits - b;
+				_words[w + 1] = (_words[w + 1] & ~(mask >> spill)) | (raw >> spill);
+			}
+			b += nbits;
+			if (b >= word_bits) { b -= word_bits; ++w; }
+		}
+	}
+	// convert to an unpacked vector
+	vector<value_type> unpack() const {
+		vector<value_type> v(_n);
+		unpack(0, _n, v.data());
+		return v;
+	}
+
+	iterator begin() { return iterator(this, 0); }
+	iterator end() { return iterator(this, _n); }
+	const_iterator begin() const { return const_iterator(this, 0); }
+	const_iterator end() const { return const_iterator(this, _n); }
+	const_iterator cbegin() const { return const_iterator(this, 0); }
+	const_iterator cend() const { return const_iterator(this, _n); }
+
+	// selectors
+	size_t size() const { return _n; }
+	// bytes of element storage
+	size_t storage() const { return _words.size() * sizeof(uint64_t); }
+	const uint64_t* words() const { return _words.data(); }
+
+private:
+	size_t                _n;
+	std::vector<uint64_t> _words;
+
+	static size_t words_for(size_t n) { return (n * nbits + word_bits - 1) / word_bits; }
+
+	uint64_t bits(size_t i) const {
+		size_t offset = i * nbits;
+		size_t w = offset / word_bits, b = offset % word_bits;
+		uint64_t raw = _words[w] >> b;
+		if (b + nbits > word_bits) raw |= _words[w + 1] << (word_bits - b);
+		return raw & mask;
+	}
+	void set_bits(size_t i, uint64_t raw) {
+		raw &= mask;
+		size_t offset = i * nbits;
+		size_t w = offset / word_bits, b = offset % word_bits;
+		_words[w] = (_words[w] & ~(mask << b)) | (raw << b);
+		if (b + nbits > word_bits) {
+			size_t spill = word_bits - b;
+			_words[w + 1] = (_words[w + 1] & ~(mask >> spill)) | (raw >> spill);
+		}
+	}
+};
+
+template<typename Scalar>
+inline size_t size(const packed_vector<Scalar>& v) { return v.size(); }
+
+template<typename Scalar>
+bool operator==(const packed_vector<Scalar>& a, const packed_vector<Scalar>& b) {
+	if (size(a) != size(b)) return false;
+	for (size_t i = 0; i < size(a); ++i) if (a[i] != b[i]) return false;
+	return true;
+}
+template<typename Scalar>
+bool operator!=(const packed_vector<Scalar>& a, const packed_vector<Scalar>& b) { return !(a == b); }
+
+template<typename Scalar>
+std::ostream& operator<<(std::ostream& ostr, const packed_vector<Scalar>& v) {
+	auto width = ostr.width();
+	size_t n = size(v);
+	for (size_t i = 0; i < n; ++i) ostr << std::setw(width) << v[i] << (i + 1 < n ? " " : "");
+	return ostr;
+}
+
+// fused dot product of packed vectors: blocks of elements are unpacked into a local buffer and
+// accumulated in a quire, with a single rounding at the end
+template<size_t nbits, size_t es>
+posit<nbits, es> dot(const packed_vector< posit<nbits, es> >& x, const packed_vector< posit<nbits, es> >& y) {
+	using Scalar = posit<nbits, es>;
+	constexpr size_t blockSize = 64;
+	Scalar xb[blockSize], yb[blockSize];
+	quire<nbits, es, 20> q(0);
+	size_t n = (size(x) < size(y) ? size(x) : size(y));
+	for (size_t i = 0; i < n; i += blockSize) {
+		size_t count = (n - i < blockSize ? n - i : blockSize);
+		x.unpack(i, count, xb);
+		y.unpack(i, count, yb);
+		for (size_t k = 0; k < count; ++k) q += quire_mul(xb[k], yb[k]);
+	}
+	Scalar result;
+	convert(q.to_value(), result);
+	return result;
+}
+
+// matrix-vector product y = A * x with packed vectors: x is unpacked once, each row is a fused dot product,
+// and the results are packed a block at a time
+template<typename AScalar, size_t nbits, size_t es>
+void gemv(const matrix_view<AScalar>& A, const packed_vector< posit<nbits, es> >& x, packed_vector< posit<nbits, es> >& y) {
+	using Scalar = posit<nbits, es>;
+	constexpr size_t blockSize = 64;
+	size_t m = num_rows(A), n = num_cols(A);
+	if (n != size(x)) throw matmul_incompatible_matrices(incompatible_matrices(m, n, size(x), 1, "gemv").what());
+	if (size(y) != m) y.resize(m);
+	vector<Scalar> xu = x.unpack();
+	Scalar yb[blockSize];
+	for (size_t i = 0; i < m; i += blockSize) {
+		size_t count = (m - i < blockSize ? m - i : blockSize);
+		for (size_t k = 0; k < count; ++k) {
+			yb[k] = fused_kernel<Scalar>::dot(0, n, [&](size_t j) { return A(i + k, j); }, [&](size_t j) { return xu[j]; });
+		}
+		y.pack(i, count, yb);
+	}
+}
+template<size_t nbits, size_t es>
+void gemv(const matrix< posit<nbits, es> >& A, const packed_vector< posit<nbits, es> >& x, packed_vector< posit<nbits, es> >& y) {
+	gemv(matrix_view<const posit<nbits, es>>(A), x, y);
+}
+
+}}} // namespace sw::unum::blas
@@ -0,0 +1,202 @@
+#pragma once
+// blocked_lu.hpp: blocked, multi-threaded LU decomposition with partial pivoting
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <iostream>
+#include <limits>
+#include <utility>  // std::pair, std::swap
+#include <universal/blas/matrix.hpp>
+#include <universal/blas/vector.hpp>
+#include <universal/blas/matrix_view.hpp>
+#include <universal/blas/fused_kernels.hpp>
+#include <universal/utility/parallel_for.hpp>
+
+namespace sw { namespace unum { namespace blas {
+
+// Right-looking blocked LU decomposition
+//
+// For each panel of nb columns starting at column k:
+//   1- factor the panel A[k:N, k:k+nb] with partial pivoting, swapping full rows
+//   2- solve the triangular system U12 = L11^-1 * A12 for the block row to the right of the panel
+//   3- update the trailing matrix A22 = A22 - L21 * U12
+// Every element update is a single fused dot product, so for posits each step rounds once
+// per element per panel. The triangular solve and the trailing update are distributed across threads.
+//
+// The result is stored in place as L + U with a unit diagonal L, and indx[j] holds the row that
+// was exchanged with row j, the same representation that ludcmp produces, so lubksb can consume it.
+
+// factor the panel A[k:N, k:kend] in place, Crout-style within the panel so that each element
+// receives all its panel contributions in one fused dot product.
+// Called by every thread t of the team of nrThreads. Tall panels share the rows below the diagonal among
+// the threads, with thread 0 doing the upper part of a column and the pivoting; short panels are factored
+// by thread 0 alone, so that they cost one barrier instead of three per column. Returns false when the
+// team was aborted.
+template<typename Scalar>
+bool lu_panel(const matrix_view<Scalar>& A, vector<size_t>& indx, size_t k, size_t kend, unsigned t, unsigned nrThreads, thread_barrier& sync) {
+	using std::fabs;
+	using Kernel = fused_kernel<Scalar>;
+	const size_t N = num_rows(A);
+	const bool shared = (N - k) > 256 && nrThreads > 1;
+	if (!shared && t != 0) return sync.wait();
+	const unsigned team = (shared ? nrThreads : 1u);
+	auto barrier = [&]() { return !shared || sync.wait(); };
+	for (size_t j = k; j < kend; ++j) {
+		// upper part of column j within the panel: forward substitution with L11
+		if (t == 0) {
+			for (size_t i = k; i < j; ++i) {
+				A(i, j) = Kernel::sub_dot(A(i, j), k, i, [&](size_t p) { return A(i, p); }, [&](size_t p) { return A(p, j); });
+			}
+		}
+		if (!barrier()) return false;
+		// lower part of column j: apply the contributions of the panel columns to the left
+		std::pair<size_t, size_t> rows = block_range(j, N, t, team);
+		for (size_t i = rows.first; i < rows.second; ++i) {
+			A(i, j) = Kernel::sub_dot(A(i, j), k, j, [&](size_t p) { return A(i, p); }, [&](size_t p) { return A(p, j); });
+		}
+		if (!barrier()) return false;
+		// select the pivot
+		if (t == 0) {
+			size_t imax = j;
+			Scalar pivot = fabs(A(j, j));
+			for (size_t i = j + 1; i < N; ++i) {
+				Scalar e = fabs(A(i, j));
+				if (e > pivot) {
+					pivot = e;
+					imax = i;
+				}
+			}
+			if (imax != j) {
+				for (size_t c = 0; c < num_cols(A); ++c) std::swap(A(imax, c), A(j, c));
+			}
+			indx[j] = imax;
+			if (A(j, j) == 0) A(j, j) = std::numeric_limits<Scalar>::epsilon();
+		}
+		if (!barrier()) return false;
+		// the multipliers of column j; the upper part of the next column does not read them
+		Scalar diagonal = A(j, j);
+		rows = block_range(j + 1, N, t, team);
+		for (size_t i = rows.first; i < rows.second; ++i) A(i, j) /= diagonal;
+	}
+	return sync.wait();
+}
+
+// in-place blocked LU decomposition using partial pivoting
+// The view can be a submatrix of a larger matrix, column-major, or wrap external memory.
+// blockSize is the panel width, nrThreads of 0 uses all hardware threads.
+// One team of threads runs all the steps and synchronizes them with a barrier, instead of forking
+// threads per panel column and per block step.
+template<typename Scalar>
+int blocked_ludcmp(const matrix_view<Scalar>& A, vector<size_t>& indx, size_t blockSize = 64, unsigned nrThreads = 0) {
+	using Kernel = fused_kernel<Scalar>;
+	const size_t N = num_rows(A);
+	if (N != num_cols(A)) {
+		std::cerr << "matrix argument to blocked_ludcmp is not square: (" << num_rows(A) << " x " << num_cols(A) << ")\n";
+		return 1;
+	}
+	if (blockSize == 0) blockSize = 1;
+	if (nrThreads == 0) nrThreads = hardware_concurrency();
+	if (size_t(nrThreads) > N) nrThreads = unsigned(N > 0 ? N : 1);
+	indx.resize(N);
+	thread_barrier sync(nrThreads);
+	parallel_blocks(0, nrThreads, [&](unsigned t, size_t, size_t) {
+		try {
+			for (size_t k = 0; k < N; k += blockSize) {
+				size_t kend = (k + blockSize < N ? k + blockSize : N);
+				if (!lu_panel(A, indx, k, kend, t, nrThreads, sync)) return;
+				if (kend == N) break;
+				// U12 = L11^-1 * A12: each column of the block row is an independent forward substitution
+				std::pair<size_t, size_t> cols = block_range(kend, N, t, nrThreads);
+				for (size_t j = cols.first; j < cols.second; ++j) {
+					for (size_t i = k + 1; i < kend; ++i) {
+						A(i, j) = Kernel::sub_dot(A(i, j), k, i, [&](size_t p) { return A(i, p); }, [&](size_t p) { return A(p, j); });
+					}
+				}
+				if (!sync.wait()) return;
+				// A22 = A22 - L21 * U12: the rows of the trailing matrix are independent
+				std::pair<size_t, size_t> rows = block_range(kend, N, t, nrThreads);
+				for (size_t i = rows.first; i < rows.second; ++i) {
+					for (size_t j = kend; j < N; ++j) {
+						A(i, j) = Kernel::sub_dot(A(i, j), k, kend, [&](size_t p) { return A(i, p); }, [&](size_t p) { return A(p, j); });
+					}
+				}
+				if (!sync.wait()) return;
+			}
+		}
+		catch (...) {
+			// release the threads waiting at the barrier, parallel_blocks rethrows the exception
+			sync.abort();
+			throw;
+		}
+	}, nrThreads);
+	return 0; // success
+}
+
+template<typename Scalar>
+int blocked_ludcmp(matrix<Scalar>& A, vector<size_t>& indx, size_t blockSize = 64, unsigned nrThreads = 0) {
+	return blocked_ludcmp(matrix_view<Scalar>(A), indx, blockSize, nrThreads);
+}
+
+// forward and back substitution of a blocked LU decomposition for a set of right hand sides stored as the columns of B
+// the columns are independent and are solved in parallel
+template<typename Scalar>
+matrix<Scalar> blocked_lubksb(const matrix<Scalar>& LU, const vector<size_t>& indx, const matrix<Scalar>& B, unsigned nrThreads = 0) {
+	using Kernel = fused_kernel<Scalar>;
+	const size_t N = num_rows(LU);
+	if (N != num_cols(LU) || N != size(indx) || N != num_rows(B)) {
+		std::cerr << "blocked_lubksb: LU (" << num_rows(LU) << " x " << num_cols(LU) << "), permutation (" << size(indx) << ") and rhs ("
+			<< num_rows(B) << " x " << num_cols(B) << ") are not congruous\n";
+		return matrix<Scalar>{};
+	}
+	matrix<Scalar> X(B);
+	parallel_for(0, num_cols(B), [&](size_t c) {
+		for (size_t i = 0; i < N; ++i) std::swap(X(i, c), X(indx[i], c));
+		// forward substitution with the unit lower triangular L
+		for (size_t i = 0; i < N; ++i) {
+			X(i, c) = Kernel::sub_dot(X(i, c), 0, i, [&](size_t p) { return LU(i, p); }, [&](size_t p) { return X(p, c); });
+		}
+		// backsubstitution with U
+		for (size_t i = N; i >= 1; --i) {
+			Scalar sum = Kernel::sub_dot(X(i - 1, c), i, N, [&](size_t p) { return LU(i - 1, p); }, [&](size_t p) { return X(p, c); });
+			X(i - 1, c) = sum / LU(i - 1, i - 1);
+		}
+	}, nrThreads);
+	return X;
+}
+
+// forward and back substitution of a blocked LU decomposition for a single right hand side
+template<typename Scalar>
+vector<Scalar> blocked_lubksb(const matrix<Scalar>& LU, const vector<size_t>& indx, const vector<Scalar>& b) {
+	using Kernel = fused_kernel<Scalar>;
+	const size_t N = num_rows(LU);
+	if (N != num_cols(LU) || N != size(indx) || N != size(b)) {
+		std::cerr << "blocked_lubksb: LU (" << num_rows(LU) << " x " << num_cols(LU) << "), permutation (" << size(indx) << ") and rhs ("
+			<< size(b) << ") are not congruous\n";
+		return vector<Scalar>{};
+	}
+	vector<Scalar> x(b);
+	for (size_t i = 0; i < N; ++i) std::swap(x[i], x[indx[i]]);
+	for (size_t i = 0; i < N; ++i) {
+		x[i] = Kernel::sub_dot(x[i], 0, i, [&](size_t p) { return LU(i, p); }, [&](size_t p) { return x[p]; });
+	}
+	for (size_t i = N; i >= 1; --i) {
+		Scalar sum = Kernel::sub_dot(x[i - 1], i, N, [&](size_t p) { return LU(i - 1, p); }, [&](size_t p) { return x[p]; });
+		x[i - 1] = sum / LU(i - 1, i - 1);
+	}
+	return x;
+}
+
+// solve the system of equations A x = b using the blocked, multi-threaded partial pivoting LU
+template<typename Scalar>
+vector<Scalar> blocked_solve(const matrix<Scalar>& A, const vector<Scalar>& b, size_t blockSize = 64, unsigned nrThreads = 0) {
+	matrix<Scalar> LU(A);
+	vector<size_t> indx;
+	if (blocked_ludcmp(LU, indx, blockSize, nrThreads) != 0) {
+		std::cerr << "blocked LU decomposition failed\n";
+		return vector<Scalar>{};
+	}
+	return blocked_lubksb(LU, indx, b);
+}
+
+}}} // namespace sw::unum::blas
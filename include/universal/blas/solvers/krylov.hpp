@@ -0,0 +1,248 @@
+#pragma once
+// krylov.hpp: preconditioned conjugate gradient, BiCGSTAB, and restarted GMRES solvers
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <cmath>
+#include <vector>
+#include <universal/blas/vector.hpp>
+#include <universal/blas/matrix.hpp>
+#include <universal/blas/sparse_matrix.hpp>
+#include <universal/blas/exceptions.hpp>
+#include <universal/blas/fused_kernels.hpp>
+#include <universal/blas/solvers/preconditioners.hpp>
+#include <universal/utility/parallel_for.hpp>
+
+namespace sw { namespace unum { namespace blas {
+
+// The solvers access the system matrix only through matvec(A, x, y), y = A * x, which is provided for
+// dense and sparse matrices, and for matrix-free operators that wrap a user function.
+// All inner products and norms are fused dot products: with posits each one rounds once.
+// Per iteration the solvers stream the operator and a handful of vectors, so the storage size of the
+// Scalar type, not the arithmetic, bounds the throughput on large problems.
+
+template<typename Scalar>
+void matvec(const matrix<Scalar>& A, const vector<Scalar>& x, vector<Scalar>& y) {
+	if (A.cols() != size(x)) throw matmul_incompatible_matrices(incompatible_matrices(A.rows(), A.cols(), size(x), 1, "matvec").what());
+	if (size(y) != A.rows()) y.resize(A.rows());
+	size_t n = A.cols();
+	parallel_for(0, A.rows(), [&](size_t i) {
+		y[i] = fused_kernel<Scalar>::dot(0, n, [&](size_t j) { return A(i, j); }, [&](size_t j) { return x[j]; });
+	});
+}
+template<typename Scalar, typename Index>
+void matvec(const sparse_matrix<Scalar, Index>& A, const vector<Scalar>& x, vector<Scalar>& y) {
+	spmv(A, x, y);
+}
+template<typename Scalar, size_t SliceHeight, typename Index>
+void matvec(const sliced_ell_matrix<Scalar, SliceHeight, Index>& A, const vector<Scalar>& x, vector<Scalar>& y) {
+	A.multiply(x, y);
+}
+
+// matrix_free_operator wraps a function op(x, y) that computes y = A * x of a square operator of order n
+template<typename Scalar, typename Function>
+class matrix_free_operator {
+public:
+	typedef Scalar value_type;
+	matrix_free_operator(size_t n, Function op) : _n{ n }, _op(op) {}
+	void apply(const vector<Scalar>& x, vector<Scalar>& y) const {
+		if (size(y) != _n) y.resize(_n);
+		_op(x, y);
+	}
+	size_t rows() const { return _n; }
+	size_t cols() const { return _n; }
+private:
+	size_t   _n;
+	Function _op;
+};
+
+template<typename Scalar, typename Function>
+matrix_free_operator<Scalar, Function> make_operator(size_t n, Function op) {
+	return matrix_free_operator<Scalar, Function>(n, op);
+}
+template<typename Scalar, typename Function>
+void matvec(const matrix_free_operator<Scalar, Function>& A, const vector<Scalar>& x, vector<Scalar>& y) {
+	A.apply(x, y);
+}
+
+// outcome of an iterative solve
+template<typename Scalar>
+struct krylov_report {
+	size_t iterations;   // number of operator applications
+	Scalar residual;     // final relative residual ||b - A x|| / ||b|| as tracked by the solver
+	bool   converged;
+};
+
+// fused inner product and 2-norm of the Krylov solvers
+template<typename Scalar>
+Scalar fused_dot(const vector<Scalar>& x, const vector<Scalar>& y) {
+	return fused_kernel<Scalar>::dot(0, size(x), [&](size_t i) { return x[i]; }, [&](size_t i) { return y[i]; });
+}
+template<typename Scalar>
+Scalar fused_norm2(const vector<Scalar>& x) {
+	using std::sqrt;
+	return sqrt(fused_dot(x, x));
+}
+
+// Preconditioned conjugate gradient for symmetric positive definite A and M.
+// x holds the initial guess on entry and the solution on exit.
+template<typename Operator, typename Scalar, typename Preconditioner>
+krylov_report<Scalar> cg(const Operator& A, const vector<Scalar>& b, vector<Scalar>& x, const Preconditioner& M, const typename vector<Scalar>::value_type& tolerance, size_t maxIterations) {
+	size_t n = size(b);
+	if (size(x) != n) { x.resize(n); x = Scalar(0); }
+	vector<Scalar> r(n), z(n), p(n), q(n);
+	Scalar bnorm = fused_norm2(b);
+	if (bnorm == Scalar(0)) bnorm = Scalar(1);
+	matvec(A, x, q);
+	for (size_t i = 0; i < n; ++i) r[i] = b[i] - q[i];
+	Scalar residual = fused_norm2(r) / bnorm;
+	if (residual <= tolerance) return { 0, residual, true };
+	M.apply(r, z);
+	p = z;
+	Scalar rho = fused_dot(r, z);
+	for (size_t itr = 1; itr <= maxIterations; ++itr) {
+		matvec(A, p, q);
+		Scalar alpha = rho / fused_dot(p, q);
+		for (size_t i = 0; i < n; ++i) {
+			x[i] += alpha * p[i];
+			r[i] -= alpha * q[i];
+		}
+		residual = fused_norm2(r) / bnorm;
+		if (residual <= tolerance) return { itr, residual, true };
+		M.apply(r, z);
+		Scalar rhoNext = fused_dot(r, z);
+		Scalar beta = rhoNext / rho;
+		rho = rhoNext;
+		for (size_t i = 0; i < n; ++i) p[i] = z[i] + beta * p[i];
+	}
+	return { maxIterations, residual, false };
+}
+template<typename Operator, typename Scalar>
+krylov_report<Scalar> cg(const Operator& A, const vector<Scalar>& b, vector<Scalar>& x, const typename vector<Scalar>::value_type& tolerance, size_t maxIterations) {
+	return cg(A, b, x, identity_preconditioner<Scalar>(), tolerance, maxIterations);
+}
+
+// Right-preconditioned BiCGSTAB for general nonsymmetric A.
+// x holds the initial guess on entry and the solution on exit.
+template<typename Operator, typename Scalar, typename Preconditioner>
+krylov_report<Scalar> bicgstab(const Operator& A, const vector<Scalar>& b, vector<Scalar>& x, const Preconditioner& M, const typename vector<Scalar>::value_type& tolerance, size_t maxIterations) {
+	size_t n = size(b);
+	if (size(x) != n) { x.resize(n); x = Scalar(0); }
+	vector<Scalar> r(n), rhat(n), p(n), v(n), s(n), t(n), phat(n), shat(n);
+	Scalar bnorm = fused_norm2(b);
+	if (bnorm == Scalar(0)) bnorm = Scalar(1);
+	matvec(A, x, v);
+	for (size_t i = 0; i < n; ++i) r[i] = b[i] - v[i];
+	Scalar residual = fused_norm2(r) / bnorm;
+	if (residual <= tolerance) return { 0, residual, true };
+	rhat = r;
+	p = Scalar(0);
+	v = Scalar(0);
+	Scalar rho(1), alpha(1), omega(1);
+	for (size_t itr = 1; itr <= maxIterations; ++itr) {
+		Scalar rhoNext = fused_dot(rhat, r);
+		if (rhoNext == Scalar(0)) return { itr, residual, false };    // breakdown: rhat is orthogonal to r
+		Scalar beta = (rhoNext / rho) * (alpha / omega);
+		rho = rhoNext;
+		for (size_t i = 0; i < n; ++i) p[i] = r[i] + beta * (p[i] - omega * v[i]);
+		M.apply(p, phat);
+		matvec(A, phat, v);
+		alpha = rho / fused_dot(rhat, v);
+		for (size_t i = 0; i < n; ++i) s[i] = r[i] - alpha * v[i];
+		residual = fused_norm2(s) / bnorm;
+		if (residual <= tolerance) {
+			for (size_t i = 0; i < n; ++i) x[i] += alpha * phat[i];
+			return { itr, residual, true };
+		}
+		M.apply(s, shat);
+		matvec(A, shat, t);
+		Scalar tt = fused_dot(t, t);
+		omega = (tt == Scalar(0) ? Scalar(0) : fused_dot(t, s) / tt);
+		for (size_t i = 0; i < n; ++i) {
+			x[i] += alpha * phat[i] + omega * shat[i];
+			r[i] = s[i] - omega * t[i];
+		}
+		residual = fused_norm2(r) / bnorm;
+		if (residual <= tolerance) return { itr, residual, true };
+		if (omega == Scalar(0)) return { itr, residual, false };     // breakdown: the stabilization step stagnates
+	}
+	return { maxIterations, residual, false };
+}
+template<typename Operator, typename Scalar>
+krylov_report<Scalar> bicgstab(const Operator& A, const vector<Scalar>& b, vector<Scalar>& x, const typename vector<Scalar>::value_type& tolerance, size_t maxIterations) {
+	return bicgstab(A, b, x, identity_preconditioner<Scalar>(), tolerance, maxIterations);
+}
+
+// Right-preconditioned GMRES restarted every 'restart' iterations, with modified Gram-Schmidt orthogonalization
+// and Givens rotations to update the least squares problem. Right preconditioning keeps the tracked residual
+// equal to the residual of the unpreconditioned system.
+// x holds the initial guess on entry and the solution on exit.
+template<typename Operator, typename Scalar, typename Preconditioner>
+krylov_report<Scalar> gmres(const Operator& A, const vector<Scalar>& b, vector<Scalar>& x, const Preconditioner& M, size_t restart, const typename vector<Scalar>::value_type& tolerance, size_t maxIterations) {
+	using std::sqrt;
+	size_t n = size(b);
+	if (size(x) != n) { x.resize(n); x = Scalar(0); }
+	if (restart == 0) restart = 1;
+	std::vector< vector<Scalar> > V(restart + 1, vector<Scalar>(n));
+	matrix<Scalar> H(restart + 1, restart);
+	vector<Scalar> cs(restart), sn(restart), g(restart + 1), y(restart), w(n), z(n);
+	Scalar bnorm = fused_norm2(b);
+	if (bnorm == Scalar(0)) bnorm = Scalar(1);
+	Scalar residual(0);
+	size_t itr = 0;
+	while (itr < maxIterations) {
+		matvec(A, x, w);
+		for (size_t i = 0; i < n; ++i) V[0][i] = b[i] - w[i];
+		Scalar beta = fused_norm2(V[0]);
+		residual = beta / bnorm;
+		if (residual <= tolerance) return { itr, residual, true };
+		for (size_t i = 0; i < n; ++i) V[0][i] /= beta;
+		g = Scalar(0);
+		g[0] = beta;
+		size_t k = 0;
+		for (; k < restart && itr < maxIterations; ++k) {
+			++itr;
+			M.apply(V[k], z);
+			matvec(A, z, w);
+			for (size_t j = 0; j <= k; ++j) {
+				H(j, k) = fused_dot(w, V[j]);
+				for (size_t i = 0; i < n; ++i) w[i] -= H(j, k) * V[j][i];
+			}
+			H(k + 1, k) = fused_norm2(w);
+			if (H(k + 1, k) != Scalar(0)) {
+				for (size_t i = 0; i < n; ++i) V[k + 1][i] = w[i] / H(k + 1, k);
+			}
+			// apply the previous rotations to the new column, and eliminate H(k+1, k)
+			for (size_t j = 0; j < k; ++j) {
+				Scalar h = cs[j] * H(j, k) + sn[j] * H(j + 1, k);
+				H(j + 1, k) = cs[j] * H(j + 1, k) - sn[j] * H(j, k);
+				H(j, k) = h;
+			}
+			Scalar r = sqrt(H(k, k) * H(k, k) + H(k + 1, k) * H(k + 1, k));
+			cs[k] = (r == Scalar(0) ? Scalar(1) : H(k, k) / r);
+			sn[k] = (r == Scalar(0) ? Scalar(0) : H(k + 1, k) / r);
+			H(k, k) = r;
+			H(k + 1, k) = Scalar(0);
+			g[k + 1] = -sn[k] * g[k];
+			g[k] = cs[k] * g[k];
+			residual = (g[k + 1] < Scalar(0) ? -g[k + 1] : g[k + 1]) / bnorm;
+			if (residual <= tolerance) { ++k; break; }
+		}
+		// solve the upper triangular system H y = g and update x += M^-1 V y
+		for (size_t j = k; j-- > 0; ) {
+			y[j] = fused_kernel<Scalar>::sub_dot(g[j], j + 1, k, [&](size_t p) { return H(j, p); }, [&](size_t p) { return y[p]; }) / H(j, j);
+		}
+		for (size_t i = 0; i < n; ++i) w[i] = fused_kernel<Scalar>::dot(0, k, [&](size_t j) { return V[j][i]; }, [&](size_t j) { return y[j]; });
+		M.apply(w, z);
+		for (size_t i = 0; i < n; ++i) x[i] += z[i];
+		if (residual <= tolerance) return { itr, residual, true };
+	}
+	return { itr, residual, false };
+}
+template<typename Operator, typename Scalar>
+krylov_report<Scalar> gmres(const Operator& A, const vector<Scalar>& b, vector<Scalar>& x, size_t restart, const typename vector<Scalar>::value_type& tolerance, size_t maxIterations) {
+	return gmres(A, b, x, identity_preconditioner<Scalar>(), restart, tolerance, maxIterations);
+}
+
+}}} // namespace sw::unum::blas
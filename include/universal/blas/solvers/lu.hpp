@@ -5,8 +5,12 @@
 //
 // This file is part of the universal numbers project, which is released under an MIT Open Source license.
 #include <iostream>
+#include <limits>
 #include <universal/posit/posit_fwd.hpp>
 #include <universal/blas/matrix.hpp>
+#include <universal/blas/fused_kernels.hpp>
+#include <universal/blas/solvers/blocked_lu.hpp>
+#include <universal/utility/parallel_for.hpp>
 
 // compilation flags
 // BLAS_TRACE_ROUNDING_EVENTS
@@ -645,4 +649,105 @@ vector<sw::unum::posit<nbits, es> > solve(const matrix<sw::unum::posit<nbits, es
 	return x;
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+// mixed-precision iterative refinement
+
+// conversion between the working type and the factorization type
+// posits of different configurations convert through their exact value with a single rounding
+template<typename To, typename From>
+struct precision_converter {
+	static To convert(const From& v) { return To(v); }
+};
+template<size_t nbits, size_t es, size_t fnbits, size_t fes>
+struct precision_converter< posit<nbits, es>, posit<fnbits, fes> > {
+	static posit<nbits, es> convert(const posit<fnbits, fes>& v) {
+		posit<nbits, es> p;
+		sw::unum::convert(v.to_value(), p);
+		return p;
+	}
+};
+template<typename To, typename From>
+To precision_cast(const From& v) { return precision_converter<To, From>::convert(v); }
+
+// outcome of solve_refine
+template<typename Scalar>
+struct refinement_report {
+	size_t iterations;      // number of refinement steps, each one residual and one pair of triangular solves
+	Scalar backward_error;  // normwise backward error ||b - A x|| / (||A|| ||x|| + ||b||) in the infinity norm
+	bool   converged;       // backward error reached the tolerance
+};
+
+// solve the system of equations A x = b by factoring A once in the narrow type LowScalar and refining the
+// solution in the working type Scalar:
+//   r = b - A x      residual in the working type, each element a single fused dot product
+//   LU d = r         correction from the narrow factorization, with r scaled to unit magnitude
+//   x = x + d
+// The O(n^3) factorization runs in the cheaper format, the O(n^2) refinement steps recover the accuracy
+// of the working type as long as cond(A) * epsilon(LowScalar) is well below 1.
+// The refinement stops when the backward error reaches the tolerance, which defaults to epsilon(Scalar),
+// or when the corrections stop shrinking.
+template<typename LowScalar, typename Scalar>
+refinement_report<Scalar> solve_refine(const matrix<Scalar>& A, const vector<Scalar>& b, vector<Scalar>& x,
+	size_t maxIterations = 20, Scalar tolerance = std::numeric_limits<Scalar>::epsilon(), size_t blockSize = 64, unsigned nrThreads = 0) {
+	using Kernel = fused_kernel<Scalar>;
+	const size_t N = num_rows(A);
+	if (N != num_cols(A) || N != size(b)) {
+		std::cerr << "solve_refine: matrix shape (" << num_rows(A) << " x " << num_cols(A) << ") is not congruous with vector size (" << size(b) << ")\n";
+		return { 0, Scalar(1), false };
+	}
+	auto magnitude = [](const Scalar& v) { return (v < Scalar(0) ? -v : v); };
+	auto inf_norm = [&](const vector<Scalar>& v) {
+		Scalar m(0);
+		for (size_t i = 0; i < size(v); ++i) if (magnitude(v[i]) > m) m = magnitude(v[i]);
+		return m;
+	};
+
+	// factor once in the narrow type
+	matrix<LowScalar> LU(N, N);
+	for (size_t i = 0; i < N; ++i) for (size_t j = 0; j < N; ++j) LU(i, j) = precision_cast<LowScalar>(A(i, j));
+	vector<size_t> indx;
+	if (blocked_ludcmp(LU, indx, blockSize, nrThreads) != 0) {
+		std::cerr << "solve_refine: LU decomposition failed\n";
+		return { 0, Scalar(1), false };
+	}
+	Scalar Anorm(0);
+	for (size_t i = 0; i < N; ++i) {
+		Scalar rowSum = Kernel::sum(0, N, [&](size_t j) { return magnitude(A(i, j)); });
+		if (rowSum > Anorm) Anorm = rowSum;
+	}
+	Scalar bnorm = inf_norm(b);
+
+	// initial solution from the narrow factorization
+	vector<LowScalar> rlow(N);
+	for (size_t i = 0; i < N; ++i) rlow[i] = precision_cast<LowScalar>(b[i]);
+	vector<LowScalar> dlow = blocked_lubksb(LU, indx, rlow);
+	x.resize(N);
+	for (size_t i = 0; i < N; ++i) x[i] = precision_cast<Scalar>(dlow[i]);
+
+	vector<Scalar> r(N);
+	Scalar previousCorrection(0);
+	bool stalled = false;
+	for (size_t itr = 0; ; ++itr) {
+		parallel_for(0, N, [&](size_t i) {
+			r[i] = Kernel::sub_dot(b[i], 0, N, [&](size_t j) { return A(i, j); }, [&](size_t j) { return x[j]; });
+		}, nrThreads);
+		Scalar rnorm = inf_norm(r);
+		Scalar backwardError = rnorm / (Anorm * inf_norm(x) + bnorm);
+		if (backwardError <= tolerance || rnorm == Scalar(0)) return { itr, backwardError, true };
+		if (itr == maxIterations || stalled) return { itr, backwardError, false };
+		// scale the residual to unit magnitude so that it lands where the narrow type has the most precision
+		for (size_t i = 0; i < N; ++i) rlow[i] = precision_cast<LowScalar>(r[i] / rnorm);
+		dlow = blocked_lubksb(LU, indx, rlow);
+		Scalar correction(0);
+		for (size_t i = 0; i < N; ++i) {
+			Scalar d = precision_cast<Scalar>(dlow[i]) * rnorm;
+			x[i] += d;
+			if (magnitude(d) > correction) correction = magnitude(d);
+		}
+		// the corrections no longer contract: the narrow factorization is too inaccurate for this matrix, or the working type is exhausted
+		stalled = (itr > 0 && correction > previousCorrection / Scalar(2));
+		previousCorrection = correction;
+	}
+}
+
 } } }  // namespace sw::unum::blas
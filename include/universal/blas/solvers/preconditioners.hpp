@@ -0,0 +1,117 @@
+#pragma once
+// preconditioners.hpp: identity, Jacobi, and ILU(0) preconditioners for the Krylov solvers
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <iostream>
+#include <string>
+#include <vector>
+#include <universal/blas/vector.hpp>
+#include <universal/blas/matrix.hpp>
+#include <universal/blas/operators.hpp>
+#include <universal/blas/sparse_matrix.hpp>
+#include <universal/blas/exceptions.hpp>
+#include <universal/blas/fused_kernels.hpp>
+
+namespace sw { namespace unum { namespace blas {
+
+// A preconditioner M approximates the system matrix A, and provides
+//     void apply(const vector<Scalar>& r, vector<Scalar>& z) const
+// that solves M z = r. The Krylov solvers take any type with this member.
+
+// no preconditioning: z = r
+template<typename Scalar>
+class identity_preconditioner {
+public:
+	void apply(const vector<Scalar>& r, vector<Scalar>& z) const { z = r; }
+};
+
+// Jacobi preconditioner: M = diag(A)
+template<typename Scalar>
+class jacobi_preconditioner {
+public:
+	template<typename Matrix>
+	explicit jacobi_preconditioner(const Matrix& A) : _invDiag(diag(A)) {
+		for (size_t i = 0; i < size(_invDiag); ++i) {
+			if (_invDiag[i] == Scalar(0)) {
+				std::cerr << "jacobi_preconditioner: zero on the diagonal in row " << i << ": row is not scaled\n";
+				_invDiag[i] = Scalar(1);
+			}
+			else {
+				_invDiag[i] = Scalar(1) / _invDiag[i];
+			}
+		}
+	}
+	void apply(const vector<Scalar>& r, vector<Scalar>& z) const {
+		size_t n = size(r);
+		if (size(z) != n) z.resize(n);
+		for (size_t i = 0; i < n; ++i) z[i] = _invDiag[i] * r[i];
+	}
+private:
+	vector<Scalar> _invDiag;
+};
+
+// incomplete LU factorization without fill-in: M = L * U where L and U are restricted to the sparsity pattern of A.
+// L has a unit diagonal and is stored below the diagonal, U is stored on and above the diagonal of the copy of A.
+// The triangular solves are fused dot products over the row segments, so posits round once per element.
+template<typename Scalar, typename Index = uint32_t>
+class ilu0_preconditioner {
+public:
+	explicit ilu0_preconditioner(const matrix<Scalar>& A) : ilu0_preconditioner(sparse_matrix<Scalar, Index>(A)) {}
+	explicit ilu0_preconditioner(const sparse_matrix<Scalar, Index>& A) : _LU(A), _diagPos(A.rows()) {
+		size_t n = _LU.rows();
+		const std::vector<size_t>& rowPtr = _LU.row_ptr();
+		const std::vector<Index>& colIndex = _LU.col_index();
+		std::vector<Scalar>& a = _LU.values();
+		// locate the diagonal of each row
+		for (size_t i = 0; i < n; ++i) {
+			_diagPos[i] = rowPtr[i + 1];
+			for (size_t k = rowPtr[i]; k < rowPtr[i + 1]; ++k) {
+				if (size_t(colIndex[k]) == i) { _diagPos[i] = k; break; }
+			}
+			if (_diagPos[i] == rowPtr[i + 1]) {
+				throw blas_exception(std::string("ilu0_preconditioner: the diagonal element of row ") + std::to_string(i) + " is not in the sparsity pattern");
+			}
+		}
+		// IKJ elimination restricted to the pattern: position[j] maps column j of row i to its storage index
+		std::vector<size_t> position(n, size_t(-1));
+		for (size_t i = 1; i < n; ++i) {
+			for (size_t k = rowPtr[i]; k < rowPtr[i + 1]; ++k) position[colIndex[k]] = k;
+			for (size_t k = rowPtr[i]; k < _diagPos[i]; ++k) {
+				size_t c = colIndex[k];
+				a[k] /= a[_diagPos[c]];
+				for (size_t kk = _diagPos[c] + 1; kk < rowPtr[c + 1]; ++kk) {
+					size_t p = position[colIndex[kk]];
+					if (p != size_t(-1)) a[p] -= a[k] * a[kk];
+				}
+			}
+			for (size_t k = rowPtr[i]; k < rowPtr[i + 1]; ++k) position[colIndex[k]] = size_t(-1);
+		}
+	}
+
+	// solve L U z = r
+	void apply(const vector<Scalar>& r, vector<Scalar>& z) const {
+		size_t n = _LU.rows();
+		if (size(z) != n) z.resize(n);
+		const std::vector<size_t>& rowPtr = _LU.row_ptr();
+		const std::vector<Index>& colIndex = _LU.col_index();
+		const std::vector<Scalar>& a = _LU.values();
+		auto lu = [&](size_t k) { return a[k]; };
+		auto zc = [&](size_t k) { return z[colIndex[k]]; };
+		for (size_t i = 0; i < n; ++i) {
+			z[i] = fused_kernel<Scalar>::sub_dot(r[i], rowPtr[i], _diagPos[i], lu, zc);
+		}
+		for (size_t i = n; i-- > 0; ) {
+			z[i] = fused_kernel<Scalar>::sub_dot(z[i], _diagPos[i] + 1, rowPtr[i + 1], lu, zc) / a[_diagPos[i]];
+		}
+	}
+
+	const sparse_matrix<Scalar, Index>& factors() const { return _LU; }
+
+private:
+	sparse_matrix<Scalar, Index> _LU;
+	std::vector<size_t>          _diagPos;
+};
+
+}}} // namespace sw::unum::blas
@@ -0,0 +1,213 @@
+#pragma once
+// runge_kutta.hpp: explicit Runge-Kutta integrators, RK4 and adaptive Dormand-Prince RK45, for ensembles of trajectories
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <universal/blas/exceptions.hpp>
+#include <universal/utility/parallel_for.hpp>
+
+namespace sw { namespace unum { namespace blas {
+
+// The integrators advance an ensemble of m trajectories of an n-dimensional system dy/dt = f(t, y).
+// The state is stored component-major, structure-of-arrays: component c of all trajectories is contiguous,
+// so the stage updates are unit-stride loops over trajectories that the number system kernels stream through.
+//
+// The right-hand side is a callable
+//     void rhs(const Scalar* t, const ensemble<Scalar>& y, ensemble<Scalar>& dydt, size_t begin, size_t end)
+// that writes dydt(c, j) for all components c and the trajectories j in [begin, end), where t[j] is the time of trajectory j.
+// The trajectories are partitioned into contiguous blocks, one per thread, and every trajectory is integrated
+// independently of the others, so the results do not depend on the number of threads.
+// The step size control of RK45 is per trajectory and computed in double precision.
+
+// state of an ensemble of trajectories
+template<typename Scalar>
+class ensemble {
+public:
+	typedef Scalar value_type;
+
+	ensemble() : _dim{ 0 }, _members{ 0 } {}
+	ensemble(size_t dim, size_t members, const Scalar& initial_value = Scalar(0)) : _dim{ dim }, _members{ members }, _data(dim * members, initial_value) {}
+
+	size_t dim() const { return _dim; }
+	size_t members() const { return _members; }
+
+	Scalar& operator()(size_t c, size_t j) { return _data[c * _members + j]; }
+	const Scalar& operator()(size_t c, size_t j) const { return _data[c * _members + j]; }
+	// the contiguous array of component c of all trajectories
+	Scalar* component(size_t c) { return _data.data() + c * _members; }
+	const Scalar* component(size_t c) const { return _data.data() + c * _members; }
+
+	// set the state of trajectory j from a function state(c)
+	template<typename State>
+	void set_member(size_t j, State&& state) {
+		for (size_t c = 0; c < _dim; ++c) (*this)(c, j) = state(c);
+	}
+
+private:
+	size_t _dim, _members;
+	std::vector<Scalar> _data;
+};
+
+// outcome of an ensemble integration, summed over the trajectories
+struct ode_report {
+	size_t steps;        // accepted steps
+	size_t rejected;     // rejected steps of the adaptive integrator
+	size_t evaluations;  // right-hand side evaluations of the thread block that needed the most
+	bool   completed;    // all trajectories reached the final time
+};
+
+namespace impl {
+
+// x(c, j) = y(c, j) + h(j) * sum_s a[s] * k[s](c, j) for the trajectories j in [begin, end)
+template<typename Scalar, typename StepSize>
+void rk_stage(const ensemble<Scalar>& y, ensemble<Scalar>* const* k, const Scalar* a, size_t nrStages, StepSize&& h, ensemble<Scalar>& x, size_t begin, size_t end) {
+	for (size_t c = 0; c < y.dim(); ++c) {
+		const Scalar* yc = y.component(c);
+		Scalar* xc = x.component(c);
+		for (size_t j = begin; j < end; ++j) {
+			Scalar sum = a[0] * k[0]->component(c)[j];
+			for (size_t s = 1; s < nrStages; ++s) sum += a[s] * k[s]->component(c)[j];
+			xc[j] = yc[j] + h(j) * sum;
+		}
+	}
+}
+
+} // namespace impl
+
+// classic fourth order Runge-Kutta with nrSteps fixed steps from t0 to t1
+template<typename Scalar, typename RHS>
+ode_report rk4(RHS&& rhs, const Scalar& t0, const Scalar& t1, size_t nrSteps, ensemble<Scalar>& y, unsigned nrThreads = 0) {
+	if (nrSteps == 0) throw blas_exception("rk4: the number of steps must be positive");
+	size_t n = y.dim(), m = y.members();
+	ensemble<Scalar> k1(n, m), k2(n, m), k3(n, m), k4(n, m), x(n, m);
+	ensemble<Scalar>* const k[4] = { &k1, &k2, &k3, &k4 };
+	std::vector<Scalar> t(m, t0);
+	// the step and the times are computed in double precision and rounded once, which also keeps
+	// the intermediate values of the time in range for fixed-point types
+	const double dt = (double(t1) - double(t0)) / double(nrSteps);
+	const Scalar h(dt);
+	const Scalar zero(0), half(0.5), one(1.0), third(1.0 / 3.0), sixth(1.0 / 6.0);
+	const Scalar a2[1] = { half }, a3[2] = { zero, half }, a4[3] = { zero, zero, one };
+	const Scalar b[4] = { sixth, third, third, sixth };
+	auto stepSize = [&](size_t) { return h; };
+	parallel_blocks(0, m, [&](unsigned, size_t begin, size_t end) {
+		for (size_t step = 0; step < nrSteps; ++step) {
+			// the time is recomputed from t0 to avoid the drift of a running sum
+			Scalar ts(double(t0) + double(step) * dt);
+			Scalar tm(double(t0) + (double(step) + 0.5) * dt);
+			Scalar te = (step + 1 == nrSteps ? t1 : Scalar(double(t0) + double(step + 1) * dt));
+			for (size_t j = begin; j < end; ++j) t[j] = ts;
+			rhs(t.data(), y, k1, begin, end);
+			impl::rk_stage(y, k, a2, 1, stepSize, x, begin, end);
+			for (size_t j = begin; j < end; ++j) t[j] = tm;
+			rhs(t.data(), x, k2, begin, end);
+			impl::rk_stage(y, k, a3, 2, stepSize, x, begin, end);
+			rhs(t.data(), x, k3, begin, end);
+			impl::rk_stage(y, k, a4, 3, stepSize, x, begin, end);
+			for (size_t j = begin; j < end; ++j) t[j] = te;
+			rhs(t.data(), x, k4, begin, end);
+			impl::rk_stage(y, k, b, 4, stepSize, y, begin, end);
+		}
+	}, nrThreads);
+	return { nrSteps * m, 0, 4 * nrSteps, true };
+}
+
+// Dormand-Prince 5(4) with a step size per trajectory and first-same-as-last stages, from t0 to t1.
+// A step is accepted when max_c |err_c| / (atol + rtol * max(|y_c|, |ynew_c|)) <= 1.
+// initialStep is the first trial step of every trajectory; a trajectory that needs more than maxSteps
+// steps is stopped where it is and the report is marked as not completed.
+template<typename Scalar, typename RHS>
+ode_report rk45(RHS&& rhs, const Scalar& t0, const Scalar& t1, ensemble<Scalar>& y, double rtol, double atol, const Scalar& initialStep, size_t maxSteps = 100000, unsigned nrThreads = 0) {
+	if (!(initialStep > Scalar(0)) || !(t1 > t0)) throw blas_exception("rk45: integrates forward in time and needs a positive initial step");
+	size_t n = y.dim(), m = y.members();
+	ensemble<Scalar> k1(n, m), k2(n, m), k3(n, m), k4(n, m), k5(n, m), k6(n, m), k7(n, m), x(n, m);
+	ensemble<Scalar>* const k[7] = { &k1, &k2, &k3, &k4, &k5, &k6, &k7 };
+	std::vector<Scalar> t(m, t0), h(m, initialStep), ts(m);
+	// Butcher tableau of Dormand and Prince
+	const double c[7] = { 0.0, 1.0 / 5.0, 3.0 / 10.0, 4.0 / 5.0, 8.0 / 9.0, 1.0, 1.0 };
+	const Scalar a2[1] = { Scalar(1.0 / 5.0) };
+	const Scalar a3[2] = { Scalar(3.0 / 40.0), Scalar(9.0 / 40.0) };
+	const Scalar a4[3] = { Scalar(44.0 / 45.0), Scalar(-56.0 / 15.0), Scalar(32.0 / 9.0) };
+	const Scalar a5[4] = { Scalar(19372.0 / 6561.0), Scalar(-25360.0 / 2187.0), Scalar(64448.0 / 6561.0), Scalar(-212.0 / 729.0) };
+	const Scalar a6[5] = { Scalar(9017.0 / 3168.0), Scalar(-355.0 / 33.0), Scalar(46732.0 / 5247.0), Scalar(49.0 / 176.0), Scalar(-5103.0 / 18656.0) };
+	const Scalar a7[6] = { Scalar(35.0 / 384.0), Scalar(0), Scalar(500.0 / 1113.0), Scalar(125.0 / 192.0), Scalar(-2187.0 / 6784.0), Scalar(11.0 / 84.0) };
+	const Scalar* const a[7] = { nullptr, a2, a3, a4, a5, a6, a7 };
+	// difference of the fifth and fourth order weights, the weights of the fifth order solution are a7
+	const Scalar e[7] = { Scalar(71.0 / 57600.0), Scalar(0), Scalar(-71.0 / 16695.0), Scalar(71.0 / 1920.0), Scalar(-17253.0 / 339200.0), Scalar(22.0 / 525.0), Scalar(-1.0 / 40.0) };
+	auto stepSize = [&](size_t j) { return h[j]; };
+
+	unsigned nrBlocks = (nrThreads == 0 ? hardware_concurrency() : nrThreads);
+	std::vector<ode_report> reports(nrBlocks, ode_report{ 0, 0, 0, true });
+	parallel_blocks(0, m, [&](unsigned threadId, size_t begin, size_t end) {
+		ode_report& report = reports[threadId];
+		std::vector<size_t> steps(end - begin, 0);
+		std::vector<bool> done(end - begin, false);
+		size_t active = end - begin;
+		auto evaluate = [&](size_t s, const ensemble<Scalar>& state) {
+			Scalar cs(c[s]);
+			for (size_t j = begin; j < end; ++j) ts[j] = t[j] + cs * h[j];
+			rhs(ts.data(), state, *k[s], begin, end);
+		};
+		evaluate(0, y);
+		report.evaluations = 1;
+		while (active > 0) {
+			// finished trajectories have a zero step and ride along unchanged
+			for (size_t s = 1; s < 7; ++s) {
+				impl::rk_stage(y, k, a[s], s, stepSize, x, begin, end);
+				evaluate(s, x);
+			}
+			report.evaluations += 6;
+			// x holds the fifth order solution, k7 its slope
+			for (size_t j = begin; j < end; ++j) {
+				if (done[j - begin]) continue;
+				double err = 0.0;
+				for (size_t cc = 0; cc < n; ++cc) {
+					Scalar ec = e[0] * k1(cc, j);
+					for (size_t s = 2; s < 7; ++s) ec += e[s] * (*k[s])(cc, j);
+					double scale = atol + rtol * std::max(std::abs(double(y(cc, j))), std::abs(double(x(cc, j))));
+					double ratio = std::abs(double(h[j] * ec)) / scale;
+					if (!(ratio <= err)) err = ratio;   // a NaN error rejects the step
+				}
+				double factor;
+				if (err <= 1.0) {
+					t[j] = t[j] + h[j];
+					for (size_t cc = 0; cc < n; ++cc) {
+						y(cc, j) = x(cc, j);
+						k1(cc, j) = k7(cc, j);
+					}
+					++report.steps;
+					factor = (err == 0.0 ? 5.0 : std::min(5.0, std::max(0.2, 0.9 * std::pow(err, -0.2))));
+				}
+				else {
+					++report.rejected;
+					factor = (err != err ? 0.2 : std::max(0.2, 0.9 * std::pow(err, -0.2)));
+				}
+				Scalar remaining = t1 - t[j];
+				if (!(remaining > Scalar(0)) || ++steps[j - begin] >= maxSteps) {
+					if (remaining > Scalar(0)) report.completed = false;
+					done[j - begin] = true;
+					h[j] = Scalar(0);
+					--active;
+					continue;
+				}
+				Scalar next = h[j] * Scalar(factor);
+				h[j] = (next < remaining ? next : remaining);
+			}
+		}
+	}, nrThreads);
+
+	ode_report total{ 0, 0, 0, true };
+	for (const ode_report& r : reports) {
+		total.steps += r.steps;
+		total.rejected += r.rejected;
+		total.evaluations = std::max(total.evaluations, r.evaluations);
+		total.completed = total.completed && r.completed;
+	}
+	return total;
+}
+
+}}}  // namespace sw::unum::blas
@@ -0,0 +1,422 @@
+#pragma once
+// stencil.hpp: matrix-free Jacobi, red-black Gauss-Seidel/SOR, and multigrid solvers for the 5-point and 7-point Laplacian
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <universal/posit/posit_fwd.hpp>
+#include <universal/blas/exceptions.hpp>
+#include <universal/utility/parallel_for.hpp>
+
+namespace sw { namespace unum { namespace blas {
+
+// The solvers compute u with -Laplace(u) = f on a structured 2D or 3D grid with mesh width h and
+// Dirichlet boundary values. The discrete operator is the 5-point (2D) or 7-point (3D) stencil
+//     (A u)_p = (2d u_p - sum_{q neighbor of p} u_q) / h^2
+// and is never stored: every sweep reads u and f and applies the stencil on the fly.
+//
+// The grids are partitioned into contiguous blocks of rows, one per thread. 3D sweeps traverse each
+// block in tiles of rows so that the three planes of a tile that the stencil reads stay in cache.
+// Gauss-Seidel and SOR update the red points, (i + j + k) even, and then the black points, so that
+// all points of one color are independent and the results do not depend on the number of threads.
+// Residual norms are fused: with posits the squares of all residuals are accumulated in one quire
+// per thread, the quires are merged exactly, and the norm is rounded once. Other number systems sum the
+// squares per thread, so their residual norms, unlike the iterates, may differ in the last digits
+// between thread counts.
+
+// grid function on nx x ny (x nz) interior points surrounded by one layer of boundary points
+template<typename Scalar>
+class grid {
+public:
+	typedef Scalar value_type;
+
+	grid() : _nx{ 0 }, _ny{ 0 }, _nz{ 0 }, _dims{ 0 } {}
+	grid(size_t nx, size_t ny, const Scalar& initial_value = Scalar(0))
+		: _nx{ nx }, _ny{ ny }, _nz{ 1 }, _dims{ 2 }, _data((nx + 2) * (ny + 2), initial_value) {}
+	grid(size_t nx, size_t ny, size_t nz, const Scalar& initial_value = Scalar(0))
+		: _nx{ nx }, _ny{ ny }, _nz{ nz }, _dims{ 3 }, _data((nx + 2) * (ny + 2) * (nz + 2), initial_value) {}
+
+	size_t nx() const { return _nx; }
+	size_t ny() const { return _ny; }
+	size_t nz() const { return _nz; }
+	size_t dims() const { return _dims; }
+	size_t interior_points() const { return _nx * _ny * _nz; }
+
+	// indices run from 0 to n+1, the interior points are 1..n; 2D grids ignore k
+	size_t index(size_t i, size_t j, size_t k = 1) const { return ((_dims == 3 ? k : 0) * (_ny + 2) + j) * (_nx + 2) + i; }
+	Scalar& operator()(size_t i, size_t j, size_t k = 1) { return _data[index(i, j, k)]; }
+	const Scalar& operator()(size_t i, size_t j, size_t k = 1) const { return _data[index(i, j, k)]; }
+
+	// distance between neighbors in y and z in the storage
+	size_t stride_y() const { return _nx + 2; }
+	size_t stride_z() const { return (_dims == 3 ? (_nx + 2) * (_ny + 2) : 0); }
+
+	Scalar* data() { return _data.data(); }
+	const Scalar* data() const { return _data.data(); }
+	size_t storage_size() const { return _data.size(); }
+
+	grid& operator=(const Scalar& value) {
+		std::fill(_data.begin(), _data.end(), value);
+		return *this;
+	}
+	// set every interior point from a function value(i, j, k)
+	template<typename Function>
+	void set_interior(Function&& value) {
+		for (size_t k = 1; k <= _nz; ++k)
+			for (size_t j = 1; j <= _ny; ++j)
+				for (size_t i = 1; i <= _nx; ++i) (*this)(i, j, k) = value(i, j, k);
+	}
+
+private:
+	size_t _nx, _ny, _nz, _dims;
+	std::vector<Scalar> _data;
+};
+
+template<typename Scalar>
+bool same_shape(const grid<Scalar>& a, const grid<Scalar>& b) {
+	return a.dims() == b.dims() && a.nx() == b.nx() && a.ny() == b.ny() && a.nz() == b.nz();
+}
+
+// outcome of a stencil solve
+template<typename Scalar>
+struct stencil_report {
+	size_t iterations;   // number of sweeps, or V-cycles for multigrid
+	Scalar residual;     // final relative residual ||f - A u|| / ||f||
+	bool   converged;
+};
+
+namespace impl {
+
+// per-thread accumulator of a sum of squares, rounded once when the partial sums of all threads are combined
+template<typename Scalar>
+struct squares_accumulator {
+	Scalar sum;
+	squares_accumulator() : sum(0) {}
+	void add(const Scalar& x) { sum += x * x; }
+	void merge(const squares_accumulator& other) { sum += other.sum; }
+	Scalar value() const { return sum; }
+};
+template<size_t nbits, size_t es>
+struct squares_accumulator< posit<nbits, es> > {
+	quire<nbits, es, 30> q;     // room for 2^30 squares of maxpos
+	squares_accumulator() : q(0) {}
+	void add(const posit<nbits, es>& x) { q += quire_mul(x, x); }
+	void merge(const squares_accumulator& other) { q += other.q; }     // exact
+	posit<nbits, es> value() const {
+		posit<nbits, es> result;
+		convert(q.to_value(), result);     // one and only rounding step of the fused norm
+		return result;
+	}
+};
+
+// call kernel(threadId, j, k) for the interior rows, in parallel blocks of rows, and in tiles of rows within a block of a 3D grid
+template<typename Scalar, typename Kernel>
+void for_each_row(const grid<Scalar>& u, Kernel&& kernel, unsigned nrThreads) {
+	size_t ny = u.ny(), nz = u.nz();
+	if (u.dims() == 2) {
+		parallel_blocks(1, ny + 1, [&](unsigned threadId, size_t begin, size_t end) {
+			for (size_t j = begin; j < end; ++j) kernel(threadId, j, size_t(1));
+		}, nrThreads);
+		return;
+	}
+	// a tile of rows in three consecutive planes should fit in a 256KB cache
+	size_t tile = std::max(size_t(4), size_t(262144) / (3 * (u.nx() + 2) * sizeof(Scalar)));
+	parallel_blocks(1, nz + 1, [&](unsigned threadId, size_t begin, size_t end) {
+		for (size_t jt = 1; jt <= ny; jt += tile) {
+			size_t jend = std::min(ny + 1, jt + tile);
+			for (size_t k = begin; k < end; ++k)
+				for (size_t j = jt; j < jend; ++j) kernel(threadId, j, k);
+		}
+	}, nrThreads);
+}
+
+// fused 2-norm of the interior values value(p), p the storage offset of a point
+template<typename Scalar, typename Value>
+Scalar fused_interior_norm(const grid<Scalar>& u, Value&& value, unsigned nrThreads) {
+	using std::sqrt;
+	unsigned nrBlocks = (nrThreads == 0 ? hardware_concurrency() : nrThreads);
+	std::vector< squares_accumulator<Scalar> > partial(nrBlocks);
+	for_each_row(u, [&](unsigned threadId, size_t j, size_t k) {
+		squares_accumulator<Scalar>& acc = partial[threadId];
+		size_t row = u.index(0, j, k);
+		for (size_t p = row + 1; p <= row + u.nx(); ++p) acc.add(value(p));
+	}, nrThreads);
+	for (size_t t = 1; t < partial.size(); ++t) partial[0].merge(partial[t]);
+	return sqrt(partial[0].value());
+}
+
+// sum of the 2d neighbors of the point at offset p
+template<typename Scalar>
+inline Scalar neighbors(const Scalar* u, size_t p, size_t sy, size_t sz) {
+	Scalar sum = u[p - 1] + u[p + 1];
+	sum += u[p - sy];
+	sum += u[p + sy];
+	if (sz) {
+		sum += u[p - sz];
+		sum += u[p + sz];
+	}
+	return sum;
+}
+
+// update the points of one color, (i + j + k) % 2 == color, with over-relaxation omega
+template<typename Scalar>
+void sor_color_sweep(grid<Scalar>& u, const grid<Scalar>& f, const Scalar& h2, const Scalar& omega, size_t color, unsigned nrThreads) {
+	const size_t sy = u.stride_y(), sz = u.stride_z(), nx = u.nx();
+	const Scalar diagonal(double(2 * u.dims()));
+	const Scalar one(1.0);
+	const Scalar weight = omega / diagonal;
+	const Scalar keep = one - omega;
+	const bool relaxed = !(omega == one);
+	Scalar* pu = u.data();
+	const Scalar* pf = f.data();
+	for_each_row(u, [&](unsigned, size_t j, size_t k) {
+		size_t first = 1 + ((j + (u.dims() == 3 ? k : 0) + 1 + color) & 1);
+		size_t row = u.index(0, j, k);
+		for (size_t i = first; i <= nx; i += 2) {
+			size_t p = row + i;
+			Scalar gs = neighbors(pu, p, sy, sz) + h2 * pf[p];
+			pu[p] = (relaxed ? keep * pu[p] + weight * gs : gs / diagonal);
+		}
+	}, nrThreads);
+}
+
+} // namespace impl
+
+// r = f - A u on the interior points; the boundary of r is zero
+template<typename Scalar>
+void residual(const grid<Scalar>& u, const grid<Scalar>& f, const Scalar& h, grid<Scalar>& r, unsigned nrThreads = 0) {
+	if (!same_shape(u, f)) throw blas_exception("residual: u and f have different shapes");
+	if (!same_shape(u, r)) r = grid<Scalar>(u.dims() == 3 ? grid<Scalar>(u.nx(), u.ny(), u.nz()) : grid<Scalar>(u.nx(), u.ny()));
+	const size_t sy = u.stride_y(), sz = u.stride_z(), nx = u.nx();
+	const Scalar diagonal(double(2 * u.dims()));
+	const Scalar rh2 = Scalar(1) / (h * h);
+	const Scalar* pu = u.data();
+	const Scalar* pf = f.data();
+	Scalar* pr = r.data();
+	impl::for_each_row(u, [&](unsigned, size_t j, size_t k) {
+		size_t row = u.index(0, j, k);
+		for (size_t p = row + 1; p <= row + nx; ++p) {
+			pr[p] = pf[p] - (diagonal * pu[p] - impl::neighbors(pu, p, sy, sz)) * rh2;
+		}
+	}, nrThreads);
+}
+
+// ||f - A u||_2 over the interior points, fused across all points and threads
+template<typename Scalar>
+Scalar residual_norm(const grid<Scalar>& u, const grid<Scalar>& f, const Scalar& h, unsigned nrThreads = 0) {
+	if (!same_shape(u, f)) throw blas_exception("residual_norm: u and f have different shapes");
+	const size_t sy = u.stride_y(), sz = u.stride_z();
+	const Scalar diagonal(double(2 * u.dims()));
+	const Scalar rh2 = Scalar(1) / (h * h);
+	const Scalar* pu = u.data();
+	const Scalar* pf = f.data();
+	return impl::fused_interior_norm(u, [&](size_t p) {
+		return pf[p] - (diagonal * pu[p] - impl::neighbors(pu, p, sy, sz)) * rh2;
+	}, nrThreads);
+}
+
+// ||f||_2 over the interior points, fused like the residual norm
+template<typename Scalar>
+Scalar interior_norm(const grid<Scalar>& f, unsigned nrThreads = 0) {
+	const Scalar* pf = f.data();
+	return impl::fused_interior_norm(f, [&](size_t p) { return pf[p]; }, nrThreads);
+}
+
+// one weighted Jacobi sweep, unew = u + omega D^-1 (f - A u), on the interior points; unew keeps its boundary values.
+// Returns the fused norm ||f - A u|| of the residual of the input, which the sweep computes anyway.
+template<typename Scalar>
+Scalar jacobi_sweep(const grid<Scalar>& u, const grid<Scalar>& f, const Scalar& h, const Scalar& omega, grid<Scalar>& unew, unsigned nrThreads = 0) {
+	if (!same_shape(u, f)) throw blas_exception("jacobi_sweep: u and f have different shapes");
+	if (!same_shape(u, unew) || &u == &unew) throw blas_exception("jacobi_sweep: unew must be a different grid of the shape of u");
+	const size_t sy = u.stride_y(), sz = u.stride_z();
+	const Scalar diagonal(double(2 * u.dims()));
+	const Scalar rh2 = Scalar(1) / (h * h);
+	const Scalar step = omega * h * h / diagonal;
+	const Scalar* pu = u.data();
+	const Scalar* pf = f.data();
+	Scalar* pn = unew.data();
+	return impl::fused_interior_norm(u, [&](size_t p) {
+		Scalar r = pf[p] - (diagonal * pu[p] - impl::neighbors(pu, p, sy, sz)) * rh2;
+		pn[p] = pu[p] + step * r;
+		return r;
+	}, nrThreads);
+}
+
+// one red-black SOR sweep in place: all red points, then all black points. omega = 1 is Gauss-Seidel.
+template<typename Scalar>
+void rb_sor_sweep(grid<Scalar>& u, const grid<Scalar>& f, const Scalar& h, const Scalar& omega, unsigned nrThreads = 0) {
+	if (!same_shape(u, f)) throw blas_exception("rb_sor_sweep: u and f have different shapes");
+	const Scalar h2 = h * h;
+	impl::sor_color_sweep(u, f, h2, omega, 0, nrThreads);
+	impl::sor_color_sweep(u, f, h2, omega, 1, nrThreads);
+}
+
+// Weighted Jacobi iteration until ||f - A u|| / ||f|| <= tolerance.
+// u holds the initial guess and the boundary values on entry and the solution on exit.
+template<typename Scalar>
+stencil_report<Scalar> jacobi(grid<Scalar>& u, const grid<Scalar>& f, const Scalar& h, const Scalar& omega, const Scalar& tolerance, size_t maxSweeps, unsigned nrThreads = 0) {
+	Scalar fnorm = interior_norm(f, nrThreads);
+	if (fnorm == Scalar(0)) fnorm = Scalar(1);
+	grid<Scalar> v(u);     // the copy carries the boundary values
+	Scalar residual(0);
+	for (size_t sweep = 0; sweep < maxSweeps; ++sweep) {
+		residual = jacobi_sweep(u, f, h, omega, v, nrThreads) / fnorm;
+		if (residual <= tolerance) return { sweep, residual, true };   // the residual belongs to u, not to the update in v
+		std::swap(u, v);
+	}
+	residual = residual_norm(u, f, h, nrThreads) / fnorm;
+	return { maxSweeps, residual, residual <= tolerance };
+}
+
+// Red-black SOR iteration until ||f - A u|| / ||f|| <= tolerance; the residual is checked every checkInterval sweeps.
+// u holds the initial guess and the boundary values on entry and the solution on exit.
+template<typename Scalar>
+stencil_report<Scalar> sor(grid<Scalar>& u, const grid<Scalar>& f, const Scalar& h, const Scalar& omega, const Scalar& tolerance, size_t maxSweeps, size_t checkInterval = 10, unsigned nrThreads = 0) {
+	Scalar fnorm = interior_norm(f, nrThreads);
+	if (fnorm == Scalar(0)) fnorm = Scalar(1);
+	if (checkInterval == 0) checkInterval = 1;
+	Scalar residual = residual_norm(u, f, h, nrThreads) / fnorm;
+	if (residual <= tolerance) return { 0, residual, true };
+	for (size_t sweep = 1; sweep <= maxSweeps; ++sweep) {
+		rb_sor_sweep(u, f, h, omega, nrThreads);
+		if (sweep % checkInterval == 0 || sweep == maxSweeps) {
+			residual = residual_norm(u, f, h, nrThreads) / fnorm;
+			if (residual <= tolerance) return { sweep, residual, true };
+		}
+	}
+	return { maxSweeps, residual, false };
+}
+
+// red-black Gauss-Seidel is SOR without over-relaxation
+template<typename Scalar>
+stencil_report<Scalar> gauss_seidel(grid<Scalar>& u, const grid<Scalar>& f, const Scalar& h, const Scalar& tolerance, size_t maxSweeps, size_t checkInterval = 10, unsigned nrThreads = 0) {
+	return sor(u, f, h, Scalar(1), tolerance, maxSweeps, checkInterval, nrThreads);
+}
+
+// SOR parameter that minimizes the spectral radius for the model problem with n interior points per dimension
+inline double optimal_sor_omega(size_t n) {
+	const double pi = 3.14159265358979323846;
+	return 2.0 / (1.0 + std::sin(pi / double(n + 1)));
+}
+
+namespace impl {
+
+// full weighting restriction of the interior of the fine grid r onto the coarse grid rc
+template<typename Scalar>
+void restrict_full_weighting(const grid<Scalar>& r, grid<Scalar>& rc, unsigned nrThreads) {
+	const Scalar quarter(0.25), half(0.5), one(1.0);
+	const Scalar w[3] = { quarter, half, quarter };
+	const bool threeD = (r.dims() == 3);
+	for_each_row(rc, [&](unsigned, size_t jc, size_t kc) {
+		size_t j = 2 * jc, k = (threeD ? 2 * kc : 1);
+		for (size_t ic = 1; ic <= rc.nx(); ++ic) {
+			size_t i = 2 * ic;
+			Scalar sum(0);
+			for (size_t dk = 0; dk < (threeD ? 3u : 1u); ++dk) {
+				Scalar wk = (threeD ? w[dk] : one);
+				for (size_t dj = 0; dj < 3; ++dj) {
+					Scalar wjk = wk * w[dj];
+					size_t row = r.index(0, j + dj - 1, k + dk - (threeD ? 1 : 0));
+					sum += wjk * (quarter * r.data()[row + i - 1] + half * r.data()[row + i] + quarter * r.data()[row + i + 1]);
+				}
+			}
+			rc(ic, jc, kc) = sum;
+		}
+	}, nrThreads);
+}
+
+// multilinear interpolation of the coarse correction ec added to the interior of the fine grid u
+template<typename Scalar>
+void prolongate_add(const grid<Scalar>& ec, grid<Scalar>& u, unsigned nrThreads) {
+	const Scalar half(0.5);
+	const bool threeD = (u.dims() == 3);
+	// a fine index i lies on the coarse index i/2 when it is even, and halfway between (i-1)/2 and (i+1)/2 when it is odd
+	auto interpolate1 = [&](size_t i, size_t jc0, size_t jc1, size_t kc) {
+		Scalar a = ec(i / 2, jc0, kc), b = ec(i / 2, jc1, kc);
+		if (i & 1) {
+			a = half * (ec(i / 2, jc0, kc) + ec(i / 2 + 1, jc0, kc));
+			b = half * (ec(i / 2, jc1, kc) + ec(i / 2 + 1, jc1, kc));
+		}
+		return (jc0 == jc1 ? a : half * (a + b));
+	};
+	for_each_row(u, [&](unsigned, size_t j, size_t k) {
+		size_t jc0 = j / 2, jc1 = (j & 1 ? j / 2 + 1 : j / 2);
+		size_t kc0 = (threeD ? k / 2 : 1), kc1 = (threeD && (k & 1) ? k / 2 + 1 : kc0);
+		for (size_t i = 1; i <= u.nx(); ++i) {
+			Scalar e = interpolate1(i, jc0, jc1, kc0);
+			if (kc1 != kc0) e = half * (e + interpolate1(i, jc0, jc1, kc1));
+			u(i, j, k) += e;
+		}
+	}, nrThreads);
+}
+
+inline bool coarsenable(size_t n) { return n >= 3 && (n & 1); }
+
+// the largest dimension of the coarsest grid of the hierarchy of u
+template<typename Scalar>
+size_t coarsest_extent(const grid<Scalar>& u) {
+	const bool threeD = (u.dims() == 3);
+	size_t nx = u.nx(), ny = u.ny(), nz = (threeD ? u.nz() : 1);
+	while (coarsenable(nx) && coarsenable(ny) && (!threeD || coarsenable(nz))) {
+		nx /= 2;
+		ny /= 2;
+		if (threeD) nz /= 2;
+	}
+	return std::max(nx, std::max(ny, nz));
+}
+
+// one V-cycle on A u = f with mesh width h
+template<typename Scalar>
+void v_cycle(grid<Scalar>& u, const grid<Scalar>& f, const Scalar& h, size_t nu1, size_t nu2, unsigned nrThreads) {
+	const Scalar one(1.0);
+	bool coarsen = coarsenable(u.nx()) && coarsenable(u.ny()) && (u.dims() == 2 || coarsenable(u.nz()));
+	if (!coarsen) {
+		// the coarsest grid, at most 3 points per dimension, is solved by Gauss-Seidel sweeps, a single point needs one
+		size_t sweeps = 4 * std::max(u.nx(), std::max(u.ny(), u.nz()));
+		for (size_t s = 0; s < sweeps; ++s) rb_sor_sweep(u, f, h, one, nrThreads);
+		return;
+	}
+	for (size_t s = 0; s < nu1; ++s) rb_sor_sweep(u, f, h, one, nrThreads);
+	grid<Scalar> r;
+	residual(u, f, h, r, nrThreads);
+	size_t nx = u.nx() / 2, ny = u.ny() / 2, nz = u.nz() / 2;
+	grid<Scalar> fc(u.dims() == 3 ? grid<Scalar>(nx, ny, nz) : grid<Scalar>(nx, ny));
+	grid<Scalar> ec(u.dims() == 3 ? grid<Scalar>(nx, ny, nz) : grid<Scalar>(nx, ny));
+	restrict_full_weighting(r, fc, nrThreads);
+	v_cycle(ec, fc, Scalar(2) * h, nu1, nu2, nrThreads);
+	prolongate_add(ec, u, nrThreads);
+	for (size_t s = 0; s < nu2; ++s) rb_sor_sweep(u, f, h, one, nrThreads);
+}
+
+} // namespace impl
+
+// Multigrid V-cycles with nu1 pre- and nu2 post-smoothing red-black Gauss-Seidel sweeps, full weighting
+// restriction, and multilinear prolongation, until ||f - A u|| / ||f|| <= tolerance.
+// The grids are coarsened while all dimensions are odd and at least 3, so n = 2^k - 1 points per dimension
+// coarsen down to a single point. The coarsest grid must have at most 3 points per dimension, which holds for
+// n + 1 = 2^k m with m <= 4; other grids, i.e. an even number of points, throw a blas_exception, as the
+// Gauss-Seidel solve of a large coarsest grid would be slower than plain relaxation.
+// u holds the initial guess and the boundary values on entry and the solution on exit.
+template<typename Scalar>
+stencil_report<Scalar> multigrid(grid<Scalar>& u, const grid<Scalar>& f, const Scalar& h, const Scalar& tolerance, size_t maxCycles, size_t nu1 = 2, size_t nu2 = 2, unsigned nrThreads = 0) {
+	if (impl::coarsest_extent(u) > 3) {
+		throw blas_exception("multigrid: a grid of " + std::to_string(u.nx()) + " x " + std::to_string(u.ny()) + (u.dims() == 3 ? " x " + std::to_string(u.nz()) : std::string())
+			+ " interior points does not coarsen to at most 3 points per dimension, use 2^k m - 1 points with m <= 4");
+	}
+	Scalar fnorm = interior_norm(f, nrThreads);
+	if (fnorm == Scalar(0)) fnorm = Scalar(1);
+	Scalar residual = residual_norm(u, f, h, nrThreads) / fnorm;
+	if (residual <= tolerance) return { 0, residual, true };
+	for (size_t cycle = 1; cycle <= maxCycles; ++cycle) {
+		impl::v_cycle(u, f, h, nu1, nu2, nrThreads);
+		residual = residual_norm(u, f, h, nrThreads) / fnorm;
+		if (residual <= tolerance) return { cycle, residual, true };
+	}
+	return { maxCycles, residual, false };
+}
+
+}}} // namespace sw::unum::blas
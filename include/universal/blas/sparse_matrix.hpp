@@ -0,0 +1,246 @@
+#pragma once
+// sparse_matrix.hpp: compressed sparse row and sliced ELLPACK matrices with fused, multi-threaded SpMV
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <universal/blas/vector.hpp>
+#include <universal/blas/matrix.hpp>
+#include <universal/blas/exceptions.hpp>
+#include <universal/blas/fused_kernels.hpp>
+#include <universal/utility/parallel_for.hpp>
+
+namespace sw { namespace unum { namespace blas {
+
+// nonzero element of a sparse matrix in coordinate form, used to assemble sparse matrices
+template<typename Scalar>
+struct sparse_entry {
+	size_t row, col;
+	Scalar value;
+};
+
+// sparse_matrix<Scalar, Index> stores an m x n matrix in compressed sparse row (CSR) format:
+//   values[k], colIndex[k] for k in [rowPtr[i], rowPtr[i+1]) are the nonzeros of row i, sorted by column
+// SpMV streams values and colIndex once, so the storage cost per nonzero, sizeof(Scalar) + sizeof(Index),
+// sets the attainable throughput: narrower Scalar and Index types translate directly into speed.
+template<typename Scalar, typename Index = uint32_t>
+class sparse_matrix {
+public:
+	typedef Scalar   value_type;
+	typedef Index    index_type;
+	typedef size_t   size_type;
+
+	sparse_matrix() : _m{ 0 }, _n{ 0 }, _rowPtr(1, 0) {}
+	// assemble from coordinate form: entries may come in any order, duplicates are summed in the order they are given
+	sparse_matrix(size_t m, size_t n, std::vector< sparse_entry<Scalar> > entries) : _m{ m }, _n{ n } {
+		std::stable_sort(entries.begin(), entries.end(), [](const sparse_entry<Scalar>& a, const sparse_entry<Scalar>& b) {
+			return (a.row < b.row) || (a.row == b.row && a.col < b.col);
+		});
+		_rowPtr.assign(m + 1, 0);
+		_colIndex.reserve(entries.size());
+		_values.reserve(entries.size());
+		size_t lastRow = m, lastCol = n;
+		for (const sparse_entry<Scalar>& e : entries) {
+			if (e.row >= m || e.col >= n) {
+				std::cerr << "sparse_matrix: entry (" << e.row << ", " << e.col << ") is outside of a (" << m << " x " << n << ") matrix: ignored\n";
+				continue;
+			}
+			if (e.row == lastRow && e.col == lastCol) {
+				_values.back() += e.value;
+				continue;
+			}
+			_colIndex.push_back(Index(e.col));
+			_values.push_back(e.value);
+			++_rowPtr[e.row + 1];
+			lastRow = e.row;
+			lastCol = e.col;
+		}
+		for (size_t i = 0; i < m; ++i) _rowPtr[i + 1] += _rowPtr[i];
+	}
+	// compress the nonzeros of a dense matrix
+	explicit sparse_matrix(const matrix<Scalar>& A) : _m{ A.rows() }, _n{ A.cols() }, _rowPtr(A.rows() + 1, 0) {
+		for (size_t i = 0; i < _m; ++i) {
+			for (size_t j = 0; j < _n; ++j) {
+				if (A(i, j) != Scalar(0)) {
+					_colIndex.push_back(Index(j));
+					_values.push_back(A(i, j));
+				}
+			}
+			_rowPtr[i + 1] = _values.size();
+		}
+	}
+
+	// element lookup: O(log(nnz in row))
+	Scalar operator()(size_t i, size_t j) const {
+		auto first = _colIndex.begin() + std::ptrdiff_t(_rowPtr[i]);
+		auto last  = _colIndex.begin() + std::ptrdiff_t(_rowPtr[i + 1]);
+		auto it = std::lower_bound(first, last, Index(j));
+		return (it != last && *it == Index(j)) ? _values[size_t(it - _colIndex.begin())] : Scalar(0);
+	}
+
+	// selectors
+	size_t rows() const { return _m; }
+	size_t cols() const { return _n; }
+	size_t nnz() const { return _values.size(); }
+	const std::vector<size_t>& row_ptr() const { return _rowPtr; }
+	const std::vector<Index>& col_index() const { return _colIndex; }
+	const std::vector<Scalar>& values() const { return _values; }
+	std::vector<Scalar>& values() { return _values; }
+	// number of bytes of the compressed representation
+	size_t storage() const { return _values.size() * (sizeof(Scalar) + sizeof(Index)) + _rowPtr.size() * sizeof(size_t); }
+
+	// convert to a dense matrix
+	matrix<Scalar> dense() const {
+		matrix<Scalar> A(_m, _n);
+		for (size_t i = 0; i < _m; ++i) {
+			for (size_t k = _rowPtr[i]; k < _rowPtr[i + 1]; ++k) A(i, _colIndex[k]) = _values[k];
+		}
+		return A;
+	}
+
+private:
+	size_t _m, _n;
+	std::vector<size_t> _rowPtr;
+	std::vector<Index>  _colIndex;
+	std::vector<Scalar> _values;
+};
+
+template<typename Scalar, typename Index>
+inline size_t num_rows(const sparse_matrix<Scalar, Index>& A) { return A.rows(); }
+template<typename Scalar, typename Index>
+inline size_t num_cols(const sparse_matrix<Scalar, Index>& A) { return A.cols(); }
+template<typename Scalar, typename Index>
+inline size_t nnz(const sparse_matrix<Scalar, Index>& A) { return A.nnz(); }
+
+// return the diagonal of a sparse matrix
+template<typename Scalar, typename Index>
+vector<Scalar> diag(const sparse_matrix<Scalar, Index>& A) {
+	size_t n = (A.rows() < A.cols() ? A.rows() : A.cols());
+	vector<Scalar> d(n);
+	for (size_t i = 0; i < n; ++i) d[i] = A(i, i);
+	return d;
+}
+
+// sparse matrix-vector product y = A * x
+// Rows are distributed across threads, and each row is one fused dot product: for posits, a quire
+// accumulates the row and rounds once, so the result does not depend on the number of threads.
+template<typename Scalar, typename Index>
+void spmv(const sparse_matrix<Scalar, Index>& A, const vector<Scalar>& x, vector<Scalar>& y, unsigned nrThreads = 0) {
+	if (A.cols() != size(x)) throw matmul_incompatible_matrices(incompatible_matrices(A.rows(), A.cols(), size(x), 1, "spmv").what());
+	if (size(y) != A.rows()) y.resize(A.rows());
+	const size_t* rowPtr = A.row_ptr().data();
+	const Index* colIndex = A.col_index().data();
+	const Scalar* values = A.values().data();
+	parallel_for(0, A.rows(), [&](size_t i) {
+		y[i] = fused_kernel<Scalar>::dot(rowPtr[i], rowPtr[i + 1], [&](size_t k) { return values[k]; }, [&](size_t k) { return x[colIndex[k]]; });
+	}, nrThreads);
+}
+
+template<typename Scalar, typename Index>
+vector<Scalar> operator*(const sparse_matrix<Scalar, Index>& A, const vector<Scalar>& x) {
+	vector<Scalar> y(A.rows());
+	spmv(A, x, y);
+	return y;
+}
+
+// sliced_ell_matrix<Scalar, SliceHeight, Index> stores the rows in slices of SliceHeight rows.
+// Each slice is padded to its longest row and stored column-major, so that consecutive rows of a slice
+// read consecutive memory, which suits wide vector units and stencil matrices with uniform row lengths.
+// Padding entries are skipped through the stored row lengths, so they never enter the accumulation.
+template<typename Scalar, size_t SliceHeight = 32, typename Index = uint32_t>
+class sliced_ell_matrix {
+public:
+	typedef Scalar   value_type;
+	typedef Index    index_type;
+	static constexpr size_t slice_height = SliceHeight;
+
+	sliced_ell_matrix() : _m{ 0 }, _n{ 0 } {}
+	// convert a CSR matrix
+	template<typename CsrIndex>
+	explicit sliced_ell_matrix(const sparse_matrix<Scalar, CsrIndex>& A) : _m{ A.rows() }, _n{ A.cols() } {
+		size_t nrSlices = (_m + SliceHeight - 1) / SliceHeight;
+		_slicePtr.assign(nrSlices + 1, 0);
+		_sliceWidth.assign(nrSlices, 0);
+		_rowLength.assign(_m, 0);
+		const std::vector<size_t>& rowPtr = A.row_ptr();
+		for (size_t s = 0; s < nrSlices; ++s) {
+			size_t width = 0;
+			for (size_t i = s * SliceHeight; i < std::min(_m, (s + 1) * SliceHeight); ++i) {
+				_rowLength[i] = Index(rowPtr[i + 1] - rowPtr[i]);
+				width = std::max(width, size_t(_rowLength[i]));
+			}
+			_sliceWidth[s] = width;
+			_slicePtr[s + 1] = _slicePtr[s] + width * SliceHeight;
+		}
+		_values.assign(_slicePtr[nrSlices], Scalar(0));
+		_colIndex.assign(_slicePtr[nrSlices], Index(0));
+		for (size_t i = 0; i < _m; ++i) {
+			size_t s = i / SliceHeight, r = i % SliceHeight;
+			for (size_t k = 0; k < _rowLength[i]; ++k) {
+				size_t e = _slicePtr[s] + k * SliceHeight + r;
+				_values[e] = A.values()[rowPtr[i] + k];
+				_colIndex[e] = Index(A.col_index()[rowPtr[i] + k]);
+			}
+		}
+	}
+
+	// selectors
+	size_t rows() const { return _m; }
+	size_t cols() const { return _n; }
+	size_t nnz() const {
+		size_t n = 0;
+		for (auto l : _rowLength) n += l;
+		return n;
+	}
+	size_t slices() const { return _sliceWidth.size(); }
+	size_t storage() const {
+		return _values.size() * (sizeof(Scalar) + sizeof(Index)) + _rowLength.size() * sizeof(Index) + _slicePtr.size() * sizeof(size_t);
+	}
+	// fraction of the stored elements that are padding
+	double padding() const { return _values.empty() ? 0.0 : 1.0 - double(nnz()) / double(_values.size()); }
+
+	// y = A * x, slices are distributed across threads
+	void multiply(const vector<Scalar>& x, vector<Scalar>& y, unsigned nrThreads = 0) const {
+		if (_n != size(x)) throw matmul_incompatible_matrices(incompatible_matrices(_m, _n, size(x), 1, "spmv").what());
+		if (size(y) != _m) y.resize(_m);
+		parallel_for(0, slices(), [&](size_t s) {
+			const Scalar* values = _values.data() + _slicePtr[s];
+			const Index* colIndex = _colIndex.data() + _slicePtr[s];
+			for (size_t i = s * SliceHeight; i < std::min(_m, (s + 1) * SliceHeight); ++i) {
+				size_t r = i % SliceHeight;
+				y[i] = fused_kernel<Scalar>::dot(0, _rowLength[i], [&](size_t k) { return values[k * SliceHeight + r]; }, [&](size_t k) { return x[colIndex[k * SliceHeight + r]]; });
+			}
+		}, nrThreads);
+	}
+
+private:
+	size_t _m, _n;
+	std::vector<size_t> _slicePtr;     // offset of each slice in values/colIndex
+	std::vector<size_t> _sliceWidth;   // padded row length of each slice
+	std::vector<Index>  _rowLength;    // number of nonzeros of each row
+	std::vector<Index>  _colIndex;
+	std::vector<Scalar> _values;
+};
+
+template<typename Scalar, size_t SliceHeight, typename Index>
+inline size_t num_rows(const sliced_ell_matrix<Scalar, SliceHeight, Index>& A) { return A.rows(); }
+template<typename Scalar, size_t SliceHeight, typename Index>
+inline size_t num_cols(const sliced_ell_matrix<Scalar, SliceHeight, Index>& A) { return A.cols(); }
+
+template<typename Scalar, size_t SliceHeight, typename Index>
+void spmv(const sliced_ell_matrix<Scalar, SliceHeight, Index>& A, const vector<Scalar>& x, vector<Scalar>& y, unsigned nrThreads = 0) {
+	A.multiply(x, y, nrThreads);
+}
+
+template<typename Scalar, size_t SliceHeight, typename Index>
+vector<Scalar> operator*(const sliced_ell_matrix<Scalar, SliceHeight, Index>& A, const vector<Scalar>& x) {
+	vector<Scalar> y(A.rows());
+	A.multiply(x, y);
+	return y;
+}
+
+}}} // namespace sw::unum::blas
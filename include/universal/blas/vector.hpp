@@ -9,6 +9,15 @@
 #include <vector>
 #include <initializer_list>
 #include <cmath>  // for std::sqrt
+#include <type_traits>
+
+// compilation flags
+// BLAS_ENABLE_EXPRESSION_TEMPLATES
+// when set, the vector and matrix arithmetic operators return expression templates that are
+// evaluated in a single loop on assignment, instead of creating a temporary for each operator
+#ifndef BLAS_ENABLE_EXPRESSION_TEMPLATES
+#define BLAS_ENABLE_EXPRESSION_TEMPLATES 0
+#endif
 
 #if defined(__clang__)
 /* Clang/LLVM. ---------------------------------------------- */
@@ -52,6 +61,14 @@
 
 namespace sw { namespace unum { namespace blas {
 
+// base of the expression templates that represent a vector-valued expression, see vector_expression.hpp
+template<typename E>
+struct vector_expression {
+	const E& self() const { return static_cast<const E&>(*this); }
+};
+template<typename T>
+struct is_vector_expression : std::is_base_of<vector_expression<T>, T> {};
+
 template<typename Scalar>
 class vector {
 public:
@@ -65,30 +82,57 @@ public:
 	typedef typename std::vector<Scalar>::const_reverse_iterator const_reverse_iterator;
 
 
-	vector() : data(0) {}
-	vector(size_t N) : data(N) {}
-	vector(size_t N, const Scalar& val) : data(N, val) {}
-	vector(std::initializer_list<Scalar> iList) : data(iList) {}
+	vector() : _data(0) {}
+	vector(size_t N) : _data(N) {}
+	vector(size_t N, const Scalar& val) : _data(N, val) {}
+	vector(std::initializer_list<Scalar> iList) : _data(iList) {}
 	vector(const vector& v) = default;
 	vector(vector&& v) = default;
 
 	vector& operator=(const vector& v) = default;
 	vector& operator=(vector&& v) = default;
 
+	// evaluate an expression template in a single pass over the elements
+	// expressions are element-wise, so the target may appear in the expression
+	template<typename E>
+	vector(const vector_expression<E>& e) : _data(e.self().size()) {
+		const E& expr = e.self();
+		for (size_t i = 0; i < _data.size(); ++i) _data[i] = expr[i];
+	}
+	template<typename E>
+	vector& operator=(const vector_expression<E>& e) {
+		const E& expr = e.self();
+		if (expr.size() != _data.size()) return *this = vector(e);
+		for (size_t i = 0; i < _data.size(); ++i) _data[i] = expr[i];
+		return *this;
+	}
+	template<typename E>
+	vector& operator+=(const vector_expression<E>& e) {
+		const E& expr = e.self();
+		for (size_t i = 0; i < _data.size(); ++i) _data[i] += expr[i];
+		return *this;
+	}
+	template<typename E>
+	vector& operator-=(const vector_expression<E>& e) {
+		const E& expr = e.self();
+		for (size_t i = 0; i < _data.size(); ++i) _data[i] -= expr[i];
+		return *this;
+	}
+
 // operators
 	vector& operator=(const Scalar& val) {
-		for (auto& v : data) v = val;
+		for (auto& v : _data) v = val;
 		return *this;
 	}
-	value_type operator[](size_t index) const { return data[index]; }
-	value_type& operator[](size_t index) { return data[index]; }
-	value_type operator()(size_t index) const { return data[index]; }
-	value_type& operator()(size_t index) { return data[index]; }
+	value_type operator[](size_t index) const { return _data[index]; }
+	value_type& operator[](size_t index) { return _data[index]; }
+	value_type operator()(size_t index) const { return _data[index]; }
+	value_type& operator()(size_t index) { return _data[index]; }
 
 	// prefix operator
 	vector operator-() {
 		vector<value_type> n(*this);
-		for (auto& v : n.data) v = -v;
+		for (auto& v : n._data) v = -v;
 		return n;
 	}
 
@@ -96,50 +140,50 @@ public:
 	//
 	// vector-wide add
 	vector& operator+=(const Scalar& offset) {
-		for (auto& e : data) e += offset;
+		for (auto& e : _data) e += offset;
 		return *this;
 	}
 	// vector-wide subtract
 	vector& operator-=(const Scalar& offset) {
-		for (auto& e : data) e -= offset;
+		for (auto& e : _data) e -= offset;
 		return *this;
 	}
 	// vector-wide multiply
 	vector& operator*=(const Scalar& scaler) {
-		for (auto& e : data) e *= scaler;
+		for (auto& e : _data) e *= scaler;
 		return *this;
 	}
 	// vector-wide divide
 	vector& operator/=(const Scalar& normalizer) {
-		for (auto& e : data) e /= normalizer;
+		for (auto& e : _data) e /= normalizer;
 		return *this;
 	}
 
 	// element-wise add
 	vector& operator+=(const vector<Scalar>& offset) {
 		for (size_t i = 0; i < size(); ++i) {
-			data[i] += offset[i];
+			_data[i] += offset[i];
 		}
 		return *this;
 	}
 	// element-wise subtract
 	vector& operator-=(const vector<Scalar>& offset) {
 		for (size_t i = 0; i < size(); ++i) {
-			data[i] -= offset[i];
+			_data[i] -= offset[i];
 		}
 		return *this;
 	}
 	// element-wise multiply
 	vector& operator*=(const vector<Scalar>& scaler) {
 		for (size_t i = 0; i < size(); ++i) {
-			data[i] *= scaler[i];
+			_data[i] *= scaler[i];
 		}
 		return *this;
 	}
 	// element-wise divide
 	vector& operator/=(const vector<Scalar>& normalizer) {
 		for (size_t i = 0; i < size(); ++i) {
-			data[i] /= normalizer[i];
+			_data[i] /= normalizer[i];
 		}
 		return *this;
 	}
@@ -147,32 +191,35 @@ public:
 	// non-reproducible sum
 	Scalar sum() const {
 		Scalar sum(0);  // should we do this with a quire?
-		for (auto v : data) sum += v;
+		for (auto v : _data) sum += v;
 		return sum;
 	}
 	// two-norm of a vector
 	Scalar norm() const {  // default is 2-norm
 		using std::sqrt;
 		Scalar twoNorm = 0;
-		for (auto v : data) twoNorm += v * v;
+		for (auto v : _data) twoNorm += v * v;
 		return sqrt(twoNorm);
 	}
 
 // modifiers
 	vector& assign(const Scalar& val) {
-		for (auto& v : data) v = val;
+		for (auto& v : _data) v = val;
 		return *this;
 	}
-	value_type& head(size_t index) { return data[index]; }
-	value_type  tail(size_t index) const { return data[index]; }
-	value_type& tail(size_t index) { return data[index]; }
-	void push_back(const value_type& e) { data.push_back(e); }
+	value_type& head(size_t index) { return _data[index]; }
+	value_type  tail(size_t index) const { return _data[index]; }
+	value_type& tail(size_t index) { return _data[index]; }
+	void push_back(const value_type& e) { _data.push_back(e); }
 	void resize(size_t N) {
-		data.resize(N);
+		_data.resize(N);
 	}
 
 // selectors
-	size_t size() const { return data.size(); }
+	size_t size() const { return _data.size(); }
+	// pointer to the contiguous element storage, to create views and to interface with external code
+	value_type* data() noexcept { return _data.data(); }
+	const value_type* data() const noexcept { return _data.data(); }
 
 	// Eigen operators I need to reverse engineer
 	vector& array() {
@@ -187,19 +234,19 @@ public:
 
 // iterators
 	_NODISCARD iterator begin() noexcept {
-		return data.begin();
+		return _data.begin();
 	}
 
 	_NODISCARD const_iterator begin() const noexcept {
-		return data.begin();
+		return _data.begin();
 	}
 
 	_NODISCARD iterator end() noexcept {
-		return data.end();
+		return _data.end();
 	}
 
 	_NODISCARD const_iterator end() const noexcept {
-		return data.end();
+		return _data.end();
 	}
 
 	_NODISCARD reverse_iterator rbegin() noexcept {
@@ -218,7 +265,7 @@ public:
 		return const_reverse_iterator(begin());
 	}
 private:
-	std::vector<Scalar> data;
+	std::vector<Scalar> _data;
 };
 
 template<typename Scalar>
@@ -228,6 +275,8 @@ std::ostream& operator<<(std::ostream& ostr, const vector<Scalar>& v) {
 	return ostr;
 }
 
+#if !BLAS_ENABLE_EXPRESSION_TEMPLATES
+// eager operators: each one returns a new vector, see vector_expression.hpp for the fused alternative
 template<typename Scalar>
 vector<Scalar> operator+(const vector<Scalar>& lhs, const vector<Scalar>& rhs) {
 	vector<Scalar> sum(lhs);
@@ -251,6 +300,7 @@ vector<Scalar> operator/(const vector<Scalar>& v, double normalizer) {
 	vector<Scalar> normalizedVector(v);
 	return normalizedVector /= normalizer;
 }
+#endif // !BLAS_ENABLE_EXPRESSION_TEMPLATES
 
 template<typename Scalar> auto size(const vector<Scalar>& v) { return v.size(); }
 
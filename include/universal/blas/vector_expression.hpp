@@ -0,0 +1,396 @@
+#pragma once
+// vector_expression.hpp: expression templates that fuse vector and matrix algebra into a single loop
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <cstddef>
+#include <iostream>
+#include <iomanip>
+#include <type_traits>
+#include <universal/blas/vector.hpp>
+#include <universal/blas/matrix.hpp>
+#include <universal/blas/vector_view.hpp>
+#include <universal/blas/matrix_view.hpp>
+#include <universal/blas/fused_kernels.hpp>
+
+// An expression such as y = a*x + b*y - z builds a tree of lightweight nodes instead of temporaries.
+// The tree is evaluated element by element when it is assigned to a vector or matrix, so the
+// whole expression costs one pass and no allocations. Each element goes through the same sequence
+// of operations as the eager operators, so the results are bit-identical to the eager evaluation.
+// dot() and sum() of an expression lower to a fused dot product/sum: for posits the expression
+// elements are accumulated in a quire and rounded once.
+//
+// The eager operators on vector/matrix remain the default. Start an expression explicitly with expr(x),
+// or define BLAS_ENABLE_EXPRESSION_TEMPLATES to make the vector and matrix operators build expressions.
+// Nodes reference their vector and matrix operands: do not store an expression in an auto variable
+// that outlives the operands, and use eval() to pass an expression to a function that takes a vector or matrix.
+
+namespace sw { namespace unum { namespace blas {
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// vector expressions
+
+// leaf node referencing a vector
+template<typename Scalar>
+class vector_reference : public vector_expression< vector_reference<Scalar> > {
+public:
+	typedef Scalar value_type;
+	explicit vector_reference(const vector<Scalar>& v) : v{ v } {}
+	value_type operator[](size_t i) const { return v[i]; }
+	size_t size() const { return v.size(); }
+private:
+	const vector<Scalar>& v;
+};
+
+// leaf node holding a vector view, which is itself a reference
+template<typename Scalar>
+class vector_view_reference : public vector_expression< vector_view_reference<Scalar> > {
+public:
+	typedef typename std::remove_const<Scalar>::type value_type;
+	explicit vector_view_reference(const vector_view<Scalar>& v) : v{ v } {}
+	value_type operator[](size_t i) const { return v[i]; }
+	size_t size() const { return v.size(); }
+private:
+	vector_view<Scalar> v;
+};
+
+// element-wise operators of the expression nodes
+struct expression_add {
+	template<typename T> static T apply(const T& a, const T& b) { return a + b; }
+};
+struct expression_sub {
+	template<typename T> static T apply(const T& a, const T& b) { return a - b; }
+};
+
+// lhs[i] op rhs[i]
+template<typename L, typename R, typename Op>
+class vector_binary_expression : public vector_expression< vector_binary_expression<L, R, Op> > {
+public:
+	typedef typename L::value_type value_type;
+	vector_binary_expression(const L& lhs, const R& rhs) : lhs{ lhs }, rhs{ rhs } {}
+	value_type operator[](size_t i) const { return Op::apply(lhs[i], rhs[i]); }
+	size_t size() const { return lhs.size(); }
+private:
+	L lhs;
+	R rhs;
+};
+
+// a * e[i]
+template<typename E>
+class vector_scale_expression : public vector_expression< vector_scale_expression<E> > {
+public:
+	typedef typename E::value_type value_type;
+	vector_scale_expression(const value_type& a, const E& e) : a{ a }, e{ e } {}
+	value_type operator[](size_t i) const { return a * e[i]; }
+	size_t size() const { return e.size(); }
+private:
+	value_type a;
+	E e;
+};
+
+// e[i] / a
+template<typename E>
+class vector_divide_expression : public vector_expression< vector_divide_expression<E> > {
+public:
+	typedef typename E::value_type value_type;
+	vector_divide_expression(const E& e, const value_type& a) : e{ e }, a{ a } {}
+	value_type operator[](size_t i) const { return e[i] / a; }
+	size_t size() const { return e.size(); }
+private:
+	E e;
+	value_type a;
+};
+
+// -e[i]
+template<typename E>
+class vector_negate_expression : public vector_expression< vector_negate_expression<E> > {
+public:
+	typedef typename E::value_type value_type;
+	explicit vector_negate_expression(const E& e) : e{ e } {}
+	value_type operator[](size_t i) const { return -e[i]; }
+	size_t size() const { return e.size(); }
+private:
+	E e;
+};
+
+// map the operands of the vector operators to expression nodes
+template<typename T, typename = void>
+struct vector_operand {};
+template<typename Scalar>
+struct vector_operand< vector<Scalar> > {
+	typedef vector_reference<Scalar> type;
+	static type wrap(const vector<Scalar>& v) { return type(v); }
+};
+template<typename Scalar>
+struct vector_operand< vector_view<Scalar> > {
+	typedef vector_view_reference<Scalar> type;
+	static type wrap(const vector_view<Scalar>& v) { return type(v); }
+};
+template<typename E>
+struct vector_operand<E, typename std::enable_if<is_vector_expression<E>::value>::type> {
+	typedef E type;
+	static const E& wrap(const E& e) { return e; }
+};
+
+template<typename T, typename = void>
+struct is_vector_operand : std::false_type {};
+template<typename T>
+struct is_vector_operand<T, std::void_t<typename vector_operand<T>::type> > : std::true_type {};
+
+// the vector operators build expressions when one of the operands already is an expression,
+// or for all vector operands when BLAS_ENABLE_EXPRESSION_TEMPLATES is set
+template<typename L, typename R>
+struct enable_vector_expression : std::enable_if<
+	is_vector_operand<L>::value && is_vector_operand<R>::value &&
+	(is_vector_expression<L>::value || is_vector_expression<R>::value || BLAS_ENABLE_EXPRESSION_TEMPLATES)> {};
+// a scalar operand is a native arithmetic type or the element type of the vector operand
+template<typename S, typename E, typename = void>
+struct is_vector_scalar : std::false_type {};
+template<typename S, typename E>
+struct is_vector_scalar<S, E, std::void_t<typename vector_operand<E>::type> > : std::integral_constant<bool,
+	std::is_arithmetic<S>::value || std::is_same<S, typename vector_operand<E>::type::value_type>::value> {};
+template<typename S, typename E>
+struct enable_scaled_vector_expression : std::enable_if<
+	is_vector_scalar<S, E>::value &&
+	(is_vector_expression<E>::value || BLAS_ENABLE_EXPRESSION_TEMPLATES)> {};
+
+// start an expression explicitly
+template<typename Scalar>
+vector_reference<Scalar> expr(const vector<Scalar>& v) { return vector_reference<Scalar>(v); }
+template<typename Scalar>
+vector_view_reference<Scalar> expr(const vector_view<Scalar>& v) { return vector_view_reference<Scalar>(v); }
+
+template<typename L, typename R, typename = typename enable_vector_expression<L, R>::type>
+vector_binary_expression<typename vector_operand<L>::type, typename vector_operand<R>::type, expression_add>
+operator+(const L& lhs, const R& rhs) {
+	return { vector_operand<L>::wrap(lhs), vector_operand<R>::wrap(rhs) };
+}
+
+template<typename L, typename R, typename = typename enable_vector_expression<L, R>::type>
+vector_binary_expression<typename vector_operand<L>::type, typename vector_operand<R>::type, expression_sub>
+operator-(const L& lhs, const R& rhs) {
+	return { vector_operand<L>::wrap(lhs), vector_operand<R>::wrap(rhs) };
+}
+
+template<typename S, typename E, typename = typename enable_scaled_vector_expression<S, E>::type>
+vector_scale_expression<typename vector_operand<E>::type>
+operator*(const S& a, const E& e) {
+	using value_type = typename vector_operand<E>::type::value_type;
+	return { value_type(a), vector_operand<E>::wrap(e) };
+}
+
+template<typename E, typename S, typename = typename enable_scaled_vector_expression<S, E>::type>
+vector_scale_expression<typename vector_operand<E>::type>
+operator*(const E& e, const S& a) {
+	using value_type = typename vector_operand<E>::type::value_type;
+	return { value_type(a), vector_operand<E>::wrap(e) };
+}
+
+template<typename E, typename S, typename = typename enable_scaled_vector_expression<S, E>::type>
+vector_divide_expression<typename vector_operand<E>::type>
+operator/(const E& e, const S& a) {
+	using value_type = typename vector_operand<E>::type::value_type;
+	return { vector_operand<E>::wrap(e), value_type(a) };
+}
+
+template<typename E, typename = typename std::enable_if<is_vector_expression<E>::value>::type>
+vector_negate_expression<E> operator-(const E& e) {
+	return vector_negate_expression<E>(e);
+}
+
+template<typename E, typename = typename std::enable_if<is_vector_expression<E>::value>::type>
+size_t size(const E& e) { return e.size(); }
+
+// fused reductions of expressions: one pass, and for posits one rounding
+template<typename L, typename R, typename = typename std::enable_if<
+	is_vector_operand<L>::value && is_vector_operand<R>::value && (is_vector_expression<L>::value || is_vector_expression<R>::value)>::type>
+typename vector_operand<L>::type::value_type dot(const L& x, const R& y) {
+	using value_type = typename vector_operand<L>::type::value_type;
+	const auto& lhs = vector_operand<L>::wrap(x);
+	const auto& rhs = vector_operand<R>::wrap(y);
+	size_t n = (lhs.size() < rhs.size() ? lhs.size() : rhs.size());
+	return fused_kernel<value_type>::dot(0, n, [&](size_t i) { return lhs[i]; }, [&](size_t i) { return rhs[i]; });
+}
+
+template<typename E>
+typename E::value_type sum(const vector_expression<E>& e) {
+	const E& expr = e.self();
+	return fused_kernel<typename E::value_type>::sum(0, expr.size(), [&](size_t i) { return expr[i]; });
+}
+
+// materialize an expression, for example to pass it to a function that takes a vector
+template<typename E>
+vector<typename E::value_type> eval(const vector_expression<E>& e) { return vector<typename E::value_type>(e); }
+
+template<typename E>
+std::ostream& operator<<(std::ostream& ostr, const vector_expression<E>& e) {
+	const E& expr = e.self();
+	auto width = ostr.precision() + 2;
+	for (size_t j = 0; j < expr.size(); ++j) ostr << std::setw(width) << expr[j] << " ";
+	return ostr;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// matrix expressions
+
+// leaf node referencing a matrix
+template<typename Scalar>
+class matrix_reference : public matrix_expression< matrix_reference<Scalar> > {
+public:
+	typedef Scalar value_type;
+	explicit matrix_reference(const matrix<Scalar>& A) : A{ A } {}
+	value_type operator()(size_t i, size_t j) const { return A(i, j); }
+	size_t rows() const { return A.rows(); }
+	size_t cols() const { return A.cols(); }
+private:
+	const matrix<Scalar>& A;
+};
+
+// leaf node holding a matrix view
+template<typename Scalar>
+class matrix_view_reference : public matrix_expression< matrix_view_reference<Scalar> > {
+public:
+	typedef typename std::remove_const<Scalar>::type value_type;
+	explicit matrix_view_reference(const matrix_view<Scalar>& A) : A{ A } {}
+	value_type operator()(size_t i, size_t j) const { return A(i, j); }
+	size_t rows() const { return A.rows(); }
+	size_t cols() const { return A.cols(); }
+private:
+	matrix_view<Scalar> A;
+};
+
+// lhs(i,j) op rhs(i,j)
+template<typename L, typename R, typename Op>
+class matrix_binary_expression : public matrix_expression< matrix_binary_expression<L, R, Op> > {
+public:
+	typedef typename L::value_type value_type;
+	matrix_binary_expression(const L& lhs, const R& rhs) : lhs{ lhs }, rhs{ rhs } {}
+	value_type operator()(size_t i, size_t j) const { return Op::apply(lhs(i, j), rhs(i, j)); }
+	size_t rows() const { return lhs.rows(); }
+	size_t cols() const { return lhs.cols(); }
+private:
+	L lhs;
+	R rhs;
+};
+
+// a * e(i,j)
+template<typename E>
+class matrix_scale_expression : public matrix_expression< matrix_scale_expression<E> > {
+public:
+	typedef typename E::value_type value_type;
+	matrix_scale_expression(const value_type& a, const E& e) : a{ a }, e{ e } {}
+	value_type operator()(size_t i, size_t j) const { return a * e(i, j); }
+	size_t rows() const { return e.rows(); }
+	size_t cols() const { return e.cols(); }
+private:
+	value_type a;
+	E e;
+};
+
+// e(i,j) / a
+template<typename E>
+class matrix_divide_expression : public matrix_expression< matrix_divide_expression<E> > {
+public:
+	typedef typename E::value_type value_type;
+	matrix_divide_expression(const E& e, const value_type& a) : e{ e }, a{ a } {}
+	value_type operator()(size_t i, size_t j) const { return e(i, j) / a; }
+	size_t rows() const { return e.rows(); }
+	size_t cols() const { return e.cols(); }
+private:
+	E e;
+	value_type a;
+};
+
+template<typename T, typename = void>
+struct matrix_operand {};
+template<typename Scalar>
+struct matrix_operand< matrix<Scalar> > {
+	typedef matrix_reference<Scalar> type;
+	static type wrap(const matrix<Scalar>& A) { return type(A); }
+};
+template<typename Scalar>
+struct matrix_operand< matrix_view<Scalar> > {
+	typedef matrix_view_reference<Scalar> type;
+	static type wrap(const matrix_view<Scalar>& A) { return type(A); }
+};
+template<typename E>
+struct matrix_operand<E, typename std::enable_if<is_matrix_expression<E>::value>::type> {
+	typedef E type;
+	static const E& wrap(const E& e) { return e; }
+};
+
+template<typename T, typename = void>
+struct is_matrix_operand : std::false_type {};
+template<typename T>
+struct is_matrix_operand<T, std::void_t<typename matrix_operand<T>::type> > : std::true_type {};
+
+template<typename L, typename R>
+struct enable_matrix_expression : std::enable_if<
+	is_matrix_operand<L>::value && is_matrix_operand<R>::value &&
+	(is_matrix_expression<L>::value || is_matrix_expression<R>::value || BLAS_ENABLE_EXPRESSION_TEMPLATES)> {};
+template<typename S, typename E, typename = void>
+struct is_matrix_scalar : std::false_type {};
+template<typename S, typename E>
+struct is_matrix_scalar<S, E, std::void_t<typename matrix_operand<E>::type> > : std::integral_constant<bool,
+	std::is_arithmetic<S>::value || std::is_same<S, typename matrix_operand<E>::type::value_type>::value> {};
+template<typename S, typename E>
+struct enable_scaled_matrix_expression : std::enable_if<
+	is_matrix_scalar<S, E>::value &&
+	(is_matrix_expression<E>::value || BLAS_ENABLE_EXPRESSION_TEMPLATES)> {};
+
+template<typename Scalar>
+matrix_reference<Scalar> expr(const matrix<Scalar>& A) { return matrix_reference<Scalar>(A); }
+template<typename Scalar>
+matrix_view_reference<Scalar> expr(const matrix_view<Scalar>& A) { return matrix_view_reference<Scalar>(A); }
+
+template<typename L, typename R, typename = typename enable_matrix_expression<L, R>::type>
+matrix_binary_expression<typename matrix_operand<L>::type, typename matrix_operand<R>::type, expression_add>
+operator+(const L& lhs, const R& rhs) {
+	return { matrix_operand<L>::wrap(lhs), matrix_operand<R>::wrap(rhs) };
+}
+
+template<typename L, typename R, typename = typename enable_matrix_expression<L, R>::type>
+matrix_binary_expression<typename matrix_operand<L>::type, typename matrix_operand<R>::type, expression_sub>
+operator-(const L& lhs, const R& rhs) {
+	return { matrix_operand<L>::wrap(lhs), matrix_operand<R>::wrap(rhs) };
+}
+
+template<typename S, typename E, typename = typename enable_scaled_matrix_expression<S, E>::type>
+matrix_scale_expression<typename matrix_operand<E>::type>
+operator*(const S& a, const E& e) {
+	using value_type = typename matrix_operand<E>::type::value_type;
+	return { value_type(a), matrix_operand<E>::wrap(e) };
+}
+
+template<typename E, typename S, typename = typename enable_scaled_matrix_expression<S, E>::type>
+matrix_scale_expression<typename matrix_operand<E>::type>
+operator*(const E& e, const S& a) {
+	using value_type = typename matrix_operand<E>::type::value_type;
+	return { value_type(a), matrix_operand<E>::wrap(e) };
+}
+
+template<typename E, typename S, typename = typename enable_scaled_matrix_expression<S, E>::type>
+matrix_divide_expression<typename matrix_operand<E>::type>
+operator/(const E& e, const S& a) {
+	using value_type = typename matrix_operand<E>::type::value_type;
+	return { matrix_operand<E>::wrap(e), value_type(a) };
+}
+
+template<typename E>
+matrix<typename E::value_type> eval(const matrix_expression<E>& e) { return matrix<typename E::value_type>(e); }
+
+template<typename E>
+std::ostream& operator<<(std::ostream& ostr, const matrix_expression<E>& e) {
+	const E& expr = e.self();
+	auto width = ostr.width();
+	for (size_t i = 0; i < expr.rows(); ++i) {
+		for (size_t j = 0; j < expr.cols(); ++j) {
+			ostr << std::fixed << std::setw(width) << expr(i, j) << " ";
+		}
+		ostr << '\n';
+	}
+	return ostr;
+}
+
+}}} // namespace sw::unum::blas
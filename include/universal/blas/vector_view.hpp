@@ -0,0 +1,146 @@
+#pragma once
+// vector_view.hpp: non-owning, strided view of a vector of elements
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <cstddef>
+#include <iostream>
+#include <iomanip>
+#include <iterator>
+#include <type_traits>
+#include <universal/blas/vector.hpp>
+
+namespace sw { namespace unum { namespace blas {
+
+// vector_view<Scalar> references n elements spaced stride elements apart in memory that it does not own.
+// Use vector_view<const Scalar> for read-only access. Copying a view copies the reference, not the elements:
+// use assign() to copy element values into the viewed memory.
+template<typename Scalar>
+class vector_view {
+public:
+	typedef typename std::remove_const<Scalar>::type value_type;
+	typedef Scalar&                                  reference;
+	typedef const Scalar&                            const_reference;
+	typedef Scalar*                                  pointer;
+	typedef size_t                                   size_type;
+
+	// strided random access iterators over the elements of the view: the const_iterator yields read-only references
+	template<bool IsConst>
+	class basic_iterator {
+		using element = typename std::conditional<IsConst, const Scalar, Scalar>::type;
+	public:
+		typedef std::random_access_iterator_tag iterator_category;
+		typedef typename std::remove_const<Scalar>::type value_type;
+		typedef std::ptrdiff_t                  difference_type;
+		typedef element*                        pointer;
+		typedef element&                        reference;
+
+		basic_iterator() : _p{ nullptr }, _stride{ 1 } {}
+		basic_iterator(element* p, std::ptrdiff_t stride) : _p{ p }, _stride{ stride } {}
+		operator basic_iterator<true>() const { return basic_iterator<true>(_p, _stride); }
+
+		reference operator*() const { return *_p; }
+		pointer operator->() const { return _p; }
+		reference operator[](difference_type n) const { return _p[n * _stride]; }
+		basic_iterator& operator++() { _p += _stride; return *this; }
+		basic_iterator operator++(int) { basic_iterator tmp(*this); _p += _stride; return tmp; }
+		basic_iterator& operator--() { _p -= _stride; return *this; }
+		basic_iterator operator--(int) { basic_iterator tmp(*this); _p -= _stride; return tmp; }
+		basic_iterator& operator+=(difference_type n) { _p += n * _stride; return *this; }
+		basic_iterator& operator-=(difference_type n) { _p -= n * _stride; return *this; }
+		basic_iterator operator+(difference_type n) const { return basic_iterator(_p + n * _stride, _stride); }
+		basic_iterator operator-(difference_type n) const { return basic_iterator(_p - n * _stride, _stride); }
+		friend basic_iterator operator+(difference_type n, const basic_iterator& it) { return it + n; }
+
+		// friends, so that an iterator and a const_iterator compare through the conversion
+		friend difference_type operator-(const basic_iterator& lhs, const basic_iterator& rhs) { return (lhs._p - rhs._p) / lhs._stride; }
+		friend bool operator==(const basic_iterator& lhs, const basic_iterator& rhs) { return lhs._p == rhs._p; }
+		friend bool operator!=(const basic_iterator& lhs, const basic_iterator& rhs) { return lhs._p != rhs._p; }
+		// a negative stride walks down in memory
+		friend bool operator< (const basic_iterator& lhs, const basic_iterator& rhs) { return (lhs._stride > 0 ? lhs._p < rhs._p : lhs._p > rhs._p); }
+		friend bool operator> (const basic_iterator& lhs, const basic_iterator& rhs) { return rhs < lhs; }
+		friend bool operator<=(const basic_iterator& lhs, const basic_iterator& rhs) { return !(rhs < lhs); }
+		friend bool operator>=(const basic_iterator& lhs, const basic_iterator& rhs) { return !(lhs < rhs); }
+	private:
+		element*       _p;
+		std::ptrdiff_t _stride;
+	};
+	typedef basic_iterator<false> iterator;
+	typedef basic_iterator<true>  const_iterator;
+
+	vector_view() : _data{ nullptr }, _n{ 0 }, _stride{ 1 } {}
+	// wrap an externally owned buffer
+	vector_view(Scalar* data, size_t n, std::ptrdiff_t stride = 1) : _data{ data }, _n{ n }, _stride{ stride } {}
+	// view all elements of a vector
+	template<typename S, typename = typename std::enable_if<std::is_convertible<S*, Scalar*>::value>::type>
+	vector_view(vector<S>& v) : _data{ v.data() }, _n{ v.size() }, _stride{ 1 } {}
+	template<typename S, typename = typename std::enable_if<std::is_convertible<const S*, Scalar*>::value>::type>
+	vector_view(const vector<S>& v) : _data{ v.data() }, _n{ v.size() }, _stride{ 1 } {}
+	// a view to mutable elements converts to a read-only view
+	template<typename S, typename = typename std::enable_if<std::is_convertible<S*, Scalar*>::value && !std::is_same<S, Scalar>::value>::type>
+	vector_view(const vector_view<S>& v) : _data{ v.data() }, _n{ v.size() }, _stride{ v.stride() } {}
+
+	vector_view(const vector_view&) = default;
+	vector_view& operator=(const vector_view&) = default;
+
+	reference operator[](size_t i) const { return _data[std::ptrdiff_t(i) * _stride]; }
+	reference operator()(size_t i) const { return _data[std::ptrdiff_t(i) * _stride]; }
+
+	// copy the values of a vector of the same size into the viewed elements
+	template<typename Vector>
+	vector_view& assign(const Vector& v) {
+		for (size_t i = 0; i < _n; ++i) (*this)[i] = v[i];
+		return *this;
+	}
+	// set all viewed elements to a value
+	vector_view& assign(const value_type& val) {
+		for (size_t i = 0; i < _n; ++i) (*this)[i] = val;
+		return *this;
+	}
+
+	// view of the n elements starting at element first
+	vector_view subview(size_t first, size_t n) const { return vector_view(_data + std::ptrdiff_t(first) * _stride, n, _stride); }
+
+	// selectors
+	size_t size() const { return _n; }
+	std::ptrdiff_t stride() const { return _stride; }
+	pointer data() const { return _data; }
+	bool contiguous() const { return _stride == 1; }
+
+	// iterators
+	iterator begin() const { return iterator(_data, _stride); }
+	iterator end() const { return iterator(_data + std::ptrdiff_t(_n) * _stride, _stride); }
+	const_iterator cbegin() const { return const_iterator(_data, _stride); }
+	const_iterator cend() const { return const_iterator(_data + std::ptrdiff_t(_n) * _stride, _stride); }
+
+private:
+	Scalar*        _data;
+	size_t         _n;
+	std::ptrdiff_t _stride;
+};
+
+template<typename Scalar> auto size(const vector_view<Scalar>& v) { return v.size(); }
+
+// create a view of the n elements of a vector starting at first and spaced stride elements apart
+template<typename Scalar>
+vector_view<Scalar> make_view(vector<Scalar>& v, size_t first, size_t n, std::ptrdiff_t stride = 1) {
+	return vector_view<Scalar>(v.data() + first, n, stride);
+}
+
+// copy the elements of a view into a new vector
+template<typename Scalar>
+vector<typename std::remove_const<Scalar>::type> to_vector(const vector_view<Scalar>& v) {
+	vector<typename std::remove_const<Scalar>::type> result(v.size());
+	for (size_t i = 0; i < v.size(); ++i) result[i] = v[i];
+	return result;
+}
+
+template<typename Scalar>
+std::ostream& operator<<(std::ostream& ostr, const vector_view<Scalar>& v) {
+	auto width = ostr.precision() + 2;
+	for (size_t j = 0; j < size(v); ++j) ostr << std::setw(width) << v[j] << " ";
+	return ostr;
+}
+
+}}}  // namespace sw::unum::blas
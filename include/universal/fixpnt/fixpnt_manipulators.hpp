@@ -5,6 +5,8 @@
 //
 // This file is part of the universal numbers project, which is released under an MIT Open Source license.
 #include <exception>
+#include <sstream>
+#include <string>
 
 #if defined(__clang__)
 /* Clang/LLVM. ---------------------------------------------- */
@@ -39,6 +41,13 @@
 namespace sw {
 namespace unum {
 
+// Generate a type tag for this fixpnt, for example, fixpnt<32,16> or fixpnt<8,4,Saturating>
+template<size_t nbits, size_t rbits, bool arithmetic, typename bt>
+std::string type_tag(const fixpnt<nbits, rbits, arithmetic, bt>& f) {
+	std::stringstream ss;
+	ss << "fixpnt<" << nbits << "," << rbits << (arithmetic == Modulo ? "" : ",Saturating") << ">";
+	return ss.str();
+}
 
 } // namespace unum
 } // namespace sw
@@ -4,6 +4,9 @@
 // Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
 //
 // This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <array>
+#include <cstdint>
+#include <universal/native/uint128.hpp>
 
 #if defined(__clang__)
 /* Clang/LLVM. ---------------------------------------------- */
@@ -37,5 +40,474 @@
 
 namespace sw { namespace unum {
 
+/*
+The elementary functions of fixpnt<nbits, rbits> compute on the raw bits only, without a round trip
+through double, for targets without a floating-point unit. sin, cos, atan, atan2 and hypot run CORDIC
+rotations on Q61 integers, exp, log, sqrt and rsqrt evaluate a table of 64 segments followed by a short
+polynomial or Newton correction. The tables, the number of CORDIC iterations and the polynomial degrees
+are constants of the configuration, generated at compile time for its precision plus guard bits.
+The working precision is about 60 bits, so the functions support fixpnt with nbits <= 64 and rbits <= 60:
+the results are within an ulp for up to about 52 fraction bits, and large values of exp carry a relative
+error of about 2^-58.
+Results that are out of range saturate to maxneg and maxpos, arguments outside of the domain of the
+function return 0 for sqrt, and maxneg for log and maxpos for rsqrt of non-positive values.
+*/
+
+namespace impl {
+
+// the bits [s, s + 64) of hi:lo, s in [0, 128)
+constexpr uint64_t fixpnt_bits128(uint64_t hi, uint64_t lo, unsigned s) {
+	return (s == 0 ? lo : (s < 64 ? (hi << (64 - s)) | (lo >> s) : hi >> (s - 64)));
+}
+
+// (a * b) >> s of unsigned values, the result fits in 64 bits
+constexpr uint64_t fixpnt_mulshift(uint64_t a, uint64_t b, unsigned s) {
+	uint64_t hi = 0, lo = 0;
+	umul128(a, b, hi, lo);
+	return fixpnt_bits128(hi, lo, s);
+}
+
+// (a * b) >> s of signed values, truncated toward zero
+constexpr int64_t fixpnt_smulshift(int64_t a, int64_t b, unsigned s) {
+	uint64_t m = fixpnt_mulshift(a < 0 ? 0 - uint64_t(a) : uint64_t(a), b < 0 ? 0 - uint64_t(b) : uint64_t(b), s);
+	return ((a < 0) != (b < 0) ? -int64_t(m) : int64_t(m));
+}
+
+// position of the most significant set bit of a non-zero value
+constexpr int fixpnt_msb(uint64_t v) {
+	int msb = 0;
+	while (v >>= 1) ++msb;
+	return msb;
+}
+
+// one Newton step y (3 - m y^2) / 2 towards 1 / sqrt(m), with m in [1, 4) in Q62 and y in (0.5, 1] in Q63
+constexpr uint64_t fixpnt_rsqrt_step(uint64_t m, uint64_t y) {
+	constexpr uint64_t one = uint64_t(1) << 63;
+	uint64_t my2 = fixpnt_mulshift(m, fixpnt_mulshift(y, y, 63), 62);
+	return (my2 <= one ? y + fixpnt_mulshift(y, one - my2, 64) : y - fixpnt_mulshift(y, my2 - one, 64));
+}
+
+// pi/4 and ln(2) in Q64, 1/ln(2) in Q63, 2/pi in Q128
+constexpr uint64_t fixpnt_pi_4 = 0xC90FDAA22168C234ull;
+constexpr uint64_t fixpnt_ln2 = 0xB17217F7D1CF79ABull;
+constexpr uint64_t fixpnt_inv_ln2 = 0xB8AA3B295C17F0BBull;
+constexpr uint64_t fixpnt_2_pi_hi = 0xA2F9836E4E441529ull;
+constexpr uint64_t fixpnt_2_pi_lo = 0xFC2757D1F534DDC0ull;
+
+// atan(2^-i) in Q61, from the series sum (-1)^k 2^(-i(2k+1)) / (2k+1) evaluated in Q64
+template<size_t n>
+constexpr std::array<int64_t, n> cordic_atan_table() {
+	std::array<int64_t, n> table{};
+	for (size_t i = 0; i < n; ++i) {
+		uint64_t sum = fixpnt_pi_4;
+		if (i > 0) {
+			sum = 0;
+			for (size_t k = 0; i * (2 * k + 1) <= 64; ++k) {
+				unsigned s = unsigned(i * (2 * k + 1));
+				uint64_t term = (s == 64 ? 1 : (uint64_t(1) << (64 - s))) / (2 * k + 1);
+				sum = (k & 1 ? sum - term : sum + term);
+			}
+		}
+		table[i] = int64_t((sum >> 3) + ((sum >> 2) & 1));
+	}
+	return table;
+}
+
+// the inverse of the CORDIC gain prod 1 / sqrt(1 + 4^-i) of n iterations in Q63
+constexpr uint64_t cordic_gain(size_t n) {
+	uint64_t p = uint64_t(1) << 63;  // 2 = 1 + 4^0 in Q62
+	for (size_t i = 1; i < n && 2 * i < 64; ++i) p += p >> (2 * i);
+	uint64_t y = uint64_t(1) << 62;
+	for (int i = 0; i < 12; ++i) y = fixpnt_rsqrt_step(p, y);
+	return y;
+}
+
+// 2^(j/64) in Q63, from the series of exp(j ln(2) / 64)
+constexpr std::array<uint64_t, 64> exp2_table() {
+	std::array<uint64_t, 64> table{};
+	for (uint64_t j = 0; j < 64; ++j) {
+		uint64_t w = fixpnt_mulshift(fixpnt_ln2, j, 6);
+		uint64_t sum = uint64_t(1) << 63, term = sum;
+		for (uint64_t k = 1; term != 0; ++k) {
+			term = fixpnt_mulshift(term, w, 64) / k;
+			sum += term;
+		}
+		table[j] = sum;
+	}
+	return table;
+}
+
+// the reciprocals 1 / (1 + (j + 1/2)/64) of the segment midpoints in Q64
+constexpr std::array<uint64_t, 64> log_reciprocal_table() {
+	std::array<uint64_t, 64> table{};
+	for (uint64_t j = 0; j < 64; ++j) {
+		uint64_t d = 129 + 2 * j;
+		uint64_t q = (uint64_t(1) << 63) / d, r = (uint64_t(1) << 63) % d;
+		table[j] = (q << 8) + (r << 8) / d;
+	}
+	return table;
+}
+
+// -ln(r) in Q62 of the reciprocals, from the series sum u^k / k of u = 1 - r evaluated in Q64
+constexpr std::array<int64_t, 64> log_table() {
+	std::array<int64_t, 64> table{};
+	std::array<uint64_t, 64> reciprocal = log_reciprocal_table();
+	for (size_t j = 0; j < 64; ++j) {
+		uint64_t u = 0 - reciprocal[j], power = u, sum = 0;
+		for (uint64_t k = 1; power != 0; ++k) {
+			sum += power / k;
+			power = fixpnt_mulshift(power, u, 64);
+		}
+		table[j] = int64_t((sum >> 2) + ((sum >> 1) & 1));
+	}
+	return table;
+}
+
+// 1 / sqrt(m) in Q63 at the midpoints m = 1 + (j + 1/2)/32 of the 96 segments of [1, 4)
+constexpr std::array<uint64_t, 96> rsqrt_table() {
+	std::array<uint64_t, 96> table{};
+	for (uint64_t j = 0; j < 96; ++j) {
+		uint64_t m = (uint64_t(1) << 62) + ((2 * j + 1) << 56);
+		uint64_t y = uint64_t(1) << 62;
+		for (int i = 0; i < 12; ++i) y = fixpnt_rsqrt_step(m, y);
+		table[j] = y;
+	}
+	return table;
+}
+
+// the coefficients 1/k! of the exponential in Q63
+template<size_t n>
+constexpr std::array<uint64_t, n> exp_coefficients() {
+	std::array<uint64_t, n> c{};
+	uint64_t f = uint64_t(1) << 63;
+	for (uint64_t k = 0; k < n; ++k) {
+		if (k > 1) f /= k;
+		c[k] = f;
+	}
+	return c;
+}
+
+// the coefficients (-1)^(k+1) / k of ln(1 + t) in Q62, c[0] is unused
+template<size_t n>
+constexpr std::array<int64_t, n> log1p_coefficients() {
+	std::array<int64_t, n> c{};
+	for (size_t k = 1; k < n; ++k) c[k] = (k & 1 ? 1 : -1) * int64_t((uint64_t(1) << 62) / k);
+	return c;
+}
+
+// the compile-time constants of the elementary functions of a fixpnt<nbits, rbits>
+template<size_t nbits, size_t rbits>
+struct fixpnt_math_tables {
+	// the CORDIC angle error after n iterations is about 2^-n, and the relative error of the magnitude about 2^-2n
+	static constexpr size_t cordicIterations = (rbits + 4 > nbits / 2 + 2 ? (rbits + 4 < 61 ? rbits + 4 : 61) : nbits / 2 + 2);
+	// the polynomial arguments are below 2^-6, each term adds about 6 bits: e^x needs the relative precision
+	// of nbits bits for its large values, ln(x) the absolute precision of rbits bits
+	static constexpr size_t expDegree = (nbits + 5) / 6 + 1;
+	static constexpr size_t logDegree = (rbits + 5) / 6 + 1;
+	// the table seed of rsqrt has 8 correct bits, each Newton step doubles them up to the significant bits of
+	// rsqrt of the smallest and sqrt of the largest value
+	static constexpr size_t rootBits = (rbits + rbits / 2 > (nbits + rbits) / 2 ? rbits + rbits / 2 : (nbits + rbits) / 2) + 4;
+	static constexpr int newtonIterations = (rootBits <= 14 ? 1 : (rootBits <= 30 ? 2 : (rootBits <= 58 ? 3 : 4)));
+
+	static constexpr std::array<int64_t, cordicIterations> atan = cordic_atan_table<cordicIterations>();
+	static constexpr uint64_t gain = cordic_gain(cordicIterations);
+	static constexpr std::array<uint64_t, 64> exp2 = exp2_table();
+	static constexpr std::array<uint64_t, expDegree + 1> expCoefficients = exp_coefficients<expDegree + 1>();
+	static constexpr std::array<uint64_t, 64> logReciprocal = log_reciprocal_table();
+	static constexpr std::array<int64_t, 64> log = log_table();
+	static constexpr std::array<int64_t, logDegree + 1> log1pCoefficients = log1p_coefficients<logDegree + 1>();
+	static constexpr std::array<uint64_t, 96> rsqrt = rsqrt_table();
+};
+
+// the raw bits of a fixpnt as a sign-extended integer
+template<size_t nbits, size_t rbits, bool arithmetic, typename bt>
+inline int64_t fixpnt_raw(const fixpnt<nbits, rbits, arithmetic, bt>& v) {
+	static_assert(nbits <= 64 && rbits <= 60, "fixed-point elementary functions support fixpnt of at most 64 bits and 60 fraction bits");
+	using BlockBinary = blockbinary<nbits, bt>;
+	BlockBinary bb = v.getbb();
+	uint64_t raw = 0;
+	for (size_t b = 0; b < BlockBinary::nrBlocks; ++b) raw |= uint64_t(bb.block(b)) << (b * BlockBinary::bitsInBlock);
+	if (nbits < 64 && ((raw >> (nbits - 1)) & 1)) raw |= ~uint64_t(0) << (nbits % 64);
+	return int64_t(raw);
+}
+
+// the fixpnt of the raw bits of the value v with q fraction bits, rounded to nearest and saturated to [maxneg, maxpos]
+template<size_t nbits, size_t rbits, bool arithmetic, typename bt>
+inline fixpnt<nbits, rbits, arithmetic, bt> fixpnt_from_q(int64_t v, int q) {
+	constexpr int64_t maxpos = int64_t(~uint64_t(0) >> (65 - nbits));
+	constexpr int64_t maxneg = -maxpos - 1;
+	int s = q - int(rbits);
+	int64_t raw = 0;
+	if (s > 0) {
+		raw = (s >= 64 ? 0 : (v >> s) + ((v >> (s - 1)) & 1));
+	}
+	else if (v != 0) {
+		int l = -s;
+		raw = (l >= 63 || v > (INT64_MAX >> l) || v < (INT64_MIN >> l) ? (v > 0 ? INT64_MAX : INT64_MIN) : int64_t(uint64_t(v) << l));
+	}
+	fixpnt<nbits, rbits, arithmetic, bt> r;
+	r.set_raw_bits(uint64_t(raw > maxpos ? maxpos : (raw < maxneg ? maxneg : raw)));
+	return r;
+}
+
+// CORDIC rotation of (gain, 0) by the angle z in Q61, |z| <= pi/2, yields (cos z, sin z) in Q61
+template<size_t nbits, size_t rbits>
+inline void cordic_rotate(int64_t z, int64_t& c, int64_t& s) {
+	using Tables = fixpnt_math_tables<nbits, rbits>;
+	int64_t x = int64_t(Tables::gain >> 2), y = 0;
+	for (size_t i = 0; i < Tables::cordicIterations; ++i) {
+		int64_t xs = x >> i, ys = y >> i;
+		if (z >= 0) {
+			x -= ys;
+			y += xs;
+			z -= Tables::atan[i];
+		}
+		else {
+			x += ys;
+			y -= xs;
+			z += Tables::atan[i];
+		}
+	}
+	c = x;
+	s = y;
+}
+
+// CORDIC vectoring of (x, y), x, y >= 0 and below 2^60, onto the x axis: returns atan(y/x) in Q61,
+// and x becomes sqrt(x^2 + y^2) / gain
+template<size_t nbits, size_t rbits>
+inline int64_t cordic_vectoring(int64_t& x, int64_t y) {
+	using Tables = fixpnt_math_tables<nbits, rbits>;
+	int64_t z = 0;
+	for (size_t i = 0; i < Tables::cordicIterations; ++i) {
+		int64_t xs = x >> i, ys = y >> i;
+		if (y > 0) {
+			x += ys;
+			y -= xs;
+			z += Tables::atan[i];
+		}
+		else {
+			x -= ys;
+			y += xs;
+			z -= Tables::atan[i];
+		}
+	}
+	return z;
+}
+
+// shifts the magnitudes ax, ay so that the larger one has its most significant bit at position 59, returns the left shift
+inline int cordic_normalize(uint64_t& ax, uint64_t& ay) {
+	int shift = 59 - fixpnt_msb(ax > ay ? ax : ay);
+	if (shift >= 0) {
+		ax <<= shift;
+		ay <<= shift;
+	}
+	else {
+		ax >>= -shift;
+		ay >>= -shift;
+	}
+	return shift;
+}
+
+// atan2 of the raw values y and x in Q61
+template<size_t nbits, size_t rbits>
+inline int64_t fixpnt_atan2_q61(int64_t y, int64_t x) {
+	uint64_t ax = (x < 0 ? 0 - uint64_t(x) : uint64_t(x)), ay = (y < 0 ? 0 - uint64_t(y) : uint64_t(y));
+	if (ax == 0 && ay == 0) return 0;
+	cordic_normalize(ax, ay);
+	int64_t vx = int64_t(ax);
+	// the angle in the first quadrant, mirrored into the quadrant of (x, y)
+	int64_t angle = cordic_vectoring<nbits, rbits>(vx, int64_t(ay));
+	if (x < 0) angle = int64_t(fixpnt_pi_4 >> 1) - angle;
+	return (y < 0 ? -angle : angle);
+}
+
+// sin (q = 0) or cos (q = 1) of the raw value v: the argument reduction by 2/pi yields the quadrant of |v|
+// and the fraction of pi/2 in Q64
+template<size_t nbits, size_t rbits>
+inline int64_t fixpnt_sincos_q61(int64_t v, unsigned q) {
+	uint64_t a = (v < 0 ? 0 - uint64_t(v) : uint64_t(v));
+	uint64_t hi = 0, lo = 0, chi = 0, clo = 0;
+	umul128(a, fixpnt_2_pi_hi, hi, lo);
+	// the lower word of 2/pi adds 64 more bits to the reduced argument of large values
+	umul128(a, fixpnt_2_pi_lo, chi, clo);
+	lo += chi;
+	if (lo < chi) ++hi;
+	// a * 2/pi has 64 + rbits fraction bits
+	uint64_t quadrant = fixpnt_bits128(hi, lo, unsigned(64 + rbits));
+	uint64_t fraction = fixpnt_bits128(hi, lo, unsigned(rbits));
+	int64_t r = int64_t(fixpnt_mulshift(fraction, fixpnt_pi_4, 64) >> 2);  // the fraction times pi/2 in Q61
+	int64_t c = 0, s = 0;
+	cordic_rotate<nbits, rbits>(r, c, s);
+	// sin(x + k pi/2) cycles through sin, cos, -sin, -cos, the cosine is one quadrant ahead
+	unsigned k = unsigned(quadrant + q) & 3;
+	int64_t result = (k & 1 ? c : s);
+	if (k & 2) result = -result;
+	return (q == 0 && v < 0 ? -result : result);
+}
+
+} // namespace impl
+
+// sine of a fixed-point value by CORDIC rotation
+template<size_t nbits, size_t rbits, bool arithmetic, typename bt>
+fixpnt<nbits, rbits, arithmetic, bt> sin(const fixpnt<nbits, rbits, arithmetic, bt>& x) {
+	return impl::fixpnt_from_q<nbits, rbits, arithmetic, bt>(impl::fixpnt_sincos_q61<nbits, rbits>(impl::fixpnt_raw(x), 0), 61);
+}
+
+// cosine of a fixed-point value by CORDIC rotation
+template<size_t nbits, size_t rbits, bool arithmetic, typename bt>
+fixpnt<nbits, rbits, arithmetic, bt> cos(const fixpnt<nbits, rbits, arithmetic, bt>& x) {
+	return impl::fixpnt_from_q<nbits, rbits, arithmetic, bt>(impl::fixpnt_sincos_q61<nbits, rbits>(impl::fixpnt_raw(x), 1), 61);
+}
+
+// arc tangent in (-pi, pi] of the point (x, y) by CORDIC vectoring
+template<size_t nbits, size_t rbits, bool arithmetic, typename bt>
+fixpnt<nbits, rbits, arithmetic, bt> atan2(const fixpnt<nbits, rbits, arithmetic, bt>& y, const fixpnt<nbits, rbits, arithmetic, bt>& x) {
+	return impl::fixpnt_from_q<nbits, rbits, arithmetic, bt>(impl::fixpnt_atan2_q61<nbits, rbits>(impl::fixpnt_raw(y), impl::fixpnt_raw(x)), 61);
+}
+
+// arc tangent of a fixed-point value, the angle of the point (1, x)
+template<size_t nbits, size_t rbits, bool arithmetic, typename bt>
+fixpnt<nbits, rbits, arithmetic, bt> atan(const fixpnt<nbits, rbits, arithmetic, bt>& x) {
+	return impl::fixpnt_from_q<nbits, rbits, arithmetic, bt>(impl::fixpnt_atan2_q61<nbits, rbits>(impl::fixpnt_raw(x), int64_t(1) << rbits), 61);
+}
+
+// sqrt(x^2 + y^2) without intermediate overflow, by CORDIC vectoring
+template<size_t nbits, size_t rbits, bool arithmetic, typename bt>
+fixpnt<nbits, rbits, arithmetic, bt> hypot(const fixpnt<nbits, rbits, arithmetic, bt>& x, const fixpnt<nbits, rbits, arithmetic, bt>& y) {
+	using namespace impl;
+	int64_t rx = fixpnt_raw(x), ry = fixpnt_raw(y);
+	uint64_t ax = (rx < 0 ? 0 - uint64_t(rx) : uint64_t(rx)), ay = (ry < 0 ? 0 - uint64_t(ry) : uint64_t(ry));
+	if (ax == 0 && ay == 0) return fixpnt<nbits, rbits, arithmetic, bt>(0);
+	int shift = cordic_normalize(ax, ay);
+	int64_t vx = int64_t(ax);
+	cordic_vectoring<nbits, rbits>(vx, int64_t(ay));
+	// the product with the gain in Q63 is 4 sqrt(x^2 + y^2) in units of the normalized raw values
+	int64_t m = int64_t(fixpnt_mulshift(uint64_t(vx), fixpnt_math_tables<nbits, rbits>::gain, 61));
+	return fixpnt_from_q<nbits, rbits, arithmetic, bt>(m, int(rbits) + shift + 2);
+}
+
+// e^x: x / ln(2) = k + j/64 + g, e^x = 2^k 2^(j/64) e^(g ln(2)) with a table of 2^(j/64) and the Taylor polynomial of e^t
+template<size_t nbits, size_t rbits, bool arithmetic, typename bt>
+fixpnt<nbits, rbits, arithmetic, bt> exp(const fixpnt<nbits, rbits, arithmetic, bt>& x) {
+	using namespace impl;
+	using Tables = fixpnt_math_tables<nbits, rbits>;
+	int64_t v = fixpnt_raw(x);
+	uint64_t a = (v < 0 ? 0 - uint64_t(v) : uint64_t(v));
+	uint64_t hi = 0, lo = 0;
+	umul128(a, fixpnt_inv_ln2, hi, lo);
+	// |x| / ln(2) has 63 + rbits fraction bits
+	uint64_t k = fixpnt_bits128(hi, lo, unsigned(63 + rbits));
+	uint64_t f = (rbits == 0 ? lo << 1 : fixpnt_bits128(hi, lo, unsigned(rbits - 1)));
+	if (k >= 64) return fixpnt_from_q<nbits, rbits, arithmetic, bt>(v < 0 ? 0 : INT64_MAX, 0);
+	int e = int(k);
+	if (v < 0) {
+		// 2^-(k + f) = 2^-(k + 1) 2^(1 - f)
+		e = -e;
+		if (f != 0) {
+			--e;
+			f = 0 - f;
+		}
+	}
+	unsigned j = unsigned(f >> 58);
+	uint64_t t = fixpnt_mulshift(f & ((uint64_t(1) << 58) - 1), fixpnt_ln2, 64);
+	uint64_t p = Tables::expCoefficients[Tables::expDegree];
+	for (size_t i = Tables::expDegree; i-- > 0; ) p = Tables::expCoefficients[i] + fixpnt_mulshift(p, t, 64);
+	// the mantissa in [1, 2) in Q62
+	int64_t m = int64_t(fixpnt_mulshift(Tables::exp2[j], p, 64));
+	return fixpnt_from_q<nbits, rbits, arithmetic, bt>(m, 62 - e);
+}
+
+// natural logarithm: x = 2^e m, ln(x) = e ln(2) - ln(r) + ln(1 + t) with a table of reciprocals r of the
+// segments of m, and the Taylor polynomial of the remaining ln(1 + t) = ln(m r), |t| <= 1/128
+template<size_t nbits, size_t rbits, bool arithmetic, typename bt>
+fixpnt<nbits, rbits, arithmetic, bt> log(const fixpnt<nbits, rbits, arithmetic, bt>& x) {
+	using namespace impl;
+	using Tables = fixpnt_math_tables<nbits, rbits>;
+	int64_t v = fixpnt_raw(x);
+	if (v <= 0) return fixpnt_from_q<nbits, rbits, arithmetic, bt>(INT64_MIN, 0);
+	int p = fixpnt_msb(uint64_t(v));
+	int e = p - int(rbits);
+	uint64_t m = uint64_t(v) << (63 - p);  // [1, 2) in Q63
+	unsigned j = unsigned(m >> 57) & 63;
+	int64_t t = int64_t(fixpnt_mulshift(m, Tables::logReciprocal[j], 64) - (uint64_t(1) << 63));
+	int64_t poly = Tables::log1pCoefficients[Tables::logDegree];
+	for (size_t i = Tables::logDegree - 1; i > 0; --i) poly = Tables::log1pCoefficients[i] + fixpnt_smulshift(poly, t, 63);
+	int64_t fraction = Tables::log[j] + fixpnt_smulshift(poly, t, 63);  // Q62
+	// e ln(2) + fraction in Q64 as a two's complement hi:lo
+	uint64_t hi = 0, lo = 0;
+	umul128(uint64_t(e < 0 ? -e : e), fixpnt_ln2, hi, lo);
+	if (e < 0) {
+		lo = ~lo + 1;
+		hi = ~hi + (lo == 0 ? 1 : 0);
+	}
+	uint64_t flo = uint64_t(fraction) << 2, fhi = uint64_t(fraction >> 62);
+	lo += flo;
+	hi += fhi + (lo < flo ? 1 : 0);
+	// round to rbits fraction bits, the integer part of ln(x) is below 64 so the result fits in 64 bits before saturation
+	unsigned s = unsigned(64 - rbits);
+	uint64_t half = uint64_t(1) << (s - 1);
+	lo += half;
+	if (lo < half) ++hi;
+	int64_t raw = int64_t(fixpnt_bits128(hi, lo, s));
+	if ((int64_t(hi) >> (s - 1)) != (raw >> 63)) raw = (int64_t(hi) < 0 ? INT64_MIN : INT64_MAX);
+	return fixpnt_from_q<nbits, rbits, arithmetic, bt>(raw, int(rbits));
+}
+
+namespace impl {
+
+// 1 / sqrt(x) of the positive raw value v: x = 4^h m with m in [1, 4) in Q62, returns h and 1 / sqrt(m) in Q63
+template<size_t nbits, size_t rbits>
+inline uint64_t fixpnt_rsqrt_q63(int64_t v, uint64_t& m, int& h) {
+	using Tables = fixpnt_math_tables<nbits, rbits>;
+	int p = fixpnt_msb(uint64_t(v));
+	int e = p - int(rbits);
+	m = uint64_t(v) << (62 - p + (e & 1));
+	h = (e - (e & 1)) / 2;
+	uint64_t y = Tables::rsqrt[(m >> 57) - 32];
+	for (int i = 0; i < Tables::newtonIterations; ++i) y = fixpnt_rsqrt_step(m, y);
+	return y;
+}
+
+} // namespace impl
+
+// reciprocal square root by a table seed and Newton iterations
+template<size_t nbits, size_t rbits, bool arithmetic, typename bt>
+fixpnt<nbits, rbits, arithmetic, bt> rsqrt(const fixpnt<nbits, rbits, arithmetic, bt>& x) {
+	using namespace impl;
+	int64_t v = fixpnt_raw(x);
+	if (v <= 0) return fixpnt_from_q<nbits, rbits, arithmetic, bt>(INT64_MAX, 0);
+	uint64_t m = 0;
+	int h = 0;
+	uint64_t y = fixpnt_rsqrt_q63<nbits, rbits>(v, m, h);
+	// y <= 1 in Q63, shifted to fit a signed value
+	return fixpnt_from_q<nbits, rbits, arithmetic, bt>(int64_t(y >> 1), 62 + h);
+}
+
+// square root as m / sqrt(m), rounded to nearest with an integer correction of the last bit
+template<size_t nbits, size_t rbits, bool arithmetic, typename bt>
+fixpnt<nbits, rbits, arithmetic, bt> sqrt(const fixpnt<nbits, rbits, arithmetic, bt>& x) {
+	using namespace impl;
+	int64_t v = fixpnt_raw(x);
+	if (v <= 0) return fixpnt<nbits, rbits, arithmetic, bt>(0);
+	uint64_t m = 0;
+	int h = 0;
+	uint64_t y = fixpnt_rsqrt_q63<nbits, rbits>(v, m, h);
+	int64_t s = int64_t(fixpnt_mulshift(m, y, 63));  // sqrt(m) in [1, 2) in Q62
+	fixpnt<nbits, rbits, arithmetic, bt> r = fixpnt_from_q<nbits, rbits, arithmetic, bt>(s, 62 - h);
+	// the rounded root r of N = v 2^rbits satisfies r^2 - r < N <= r^2 + r
+	uint64_t root = uint64_t(fixpnt_raw(r));
+	uint64_t nhi = (rbits == 0 ? 0 : uint64_t(v) >> (64 - rbits)), nlo = uint64_t(v) << rbits;
+	auto above = [&](uint64_t c) {  // N > c^2 + c
+		uint64_t hi = 0, lo = 0;
+		umul128(c, c, hi, lo);
+		lo += c;
+		if (lo < c) ++hi;
+		return (nhi > hi || (nhi == hi && nlo > lo));
+	};
+	if (above(root)) ++root;
+	else if (root > 0 && !above(root - 1)) --root;
+	r.set_raw_bits(root);
+	return r;
+}
 
 }} // namespace sw::unum
@@ -0,0 +1,358 @@
+#pragma once
+// fdp.hpp: limb-based Kulisch accumulator and exact fused dot products for IEEE float and double
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <universal/native/uint128.hpp>
+#include <universal/utility/parallel_for.hpp>
+
+namespace sw { namespace ieee {
+
+// field layout of the IEEE-754 binary formats: a finite x is (-1)^s * m * 2^e with an integer significand m
+template<typename Real> struct kulisch_traits;
+template<>
+struct kulisch_traits<float> {
+	typedef uint32_t bits_type;
+	static constexpr int fraction_bits = 23;
+	static constexpr int exponent_mask = 0xFF;
+	static constexpr int exponent_bias = 150;     // e = E - 150 for the integer significand
+	static constexpr int min_exponent  = -149;    // e of the subnormals
+	static constexpr int max_exponent  = 104;     // e of the largest binade
+};
+template<>
+struct kulisch_traits<double> {
+	typedef uint64_t bits_type;
+	static constexpr int fraction_bits = 52;
+	static constexpr int exponent_mask = 0x7FF;
+	static constexpr int exponent_bias = 1075;
+	static constexpr int min_exponent  = -1074;
+	static constexpr int max_exponent  = 971;
+};
+
+/*
+ kulisch_accumulator<Real> is an exact fixed-point accumulator for sums and dot products of float or double.
+
+ The accumulator covers every product of two finite values plus 64 carry bits, in 32-bit digits that are
+ stored in 64-bit signed integers. Products are not deposited into the digits one by one: a product of two
+ significands is shifted by its exponent modulo 8 and added to a 128-bit two's complement bin that is selected
+ by its exponent divided by 8, which is a single add with carry. Every 2^13 products the touched bins are
+ flushed into the digits and the carries are propagated. For double the bins take 8KB and the digits 1KB,
+ and for typical data only a handful of bins are hot, so the working set stays in the L1 cache.
+
+ Sums and products are exact, the result is rounded once to nearest-even, and it does not depend on the
+ order of accumulation: partial accumulators can be merged, for example one per thread.
+ Infinities and NaNs follow IEEE semantics: a NaN operand, inf - inf, or 0 * inf make the result NaN.
+ */
+template<typename Real>
+class kulisch_accumulator {
+	using traits = kulisch_traits<Real>;
+	using bits_type = typename traits::bits_type;
+	static constexpr int significand_bits = traits::fraction_bits + 1;
+public:
+	// absolute bit position of 2^0: the smallest product lands on bit 0
+	static constexpr int offset = -2 * traits::min_exponent;
+	static constexpr size_t nrDigits = size_t(offset + 2 * (traits::max_exponent + significand_bits) + 64) / 32 + 2;
+	static constexpr size_t nrBins = size_t(offset + 2 * traits::max_exponent) / 8 + 1;
+
+	kulisch_accumulator() {
+		for (size_t i = 0; i < nrBins; ++i) _bin[i][0] = _bin[i][1] = 0;
+		_lowBin = nrBins;
+		_highBin = 0;
+		clear();
+	}
+
+	void clear() {
+		for (size_t i = _lowBin; i <= _highBin && i < nrBins; ++i) _bin[i][0] = _bin[i][1] = 0;
+		_lowBin = nrBins;
+		_highBin = 0;
+		_pending = 0;
+		for (size_t i = 0; i < nrDigits; ++i) _digit[i] = 0;
+		_nan = _posinf = _neginf = false;
+	}
+
+	// exact accumulation of a value
+	kulisch_accumulator& operator+=(Real x) {
+		add_values(1, &x, 1);
+		return *this;
+	}
+	kulisch_accumulator& operator-=(Real x) { return *this += -x; }
+
+	// exact accumulation of the product a * b
+	void add_product(Real a, Real b) {
+		add_products(1, &a, 1, &b, 1);
+	}
+
+	// exact accumulation of x[0, n) with stride incx
+	void add_values(size_t n, const Real* x, size_t incx = 1) {
+		while (n > 0) {
+			size_t chunk = flush_interval - _pending;
+			if (chunk > n) chunk = n;
+			size_t low = _lowBin, high = _highBin;
+			for (size_t i = 0; i < chunk; ++i, x += incx) {
+				bool sign;
+				uint64_t m;
+				int e;
+				if (!decompose(*x, sign, m, e)) {
+					special(*x);
+					continue;
+				}
+				size_t b = bin(m, 0, e + offset, sign);
+				low = (b < low ? b : low);
+				high = (b > high ? b : high);
+			}
+			commit(chunk, low, high);
+			n -= chunk;
+		}
+	}
+
+	// exact accumulation of the products x[i * incx] * y[i * incy], i in [0, n)
+	// The loop keeps its bookkeeping in registers and flushes the bins once per 2^13 products.
+	void add_products(size_t n, const Real* x, size_t incx, const Real* y, size_t incy) {
+		while (n > 0) {
+			size_t chunk = flush_interval - _pending;
+			if (chunk > n) chunk = n;
+			size_t low = _lowBin, high = _highBin;
+			for (size_t i = 0; i < chunk; ++i, x += incx, y += incy) {
+				bool sa, sb;
+				uint64_t ma, mb;
+				int ea, eb;
+				bool finite = decompose(*x, sa, ma, ea) & decompose(*y, sb, mb, eb);
+				if (!finite) {
+					special(*x * *y);
+					continue;
+				}
+				uint64_t lo, hi;
+				sw::unum::umul128(ma, mb, hi, lo);
+				size_t b = bin(lo, hi, ea + eb + offset, sa != sb);
+				low = (b < low ? b : low);
+				high = (b > high ? b : high);
+			}
+			commit(chunk, low, high);
+			n -= chunk;
+		}
+	}
+
+	// exact merge of two accumulators
+	kulisch_accumulator& operator+=(const kulisch_accumulator& rhs) {
+		kulisch_accumulator r(rhs);
+		r.flush();
+		flush();
+		for (size_t i = 0; i < nrDigits; ++i) _digit[i] += r._digit[i];
+		normalize();
+		_nan |= rhs._nan;
+		_posinf |= rhs._posinf;
+		_neginf |= rhs._neginf;
+		return *this;
+	}
+
+	// the accumulated value rounded to nearest, ties to even
+	Real value() const {
+		if (_nan || (_posinf && _neginf)) return std::numeric_limits<Real>::quiet_NaN();
+		if (_posinf) return std::numeric_limits<Real>::infinity();
+		if (_neginf) return -std::numeric_limits<Real>::infinity();
+		kulisch_accumulator a(*this);
+		a.flush();
+		bool negative = a._digit[nrDigits - 1] < 0;
+		if (negative) {
+			for (size_t i = 0; i < nrDigits; ++i) a._digit[i] = -a._digit[i];
+			a.normalize();
+		}
+		size_t top = nrDigits;
+		while (top > 0 && a._digit[top - 1] == 0) --top;
+		if (top == 0) return Real(0);
+		int msb = 32 * int(top - 1);
+		for (uint64_t d = uint64_t(a._digit[top - 1]); d > 1; d >>= 1) ++msb;
+		// keep significand_bits bits, but none below the smallest subnormal
+		int low = msb - (significand_bits - 1);
+		if (low < offset + traits::min_exponent) low = offset + traits::min_exponent;
+		uint64_t m = 0;
+		for (int i = msb; i >= low; --i) m = (m << 1) | uint64_t(a.bit(i));
+		bool guard = a.bit(low - 1);
+		bool sticky = false;
+		for (int i = low - 2; i >= 0 && !sticky; --i) sticky = a.bit(i);
+		if (guard && (sticky || (m & 1))) ++m;
+		Real r = std::ldexp(Real(m), low - offset);
+		return negative ? -r : r;
+	}
+	explicit operator Real() const { return value(); }
+
+	bool iszero() const {
+		kulisch_accumulator a(*this);
+		a.flush();
+		for (size_t i = 0; i < nrDigits; ++i) if (a._digit[i]) return false;
+		return !(_nan || _posinf || _neginf);
+	}
+
+private:
+	uint64_t _bin[nrBins][2];    // 128-bit two's complement partial sums, bin i holds multiples of 2^(8i - offset)
+	int64_t _digit[nrDigits];    // value = sum of _digit[i] * 2^(32i - offset) + the bins
+	size_t _lowBin, _highBin;    // range of the bins that can be nonzero
+	uint32_t _pending;           // products in the bins since the last flush
+	bool _nan, _posinf, _neginf;
+
+	// a bin receives less than 2^114 per product, so 2^13 products fit in its 127-bit magnitude
+	static constexpr uint32_t flush_interval = uint32_t(1) << 13;
+
+	// split a finite x into sign, integer significand, and exponent; returns false for inf and NaN
+	static bool decompose(Real x, bool& sign, uint64_t& m, int& e) {
+		bits_type bits;
+		std::memcpy(&bits, &x, sizeof(Real));
+		sign = (bits >> (8 * sizeof(Real) - 1)) != 0;
+		int E = int((bits >> traits::fraction_bits) & bits_type(traits::exponent_mask));
+		// subnormals have no hidden bit and share the exponent of the smallest normal binade
+		m = uint64_t(bits & ((bits_type(1) << traits::fraction_bits) - 1)) | (uint64_t(E != 0) << traits::fraction_bits);
+		e = (E != 0 ? E : 1) - traits::exponent_bias;
+		return E != traits::exponent_mask;
+	}
+
+	void special(Real x) {
+		if (std::isnan(x)) _nan = true;
+		else if (x > 0) _posinf = true;
+		else _neginf = true;
+	}
+
+	// add or subtract (hi:lo) * 2^position, (hi:lo) < 2^106, to its bin and return the bin index.
+	// The sign is applied with a mask instead of a branch, as signs of random data are unpredictable.
+	size_t bin(uint64_t lo, uint64_t hi, int position, bool negative) {
+		size_t b = size_t(position) / 8;
+		unsigned s = unsigned(position) % 8;
+		uint64_t mask = uint64_t(0) - uint64_t(negative);
+		uint64_t t1 = (hi << s) | ((lo >> 1) >> (63 - s));
+		uint64_t t0 = lo << s;
+		t1 = (t1 ^ mask) + (mask & uint64_t(t0 == 0));
+		t0 = (t0 ^ mask) - mask;
+		uint64_t sum = _bin[b][0] + t0;
+		_bin[b][1] += t1 + uint64_t(sum < t0);
+		_bin[b][0] = sum;
+		return b;
+	}
+
+	// record a chunk of binned products and flush when the bins are full
+	void commit(size_t count, size_t low, size_t high) {
+		_lowBin = low;
+		_highBin = high;
+		_pending += uint32_t(count);
+		if (_pending == flush_interval) flush();
+	}
+
+	// add or subtract (hi:lo) * 2^position, (hi:lo) < 2^127, to the digits as five increments below 2^32
+	void deposit(uint64_t lo, uint64_t hi, int position, bool negative) {
+		size_t k = size_t(position) / 32;
+		unsigned s = unsigned(position) % 32;
+		uint64_t t0 = lo << s;
+		uint64_t t1 = (hi << s) | ((lo >> 1) >> (63 - s));
+		uint64_t t2 = (hi >> 1) >> (63 - s);
+		int64_t* d = _digit + k;
+		if (negative) {
+			d[0] -= int64_t(t0 & 0xFFFFFFFFu);
+			d[1] -= int64_t(t0 >> 32);
+			d[2] -= int64_t(t1 & 0xFFFFFFFFu);
+			d[3] -= int64_t(t1 >> 32);
+			d[4] -= int64_t(t2);
+		}
+		else {
+			d[0] += int64_t(t0 & 0xFFFFFFFFu);
+			d[1] += int64_t(t0 >> 32);
+			d[2] += int64_t(t1 & 0xFFFFFFFFu);
+			d[3] += int64_t(t1 >> 32);
+			d[4] += int64_t(t2);
+		}
+	}
+
+	// move the bins into the digits and propagate the carries
+	void flush() {
+		for (size_t b = _lowBin; b <= _highBin && b < nrBins; ++b) {
+			uint64_t lo = _bin[b][0], hi = _bin[b][1];
+			if ((lo | hi) == 0) continue;
+			bool negative = (hi >> 63) != 0;
+			if (negative) {
+				hi = ~hi + uint64_t(lo == 0);
+				lo = uint64_t(0) - lo;
+			}
+			deposit(lo, hi, int(8 * b), negative);
+			_bin[b][0] = _bin[b][1] = 0;
+		}
+		_lowBin = nrBins;
+		_highBin = 0;
+		_pending = 0;
+		normalize();
+	}
+
+	// propagate the carries: all digits but the top one end up in [0, 2^32), the top digit carries the sign
+	void normalize() {
+		int64_t carry = 0;
+		for (size_t i = 0; i + 1 < nrDigits; ++i) {
+			int64_t d = _digit[i] + carry;
+			_digit[i] = d & 0xFFFFFFFF;
+			carry = d >> 32;   // arithmetic shift: floor division
+		}
+		_digit[nrDigits - 1] += carry;
+	}
+
+	// bit i of a normalized, non-negative accumulator
+	bool bit(int i) const {
+		if (i < 0) return false;
+		return (uint64_t(_digit[i / 32]) >> (i % 32)) & 1;
+	}
+};
+
+// exact sum of x[0, n) with stride incx, rounded once
+template<typename Real>
+Real exact_sum(size_t n, const Real* x, size_t incx = 1) {
+	kulisch_accumulator<Real> acc;
+	acc.add_values(n, x, incx);
+	return acc.value();
+}
+
+template<typename Real>
+Real exact_sum(const std::vector<Real>& x) {
+	return exact_sum(x.size(), x.data());
+}
+
+// exact fused dot product of x[0, n) and y[0, n) with strides, rounded once
+template<typename Real>
+Real fdp(size_t n, const Real* x, size_t incx, const Real* y, size_t incy) {
+	kulisch_accumulator<Real> acc;
+	acc.add_products(n, x, incx, y, incy);
+	return acc.value();
+}
+
+template<typename Real>
+Real fdp(const std::vector<Real>& x, const std::vector<Real>& y) {
+	size_t n = (x.size() < y.size() ? x.size() : y.size());
+	return fdp(n, x.data(), 1, y.data(), 1);
+}
+
+// multi-threaded exact fused dot product: each thread accumulates a block into its own accumulator and
+// the accumulators are merged exactly, so the result is identical for any number of threads
+template<typename Real>
+Real parallel_fdp(const std::vector<Real>& x, const std::vector<Real>& y, unsigned nrThreads = 0) {
+	size_t n = (x.size() < y.size() ? x.size() : y.size());
+	if (nrThreads == 0) nrThreads = sw::unum::hardware_concurrency();
+	std::vector< kulisch_accumulator<Real> > partials(nrThreads);
+	sw::unum::parallel_blocks(0, n, [&](unsigned t, size_t begin, size_t end) {
+		partials[t].add_products(end - begin, x.data() + begin, 1, y.data() + begin, 1);
+	}, nrThreads);
+	for (unsigned t = 1; t < nrThreads; ++t) partials[0] += partials[t];
+	return partials[0].value();
+}
+
+// multi-threaded exact sum
+template<typename Real>
+Real parallel_exact_sum(const std::vector<Real>& x, unsigned nrThreads = 0) {
+	if (nrThreads == 0) nrThreads = sw::unum::hardware_concurrency();
+	std::vector< kulisch_accumulator<Real> > partials(nrThreads);
+	sw::unum::parallel_blocks(0, x.size(), [&](unsigned t, size_t begin, size_t end) {
+		partials[t].add_values(end - begin, x.data() + begin, 1);
+	}, nrThreads);
+	for (unsigned t = 1; t < nrThreads; ++t) partials[0] += partials[t];
+	return partials[0].value();
+}
+
+}} // namespace sw::ieee
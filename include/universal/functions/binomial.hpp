@@ -4,6 +4,8 @@
 // Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
 //
 // This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <vector>
+#include "product_tree.hpp"
 
 namespace sw { namespace function {
 
@@ -14,14 +16,72 @@ IntegerType gcd(IntegerType a, IntegerType b) {
 	return gcd(b, a % b);
 }
 
-// Least Common Multiple of n integer-type numbers
+// Least Common Multiple of n integer-type numbers by a subproduct tree: lcm(a, b) = (a / gcd(a, b)) * b
+// combines neighbors pairwise, so that the gcds and products at each level have operands of similar size.
+// The subtrees run on nrThreads threads, 0 selects all hardware threads.
 template<typename Vector>
-typename Vector::value_type findlcm(const Vector& v) {
-	typename Vector::value_type lcm = v[0];
-	for (size_t i = 1; i < v.size(); i++) {
-		lcm = (v[i] * lcm) / gcd(v[i], lcm);
+typename Vector::value_type findlcm(const Vector& v, unsigned nrThreads = 1) {
+	using Scalar = typename Vector::value_type;
+	using Arithmetic = product_arithmetic<Scalar>;
+	using Value = typename Arithmetic::value_type;
+	std::vector<Value> leaves;
+	leaves.reserve(v.size());
+	for (const Scalar& s : v) leaves.push_back(Arithmetic::from_scalar(s));
+	Value lcm = reduce_tree(std::move(leaves), [](const Value& a, const Value& b) {
+		if (Arithmetic::iszero(a) || Arithmetic::iszero(b)) return Arithmetic::from_native(0);
+		return Arithmetic::multiply(Arithmetic::divide_exact(a, Arithmetic::gcd(a, b)), b);
+	}, Arithmetic::from_native(1), nrThreads);
+	return Arithmetic::to_scalar(lcm);
+}
+
+// Greatest Common Divisor of n integer-type numbers by a tree of gcds, the subtrees run on nrThreads threads
+template<typename Vector>
+typename Vector::value_type findgcd(const Vector& v, unsigned nrThreads = 1) {
+	using Scalar = typename Vector::value_type;
+	using Arithmetic = product_arithmetic<Scalar>;
+	using Value = typename Arithmetic::value_type;
+	std::vector<Value> leaves;
+	leaves.reserve(v.size());
+	for (const Scalar& s : v) leaves.push_back(Arithmetic::from_scalar(s));
+	Value gcd = reduce_tree(std::move(leaves), [](const Value& a, const Value& b) { return Arithmetic::gcd(a, b); }, Arithmetic::from_native(0), nrThreads);
+	return Arithmetic::to_scalar(gcd);
+}
+
+// (n over k) from its prime factorization: by Legendre's formula the exponent of the prime p is
+// sum_i floor(n / p^i) - floor(k / p^i) - floor((n - k) / p^i), and the prime powers multiply in a product tree
+// on nrThreads threads, so no division is needed.
+template<typename Scalar>
+Scalar binomial_coefficient(unsigned long long n, unsigned long long k, unsigned nrThreads = 1) {
+	using Arithmetic = product_arithmetic<Scalar>;
+	using Value = typename Arithmetic::value_type;
+	if (k > n) return Scalar(0);
+	if (k > n - k) k = n - k;
+	// the primes up to n from a sieve over the odd numbers
+	std::vector<bool> composite(n / 2 + 1, false);
+	for (unsigned long long i = 3; i * i <= n; i += 2) {
+		if (composite[i / 2]) continue;
+		for (unsigned long long j = i * i; j <= n; j += 2 * i) composite[j / 2] = true;
 	}
-	return lcm;
+	unsigned long long p = 1, remaining = 0;
+	auto factors = [&](unsigned long long& v) {
+		while (remaining == 0) {
+			// the next prime, and its exponent
+			p = (p < 2 ? 2 : (p == 2 ? 3 : p + 2));
+			while (p <= n && p > 2 && composite[p / 2]) p += 2;
+			if (p > n || k == 0) return false;
+			for (unsigned long long q = p; q <= n; ) {
+				remaining += n / q - k / q - (n - k) / q;
+				if (q > n / p) break;
+				q *= p;
+			}
+		}
+		--remaining;
+		v = p;
+		return true;
+	};
+	std::vector<Value> leaves = impl::packed_leaves<Value, Arithmetic>(factors);
+	Value coefficient = reduce_tree(std::move(leaves), [](const Value& a, const Value& b) { return Arithmetic::multiply(a, b); }, Arithmetic::from_native(1), nrThreads);
+	return Arithmetic::to_scalar(coefficient);
 }
 
 // BinomialCoefficient calculates the binomial coefficience recursively
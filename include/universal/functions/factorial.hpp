@@ -4,6 +4,8 @@
 // Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
 //
 // This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <vector>
+#include "product_tree.hpp"
 
 namespace sw { namespace function {
 
@@ -29,6 +31,38 @@ Scalar factoriali(const Scalar& n) {
 	return v;
 }
 
+// n! by binary splitting. The odd part of n! is the product over i of the odd numbers in (n / 2^(i+1), n / 2^i]
+// to the power i + 1, the power of two is n - popcount(n). Every range is a product tree, and the powers
+// follow from a running product, so that the large multiplications are few and balanced.
+// The leaves of the trees are distributed across nrThreads threads, 0 selects all hardware threads.
+template<typename Scalar>
+Scalar binary_split_factorial(unsigned long long n, unsigned nrThreads = 1) {
+	using Arithmetic = product_arithmetic<Scalar>;
+	using Value = typename Arithmetic::value_type;
+	auto multiply = [](const Value& a, const Value& b) { return Arithmetic::multiply(a, b); };
+	const Value one = Arithmetic::from_native(1);
+	int top = 0;
+	while (top < 64 && (n >> top) > 1) ++top;
+	Value odd = one, oddPart = one;
+	for (int i = top; i >= 0; --i) {
+		// the odd numbers in (n >> (i + 1), n >> i]
+		unsigned long long hi = n >> i, next = ((i + 1 < 64 ? n >> (i + 1) : 0) + 1) | 1ull;
+		if (next <= hi) {
+			std::vector<Value> leaves = impl::packed_leaves<Value, Arithmetic>([&](unsigned long long& v) {
+				if (next > hi || next == 0) return false;
+				v = next;
+				next += 2;
+				return true;
+			});
+			odd = multiply(odd, reduce_tree(std::move(leaves), multiply, one, nrThreads));
+		}
+		oddPart = multiply(oddPart, odd);
+	}
+	unsigned long long twos = n;
+	for (unsigned long long m = n; m; m &= m - 1) --twos;
+	return Arithmetic::to_scalar(multiply(oddPart, Arithmetic::power_of_two(twos)));
+}
+
 }  // namespace function
 }  // namespace sw
 
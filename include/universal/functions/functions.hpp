@@ -10,6 +10,7 @@
 #include "twosum.hpp"
 
 // special functions
+#include "product_tree.hpp"
 #include "factorial.hpp"
 #include "binomial.hpp"
 #include "loss.hpp"
@@ -0,0 +1,122 @@
+#pragma once
+// product_tree.hpp: balanced reduction trees for products, and the arithmetic they run on
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include <universal/utility/parallel_for.hpp>
+
+namespace sw { namespace function {
+
+/*
+Folding a sequence left to right multiplies an ever growing product with a small value, so the last
+products dominate and the fold cannot profit from fast multiplication of large operands. A product tree
+multiplies neighbors pairwise, level by level, so that the operands of every product have about the same
+size: with a subquadratic multiplication the whole tree costs about as much as its final product.
+The subtrees are independent, which distributes the lower levels across threads.
+
+The trees compute on product_arithmetic<Scalar>::value_type. By default that is Scalar with its operators;
+number systems with a faster internal representation specialize product_arithmetic to convert once at the
+leaves and once at the root. The additions and subtractions carry the recurrences of sw::sequences on the
+same representation.
+*/
+
+template<typename Scalar>
+struct product_arithmetic {
+	typedef Scalar value_type;
+	static value_type from_native(unsigned long long v) { return value_type(v); }
+	static value_type from_scalar(const Scalar& v) { return v; }
+	static Scalar to_scalar(const value_type& v) { return v; }
+	static bool iszero(const value_type& v) { return v == value_type(0); }
+	static value_type add(const value_type& a, const value_type& b) { return a + b; }
+	static value_type subtract(const value_type& a, const value_type& b) { return a - b; }
+	static value_type multiply(const value_type& a, const value_type& b) { return a * b; }
+	// a / b for a multiple a of b
+	static value_type divide_exact(const value_type& a, const value_type& b) { return a / b; }
+	static value_type gcd(value_type a, value_type b) {
+		while (!iszero(b)) {
+			value_type r(a);
+			r %= b;
+			a = b;
+			b = r;
+		}
+		return a;
+	}
+	static value_type power_of_two(unsigned long long k) {
+		value_type result(1), base(2);
+		for (; k; k >>= 1) {
+			if (k & 1) result = result * base;
+			if (k > 1) base = base * base;
+		}
+		return result;
+	}
+};
+
+namespace impl {
+
+// pairwise reduction of values[begin, end) level by level
+template<typename Value, typename Combine>
+Value reduce_levels(std::vector<Value>& values, size_t begin, size_t end, Combine& combine) {
+	size_t n = end - begin;
+	while (n > 1) {
+		size_t half = n / 2;
+		for (size_t i = 0; i < half; ++i) values[begin + i] = combine(values[begin + 2 * i], values[begin + 2 * i + 1]);
+		if (n & 1) values[begin + half] = std::move(values[begin + n - 1]);
+		n = half + (n & 1);
+	}
+	return std::move(values[begin]);
+}
+
+// the products of the numbers of a sequence packed into leaves that fit 64 bits
+template<typename Value, typename Arithmetic, typename Sequence>
+std::vector<Value> packed_leaves(Sequence&& next) {
+	std::vector<Value> leaves;
+	unsigned long long leaf = 1, v;
+	while (next(v)) {
+		if (leaf > ~0ull / v) {
+			leaves.push_back(Arithmetic::from_native(leaf));
+			leaf = v;
+		}
+		else {
+			leaf *= v;
+		}
+	}
+	if (leaf > 1 || leaves.empty()) leaves.push_back(Arithmetic::from_native(leaf));
+	return leaves;
+}
+
+} // namespace impl
+
+// reduce values with the associative operation combine in a balanced binary tree. The subtrees of nrThreads
+// contiguous blocks of leaves run concurrently, 0 selects all hardware threads, and their roots combine on the
+// calling thread. An empty sequence reduces to identity.
+template<typename Value, typename Combine>
+Value reduce_tree(std::vector<Value> values, Combine combine, const Value& identity, unsigned nrThreads = 1) {
+	if (values.empty()) return identity;
+	if (nrThreads == 0) nrThreads = sw::unum::hardware_concurrency();
+	nrThreads = unsigned(std::min(size_t(nrThreads), values.size()));
+	if (nrThreads <= 1) return impl::reduce_levels(values, 0, values.size(), combine);
+	std::vector<Value> roots(nrThreads, identity);
+	sw::unum::parallel_blocks(0, values.size(), [&](unsigned threadId, size_t begin, size_t end) {
+		roots[threadId] = impl::reduce_levels(values, begin, end, combine);
+	}, nrThreads);
+	return impl::reduce_levels(roots, 0, roots.size(), combine);
+}
+
+// product of a sequence of numbers by a product tree
+template<typename Scalar>
+Scalar product_tree(const std::vector<Scalar>& v, unsigned nrThreads = 1) {
+	using Arithmetic = product_arithmetic<Scalar>;
+	using Value = typename Arithmetic::value_type;
+	std::vector<Value> leaves;
+	leaves.reserve(v.size());
+	for (const Scalar& s : v) leaves.push_back(Arithmetic::from_scalar(s));
+	Value product = reduce_tree(std::move(leaves), [](const Value& a, const Value& b) { return Arithmetic::multiply(a, b); }, Arithmetic::from_native(1), nrThreads);
+	return Arithmetic::to_scalar(product);
+}
+
+}  // namespace function
+}  // namespace sw
@@ -0,0 +1,238 @@
+#pragma once
+// reproducible_sum.hpp: sums and dot products of float and double that are bit-identical for any order, chunking, or thread count
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <universal/functions/twosum.hpp>
+#include <universal/utility/parallel_for.hpp>
+
+namespace sw {
+namespace function {
+
+/*
+Reproducible summation with K-fold error-free extraction, after Rump, Ogita, and Oishi's ExtractVector and
+Demmel and Nguyen's reproducible summation.
+
+For n values of magnitude at most m, pick the power of two sigma = 2^M * 2^ceil(log2(m)) with M = ceil(log2(n + 2)).
+The extraction q = (sigma + x) - sigma rounds x to a multiple of ulp(sigma), and the remainder x - q is exact.
+All q are multiples of ulp(sigma) and their sum stays below sigma, so the sum of the q is exact in any order.
+The remainders are extracted again against sigma * 2^M * eps, K times in total, and what is left after the
+last fold is dropped. The fold sums depend only on the values, n, and m, and not on the order of addition,
+so partial sums of any partition of the data combine into the same bits. The folds are combined with twoSum.
+
+float values are accumulated in double, which also holds every product of two floats exactly.
+For double dot products each product is split into x*y = p + e with an fma and p and e are summed in separate folds.
+*/
+
+// accumulation type of the reproducible kernels
+template<typename Real> struct reproducible_traits;
+template<> struct reproducible_traits<float>  { typedef double accumulator; };
+template<> struct reproducible_traits<double> { typedef double accumulator; };
+
+template<typename Real, unsigned K = 3>
+class kfold_sum {
+	static_assert(K > 0, "kfold_sum needs at least one fold");
+public:
+	// extraction boundaries for n values of magnitude at most maxAbs: all partial sums that are merged must use the same boundaries
+	kfold_sum(Real maxAbs, size_t n) : _shift(0), _scale(1) {
+		int M = 0;
+		while ((size_t(1) << M) < n + 2 && M < 62) ++M;
+		int e = 0;
+		if (maxAbs > 0) std::frexp(maxAbs, &e);    // maxAbs < 2^e
+		else e = std::numeric_limits<Real>::min_exponent;
+		int x = e + M;
+		// keep sigma + x below the overflow threshold by scaling the inputs down by a power of two
+		if (x > std::numeric_limits<Real>::max_exponent - 1) {
+			_shift = x - (std::numeric_limits<Real>::max_exponent - 1);
+			x -= _shift;
+			_scale = std::ldexp(Real(1), -_shift);
+		}
+		for (unsigned k = 0; k < K; ++k) {
+			// sigma stays a normal number, below that the extraction is exact anyway
+			if (x < std::numeric_limits<Real>::min_exponent) x = std::numeric_limits<Real>::min_exponent;
+			_sigma[k] = std::ldexp(Real(1), x);
+			_fold[k] = Real(0);
+			x += M - std::numeric_limits<Real>::digits;
+		}
+	}
+
+	void add(Real v) {
+		v *= _scale;
+		for (unsigned k = 0; k < K; ++k) {
+			Real q = (_sigma[k] + v) - _sigma[k];
+			_fold[k] += q;
+			v -= q;
+		}
+	}
+
+	// exact combination with a partial sum that uses the same boundaries
+	kfold_sum& operator+=(const kfold_sum& rhs) {
+		for (unsigned k = 0; k < K; ++k) _fold[k] += rhs._fold[k];
+		return *this;
+	}
+
+	// the sum of the folds, smallest first, with the rounding errors of the additions compensated
+	Real value() const {
+		Real s = _fold[K - 1], c = Real(0);
+		for (unsigned k = K - 1; k-- > 0; ) {
+			std::pair<Real, Real> sr = twoSum(s, _fold[k]);
+			s = sr.first;
+			c += sr.second;
+		}
+		return std::ldexp(s + c, _shift);
+	}
+
+private:
+	Real _sigma[K];
+	Real _fold[K];
+	int  _shift;
+	Real _scale;
+};
+
+namespace impl {
+
+// IEEE result of a sum that contains infinities or NaNs, independent of the order of the terms
+struct nonfinite_terms {
+	bool nan = false, posinf = false, neginf = false;
+	void record(double v) {
+		if (v != v) nan = true;
+		else if (v > 0) posinf = true;
+		else if (v < 0) neginf = true;
+	}
+	bool any() const { return nan || posinf || neginf; }
+	void merge(const nonfinite_terms& rhs) { nan |= rhs.nan; posinf |= rhs.posinf; neginf |= rhs.neginf; }
+	double value() const {
+		if (nan || (posinf && neginf)) return std::numeric_limits<double>::quiet_NaN();
+		return posinf ? std::numeric_limits<double>::infinity() : -std::numeric_limits<double>::infinity();
+	}
+};
+
+// largest magnitude of term(i), i in [0, n), and the non-finite terms
+template<typename Accum, typename Term>
+Accum max_magnitude(size_t n, Term& term, unsigned nrThreads, nonfinite_terms& special) {
+	std::vector<Accum> maxima(nrThreads, Accum(0));
+	std::vector<nonfinite_terms> specials(nrThreads);
+	sw::unum::parallel_blocks(0, n, [&](unsigned t, size_t begin, size_t end) {
+		Accum m = Accum(0);
+		for (size_t i = begin; i < end; ++i) {
+			Accum a = std::abs(Accum(term(i)));
+			if (!(a <= std::numeric_limits<Accum>::max())) specials[t].record(double(term(i)));
+			else if (a > m) m = a;
+		}
+		maxima[t] = m;
+	}, nrThreads);
+	Accum m = Accum(0);
+	for (unsigned t = 0; t < nrThreads; ++t) {
+		if (maxima[t] > m) m = maxima[t];
+		special.merge(specials[t]);
+	}
+	return m;
+}
+
+inline unsigned resolve_threads(unsigned nrThreads) {
+	return (nrThreads == 0 ? sw::unum::hardware_concurrency() : nrThreads);
+}
+
+} // namespace impl
+
+// reproducible sum of term(i), i in [0, n), where term returns a float or double.
+// The result is bit-identical for any nrThreads; a nrThreads of 0 selects all hardware threads.
+template<typename Real, unsigned K = 3, typename Term>
+Real reproducible_sum_of(size_t n, Term term, unsigned nrThreads = 1) {
+	using Accum = typename reproducible_traits<Real>::accumulator;
+	nrThreads = impl::resolve_threads(nrThreads);
+	impl::nonfinite_terms special;
+	Accum maxAbs = impl::max_magnitude<Accum>(n, term, nrThreads, special);
+	if (special.any()) return Real(special.value());
+	kfold_sum<Accum, K> zero(maxAbs, n);
+	std::vector< kfold_sum<Accum, K> > partials(nrThreads, zero);
+	sw::unum::parallel_blocks(0, n, [&](unsigned t, size_t begin, size_t end) {
+		kfold_sum<Accum, K> s(zero);
+		for (size_t i = begin; i < end; ++i) s.add(Accum(term(i)));
+		partials[t] = s;
+	}, nrThreads);
+	for (unsigned t = 1; t < nrThreads; ++t) partials[0] += partials[t];
+	return Real(partials[0].value());
+}
+
+namespace impl {
+
+// float products are exact in double
+template<unsigned K, typename X, typename Y>
+float reproducible_dot_of(size_t n, X& x, Y& y, unsigned nrThreads, float) {
+	return reproducible_sum_of<float, K>(n, [&](size_t i) { return double(x(i)) * double(y(i)); }, nrThreads);
+}
+
+// double products are split into p + e with an fma, and p and e are summed in their own folds
+template<unsigned K, typename X, typename Y>
+double reproducible_dot_of(size_t n, X& x, Y& y, unsigned nrThreads, double) {
+	auto product = [&](size_t i) { return double(x(i)) * double(y(i)); };
+	nonfinite_terms special;
+	double maxAbs = max_magnitude<double>(n, product, nrThreads, special);
+	if (special.any()) return special.value();
+	// the error of a rounded product is at most half an ulp of the product
+	kfold_sum<double, K> zeroProducts(maxAbs, n);
+	kfold_sum<double, K> zeroErrors(std::ldexp(maxAbs, -std::numeric_limits<double>::digits), n);
+	std::vector< kfold_sum<double, K> > products(nrThreads, zeroProducts), errors(nrThreads, zeroErrors);
+	sw::unum::parallel_blocks(0, n, [&](unsigned t, size_t begin, size_t end) {
+		kfold_sum<double, K> p(zeroProducts), e(zeroErrors);
+		for (size_t i = begin; i < end; ++i) {
+			double a = double(x(i)), b = double(y(i));
+			double ab = a * b;
+			p.add(ab);
+			e.add(std::fma(a, b, -ab));
+		}
+		products[t] = p;
+		errors[t] = e;
+	}, nrThreads);
+	for (unsigned t = 1; t < nrThreads; ++t) {
+		products[0] += products[t];
+		errors[0] += errors[t];
+	}
+	std::pair<double, double> sr = twoSum(products[0].value(), errors[0].value());
+	return sr.first + sr.second;
+}
+
+} // namespace impl
+
+// reproducible dot product of x(i) * y(i), i in [0, n), where x and y return a float or double
+template<typename Real, unsigned K = 3, typename X, typename Y>
+Real reproducible_dot_of(size_t n, X x, Y y, unsigned nrThreads = 1) {
+	return impl::reproducible_dot_of<K>(n, x, y, impl::resolve_threads(nrThreads), Real(0));
+}
+
+// reproducible sum of x[0, n) with stride incx
+template<typename Real>
+Real reproducible_sum(size_t n, const Real* x, size_t incx = 1, unsigned nrThreads = 1) {
+	return reproducible_sum_of<Real>(n, [=](size_t i) { return x[i * incx]; }, nrThreads);
+}
+
+template<typename Real>
+Real reproducible_sum(const std::vector<Real>& x, unsigned nrThreads = 1) {
+	return reproducible_sum(x.size(), x.data(), 1, nrThreads);
+}
+
+// reproducible sum of magnitudes of x[0, n) with stride incx
+template<typename Real>
+Real reproducible_asum(size_t n, const Real* x, size_t incx = 1, unsigned nrThreads = 1) {
+	return reproducible_sum_of<Real>(n, [=](size_t i) { return std::abs(x[i * incx]); }, nrThreads);
+}
+
+// reproducible dot product of x[0, n) and y[0, n) with strides
+template<typename Real>
+Real reproducible_dot(size_t n, const Real* x, size_t incx, const Real* y, size_t incy, unsigned nrThreads = 1) {
+	return reproducible_dot_of<Real>(n, [=](size_t i) { return x[i * incx]; }, [=](size_t i) { return y[i * incy]; }, nrThreads);
+}
+
+template<typename Real>
+Real reproducible_dot(const std::vector<Real>& x, const std::vector<Real>& y, unsigned nrThreads = 1) {
+	size_t n = (x.size() < y.size() ? x.size() : y.size());
+	return reproducible_dot(n, x.data(), 1, y.data(), 1, nrThreads);
+}
+
+}  // namespace function
+}  // namespace sw
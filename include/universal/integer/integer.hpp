@@ -4,6 +4,8 @@
 // Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
 //
 // This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <charconv>
+#include <cstring>
 #include <string>
 #include <sstream>
 #include <iostream>
@@ -118,6 +120,11 @@ inline void convert_unsigned(uint64_t v, integer<nbits, BlockType>& result) {
 
 template<size_t nbits, typename BlockType>
 bool parse(const std::string& number, integer<nbits, BlockType>& v);
+// radix conversions of integer_charconv.hpp
+template<size_t nbits, typename BlockType>
+std::to_chars_result to_chars(char* first, char* last, const integer<nbits, BlockType>& value, int base = 10);
+template<size_t nbits, typename BlockType>
+std::from_chars_result from_chars(const char* first, const char* last, integer<nbits, BlockType>& value, int base = 10);
 
 // idiv_t for integer<nbits, BlockType> to capture quotient and remainder during long division
 template<size_t nbits, typename BlockType>
@@ -731,185 +738,6 @@ private:
 	friend signed findMsb(const integer<nnbits, BBlockType>& v);
 };
 
-// paired down implementation of a decimal type to generate decimal representations for integer<nbits, BlockType> types
-namespace impl {
-	// Decimal representation as a set of decimal digits with sign used for creating decimal representations of the integers
-class decimal : public std::vector<uint8_t> {
-public:
-	bool sign;
-	// remove any leading zeros from a decimal representation
-	void unpad() {
-		int n = (int)size();
-		for (int i = n - 1; i > 0; --i) {
-			if (operator[](i) == 0) pop_back();
-		}
-	}
-private:
-	friend std::ostream& operator<<(std::ostream& ostr, const decimal& d);
-};
-
-// generate an ASCII decimal format and send to ostream
-inline std::ostream& operator<<(std::ostream& ostr, const decimal& d) {
-	// to make certain that setw and left/right operators work properly
-	// we need to transform the integer into a string
-	std::stringstream ss;
-
-	//std::streamsize width = ostr.width();
-	std::ios_base::fmtflags ff;
-	ff = ostr.flags();
-	ss.flags(ff);
-	if (d.sign) ss << '-';
-	for (decimal::const_reverse_iterator rit = d.rbegin(); rit != d.rend(); ++rit) {
-		ss << (int)*rit;
-	}
-	return ostr << ss.str();
-}
-// forward reference
-void sub(decimal& lhs, const decimal& rhs);
-
-bool less(const decimal& lhs, const decimal& rhs) {
-	// this logic assumes that there is no padding in the operands
-	size_t l = lhs.size();
-	size_t r = rhs.size();
-	if (l < r) return true;
-	if (l > r) return false;
-	// numbers are the same size, need to compare magnitude
-	decimal::const_reverse_iterator ritl = lhs.rbegin();
-	decimal::const_reverse_iterator ritr = rhs.rbegin();
-	for (; ritl != lhs.rend() || ritr != rhs.rend(); ++ritl, ++ritr) {
-		if (*ritl < *ritr) return true;
-		if (*ritl > *ritr) return false;
-		// if the digits are equal we need to check the next set
-	}
-	// at this point we know the two operands are the same
-	return false;
-}
-void add(decimal& lhs, const decimal& rhs) {
-	decimal _rhs(rhs);   // is this copy necessary? I introduced it to have a place to pad
-	if (lhs.sign != rhs.sign) {  // different signs
-		_rhs.sign = !rhs.sign;
-		return sub(lhs, _rhs);
-	}
-	else {
-		// same sign implies this->negative is invariant
-	}
-	size_t l = lhs.size();
-	size_t r = _rhs.size();
-	// zero pad the shorter decimal
-	if (l < r) {
-		lhs.insert(lhs.end(), r - l, 0);
-	}
-	else {
-		_rhs.insert(_rhs.end(), l - r, 0);
-	}
-	decimal::iterator lit = lhs.begin();
-	decimal::iterator rit = _rhs.begin();
-	char carry = 0;
-	for (; lit != lhs.end() || rit != _rhs.end(); ++lit, ++rit) {
-		*lit += *rit + carry;
-		if (*lit > 9) {
-			carry = 1;
-			*lit -= 10;
-		}
-		else {
-			carry = 0;
-		}
-	}
-	if (carry) lhs.push_back(1);
-}
-void sub(decimal& lhs, const decimal& rhs) {
-	decimal _rhs(rhs);   // is this copy necessary? I introduced it to have a place to pad
-	bool sign = lhs.sign;
-	if (lhs.sign != rhs.sign) {
-		_rhs.sign = !rhs.sign;
-		return add(lhs, _rhs);
-	}
-	// largest value must be subtracted from
-	size_t l = lhs.size();
-	size_t r = _rhs.size();
-	// zero pad the shorter decimal
-	if (l < r) {
-		lhs.insert(lhs.end(), r - l, 0);
-		std::swap(lhs, _rhs);
-		sign = !sign;
-	}
-	else if (r < l) {
-		_rhs.insert(_rhs.end(), l - r, 0);
-	}
-	else {
-		// the operands are the same size, thus we need to check their magnitude
-		if (less(lhs, _rhs)) {
-			std::swap(lhs, _rhs);
-			sign = !sign;
-		}
-	}
-	decimal::iterator lit = lhs.begin();
-	decimal::iterator rit = _rhs.begin();
-	char borrow = 0;
-	for (; lit != lhs.end() || rit != _rhs.end(); ++lit, ++rit) {
-		if (*rit > *lit - borrow) {
-			*lit = 10 + *lit - borrow - *rit;
-			borrow = 1;
-		}
-		else {
-			*lit = *lit - borrow - *rit;
-			borrow = 0;
-		}
-	}
-	if (borrow) std::cout << "can this happen?" << std::endl;
-	lhs.unpad();
-	lhs.sign = sign;
-}
-void mul(decimal& lhs, const decimal& rhs) {
-	bool signOfFinalResult = (lhs.sign != rhs.sign) ? true : false;
-	decimal product;
-	// find the smallest decimal to minimize the amount of work
-	size_t l = lhs.size();
-	size_t r = rhs.size();
-	decimal::const_iterator sit, bit; // sit = smallest iterator, bit = biggest iterator
-	if (l < r) {
-		size_t position = 0;
-		for (sit = lhs.begin(); sit != lhs.end(); ++sit) {
-			decimal partial_sum;
-			partial_sum.insert(partial_sum.end(), r + position, 0);
-			decimal::iterator pit = partial_sum.begin() + position;
-			char carry = 0;
-			for (bit = rhs.begin(); bit != rhs.end() || pit != partial_sum.end(); ++bit, ++pit) {
-				char digit = *sit * *bit + carry;
-				*pit = digit % 10;
-				carry = digit / 10;
-			}
-			if (carry) partial_sum.push_back(carry);
-			add(product, partial_sum);
-//			std::cout << "partial sum " << partial_sum << " intermediate product " << product << std::endl;
-			++position;
-		}
-	}
-	else {
-		size_t position = 0;
-		for (sit = rhs.begin(); sit != rhs.end(); ++sit) {
-			decimal partial_sum;
-			partial_sum.insert(partial_sum.end(), l + position, 0);
-			decimal::iterator pit = partial_sum.begin() + position;
-			char carry = 0;
-			for (bit = lhs.begin(); bit != lhs.end() || pit != partial_sum.end(); ++bit, ++pit) {
-				char digit = *sit * *bit + carry;
-				*pit = digit % 10;
-				carry = digit / 10;
-			}
-			if (carry) partial_sum.push_back(carry);
-			add(product, partial_sum);
-//			std::cout << "partial sum " << partial_sum << " intermediate product " << product << std::endl;
-			++position;
-		}
-	}
-	product.unpad();
-	product.sign = signOfFinalResult;
-	lhs = product;
-}
-
-} // namespace impl
-
 ////////////////////////    INTEGER functions   /////////////////////////////////
 
 template<size_t nbits, typename BlockType>
@@ -927,27 +755,10 @@ inline integer<nbits, BlockType> twos_complement(const integer<nbits, BlockType>
 // convert integer to decimal string
 template<size_t nbits, typename BlockType>
 std::string convert_to_decimal_string(const integer<nbits, BlockType>& value) {
-	if (value.iszero()) {
-		return std::string("0");
-	}
-	integer<nbits, BlockType> number = value.sign() ? twos_complement(value) : value;
-	impl::decimal partial, multiplier;
-	partial.push_back(0); partial.sign = false;
-	multiplier.push_back(1); multiplier.sign = false;
-	// convert integer to decimal by adding and doubling multipliers
-	for (unsigned i = 0; i < nbits; ++i) {
-		if (number.at(i)) {
-			impl::add(partial, multiplier);
-			// std::cout << partial << std::endl;
-		}
-		impl::add(multiplier, multiplier);
-	}
-	std::stringstream ss;
-	if (value.sign()) ss << '-';
-	for (impl::decimal::const_reverse_iterator rit = partial.rbegin(); rit != partial.rend(); ++rit) {
-		ss << (int)*rit;
-	}
-	return ss.str();
+	// nbits log10(2) digits, rounded up, and a sign
+	char digits[nbits * 30103 / 100000 + 3];
+	std::to_chars_result r = to_chars(digits, digits + sizeof(digits), value);
+	return std::string(digits, r.ptr);
 }
 
 // findMsb takes an integer<nbits, BlockType> reference and returns the position of the most significant bit, -1 if v == 0
@@ -1166,22 +977,15 @@ bool parse(const std::string& number, integer<nbits, BlockType>& value) {
 	}
 	else if (std::regex_match(number, decimal_regex)) {
 		//std::cout << "found a decimal integer representation\n";
-		integer<nbits, BlockType> scale = 1;
-		for (std::string::const_reverse_iterator r = number.rbegin();
-			r != number.rend();
-			++r) {
-			if (*r == '-') {
-				value = -value;
-			}
-			else if (*r == '+') {
-				break;
-			}
-			else {
-				integer<nbits, BlockType> digit = charLookup.at(*r);
-				value += scale * digit;
-				scale *= 10;
-			}
-		}
+		// the signs apply from the digits outward up to the first '+'
+		size_t nrSigns = number.find_first_not_of("-+");
+		bool negative = false;
+		for (size_t i = nrSigns; i > 0 && number[i - 1] == '-'; --i) negative = !negative;
+		const char* digits = number.data() + nrSigns;
+		const char* last = number.data() + number.size();
+		// from_chars reads the '-' next to the digits, so that the most negative value parses
+		std::from_chars_result r = from_chars(negative ? digits - 1 : digits, last, value);
+		if (r.ec != std::errc() || r.ptr != last) return false;
 		bSuccess = true;
 	}
 
@@ -1480,3 +1284,5 @@ inline integer<nbits, BlockType> operator^(const long long lhs, const integer<nb
 
 } // namespace unum
 } // namespace sw
+
+#include "./integer_charconv.hpp"
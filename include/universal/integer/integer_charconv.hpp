@@ -0,0 +1,608 @@
+#pragma once
+// integer_charconv.hpp: subquadratic radix conversion of arbitrary integers to and from character strings
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <algorithm>
+#include <array>
+#include <charconv>       // std::to_chars_result, std::from_chars_result
+#include <cstdint>
+#include <mutex>          // std::call_once
+#include <system_error>
+#include "./integer.hpp"
+
+namespace sw { namespace unum {
+
+// to_chars/from_chars convert in the bases 2 to 36 like their std:: counterparts for the native integers:
+// lowercase digits without a prefix, an optional '-' and no '+', and result_out_of_range for a number that
+// does not fit integer<nbits>, which then is left unmodified.
+//
+// Power of two bases map groups of bits to digits in linear time. The other bases work in chunks of c digits,
+// with C = base^c the largest power of the base below 2^32. Values of up to radix_basecase_limbs limbs
+// convert by repeated division or multiplication by C. Larger values divide and conquer over the powers
+// C^(2^i): to_chars splits a value into quotient and remainder by the power of about half its size, and
+// from_chars joins the values of the two halves of the digits with a product by the power. With a Karatsuba
+// product and Barrett division by a reciprocal of the power the conversion costs O(M(n) log n) instead of O(n^2).
+//
+// Neither direction allocates. The limbs of a conversion live in a std::array of O(nbits/32) limbs on the
+// stack, and integer<nbits> has a static table per base of the powers and their reciprocals, computed once
+// by the first conversion in that base. operator<< and parse() of integer.hpp convert through here.
+
+namespace impl {
+
+constexpr size_t radix_basecase_limbs = 32;    // the largest value that converts by repeated division by C
+constexpr size_t radix_karatsuba_limbs = 32;   // the smallest operand that the product splits
+constexpr size_t radix_max_levels = 64;        // the powers C^(2^i) of a table
+
+// the chunk C of every base carries more than 27 bits, 24^6 is the smallest, so a value of k chunks has less
+// than nbits / 27 + 1 chunks when it fits integer<nbits>
+constexpr size_t radix_chunk_bits = 27;
+constexpr size_t radix_max_chunks(size_t nbits) { return nbits / radix_chunk_bits + 3; }
+
+inline bool is_power_of_two_base(int base) { return (base & (base - 1)) == 0; }
+
+inline char radix_digit(uint32_t d) { return char(d < 10 ? '0' + d : 'a' + (d - 10)); }
+
+// the value of a digit character, 36 for a character that is not a digit in any base
+inline uint32_t radix_value(char ch) {
+	if (ch >= '0' && ch <= '9') return uint32_t(ch - '0');
+	if (ch >= 'a' && ch <= 'z') return uint32_t(ch - 'a') + 10;
+	if (ch >= 'A' && ch <= 'Z') return uint32_t(ch - 'A') + 10;
+	return 36;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// kernels on little-endian arrays of 32-bit limbs
+
+inline size_t radix_trim(const uint32_t* a, size_t n) {
+	while (n > 0 && a[n - 1] == 0) --n;
+	return n;
+}
+
+inline size_t radix_bit_length(const uint32_t* a, size_t n) {
+	if (n == 0) return 0;
+	size_t bits = 32 * (n - 1);
+	for (uint32_t top = a[n - 1]; top; top >>= 1) ++bits;
+	return bits;
+}
+
+// compare trimmed arrays
+inline int radix_compare(const uint32_t* a, size_t na, const uint32_t* b, size_t nb) {
+	if (na != nb) return (na < nb ? -1 : 1);
+	for (size_t i = na; i > 0; --i) {
+		if (a[i - 1] != b[i - 1]) return (a[i - 1] < b[i - 1] ? -1 : 1);
+	}
+	return 0;
+}
+
+// a[0, na) += b[0, nb) for nb <= na, returns the carry out of a
+inline uint32_t radix_add(uint32_t* a, size_t na, const uint32_t* b, size_t nb) {
+	uint64_t carry = 0;
+	size_t i = 0;
+	for (; i < nb; ++i) {
+		carry += uint64_t(a[i]) + b[i];
+		a[i] = uint32_t(carry);
+		carry >>= 32;
+	}
+	for (; carry && i < na; ++i) {
+		carry += a[i];
+		a[i] = uint32_t(carry);
+		carry >>= 32;
+	}
+	return uint32_t(carry);
+}
+
+// a[0, na) -= b[0, nb) modulo 2^(32 na) for nb <= na
+inline void radix_sub(uint32_t* a, size_t na, const uint32_t* b, size_t nb) {
+	uint64_t borrow = 0;
+	size_t i = 0;
+	for (; i < nb; ++i) {
+		uint64_t d = uint64_t(a[i]) - b[i] - borrow;
+		a[i] = uint32_t(d);
+		borrow = (d >> 63);
+	}
+	for (; borrow && i < na; ++i) {
+		uint64_t d = uint64_t(a[i]) - borrow;
+		a[i] = uint32_t(d);
+		borrow = (d >> 63);
+	}
+}
+
+// a[0, n) /= d on a trimmed array, returns the remainder and trims n
+inline uint32_t radix_divide(uint32_t* a, size_t& n, uint32_t d) {
+	uint64_t r = 0;
+	for (size_t i = n; i > 0; --i) {
+		uint64_t t = (r << 32) | a[i - 1];
+		a[i - 1] = uint32_t(t / d);
+		r = t % d;
+	}
+	while (n > 0 && a[n - 1] == 0) --n;
+	return uint32_t(r);
+}
+
+// a[0, n) = a * m + d on a trimmed array with room for one more limb
+inline void radix_multiply_add(uint32_t* a, size_t& n, uint32_t m, uint32_t d) {
+	uint64_t carry = d;
+	for (size_t i = 0; i < n; ++i) {
+		uint64_t t = uint64_t(a[i]) * m + carry;
+		a[i] = uint32_t(t);
+		carry = (t >> 32);
+	}
+	if (carry) a[n++] = uint32_t(carry);
+}
+
+// r[0, na + nb) = a[0, na) * b[0, nb)
+inline void radix_mul_basecase(uint32_t* r, const uint32_t* a, size_t na, const uint32_t* b, size_t nb) {
+	std::fill(r, r + na + nb, 0u);
+	for (size_t j = 0; j < nb; ++j) {
+		uint64_t carry = 0;
+		for (size_t i = 0; i < na; ++i) {
+			carry += uint64_t(a[i]) * b[j] + r[i + j];
+			r[i + j] = uint32_t(carry);
+			carry >>= 32;
+		}
+		r[na + j] = uint32_t(carry);
+	}
+}
+
+// the scratch limbs of radix_mul for operands of at most n limbs
+constexpr size_t radix_mul_scratch(size_t n) {
+	return n < radix_karatsuba_limbs ? 0 : 4 * ((n + 1) / 2 + 1) + radix_mul_scratch((n + 1) / 2 + 1);
+}
+
+// r[0, na + nb) = a[0, na) * b[0, nb) with radix_mul_scratch(max(na, nb)) limbs at ws, r does not overlap a or b
+inline void radix_mul(uint32_t* r, const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* ws) {
+	if (na < nb) {
+		std::swap(a, b);
+		std::swap(na, nb);
+	}
+	if (nb < radix_karatsuba_limbs) {
+		radix_mul_basecase(r, a, na, b, nb);
+		return;
+	}
+	const size_t h = (na + 1) / 2;
+	if (nb <= h) {
+		// sum the products of b and the slices of a of its size
+		std::fill(r, r + na + nb, 0u);
+		for (size_t j = 0; j < na; j += nb) {
+			size_t n = std::min(nb, na - j);
+			radix_mul(ws, a + j, n, b, nb, ws + 2 * nb);
+			radix_add(r + j, na + nb - j, ws, n + nb);
+		}
+		return;
+	}
+	// a = a1 b^h + a0 and b = b1 b^h + b0, with a0 b1 + a1 b0 = (a0 + a1)(b0 + b1) - a0 b0 - a1 b1
+	radix_mul(r, a, h, b, h, ws);
+	radix_mul(r + 2 * h, a + h, na - h, b + h, nb - h, ws);
+	uint32_t* sa = ws;
+	uint32_t* sb = ws + (h + 1);
+	uint32_t* z = ws + 2 * (h + 1);
+	std::copy(a, a + h, sa);
+	sa[h] = radix_add(sa, h, a + h, na - h);
+	std::copy(b, b + h, sb);
+	sb[h] = radix_add(sb, h, b + h, nb - h);
+	radix_mul(z, sa, h + 1, sb, h + 1, ws + 4 * (h + 1));
+	radix_sub(z, 2 * h + 2, r, 2 * h);
+	radix_sub(z, 2 * h + 2, r + 2 * h, na + nb - 2 * h);
+	radix_add(r + h, na + nb - h, z, radix_trim(z, 2 * h + 2));
+}
+
+// q[0, nu - nv + 1) = u[0, nu) / v[0, nv) for a trimmed v of at least two limbs and nu >= nv,
+// by Knuth's algorithm D with nu + nv + 1 limbs at ws
+inline void radix_divide_basecase(uint32_t* q, const uint32_t* u, size_t nu, const uint32_t* v, size_t nv, uint32_t* ws) {
+	unsigned s = 0;
+	while (!(v[nv - 1] & (0x80000000u >> s))) ++s;
+	uint32_t* vn = ws;
+	uint32_t* un = ws + nv;
+	for (size_t i = nv - 1; i > 0; --i) vn[i] = (v[i] << s) | (s ? v[i - 1] >> (32 - s) : 0u);
+	vn[0] = v[0] << s;
+	un[nu] = (s ? u[nu - 1] >> (32 - s) : 0u);
+	for (size_t i = nu - 1; i > 0; --i) un[i] = (u[i] << s) | (s ? u[i - 1] >> (32 - s) : 0u);
+	un[0] = u[0] << s;
+	for (size_t j = nu - nv + 1; j-- > 0; ) {
+		uint64_t numerator = (uint64_t(un[j + nv]) << 32) | un[j + nv - 1];
+		uint64_t qhat = numerator / vn[nv - 1], rhat = numerator % vn[nv - 1];
+		while (qhat > 0xFFFFFFFFull || qhat * vn[nv - 2] > ((rhat << 32) | un[j + nv - 2])) {
+			--qhat;
+			rhat += vn[nv - 1];
+			if (rhat > 0xFFFFFFFFull) break;
+		}
+		// un[j, j + nv] -= qhat vn, and add vn back when that went negative
+		int64_t k = 0, t;
+		for (size_t i = 0; i < nv; ++i) {
+			uint64_t p = qhat * vn[i];
+			t = int64_t(un[i + j]) - k - int64_t(p & 0xFFFFFFFFull);
+			un[i + j] = uint32_t(t);
+			k = int64_t(p >> 32) - (t >> 32);
+		}
+		t = int64_t(un[j + nv]) - k;
+		un[j + nv] = uint32_t(t);
+		if (t < 0) {
+			--qhat;
+			uint64_t carry = 0;
+			for (size_t i = 0; i < nv; ++i) {
+				carry += uint64_t(un[i + j]) + vn[i];
+				un[i + j] = uint32_t(carry);
+				carry >>= 32;
+			}
+			un[j + nv] += uint32_t(carry);
+		}
+		q[j] = uint32_t(qhat);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// the powers of a base
+
+// the powers P(i) = C^(2^i) of the chunk C of a base up to the first one of more than valueChunks limbs, and
+// for the powers of at most valueLimbs limbs the reciprocals floor(b^(2n) / P(i)), b = 2^32, n the number
+// of limbs of P(i), for the Barrett division of values below P(i)^2
+struct radix_powers {
+	unsigned base;
+	uint32_t chunk;         // C = base^chunkDigits
+	unsigned chunkDigits;
+	size_t levels;          // the number of powers
+	size_t inverses;        // the number of reciprocals
+	const uint32_t* limbs;
+	size_t powerOffset[radix_max_levels];
+	size_t powerSize[radix_max_levels];
+	size_t reciprocalOffset[radix_max_levels];
+	size_t reciprocalSize[radix_max_levels];
+
+	const uint32_t* power(size_t i) const { return limbs + powerOffset[i]; }
+	const uint32_t* reciprocal(size_t i) const { return limbs + reciprocalOffset[i]; }
+};
+
+// the limbs of the powers and reciprocals, and the scratch limbs to compute them
+constexpr size_t radix_powers_limbs(size_t valueLimbs, size_t valueChunks) {
+	return 4 * valueChunks + 2 * valueLimbs + 4 * radix_max_levels;
+}
+constexpr size_t radix_powers_scratch(size_t valueLimbs, size_t valueChunks) {
+	return 6 * valueLimbs + 8 + radix_mul_scratch(valueChunks);
+}
+
+// compute the powers of a base into storage, with radix_powers_scratch limbs at ws
+inline void radix_powers_init(radix_powers& rp, unsigned base, size_t valueLimbs, size_t valueChunks, uint32_t* storage, uint32_t* ws) {
+	rp.base = base;
+	rp.chunk = base;
+	rp.chunkDigits = 1;
+	while (uint64_t(rp.chunk) * base <= 0xFFFFFFFFull) {
+		rp.chunk *= base;
+		++rp.chunkDigits;
+	}
+	rp.limbs = storage;
+	storage[0] = rp.chunk;
+	rp.powerOffset[0] = 0;
+	rp.powerSize[0] = 1;
+	rp.levels = 1;
+	size_t offset = 1;
+	while (rp.powerSize[rp.levels - 1] <= valueChunks) {
+		const size_t i = rp.levels++;
+		const size_t n = rp.powerSize[i - 1];
+		radix_mul(storage + offset, rp.power(i - 1), n, rp.power(i - 1), n, ws);
+		rp.powerOffset[i] = offset;
+		rp.powerSize[i] = radix_trim(storage + offset, 2 * n);
+		offset += rp.powerSize[i];
+	}
+	rp.inverses = 0;
+	while (rp.inverses < rp.levels && rp.powerSize[rp.inverses] <= valueLimbs) {
+		const size_t i = rp.inverses++;
+		const size_t n = rp.powerSize[i];
+		uint32_t* u = ws;
+		std::fill(u, u + 2 * n, 0u);
+		u[2 * n] = 1;
+		uint32_t* q = storage + offset;
+		size_t nq = 2 * n + 1;
+		if (n == 1) {
+			radix_divide(u, nq, rp.chunk);
+			std::copy(u, u + nq, q);
+		}
+		else {
+			radix_divide_basecase(q, u, 2 * n + 1, rp.power(i), n, u + 2 * n + 1);
+			nq = radix_trim(q, n + 2);
+		}
+		rp.reciprocalOffset[i] = offset;
+		rp.reciprocalSize[i] = nq;
+		offset += nq;
+	}
+}
+
+// the static tables of the powers of the bases for the conversions of integer<nbits>
+template<size_t nbits>
+struct radix_power_table {
+	static constexpr size_t valueLimbs = (nbits + 31) / 32;
+	static constexpr size_t valueChunks = radix_max_chunks(nbits);
+
+	radix_powers rp;
+	std::array<uint32_t, radix_powers_limbs(valueLimbs, valueChunks)> storage;
+
+	static const radix_powers& get(unsigned base) {
+		static radix_power_table tables[37];
+		static std::once_flag computed[37];
+		std::call_once(computed[base], [base]() {
+			std::array<uint32_t, radix_powers_scratch(valueLimbs, valueChunks)> ws;
+			radix_powers_init(tables[base].rp, base, valueLimbs, valueChunks, tables[base].storage.data(), ws.data());
+		});
+		return tables[base].rp;
+	}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// the conversions
+
+// q = x / P(i) and r = x % P(i) for x[0, nx) < P(i)^2. q has room for nx - n + 2 limbs and r for n + 2,
+// n the limbs of P(i), and ws for nx + 2 + radix_mul_scratch(n + 1)
+inline void radix_divmod(const uint32_t* x, size_t nx, const radix_powers& rp, size_t i, uint32_t* q, size_t& nq, uint32_t* r, size_t& nr, uint32_t* ws) {
+	const uint32_t* p = rp.power(i);
+	const size_t n = rp.powerSize[i];
+	if (radix_compare(x, nx, p, n) < 0) {
+		nq = 0;
+		std::copy(x, x + nx, r);
+		nr = nx;
+		return;
+	}
+	// q = floor(floor(x / b^(n-1)) * mu / b^(n+1)) is at most two below the quotient
+	const size_t n1 = nx - (n - 1), nm = rp.reciprocalSize[i];
+	radix_mul(ws, x + (n - 1), n1, rp.reciprocal(i), nm, ws + n1 + nm);
+	nq = (n1 + nm > n + 1 ? n1 + nm - (n + 1) : 0);
+	std::copy(ws + (n + 1), ws + (n + 1) + nq, q);
+	nq = radix_trim(q, nq);
+	// r = x - q P(i) < 3 P(i) fits n + 1 limbs
+	radix_mul(ws, q, nq, p, n, ws + nq + n);
+	const size_t m = std::min(nx, n + 1);
+	std::copy(x, x + m, r);
+	std::fill(r + m, r + n + 1, 0u);
+	radix_sub(r, n + 1, ws, std::min(nq + n, n + 1));
+	nr = radix_trim(r, n + 1);
+	while (radix_compare(r, nr, p, n) >= 0) {
+		radix_sub(r, nr, p, n);
+		nr = radix_trim(r, nr);
+		q[nq] = 0;
+		for (size_t j = 0; ++q[j] == 0; ++j) {}
+		nq = radix_trim(q, nq + 1);
+	}
+}
+
+// write the digits of a[0, n) right aligned in [out, out + width) with leading zeros, destroys a
+inline void radix_basecase_padded(uint32_t* a, size_t n, const radix_powers& rp, char* out, size_t width) {
+	char* p = out + width;
+	while (n > 0) {
+		uint32_t r = radix_divide(a, n, rp.chunk);
+		for (unsigned j = 0; j < rp.chunkDigits && p > out; ++j) {
+			*--p = radix_digit(r % rp.base);
+			r /= rp.base;
+		}
+	}
+	while (p > out) *--p = '0';
+}
+
+// write the digits of a[0, n), n <= radix_basecase_limbs, without leading zeros, destroys a.
+// Returns the end of the digits, nullptr when they do not fit [first, last).
+inline char* radix_basecase(uint32_t* a, size_t n, const radix_powers& rp, char* first, char* last) {
+	char digits[32 * radix_basecase_limbs + 32];
+	char* end = digits + sizeof(digits);
+	char* p = end;
+	do {
+		uint32_t r = radix_divide(a, n, rp.chunk);
+		for (unsigned j = 0; j < rp.chunkDigits; ++j) {
+			*--p = radix_digit(r % rp.base);
+			r /= rp.base;
+		}
+	} while (n > 0);
+	while (p + 1 < end && *p == '0') ++p;
+	if (last - first < end - p) return nullptr;
+	while (p < end) *first++ = *p++;
+	return first;
+}
+
+constexpr size_t radix_max(size_t a, size_t b) { return (a < b ? b : a); }
+
+// the scratch limbs of radix_to_chars_padded for a value below P(i)^2, of at most n = 2 s limbs,
+// s the limbs of P(i): its quotient and remainder, and either the Barrett division or the next level
+constexpr size_t radix_to_chars_padded_scratch(size_t n) {
+	return n <= radix_basecase_limbs ? 0 : n + 4 + radix_max(n + 2 + radix_mul_scratch(n / 2 + 1), radix_to_chars_padded_scratch(n / 2 + 1));
+}
+
+// write the digits of x[0, nx) < P(i)^2 right aligned in 2 c 2^i digits with leading zeros, destroys x
+inline void radix_to_chars_padded(uint32_t* x, size_t nx, const radix_powers& rp, size_t i, char* out, uint32_t* ws) {
+	const size_t width = (size_t(2) * rp.chunkDigits) << i;
+	if (nx <= radix_basecase_limbs) {
+		radix_basecase_padded(x, nx, rp, out, width);
+		return;
+	}
+	// x has more than radix_basecase_limbs limbs, so i > 0
+	const size_t n = rp.powerSize[i];
+	uint32_t* q = ws;
+	uint32_t* r = ws + (n + 2);
+	size_t nq, nr;
+	radix_divmod(x, nx, rp, i, q, nq, r, nr, ws + 2 * (n + 2));
+	radix_to_chars_padded(q, nq, rp, i - 1, out, ws + 2 * (n + 2));
+	radix_to_chars_padded(r, nr, rp, i - 1, out + width / 2, ws + 2 * (n + 2));
+}
+
+// the scratch limbs of radix_to_chars for a value of n limbs
+constexpr size_t radix_to_chars_scratch(size_t n) {
+	return n <= radix_basecase_limbs ? 0 : n + 4 + radix_max(radix_max(n + 2 + radix_mul_scratch(n + 1), radix_to_chars_scratch(n / 2 + 1)), radix_to_chars_padded_scratch(n + 1));
+}
+
+// write the digits of x[0, nx) without leading zeros, destroys x, with radix_to_chars_scratch(nx) limbs at ws.
+// Returns the end of the digits, nullptr when they do not fit [first, last).
+inline char* radix_to_chars(uint32_t* x, size_t nx, const radix_powers& rp, char* first, char* last, uint32_t* ws) {
+	if (nx <= radix_basecase_limbs) return radix_basecase(x, nx, rp, first, last);
+	// the largest power P(k) <= x, so that x < P(k + 1) = P(k)^2, and k > 0
+	size_t k = 0;
+	while (radix_compare(rp.power(k + 1), rp.powerSize[k + 1], x, nx) <= 0) ++k;
+	const size_t n = rp.powerSize[k];
+	uint32_t* q = ws;
+	uint32_t* r = ws + (nx - n + 2);
+	uint32_t* next = r + (n + 2);
+	size_t nq, nr;
+	radix_divmod(x, nx, rp, k, q, nq, r, nr, next);
+	first = radix_to_chars(q, nq, rp, first, last, next);
+	const size_t width = size_t(rp.chunkDigits) << k;
+	if (first == nullptr || size_t(last - first) < width) return nullptr;
+	radix_to_chars_padded(r, nr, rp, k - 1, first, next);
+	return first + width;
+}
+
+// the value of the n digits at s, for at most radix_basecase_limbs - 1 chunks, in a[] of as many limbs as chunks
+inline size_t radix_basecase_value(const char* s, size_t n, const radix_powers& rp, uint32_t* a) {
+	size_t size = 0;
+	size_t lead = n % rp.chunkDigits;
+	if (lead == 0) lead = rp.chunkDigits;
+	uint32_t scale = 1;
+	for (size_t j = 0; j < lead; ++j) scale *= rp.base;
+	while (n > 0) {
+		uint32_t chunk = 0;
+		for (size_t j = 0; j < lead; ++j) chunk = chunk * rp.base + radix_value(s[j]);
+		radix_multiply_add(a, size, scale, chunk);
+		s += lead;
+		n -= lead;
+		lead = rp.chunkDigits;
+		scale = rp.chunk;
+	}
+	return size;
+}
+
+// the scratch limbs of radix_from_chars for digits of the given number of chunks:
+// the values of both parts, and either their conversion or their product
+constexpr size_t radix_from_chars_scratch(size_t chunks) {
+	size_t low = 1;
+	while (2 * low < chunks) low *= 2;
+	return chunks < radix_basecase_limbs ? 0 : chunks + radix_max(radix_from_chars_scratch(low), radix_mul_scratch(low));
+}
+
+// the value of the n digits at s in a[] of as many limbs as the digits have chunks, with
+// radix_from_chars_scratch(chunks) limbs at ws. Returns the number of limbs of the value.
+inline size_t radix_from_chars(const char* s, size_t n, const radix_powers& rp, uint32_t* a, uint32_t* ws) {
+	if (n <= (radix_basecase_limbs - 1) * rp.chunkDigits) return radix_basecase_value(s, n, rp, a);
+	// the low part is the largest power of two of chunks below the number of chunks
+	const size_t chunks = (n + rp.chunkDigits - 1) / rp.chunkDigits;
+	size_t i = 0;
+	while ((size_t(2) << i) < chunks) ++i;
+	const size_t low = size_t(1) << i;
+	uint32_t* hi = ws;
+	uint32_t* lo = ws + (chunks - low);
+	uint32_t* next = lo + low;
+	const size_t nh = radix_from_chars(s, n - rp.chunkDigits * low, rp, hi, next);
+	const size_t nl = radix_from_chars(s + (n - rp.chunkDigits * low), rp.chunkDigits * low, rp, lo, next);
+	// a = hi P(i) + lo, with lo < P(i)
+	const size_t np = rp.powerSize[i];
+	radix_mul(a, hi, nh, rp.power(i), np, next);
+	radix_add(a, nh + np, lo, nl);
+	return radix_trim(a, nh + np);
+}
+
+// the bits [position, position + k) of an integer, k <= 8
+template<size_t nbits, typename BlockType>
+uint32_t radix_bits(const integer<nbits, BlockType>& v, size_t position, unsigned k) {
+	constexpr size_t nrBytes = integer<nbits, BlockType>::nrBytes;
+	size_t i = position / 8;
+	uint32_t w = (i < nrBytes ? v.byte(unsigned(i)) : 0u) | ((i + 1 < nrBytes ? uint32_t(v.byte(unsigned(i + 1))) : 0u) << 8);
+	return (w >> (position % 8)) & ((1u << k) - 1);
+}
+
+} // namespace impl
+
+// write value in the base into [first, last): an optional '-' and the digits without leading zeros,
+// { last, value_too_large } when they do not fit
+template<size_t nbits, typename BlockType>
+std::to_chars_result to_chars(char* first, char* last, const integer<nbits, BlockType>& value, int base) {
+	using Integer = integer<nbits, BlockType>;
+	using Table = impl::radix_power_table<nbits>;
+	using namespace impl;
+	if (base < 2 || base > 36) return { first, std::errc::invalid_argument };
+	// the negation of the most negative value is itself, and its bits are the magnitude 2^(nbits-1)
+	bool negative = value.sign();
+	Integer magnitude(negative ? -value : value);
+	if (negative) {
+		if (first == last) return { last, std::errc::value_too_large };
+		*first++ = '-';
+	}
+	char* end;
+	if (is_power_of_two_base(base)) {
+		size_t nrBits = size_t(findMsb(magnitude) + 1);
+		unsigned k = 0;
+		while ((1 << k) < base) ++k;
+		size_t nrDigits = (nrBits == 0 ? 1 : (nrBits + k - 1) / k);
+		if (size_t(last - first) < nrDigits) return { last, std::errc::value_too_large };
+		for (size_t d = nrDigits; d > 0; --d) *first++ = radix_digit(radix_bits(magnitude, (d - 1) * k, k));
+		end = first;
+	}
+	else {
+		// the limbs of the magnitude followed by the scratch of the conversion
+		constexpr size_t n = Table::valueLimbs;
+		std::array<uint32_t, n + radix_to_chars_scratch(n)> arena;
+		uint32_t* a = arena.data();
+		std::fill(a, a + n, 0u);
+		for (unsigned i = 0; i < Integer::nrBytes; ++i) a[i / 4] |= uint32_t(magnitude.byte(i)) << (8 * (i % 4));
+		end = radix_to_chars(a, radix_trim(a, n), Table::get(unsigned(base)), first, last, a + n);
+	}
+	if (end == nullptr) return { last, std::errc::value_too_large };
+	return { end, std::errc() };
+}
+
+// parse an optional '-' and the longest sequence of digits of the base at first into value
+template<size_t nbits, typename BlockType>
+std::from_chars_result from_chars(const char* first, const char* last, integer<nbits, BlockType>& value, int base) {
+	using Integer = integer<nbits, BlockType>;
+	using Table = impl::radix_power_table<nbits>;
+	using namespace impl;
+	if (base < 2 || base > 36) return { first, std::errc::invalid_argument };
+	const char* s = first;
+	bool negative = (s != last && *s == '-');
+	if (negative) ++s;
+	const char* digits = s;
+	while (s != last && radix_value(*s) < unsigned(base)) ++s;
+	if (s == digits) return { first, std::errc::invalid_argument };
+	while (digits + 1 < s && *digits == '0') ++digits;
+	const size_t n = size_t(s - digits);
+
+	Integer result;
+	size_t nrBits;
+	if (is_power_of_two_base(base)) {
+		unsigned k = 0;
+		while ((1 << k) < base) ++k;
+		nrBits = (n - 1) * k;
+		for (uint32_t lead = radix_value(*digits); lead; lead >>= 1) ++nrBits;
+		if (nrBits <= nbits) {
+			// collect the bits from the least significant digit on
+			uint32_t window = 0;
+			unsigned windowBits = 0, byteIndex = 0;
+			for (const char* p = s; p > digits; ) {
+				window |= radix_value(*--p) << windowBits;
+				windowBits += k;
+				for (; windowBits >= 8; windowBits -= 8, window >>= 8) {
+					if (byteIndex < Integer::nrBytes) result.setbyte(byteIndex++, uint8_t(window));
+				}
+			}
+			if (windowBits > 0 && byteIndex < Integer::nrBytes) result.setbyte(byteIndex, uint8_t(window));
+		}
+	}
+	else {
+		const radix_powers& rp = Table::get(unsigned(base));
+		const size_t chunks = (n + rp.chunkDigits - 1) / rp.chunkDigits;
+		if ((chunks - 1) * radix_chunk_bits >= nbits) {
+			// the value is at least C^(chunks - 1) > 2^nbits
+			nrBits = nbits + 1;
+		}
+		else {
+			// the limbs of the value followed by the scratch of the conversion
+			constexpr size_t m = Table::valueChunks;
+			std::array<uint32_t, m + radix_from_chars_scratch(m)> arena;
+			uint32_t* a = arena.data();
+			size_t size = radix_from_chars(digits, n, rp, a, a + m);
+			nrBits = radix_bit_length(a, size);
+			if (nrBits <= nbits) {
+				for (unsigned i = 0; i < Integer::nrBytes && i / 4 < size; ++i) result.setbyte(i, uint8_t(a[i / 4] >> (8 * (i % 4))));
+			}
+		}
+	}
+	// a magnitude of nbits bits only fits as the most negative value, the only nonzero value that is its own negation
+	if (nrBits > nbits || (nrBits == nbits && !(negative && -result == result))) return { s, std::errc::result_out_of_range };
+	value = (negative ? -result : result);
+	return { s, std::errc() };
+}
+
+}} // namespace sw::unum
@@ -5,6 +5,7 @@
 //
 // This file is part of the universal numbers project, which is released under an MIT Open Source license.
 #include <exception>
+#include <stdexcept>
 
 #if defined(__clang__)
 /* Clang/LLVM. ---------------------------------------------- */
@@ -48,6 +49,16 @@ struct integer_overflow : public std::runtime_error {
 	integer_overflow() : std::runtime_error("integer arithmetic overflow") {}
 };
 
+// modular arithmetic needs a positive modulus, odd for Montgomery arithmetic
+struct integer_invalid_modulus : public std::runtime_error {
+	integer_invalid_modulus() : std::runtime_error("invalid modulus for modular arithmetic") {}
+};
+
+// modular exponentiation needs a non-negative exponent
+struct integer_invalid_exponent : public std::runtime_error {
+	integer_invalid_exponent() : std::runtime_error("negative exponent in modular exponentiation") {}
+};
+
 ///////////////////////////////////////////////////////////////
 // internal implementation exceptions
 
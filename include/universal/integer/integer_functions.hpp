@@ -6,6 +6,7 @@
 // This file is part of the universal numbers project, which is released under an MIT Open Source license.
 #include <vector>
 #include "./integer_exceptions.hpp"
+#include "./modular.hpp"
 
 #if defined(__clang__)
 /* Clang/LLVM. ---------------------------------------------- */
@@ -42,17 +43,36 @@ namespace unum {
 
 	// exponentiation by squaring is the standard method for modular exponentiation of large numbers in asymmetric cryptography
 
-// calculate the integer power a ^ b using exponentiation by squaring
+// calculate the integer power a ^ b, b >= 0, using exponentiation by squaring on the limbs of the magnitude,
+// so that the products cost what the operands need rather than the width of the type.
+// The intermediate results are truncated to nbits, which yields the power modulo 2^nbits like the operators.
 template<size_t nbits, typename BlockType>
 integer<nbits, BlockType> ipow(const integer<nbits, BlockType>& a, const integer<nbits, BlockType>& b) {
-	integer<nbits, BlockType> result(1), base(a), exp(b);
-	for (;;) {
-		if (exp.isodd()) result *= base;
-		exp >>= 1;
-		if (exp == 0) break;
-		base *= base;
+	using namespace impl;
+	constexpr size_t nrLimbs = (nbits + 31) / 32;
+	bool negative;
+	limbs base = to_limbs(a, negative);
+	limbs exp = to_limbs(b);
+	limbs result(1, 1);
+	auto truncate = [](limbs& v) {
+#if INTEGER_THROW_ARITHMETIC_EXCEPTION
+		if (bit_length(v) > nbits - 1) throw integer_overflow();
+#endif // INTEGER_THROW_ARITHMETIC_EXCEPTION
+		if (v.size() > nrLimbs) v.resize(nrLimbs);
+		trim(v);
+	};
+	size_t bits = bit_length(exp);
+	for (size_t i = 0; i < bits; ++i) {
+		if (test_bit(exp, i)) {
+			result = karatsuba_mul(result, base);
+			truncate(result);
+		}
+		if (i + 1 == bits) break;
+		base = karatsuba_mul(base, base);
+		truncate(base);
 	}
-	return result;
+	integer<nbits, BlockType> r = from_limbs<nbits, BlockType>(result);
+	return (negative && test_bit(exp, 0) ? -r : r);
 }
 
 } // namespace unum
@@ -0,0 +1,686 @@
+#pragma once
+// modular.hpp: Montgomery and Barrett modular arithmetic and sliding-window modular exponentiation for arbitrary integers
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "./integer_exceptions.hpp"
+
+namespace sw { namespace unum {
+
+/*
+The generic operators of integer<nbits> divide and multiply bit by bit, so a modular exponentiation with a
+2048-bit modulus takes millions of bit-serial division steps. The kernels in this file work on the magnitude
+of the operands as little-endian 32-bit limbs with 64-bit products:
+
+  montgomery_context   odd moduli: Montgomery multiplication (CIOS) replaces the division by a shift
+  barrett_context      any modulus: reduction by a precomputed reciprocal, two multiplications per reduction
+  modexp(b, e, m)      sliding-window exponentiation, Montgomery for odd moduli and Barrett otherwise
+  mulmod(a, b, m)      a single modular product
+
+The contexts precompute everything that depends on the modulus only, so that a sequence of products
+with the same modulus, as in Miller-Rabin or Pollard rho, pays for it once. A context is not modified
+by its operations, and can be shared by threads.
+*/
+
+namespace impl {
+
+typedef std::vector<uint32_t> limbs;
+
+// magnitude of a non-negative integer as 32-bit limbs, least significant first, without leading zero limbs
+template<size_t nbits, typename BlockType>
+limbs to_limbs(const integer<nbits, BlockType>& a) {
+	constexpr unsigned nrBytes = integer<nbits, BlockType>::nrBytes;
+	limbs r((nrBytes + 3) / 4, 0);
+	for (unsigned i = 0; i < nrBytes; ++i) r[i / 4] |= uint32_t(a.byte(i)) << (8 * (i % 4));
+	while (!r.empty() && r.back() == 0) r.pop_back();
+	return r;
+}
+
+template<size_t nbits, typename BlockType>
+integer<nbits, BlockType> from_limbs(const limbs& a) {
+	integer<nbits, BlockType> r;
+	constexpr unsigned nrBytes = integer<nbits, BlockType>::nrBytes;
+	for (unsigned i = 0; i < nrBytes && i / 4 < a.size(); ++i) r.setbyte(i, uint8_t(a[i / 4] >> (8 * (i % 4))));
+	return r;
+}
+
+// a non-negative integer and its sign, so that negative operands reduce to m - (|a| mod m)
+template<size_t nbits, typename BlockType>
+limbs to_limbs(const integer<nbits, BlockType>& a, bool& negative) {
+	negative = a.sign();
+	return (negative ? to_limbs(-a) : to_limbs(a));
+}
+
+// a signed multiprecision value
+struct signed_limbs {
+	limbs magnitude;
+	bool  negative = false;
+};
+
+inline void trim(limbs& a) { while (!a.empty() && a.back() == 0) a.pop_back(); }
+
+inline size_t bit_length(const limbs& a) {
+	for (size_t i = a.size(); i > 0; --i) {
+		if (a[i - 1]) {
+			size_t bits = 32 * (i - 1);
+			for (uint32_t v = a[i - 1]; v; v >>= 1) ++bits;
+			return bits;
+		}
+	}
+	return 0;
+}
+
+inline bool test_bit(const limbs& a, size_t i) { return (i / 32 < a.size()) && ((a[i / 32] >> (i % 32)) & 1u); }
+
+// compare a[0..n) and b[0..n)
+inline int limb_compare(const uint32_t* a, const uint32_t* b, size_t n) {
+	for (size_t i = n; i > 0; --i) {
+		if (a[i - 1] != b[i - 1]) return (a[i - 1] < b[i - 1] ? -1 : 1);
+	}
+	return 0;
+}
+
+// compare two trimmed limb vectors
+inline int limb_compare(const limbs& a, const limbs& b) {
+	if (a.size() != b.size()) return (a.size() < b.size() ? -1 : 1);
+	return limb_compare(a.data(), b.data(), a.size());
+}
+
+// a[0..n) -= b[0..n), returns the borrow
+inline uint32_t limb_sub(uint32_t* a, const uint32_t* b, size_t n) {
+	uint64_t borrow = 0;
+	for (size_t i = 0; i < n; ++i) {
+		uint64_t d = uint64_t(a[i]) - b[i] - borrow;
+		a[i] = uint32_t(d);
+		borrow = (d >> 63);
+	}
+	return uint32_t(borrow);
+}
+
+// a[0..n) += b[0..n), returns the carry
+inline uint32_t limb_add(uint32_t* a, const uint32_t* b, size_t n) {
+	uint64_t carry = 0;
+	for (size_t i = 0; i < n; ++i) {
+		uint64_t s = uint64_t(a[i]) + b[i] + carry;
+		a[i] = uint32_t(s);
+		carry = (s >> 32);
+	}
+	return uint32_t(carry);
+}
+
+// schoolbook product of a and b, a.size() + b.size() limbs
+inline limbs limb_mul(const limbs& a, const limbs& b) {
+	limbs r(a.size() + b.size(), 0);
+	for (size_t i = 0; i < a.size(); ++i) {
+		uint64_t carry = 0, ai = a[i];
+		for (size_t j = 0; j < b.size(); ++j) {
+			uint64_t t = ai * b[j] + r[i + j] + carry;
+			r[i + j] = uint32_t(t);
+			carry = (t >> 32);
+		}
+		r[i + b.size()] = uint32_t(carry);
+	}
+	return r;
+}
+
+// a + b of two limb vectors of any length
+inline limbs add_magnitudes(const limbs& a, const limbs& b) {
+	const limbs& x = (a.size() >= b.size() ? a : b);
+	const limbs& y = (a.size() >= b.size() ? b : a);
+	limbs r(x.size() + 1, 0);
+	uint64_t carry = 0;
+	for (size_t i = 0; i < x.size(); ++i) {
+		uint64_t s = uint64_t(x[i]) + (i < y.size() ? y[i] : 0u) + carry;
+		r[i] = uint32_t(s);
+		carry = (s >> 32);
+	}
+	r[x.size()] = uint32_t(carry);
+	trim(r);
+	return r;
+}
+
+// a - b for a >= b
+inline limbs sub_magnitudes(const limbs& a, const limbs& b) {
+	limbs r(a);
+	uint64_t borrow = 0;
+	for (size_t i = 0; i < r.size(); ++i) {
+		uint64_t d = uint64_t(r[i]) - (i < b.size() ? b[i] : 0u) - borrow;
+		r[i] = uint32_t(d);
+		borrow = (d >> 63);
+	}
+	trim(r);
+	return r;
+}
+
+// a + b of two signed values
+inline signed_limbs signed_add(const signed_limbs& a, const signed_limbs& b) {
+	signed_limbs r;
+	if (a.negative == b.negative) {
+		r.magnitude = add_magnitudes(a.magnitude, b.magnitude);
+		r.negative = a.negative;
+	}
+	else if (limb_compare(a.magnitude, b.magnitude) >= 0) {
+		r.magnitude = sub_magnitudes(a.magnitude, b.magnitude);
+		r.negative = a.negative;
+	}
+	else {
+		r.magnitude = sub_magnitudes(b.magnitude, a.magnitude);
+		r.negative = b.negative;
+	}
+	if (r.magnitude.empty()) r.negative = false;
+	return r;
+}
+
+// r += b * 2^(32 offset), r has room for the sum
+inline void limb_add_at(limbs& r, const limbs& b, size_t offset) {
+	uint64_t carry = 0;
+	for (size_t i = 0; i < b.size(); ++i) {
+		uint64_t s = uint64_t(r[offset + i]) + b[i] + carry;
+		r[offset + i] = uint32_t(s);
+		carry = (s >> 32);
+	}
+	for (size_t k = offset + b.size(); carry; ++k) {
+		uint64_t s = uint64_t(r[k]) + carry;
+		r[k] = uint32_t(s);
+		carry = (s >> 32);
+	}
+}
+
+inline limbs mul_small(const limbs& a, uint32_t m) {
+	limbs r(a.size() + 1, 0);
+	uint64_t carry = 0;
+	for (size_t i = 0; i < a.size(); ++i) {
+		uint64_t t = uint64_t(a[i]) * m + carry;
+		r[i] = uint32_t(t);
+		carry = (t >> 32);
+	}
+	r[a.size()] = uint32_t(carry);
+	trim(r);
+	return r;
+}
+
+// a /= d, returns the remainder
+inline uint32_t div_small(limbs& a, uint32_t d) {
+	uint64_t r = 0;
+	for (size_t i = a.size(); i > 0; --i) {
+		uint64_t t = (r << 32) | a[i - 1];
+		a[i - 1] = uint32_t(t / d);
+		r = t % d;
+	}
+	trim(a);
+	return uint32_t(r);
+}
+
+// below this number of limbs the schoolbook product is faster than Karatsuba
+constexpr size_t karatsuba_threshold = 32;
+
+// trimmed product of a and b by Karatsuba's method: three half-size products instead of four.
+// An operand that is more than twice as long as the other is cut in pieces of the length of the shorter one.
+inline limbs karatsuba_mul(const limbs& a, const limbs& b) {
+	if (a.size() < b.size()) return karatsuba_mul(b, a);
+	const size_t na = a.size(), nb = b.size();
+	limbs r;
+	if (nb < karatsuba_threshold) {
+		r = limb_mul(a, b);
+	}
+	else if (2 * nb <= na) {
+		r.assign(na + nb, 0);
+		for (size_t offset = 0; offset < na; offset += nb) {
+			limbs piece(a.begin() + offset, a.begin() + std::min(na, offset + nb));
+			trim(piece);
+			limb_add_at(r, karatsuba_mul(piece, b), offset);
+		}
+	}
+	else {
+		// a = a1 2^(32h) + a0, b = b1 2^(32h) + b0 with nb > h
+		const size_t h = na / 2;
+		limbs a0(a.begin(), a.begin() + h), a1(a.begin() + h, a.end());
+		limbs b0(b.begin(), b.begin() + h), b1(b.begin() + h, b.end());
+		trim(a0); trim(b0);
+		limbs z0 = karatsuba_mul(a0, b0);
+		limbs z2 = karatsuba_mul(a1, b1);
+		limbs z1 = karatsuba_mul(add_magnitudes(a0, a1), add_magnitudes(b0, b1));
+		z1 = sub_magnitudes(sub_magnitudes(z1, z0), z2);
+		r.assign(na + nb, 0);
+		limb_add_at(r, z0, 0);
+		limb_add_at(r, z1, h);
+		limb_add_at(r, z2, 2 * h);
+	}
+	trim(r);
+	return r;
+}
+
+// quotient and remainder of a / m, m != 0, by Knuth's algorithm D: one quotient limb per step, estimated from the
+// leading limbs of the normalized operands and corrected at most twice
+inline void limb_divmod(const limbs& a, const limbs& m, limbs* quotient, limbs& remainder) {
+	limbs u(a), v(m);
+	trim(u); trim(v);
+	if (limb_compare(u, v) < 0) {
+		if (quotient) quotient->clear();
+		remainder.swap(u);
+		return;
+	}
+	const size_t n = v.size();
+	if (n == 1) {
+		uint32_t r = div_small(u, v[0]);
+		if (quotient) quotient->swap(u);
+		remainder.assign(r ? 1 : 0, r);
+		return;
+	}
+	const size_t k = u.size() - n;
+	// normalize so that the leading limb of the divisor has its top bit set
+	unsigned shift = 0;
+	while (!(v[n - 1] & (0x80000000u >> shift))) ++shift;
+	u.push_back(0);
+	if (shift) {
+		for (size_t i = n; i > 0; --i) v[i - 1] = (v[i - 1] << shift) | (i > 1 ? v[i - 2] >> (32 - shift) : 0u);
+		for (size_t i = u.size(); i > 0; --i) u[i - 1] = (u[i - 1] << shift) | (i > 1 ? u[i - 2] >> (32 - shift) : 0u);
+	}
+	limbs q(k + 1, 0);
+	const uint64_t base = uint64_t(1) << 32;
+	for (size_t j = k + 1; j > 0; --j) {
+		const size_t jj = j - 1;
+		uint64_t numerator = (uint64_t(u[jj + n]) << 32) | u[jj + n - 1];
+		uint64_t qhat = numerator / v[n - 1], rhat = numerator % v[n - 1];
+		while (qhat >= base || qhat * v[n - 2] > ((rhat << 32) | u[jj + n - 2])) {
+			--qhat;
+			rhat += v[n - 1];
+			if (rhat >= base) break;
+		}
+		// u[jj, jj + n] -= qhat * v
+		int64_t borrow = 0;
+		uint64_t carry = 0;
+		for (size_t i = 0; i < n; ++i) {
+			uint64_t p = qhat * v[i] + carry;
+			carry = (p >> 32);
+			int64_t t = int64_t(u[jj + i]) - borrow - int64_t(p & 0xffffffffull);
+			u[jj + i] = uint32_t(t);
+			borrow = (t < 0 ? 1 : 0);
+		}
+		int64_t t = int64_t(u[jj + n]) - borrow - int64_t(carry);
+		u[jj + n] = uint32_t(t);
+		if (t < 0) {
+			// the estimate was one too large: add the divisor back
+			--qhat;
+			carry = 0;
+			for (size_t i = 0; i < n; ++i) {
+				uint64_t s = uint64_t(u[jj + i]) + v[i] + carry;
+				u[jj + i] = uint32_t(s);
+				carry = (s >> 32);
+			}
+			u[jj + n] += uint32_t(carry);
+		}
+		q[jj] = uint32_t(qhat);
+	}
+	// the remainder is u[0, n) shifted back
+	limbs r(u.begin(), u.begin() + n);
+	if (shift) {
+		for (size_t i = 0; i < n; ++i) r[i] = (r[i] >> shift) | (i + 1 < n ? r[i + 1] << (32 - shift) : 0u);
+	}
+	trim(r);
+	remainder.swap(r);
+	if (quotient) {
+		trim(q);
+		quotient->swap(q);
+	}
+}
+
+// a mod m in exactly m.size() limbs
+inline limbs limb_mod(const limbs& a, const limbs& m) {
+	limbs r;
+	if (limb_compare(a, m) < 0) r = a;
+	else limb_divmod(a, m, nullptr, r);
+	r.resize(m.size(), 0);
+	return r;
+}
+
+// number of trailing zero bits of a non-zero limb vector
+inline size_t trailing_zeros(const limbs& a) {
+	size_t z = 0;
+	while (!test_bit(a, z)) ++z;
+	return z;
+}
+
+// a >>= s
+inline void shift_right(limbs& a, size_t s) {
+	size_t w = s / 32, bits = s % 32;
+	if (w) a.erase(a.begin(), a.begin() + std::min(w, a.size()));
+	if (bits) {
+		for (size_t i = 0; i < a.size(); ++i) {
+			a[i] = (a[i] >> bits) | (i + 1 < a.size() ? (a[i + 1] << (32 - bits)) : 0u);
+		}
+	}
+	trim(a);
+}
+
+// binary gcd of two limb vectors
+inline limbs limb_gcd(limbs a, limbs b) {
+	trim(a); trim(b);
+	if (a.empty()) return b;
+	if (b.empty()) return a;
+	size_t za = trailing_zeros(a), zb = trailing_zeros(b);
+	size_t shift = std::min(za, zb);
+	shift_right(a, za);
+	shift_right(b, zb);
+	// a and b are odd
+	while (!b.empty()) {
+		if (limb_compare(a, b) > 0) a.swap(b);
+		uint32_t borrow = limb_sub(b.data(), a.data(), a.size());
+		for (size_t i = a.size(); borrow && i < b.size(); ++i) borrow = (b[i]-- == 0);
+		trim(b);
+		if (!b.empty()) shift_right(b, trailing_zeros(b));
+	}
+	// a << shift
+	size_t w = shift / 32, bits = shift % 32;
+	limbs r(a.size() + w + 1, 0);
+	for (size_t i = 0; i < a.size(); ++i) {
+		r[i + w] |= a[i] << bits;
+		if (bits) r[i + w + 1] |= a[i] >> (32 - bits);
+	}
+	trim(r);
+	return r;
+}
+
+// width of the window of the sliding-window exponentiation for an exponent of the given number of bits
+inline unsigned exponent_window(size_t bits) {
+	if (bits <= 24) return 1;
+	if (bits <= 80) return 3;
+	if (bits <= 240) return 4;
+	if (bits <= 672) return 5;
+	return 6;
+}
+
+// g^e by left-to-right sliding-window exponentiation: mul(a, b, r) computes r = a * b in the arithmetic of the caller,
+// one is its multiplicative identity. The table holds the odd powers g, g^3, ..., g^(2^w - 1).
+template<typename Mul>
+limbs sliding_window_pow(const limbs& g, const limbs& e, const limbs& one, Mul&& mul) {
+	size_t bits = bit_length(e);
+	if (bits == 0) return one;
+	unsigned w = exponent_window(bits);
+	std::vector<limbs> table(size_t(1) << (w - 1));
+	table[0] = g;
+	if (table.size() > 1) {
+		limbs g2;
+		mul(g, g, g2);
+		for (size_t k = 1; k < table.size(); ++k) mul(table[k - 1], g2, table[k]);
+	}
+	limbs acc, tmp;
+	bool first = true;
+	size_t i = bits;
+	while (i > 0) {
+		if (!test_bit(e, i - 1)) {
+			mul(acc, acc, tmp); acc.swap(tmp);
+			--i;
+			continue;
+		}
+		// the window [l, i) starts and ends with a set bit
+		size_t l = (i > w ? i - w : 0);
+		while (!test_bit(e, l)) ++l;
+		size_t value = 0;
+		for (size_t k = i; k > l; --k) value = (value << 1) | (test_bit(e, k - 1) ? 1u : 0u);
+		if (first) {
+			acc = table[value >> 1];
+			first = false;
+		}
+		else {
+			for (size_t k = l; k < i; ++k) { mul(acc, acc, tmp); acc.swap(tmp); }
+			mul(acc, table[value >> 1], tmp); acc.swap(tmp);
+		}
+		i = l;
+	}
+	return acc;
+}
+
+} // namespace impl
+
+// Montgomery arithmetic modulo an odd modulus m > 1.
+// Residues in the Montgomery domain are a * R mod m with R = 2^(32n), n the number of limbs of m;
+// products of residues stay in the domain, so chains of multiplications convert only at their ends.
+template<size_t nbits, typename BlockType>
+class montgomery_context {
+public:
+	using Integer = integer<nbits, BlockType>;
+	typedef std::vector<uint32_t> residue;
+
+	explicit montgomery_context(const Integer& modulus) : m(modulus) {
+		if (modulus.sign() || modulus.iseven() || modulus.isone()) throw integer_invalid_modulus();
+		N = impl::to_limbs(modulus);
+		n = N.size();
+		// -N^-1 mod 2^32 by Newton's iteration, each step doubles the number of correct bits
+		uint32_t inv = 1;
+		for (int i = 0; i < 5; ++i) inv *= 2u - N[0] * inv;
+		nprime = uint32_t(0) - inv;
+		// R mod N and R^2 mod N by modular doubling
+		R1.assign(n, 0);
+		R1[0] = 1;
+		for (size_t i = 0; i < 32 * n; ++i) double_mod(R1);
+		R2 = R1;
+		for (size_t i = 0; i < 32 * n; ++i) double_mod(R2);
+	}
+
+	const Integer& modulus() const { return m; }
+	size_t size() const { return n; }
+
+	// conversion into and out of the Montgomery domain
+	residue to_montgomery(const Integer& a) const {
+		bool negative;
+		impl::limbs x = impl::limb_mod(impl::to_limbs(a, negative), N);
+		if (negative) x = negate(x);
+		residue r(n);
+		montmul(x.data(), R2.data(), r.data());
+		return r;
+	}
+	Integer from_montgomery(const residue& a) const {
+		residue one(n, 0), r(n);
+		one[0] = 1;
+		montmul(a.data(), one.data(), r.data());
+		return impl::from_limbs<nbits, BlockType>(r);
+	}
+	// the residue of 1
+	const residue& one() const { return R1; }
+
+	// r = a * b, a + b, a - b of residues; r may alias a or b
+	void mul(const residue& a, const residue& b, residue& r) const {
+		residue t(n);
+		montmul(a.data(), b.data(), t.data());
+		r.swap(t);
+	}
+	void add(const residue& a, const residue& b, residue& r) const {
+		residue t(a);
+		uint32_t carry = impl::limb_add(t.data(), b.data(), n);
+		if (carry || impl::limb_compare(t.data(), N.data(), n) >= 0) impl::limb_sub(t.data(), N.data(), n);
+		r.swap(t);
+	}
+	void sub(const residue& a, const residue& b, residue& r) const {
+		residue t(a);
+		if (impl::limb_sub(t.data(), b.data(), n)) impl::limb_add(t.data(), N.data(), n);
+		r.swap(t);
+	}
+	// base^exponent of a residue, exponent >= 0
+	residue pow(const residue& base, const impl::limbs& exponent) const {
+		residue t(n);
+		return impl::sliding_window_pow(base, exponent, R1, [&](const residue& a, const residue& b, residue& r) {
+			montmul(a.data(), b.data(), t.data());
+			r.assign(t.begin(), t.end());
+		});
+	}
+
+	// a * b mod m, base^exponent mod m of integers, the results are in [0, m)
+	Integer mul(const Integer& a, const Integer& b) const {
+		residue r;
+		mul(to_montgomery(a), to_montgomery(b), r);
+		return from_montgomery(r);
+	}
+	Integer pow(const Integer& base, const Integer& exponent) const {
+		if (exponent.sign()) throw integer_invalid_exponent();
+		return from_montgomery(pow(to_montgomery(base), impl::to_limbs(exponent)));
+	}
+
+	// t = a * b * R^-1 mod N by coarsely integrated operand scanning, t must not alias a or b
+	void montmul(const uint32_t* a, const uint32_t* b, uint32_t* t) const {
+		uint32_t hi = 0;   // t[n], the limb above the running result
+		std::fill(t, t + n, 0);
+		for (size_t i = 0; i < n; ++i) {
+			uint64_t bi = b[i], carry = 0;
+			for (size_t j = 0; j < n; ++j) {
+				uint64_t s = uint64_t(t[j]) + a[j] * bi + carry;
+				t[j] = uint32_t(s);
+				carry = (s >> 32);
+			}
+			uint64_t s = uint64_t(hi) + carry;
+			uint32_t top = uint32_t(s >> 32);
+			hi = uint32_t(s);
+			// add q * N so that the lowest limb vanishes, and shift down one limb
+			uint64_t q = uint32_t(t[0] * nprime);
+			carry = (uint64_t(t[0]) + q * N[0]) >> 32;
+			for (size_t j = 1; j < n; ++j) {
+				s = uint64_t(t[j]) + q * N[j] + carry;
+				t[j - 1] = uint32_t(s);
+				carry = (s >> 32);
+			}
+			s = uint64_t(hi) + carry;
+			t[n - 1] = uint32_t(s);
+			hi = top + uint32_t(s >> 32);
+		}
+		if (hi || impl::limb_compare(t, N.data(), n) >= 0) impl::limb_sub(t, N.data(), n);
+	}
+
+private:
+	Integer          m;
+	impl::limbs  N;      // modulus
+	size_t           n;      // number of limbs of the modulus
+	uint32_t         nprime; // -N^-1 mod 2^32
+	residue          R1;     // R mod N
+	residue          R2;     // R^2 mod N
+
+	void double_mod(impl::limbs& x) const {
+		uint32_t carry = impl::limb_add(x.data(), x.data(), n);
+		if (carry || impl::limb_compare(x.data(), N.data(), n) >= 0) impl::limb_sub(x.data(), N.data(), n);
+	}
+	impl::limbs negate(const impl::limbs& x) const {
+		impl::limbs r(N);
+		bool zero = std::all_of(x.begin(), x.end(), [](uint32_t v) { return v == 0; });
+		if (zero) return x;
+		impl::limb_sub(r.data(), x.data(), n);
+		return r;
+	}
+};
+
+// Barrett reduction modulo any modulus m > 0: x mod m = x - floor(x * mu / b^(2n)) * m, up to two corrections,
+// with the reciprocal mu = floor(b^(2n) / m), b = 2^32 and n the number of limbs of m
+template<size_t nbits, typename BlockType>
+class barrett_context {
+public:
+	using Integer = integer<nbits, BlockType>;
+
+	explicit barrett_context(const Integer& modulus) : m(modulus) {
+		if (modulus.sign() || modulus.iszero()) throw integer_invalid_modulus();
+		N = impl::to_limbs(modulus);
+		n = N.size();
+		impl::limbs b2n(2 * n + 1, 0);
+		b2n[2 * n] = 1;
+		impl::limbs remainder;
+		impl::limb_divmod(b2n, N, &mu, remainder);
+	}
+
+	const Integer& modulus() const { return m; }
+
+	// x mod m of a magnitude below b^(2n), the result has n limbs
+	impl::limbs reduce(const impl::limbs& x) const {
+		if (x.size() > 2 * n) return impl::limb_mod(x, N);
+		impl::limbs xx(x);
+		xx.resize(2 * n, 0);
+		// q = floor(floor(x / b^(n-1)) * mu / b^(n+1))
+		impl::limbs q1(xx.begin() + (n - 1), xx.end());
+		impl::limbs q2 = impl::limb_mul(q1, mu);
+		impl::limbs q3;
+		if (q2.size() > n + 1) q3.assign(q2.begin() + (n + 1), q2.end());
+		// r = (x - q * m) mod b^(n+1)
+		impl::limbs r(xx.begin(), xx.begin() + (n + 1));
+		impl::limbs qm(n + 1, 0);
+		for (size_t i = 0; i < q3.size() && i <= n; ++i) {
+			uint64_t carry = 0, qi = q3[i];
+			for (size_t j = 0; j < n && i + j <= n; ++j) {
+				uint64_t t = qi * N[j] + qm[i + j] + carry;
+				qm[i + j] = uint32_t(t);
+				carry = (t >> 32);
+			}
+			if (i + n <= n) qm[i + n] += uint32_t(carry);
+		}
+		impl::limb_sub(r.data(), qm.data(), n + 1);
+		impl::limbs m1(N);
+		m1.push_back(0);
+		while (impl::limb_compare(r.data(), m1.data(), n + 1) >= 0) impl::limb_sub(r.data(), m1.data(), n + 1);
+		r.resize(n);
+		return r;
+	}
+	// r = a * b mod m of reduced operands of n limbs; r may alias a or b
+	void mul(const impl::limbs& a, const impl::limbs& b, impl::limbs& r) const {
+		impl::limbs t = reduce(impl::limb_mul(a, b));
+		r.swap(t);
+	}
+	// the reduced magnitude of an integer, m - (|a| mod m) for negative a
+	impl::limbs residue(const Integer& a) const {
+		bool negative;
+		impl::limbs x = impl::to_limbs(a, negative);
+		impl::limbs r = (x.size() <= 2 * n ? reduce(x) : impl::limb_mod(x, N));
+		if (negative && !std::all_of(r.begin(), r.end(), [](uint32_t v) { return v == 0; })) {
+			impl::limbs t(N);
+			impl::limb_sub(t.data(), r.data(), n);
+			r.swap(t);
+		}
+		return r;
+	}
+
+	// a * b mod m, base^exponent mod m, the results are in [0, m)
+	Integer mul(const Integer& a, const Integer& b) const {
+		impl::limbs r;
+		mul(residue(a), residue(b), r);
+		return impl::from_limbs<nbits, BlockType>(r);
+	}
+	Integer pow(const Integer& base, const Integer& exponent) const {
+		if (exponent.sign()) throw integer_invalid_exponent();
+		impl::limbs one(n, 0);
+		one[0] = 1;
+		one = reduce(one);   // 1 mod 1 is 0
+		impl::limbs r = impl::sliding_window_pow(residue(base), impl::to_limbs(exponent), one,
+			[&](const impl::limbs& a, const impl::limbs& b, impl::limbs& p) { mul(a, b, p); });
+		return impl::from_limbs<nbits, BlockType>(r);
+	}
+
+private:
+	Integer          m;
+	impl::limbs  N;   // modulus
+	size_t           n;   // number of limbs of the modulus
+	impl::limbs  mu;  // floor(b^(2n) / N)
+};
+
+// base^exponent mod modulus, exponent >= 0 and modulus > 0: Montgomery arithmetic for odd moduli, Barrett reduction otherwise
+template<size_t nbits, typename BlockType>
+integer<nbits, BlockType> modexp(const integer<nbits, BlockType>& base, const integer<nbits, BlockType>& exponent, const integer<nbits, BlockType>& modulus) {
+	if (modulus.isodd() && !modulus.isone() && !modulus.sign()) return montgomery_context<nbits, BlockType>(modulus).pow(base, exponent);
+	return barrett_context<nbits, BlockType>(modulus).pow(base, exponent);
+}
+
+// a * b mod modulus, modulus > 0, the result is in [0, modulus)
+template<size_t nbits, typename BlockType>
+integer<nbits, BlockType> mulmod(const integer<nbits, BlockType>& a, const integer<nbits, BlockType>& b, const integer<nbits, BlockType>& modulus) {
+	if (modulus.sign() || modulus.iszero()) throw integer_invalid_modulus();
+	impl::limbs N = impl::to_limbs(modulus);
+	bool na, nb;
+	impl::limbs x = impl::limb_mod(impl::to_limbs(a, na), N);
+	impl::limbs y = impl::limb_mod(impl::to_limbs(b, nb), N);
+	impl::limbs r = impl::limb_mod(impl::limb_mul(x, y), N);
+	if (na != nb && !std::all_of(r.begin(), r.end(), [](uint32_t v) { return v == 0; })) {
+		impl::limbs t(N);
+		impl::limb_sub(t.data(), r.data(), N.size());
+		r.swap(t);
+	}
+	return impl::from_limbs<nbits, BlockType>(r);
+}
+
+}} // namespace sw::unum
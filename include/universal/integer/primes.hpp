@@ -4,8 +4,13 @@
 // Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
 //
 // This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <cstdint>
+#include <random>
 #include <vector>
 #include "./integer_exceptions.hpp"
+#include "./modular.hpp"
+#include "./product_tree.hpp"
+#include "./sieves.hpp"
 
 #if defined(__clang__)
 /* Clang/LLVM. ---------------------------------------------- */
@@ -112,53 +117,139 @@ template<class _Mt,
  least common multiple  lcm(a, b) = PROD p^max(a_p, b_p)
  */
 
-// calculate the greatest common divisor of two numbers
+// calculate the greatest common divisor of two numbers: binary gcd of the magnitudes
 template<size_t nbits, typename BlockType>
 integer<nbits, BlockType> gcd(const integer<nbits, BlockType>& a, const integer<nbits, BlockType>& b) {
-	return b.iszero() ? a : gcd(b, a % b);
+	using Arithmetic = sw::function::product_arithmetic< integer<nbits, BlockType> >;
+	return Arithmetic::to_scalar(Arithmetic::gcd(Arithmetic::from_scalar(a), Arithmetic::from_scalar(b)));
 }
 
-// calculate the greatest common divisor of N numbers
+// calculate the greatest common divisor of N numbers with a tree of gcds on nrThreads threads
 template<size_t nbits, typename BlockType>
-integer<nbits, BlockType> gcd(const std::vector< integer<nbits, BlockType> >& v) {
-	if (v.size() == 0) return 0;
-	if (v.size() == 1) return v[0];
-	integer<nbits, BlockType> gcd_n = v[0];
-	for (size_t i = 1; i < v.size(); ++i) {
-		gcd_n = gcd(gcd_n, v[i]);
-	}
-	return gcd_n;
+integer<nbits, BlockType> gcd(const std::vector< integer<nbits, BlockType> >& v, unsigned nrThreads = 1) {
+	return sw::function::findgcd(v, nrThreads);
 }
 
 // calculate the least common multiple of two numbers
 template<size_t nbits, typename BlockType>
 integer<nbits, BlockType> lcm(const integer<nbits, BlockType>& a, const integer<nbits, BlockType>& b) {
-	return (a * b) / gcd(a, b);
+	return sw::function::findlcm(std::vector< integer<nbits, BlockType> >{ a, b });
 }
 
-// calculate the least common multiple of N numbers
+// calculate the least common multiple of N numbers with a subproduct tree on nrThreads threads, 0 selects all hardware threads
 template<size_t nbits, typename BlockType>
-integer<nbits, BlockType> lcm(const std::vector< integer<nbits, BlockType> >& v) {
+integer<nbits, BlockType> lcm(const std::vector< integer<nbits, BlockType> >& v, unsigned nrThreads = 1) {
 	if (v.size() == 0) return 0;
-	if (v.size() == 1) return v[0];
-	integer<nbits, BlockType> lcm = v[0];
-	for (size_t i = 0; i < v.size(); ++i) {
-		lcm = (v[i] * lcm) / gcd(lcm, v[i]);
+	return sw::function::findlcm(v, nrThreads);
+}
+
+namespace impl {
+
+// the primes below 1000, for trial division before Miller-Rabin
+inline const std::vector<uint32_t>& small_primes() {
+	static const std::vector<uint32_t> primes = [] {
+		std::vector<uint32_t> p;
+		for (uint32_t c = 2; c < 1000; ++c) {
+			bool prime = true;
+			for (size_t i = 0; i < p.size() && p[i] * p[i] <= c && prime; ++i) prime = (c % p[i] != 0);
+			if (prime) p.push_back(c);
+		}
+		return p;
+	}();
+	return primes;
+}
+
+// a mod d of a limb vector and a small divisor
+inline uint32_t limb_mod_small(const limbs& a, uint32_t d) {
+	uint64_t r = 0;
+	for (size_t i = a.size(); i > 0; --i) r = ((r << 32) | a[i - 1]) % d;
+	return uint32_t(r);
+}
+
+// one Miller-Rabin round for n - 1 = d * 2^s with the witness a in the Montgomery domain of n: false when a proves n composite
+template<size_t nbits, typename BlockType>
+bool miller_rabin_round(const montgomery_context<nbits, BlockType>& ctx, const limbs& a, const limbs& d, size_t s, const limbs& minusOne) {
+	limbs x = ctx.pow(a, d);
+	if (x == ctx.one() || x == minusOne) return true;
+	for (size_t i = 1; i < s; ++i) {
+		ctx.mul(x, x, x);
+		if (x == minusOne) return true;
+		if (x == ctx.one()) return false;
 	}
-	return lcm;
+	return false;
+}
+
+} // namespace impl
+
+// Miller-Rabin primality test, preceded by trial division by the primes below 1000.
+// Below 3,317,044,064,679,887,385,961,981 the prime bases 2 to 37 make the test deterministic. Larger candidates
+// are tested with base 2 and reps - 1 pseudo-random bases from a generator seeded with seed, so that a composite
+// passes with a probability below 4^-reps.
+template<size_t nbits, typename BlockType>
+bool miller_rabin(const integer<nbits, BlockType>& n, unsigned reps = 25, uint64_t seed = 0) {
+	using namespace impl;
+	if (n.sign()) return false;
+	limbs N = to_limbs(n);
+	if (N.empty() || (N.size() == 1 && N[0] < 2)) return false;
+	for (uint32_t p : small_primes()) {
+		if (N.size() == 1 && N[0] == p) return true;
+		if (limb_mod_small(N, p) == 0) return false;
+	}
+	if (N.size() == 1 && N[0] < 1000000u) return true;   // no prime factor up to its square root
+
+	// n - 1 = d * 2^s with d odd
+	limbs d(N);
+	d[0] -= 1;   // n is odd
+	size_t s = trailing_zeros(d);
+	shift_right(d, s);
+
+	montgomery_context<nbits, BlockType> ctx(n);
+	limbs zero(ctx.size(), 0), minusOne;
+	ctx.sub(zero, ctx.one(), minusOne);
+
+	static const limbs deterministicBound = { 0x2410a5fdu, 0x51adc5b2u, 0x0002be69u };
+	if (limb_compare(N, deterministicBound) < 0) {
+		for (uint32_t a : { 2u, 3u, 5u, 7u, 11u, 13u, 17u, 19u, 23u, 29u, 31u, 37u }) {
+			if (!miller_rabin_round(ctx, ctx.to_montgomery(integer<nbits, BlockType>(a)), d, s, minusOne)) return false;
+		}
+		return true;
+	}
+	if (!miller_rabin_round(ctx, ctx.to_montgomery(integer<nbits, BlockType>(2)), d, s, minusOne)) return false;
+	// a uniformly distributed value in [0, n) is a uniformly distributed Montgomery residue, no conversion needed
+	std::mt19937_64 engine(seed);
+	for (unsigned r = 1; r < reps; ++r) {
+		limbs a(ctx.size() + 1);
+		for (uint32_t& limb : a) limb = uint32_t(engine());
+		trim(a);
+		a = limb_mod(a, N);
+		if (a == zero || a == ctx.one() || a == minusOne) { --r; continue; }
+		if (!miller_rabin_round(ctx, a, d, s, minusOne)) return false;
+	}
+	return true;
 }
 
 // check if a number is prime
 template<size_t nbits, typename BlockType>
 bool isPrime(const integer<nbits, BlockType>& a) {
-	if (a.iszero() || a == 1) return false; // smallest prime number is 2
-	for (integer<nbits, BlockType> i = 2; i < a / 2; ++i) if ((a % i) == 0) return false;
-	return true;
+	return miller_rabin(a);
 }
 
 // generate prime numbers in a range
+// ranges below 2^48 run through the segmented sieve, larger ones test each candidate with Miller-Rabin
 template<size_t nbits, typename BlockType>
 bool primeNumbersInRange(const integer<nbits, BlockType>& low, const integer<nbits, BlockType>& high, std::vector< integer<nbits, BlockType> >& primes) {
+	impl::limbs h = impl::to_limbs(high);
+	if (!high.sign() && impl::bit_length(h) <= 48) {
+		size_t before = primes.size();
+		uint64_t hi = (h.empty() ? 0 : h[0]) | (h.size() > 1 ? uint64_t(h[1]) << 32 : 0);
+		uint64_t lo = 0;
+		if (!low.sign()) {
+			impl::limbs l = impl::to_limbs(low);
+			lo = (l.empty() ? 0 : l[0]) | (l.size() > 1 ? uint64_t(l[1]) << 32 : 0);
+		}
+		segmented_sieve(lo, hi, primes);
+		return primes.size() > before;
+	}
 	bool bFound = false;
 	for (integer<nbits, BlockType> i = low; i < high; ++i) {
 		if (isPrime(i)) {
@@ -209,5 +300,57 @@ integer<nbits, BlockType> fermatFactorization(const integer<nbits, BlockType>& n
 	return a - sqrt(bsquare);
 }
 
+// Factorization using Pollard's rho method with Brent's cycle detection: returns a proper factor of number,
+// or 1 when number is prime or no factor was found within maxIterations steps of the iteration x -> x^2 + c.
+// The iteration runs in the Montgomery domain of number, and the differences x - y accumulate in a product
+// that takes one gcd with number per batch of 128 steps.
+template<size_t nbits, typename BlockType>
+integer<nbits, BlockType> pollardRhoFactorization(const integer<nbits, BlockType>& number, uint64_t maxIterations = (uint64_t(1) << 26)) {
+	using namespace impl;
+	using Integer = integer<nbits, BlockType>;
+	Integer one(1);
+	if (number.sign() || number <= Integer(3)) return one;
+	if (number.iseven()) return Integer(2);
+	if (miller_rabin(number)) return one;
+	montgomery_context<nbits, BlockType> ctx(number);
+	limbs N = to_limbs(number);
+	constexpr uint64_t batch = 128;
+	for (unsigned c = 1; c < 64; ++c) {
+		limbs cm = ctx.to_montgomery(Integer(c));
+		auto f = [&](limbs& y) {
+			ctx.mul(y, y, y);
+			ctx.add(y, cm, y);
+		};
+		limbs y = ctx.to_montgomery(Integer(2)), x, ys, q = ctx.one(), diff;
+		limbs g(1, 1);
+		uint64_t iterations = 0;
+		for (uint64_t r = 1; g == limbs(1, 1) && iterations < maxIterations; r *= 2) {
+			x = y;
+			for (uint64_t i = 0; i < r; ++i) f(y);
+			for (uint64_t k = 0; k < r && g == limbs(1, 1); k += batch) {
+				ys = y;
+				for (uint64_t i = 0; i < std::min(batch, r - k); ++i) {
+					f(y);
+					ctx.sub(x, y, diff);
+					ctx.mul(q, diff, q);
+				}
+				g = limb_gcd(q, N);
+				iterations += 2 * batch;
+			}
+		}
+		if (g == N) {
+			// the batch overshot the cycle: repeat its steps one gcd at a time
+			do {
+				f(ys);
+				ctx.sub(x, ys, diff);
+				g = limb_gcd(diff, N);
+			} while (g == limbs(1, 1));
+		}
+		if (g != limbs(1, 1) && g != N) return from_limbs<nbits, BlockType>(g);
+		if (iterations >= maxIterations) break;
+	}
+	return one;
+}
+
 } // namespace unum
 } // namespace sw
@@ -0,0 +1,100 @@
+#pragma once
+// product_tree.hpp: product trees, factorials, binomial coefficients, gcd and lcm of arbitrary integers on 32-bit limbs
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <cstdint>
+#include <vector>
+#include <universal/functions/product_tree.hpp>
+#include <universal/functions/factorial.hpp>
+#include <universal/functions/binomial.hpp>
+#include "./integer_exceptions.hpp"
+#include "./modular.hpp"
+
+namespace sw { namespace function {
+
+// The trees of integer<nbits> run on trimmed limb vectors: the generic operators of integer<nbits> cost the full
+// width of the type, independent of the magnitude of the operands, while the Karatsuba product of limb vectors
+// costs what the operands need. The result converts back once, and signals integer_overflow under
+// INTEGER_THROW_ARITHMETIC_EXCEPTION when it does not fit, like the arithmetic operators.
+template<size_t nbits, typename BlockType>
+struct product_arithmetic< sw::unum::integer<nbits, BlockType> > {
+	typedef sw::unum::integer<nbits, BlockType> Scalar;
+	typedef sw::unum::impl::signed_limbs value_type;
+	typedef sw::unum::impl::limbs limbs;
+
+	static value_type from_native(unsigned long long v) {
+		value_type r;
+		r.magnitude = { uint32_t(v), uint32_t(v >> 32) };
+		sw::unum::impl::trim(r.magnitude);
+		return r;
+	}
+	static value_type from_scalar(const Scalar& v) {
+		value_type r;
+		r.magnitude = sw::unum::impl::to_limbs(v, r.negative);
+		return r;
+	}
+	static Scalar to_scalar(const value_type& v) {
+#if INTEGER_THROW_ARITHMETIC_EXCEPTION
+		if (sw::unum::impl::bit_length(v.magnitude) > nbits - 1) throw sw::unum::integer_overflow();
+#endif // INTEGER_THROW_ARITHMETIC_EXCEPTION
+		Scalar r = sw::unum::impl::from_limbs<nbits, BlockType>(v.magnitude);
+		return (v.negative ? -r : r);
+	}
+	static bool iszero(const value_type& v) { return v.magnitude.empty(); }
+	static value_type add(const value_type& a, const value_type& b) { return sw::unum::impl::signed_add(a, b); }
+	static value_type subtract(const value_type& a, value_type b) {
+		b.negative = !b.negative && !b.magnitude.empty();
+		return sw::unum::impl::signed_add(a, b);
+	}
+	static value_type multiply(const value_type& a, const value_type& b) {
+		value_type r;
+		r.magnitude = sw::unum::impl::karatsuba_mul(a.magnitude, b.magnitude);
+		r.negative = (a.negative != b.negative) && !r.magnitude.empty();
+		return r;
+	}
+	static value_type divide_exact(const value_type& a, const value_type& b) {
+		value_type r;
+		limbs remainder;
+		sw::unum::impl::limb_divmod(a.magnitude, b.magnitude, &r.magnitude, remainder);
+		r.negative = (a.negative != b.negative) && !r.magnitude.empty();
+		return r;
+	}
+	static value_type gcd(const value_type& a, const value_type& b) {
+		value_type r;
+		r.magnitude = sw::unum::impl::limb_gcd(a.magnitude, b.magnitude);
+		return r;
+	}
+	static value_type power_of_two(unsigned long long k) {
+		value_type r;
+		r.magnitude.assign(size_t(k / 32) + 1, 0);
+		r.magnitude.back() = (1u << (k % 32));
+		return r;
+	}
+};
+
+}  // namespace function
+}  // namespace sw
+
+namespace sw { namespace unum {
+
+// n! of an arbitrary integer by binary splitting on nrThreads threads, 0 selects all hardware threads
+template<size_t nbits, typename BlockType = uint8_t>
+integer<nbits, BlockType> factorial(unsigned long long n, unsigned nrThreads = 1) {
+	return sw::function::binary_split_factorial< integer<nbits, BlockType> >(n, nrThreads);
+}
+
+// (n over k) of an arbitrary integer from its prime factorization on nrThreads threads
+template<size_t nbits, typename BlockType = uint8_t>
+integer<nbits, BlockType> binomial(unsigned long long n, unsigned long long k, unsigned nrThreads = 1) {
+	return sw::function::binomial_coefficient< integer<nbits, BlockType> >(n, k, nrThreads);
+}
+
+// product of a sequence of arbitrary integers by a product tree
+template<size_t nbits, typename BlockType>
+integer<nbits, BlockType> product(const std::vector< integer<nbits, BlockType> >& v, unsigned nrThreads = 1) {
+	return sw::function::product_tree(v, nrThreads);
+}
+
+}} // namespace sw::unum
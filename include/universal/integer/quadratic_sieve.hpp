@@ -0,0 +1,618 @@
+#pragma once
+// quadratic_sieve.hpp: self-initializing quadratic sieve factorization of arbitrary integers
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <random>
+#include <set>
+#include <vector>
+#include <universal/utility/parallel_for.hpp>
+#include "./integer_exceptions.hpp"
+#include "./modular.hpp"
+#include "./primes.hpp"
+#include "./sieves.hpp"
+
+namespace sw { namespace unum {
+
+/*
+Self-initializing quadratic sieve (SIQS)
+
+For a multiplier k and the polynomials Q(x) = (A x + b)^2 - kN = A g(x), g(x) = A x^2 + 2 b x + c, with
+A a product of s factor base primes close to sqrt(2kN)/M and b^2 = kN mod A, every x in [-M, M) with g(x)
+smooth over the factor base yields a relation (A x + b)^2 = A g(x) mod N. A fixed A has 2^(s-1) values of b,
+which the Gray code enumerates with one addition per prime to update the roots: the self-initialization.
+
+  factor base    primes p with (kN/p) = 1 below a bound chosen by the size of N, from the segmented sieve
+  sieving        byte logarithms on blocks of the interval that fit the L1 cache, the primes below 50 are
+                 not sieved and accounted for in the threshold
+  large primes   a cofactor below 64 times the largest factor base prime is kept as a partial relation;
+                 two partials with the same large prime combine into a full relation
+  threads        every thread sieves its own polynomials, the relations are merged under a lock
+  linear algebra dense Gaussian elimination over GF(2) with 64-bit words, each vector of the null space is
+                 a candidate congruence of squares X^2 = Y^2 mod N
+
+The multiprecision work runs on 32-bit limbs, see modular.hpp. The sieving time roughly quintuples every
+ten digits and scales with the number of threads. The dense elimination is sequential and needs about
+(factor base size)^3 / 64 word operations, a few seconds at 70 digits and minutes at 90 digits.
+*/
+
+// statistics of a quadratic sieve run
+struct quadratic_sieve_report {
+	unsigned multiplier = 1;        // Knuth-Schroeppel multiplier k
+	size_t   factorBaseSize = 0;
+	size_t   sieveInterval = 0;     // 2M
+	size_t   polynomials = 0;       // number of polynomials sieved
+	size_t   fullRelations = 0;     // relations found smooth
+	size_t   combinedRelations = 0; // relations combined from two partials
+	size_t   dependencies = 0;      // null space vectors tried
+	double   sieveSeconds = 0.0;
+	double   linearAlgebraSeconds = 0.0;
+};
+
+namespace impl {
+
+inline double log2_limbs(const limbs& a) {
+	if (a.empty()) return 0.0;
+	size_t n = a.size();
+	double top = double(a[n - 1]) * 4294967296.0 + (n > 1 ? double(a[n - 2]) : 0.0);
+	return std::log2(top) + 32.0 * double(n >= 2 ? n - 2 : 0) - (n >= 2 ? 0.0 : 32.0);
+}
+
+inline uint32_t mod_pow32(uint64_t b, uint64_t e, uint32_t p) {
+	uint64_t r = 1;
+	b %= p;
+	for (; e; e >>= 1) {
+		if (e & 1) r = r * b % p;
+		b = b * b % p;
+	}
+	return uint32_t(r);
+}
+
+inline uint32_t mod_inverse32(uint32_t a, uint32_t p) {
+	int64_t t = 0, newt = 1, r = p, newr = a % p;
+	while (newr) {
+		int64_t q = r / newr;
+		int64_t tmp = t - q * newt; t = newt; newt = tmp;
+		tmp = r - q * newr; r = newr; newr = tmp;
+	}
+	return uint32_t(t < 0 ? t + p : t);
+}
+
+// a square root of n modulo the odd prime p by Tonelli-Shanks, n a quadratic residue
+inline uint32_t sqrt_mod32(uint32_t n, uint32_t p) {
+	n %= p;
+	if (n == 0) return 0;
+	if (p % 4 == 3) return mod_pow32(n, (p + 1) / 4, p);
+	uint32_t q = p - 1, s = 0;
+	while ((q & 1) == 0) { q >>= 1; ++s; }
+	uint32_t z = 2;
+	while (mod_pow32(z, (p - 1) / 2, p) != p - 1) ++z;
+	uint64_t m = s, c = mod_pow32(z, q, p), t = mod_pow32(n, q, p), r = mod_pow32(n, (q + 1) / 2, p);
+	while (t != 1) {
+		uint64_t i = 0, tt = t;
+		while (tt != 1) { tt = tt * tt % p; ++i; }
+		uint64_t b = c;
+		for (uint64_t j = 0; j + 1 < m - i; ++j) b = b * b % p;
+		m = i;
+		c = b * b % p;
+		t = t * c % p;
+		r = r * b % p;
+	}
+	return uint32_t(r);
+}
+
+// floor of the e-th root of n by Newton's iteration from above
+inline limbs limb_root(const limbs& n, unsigned e) {
+	size_t bits = bit_length(n);
+	size_t rootBits = (bits + e - 1) / e;
+	limbs r(rootBits / 32 + 1, 0);
+	r[rootBits / 32] = (1u << (rootBits % 32));
+	trim(r);
+	for (;;) {
+		limbs t(1, 1);
+		for (unsigned i = 1; i < e; ++i) { t = limb_mul(t, r); trim(t); }
+		limbs q, remainder;
+		limb_divmod(n, t, &q, remainder);
+		limbs next = add_magnitudes(mul_small(r, e - 1), q);
+		div_small(next, e);
+		if (limb_compare(next, r) >= 0) return r;
+		r.swap(next);
+	}
+}
+
+// the root r when n = r^e for a prime e, an empty vector otherwise; n has no factor below 1000, so e < bits / 9
+inline limbs perfect_power_root(const limbs& n) {
+	size_t bits = bit_length(n);
+	for (uint32_t e : small_primes()) {
+		if (9 * size_t(e) > bits) break;
+		limbs r = limb_root(n, e);
+		limbs power(1, 1);
+		for (unsigned i = 0; i < e; ++i) { power = limb_mul(power, r); trim(power); }
+		if (power == n) return r;
+	}
+	return limbs();
+}
+
+// a relation Y^2 = (-1)^e0 * prod p_i * prod L_j^2 mod N: the factors hold indices into the factor base with repetition,
+// index 0 is -1, and the large primes of combined partial relations enter the square root once
+struct qs_relation {
+	limbs                 Y;
+	std::vector<uint32_t> factors;
+	std::vector<uint32_t> largePrimes;
+};
+
+// factor base sizes and sieve intervals by the number of decimal digits of kN
+inline void qs_parameters(double digits, size_t& factorBaseSize, size_t& interval) {
+	static const double table[][3] = {
+		{ 20,   120,  65536 }, { 30,   250,  65536 }, { 40,   600,  65536 }, { 50,  1400, 131072 },
+		{ 60,  3000, 196608 }, { 70,  6500, 262144 }, { 80, 12000, 393216 }, { 90, 24000, 524288 }
+	};
+	constexpr size_t rows = sizeof(table) / sizeof(table[0]);
+	if (digits <= table[0][0]) { factorBaseSize = size_t(table[0][1]); interval = size_t(table[0][2]); return; }
+	for (size_t i = 1; i < rows; ++i) {
+		if (digits <= table[i][0]) {
+			double f = (digits - table[i - 1][0]) / (table[i][0] - table[i - 1][0]);
+			factorBaseSize = size_t(table[i - 1][1] + f * (table[i][1] - table[i - 1][1]));
+			interval = size_t(table[i - 1][2]);
+			return;
+		}
+	}
+	factorBaseSize = size_t(table[rows - 1][1]);
+	interval = size_t(table[rows - 1][2]);
+}
+
+// Knuth-Schroeppel: the multiplier k that maximizes the expected contribution of the small primes to the smoothness of Q(x)
+inline unsigned qs_multiplier(const limbs& N, const std::vector<uint64_t>& primes) {
+	static const unsigned candidates[] = { 1, 3, 5, 7, 11, 13, 15, 17, 19, 21, 23, 29, 31, 33, 35, 37, 39, 41, 43, 47, 51, 53, 55, 57, 59, 61, 65, 67, 69, 71, 73 };
+	unsigned best = 1;
+	double bestScore = -1.0e300;
+	uint32_t n8 = N[0] & 7;
+	for (unsigned k : candidates) {
+		uint32_t kn8 = (n8 * k) & 7;
+		double score = -0.5 * std::log(double(k));
+		if (kn8 == 1) score += 2.0 * std::log(2.0);
+		else if (kn8 == 5) score += std::log(2.0);
+		else if (kn8 == 3 || kn8 == 7) score += 0.5 * std::log(2.0);
+		for (size_t i = 1; i < primes.size() && primes[i] < 2000; ++i) {
+			uint32_t p = uint32_t(primes[i]);
+			uint32_t knp = uint32_t(uint64_t(limb_mod_small(N, p)) * k % p);
+			if (knp == 0) score += std::log(double(p)) / double(p);
+			else if (mod_pow32(knp, (p - 1) / 2, p) == 1) score += 2.0 * std::log(double(p)) / double(p - 1);
+		}
+		if (score > bestScore) { bestScore = score; best = k; }
+	}
+	return best;
+}
+
+// the factor base of kN and the state shared by the sieving threads
+struct qs_context {
+	limbs N, kN;
+	unsigned k = 1;
+	std::vector<uint32_t> prime;     // prime[0] is the placeholder of -1
+	std::vector<uint32_t> root;      // sqrt(kN) mod p
+	std::vector<uint8_t>  logp;
+	size_t   smallPrimes = 1;        // the primes below this index are not sieved
+	size_t   M = 0;                  // the interval is [-M, M)
+	uint64_t largePrimeBound = 0;
+	unsigned threshold = 0;
+	size_t   target = 0;             // number of relations to collect
+	// the A factor selection
+	size_t   s = 0;
+	size_t   qLow = 0, qHigh = 0;    // index range of the candidate factors of A
+	double   log2TargetA = 0.0;
+
+	std::mutex guard;
+	std::vector<qs_relation> relations;
+	std::map<uint32_t, qs_relation> partials;
+	std::set<limbs> seen;
+	std::set< std::vector<uint32_t> > usedA;
+	std::atomic<bool> done{ false };
+	std::atomic<size_t> polynomials{ 0 };
+	size_t combined = 0;
+};
+
+// Y mod N of a signed value
+inline limbs qs_reduce(const signed_limbs& v, const limbs& N) {
+	limbs r = limb_mod(v.magnitude, N);
+	trim(r);
+	if (v.negative && !r.empty()) r = sub_magnitudes(N, r);
+	return r;
+}
+
+inline limbs qs_mulmod(const limbs& a, const limbs& b, const limbs& N) {
+	limbs r = limb_mod(limb_mul(a, b), N);
+	trim(r);
+	return r;
+}
+
+// record a smooth or partial relation
+inline void qs_add_relation(qs_context& ctx, qs_relation&& rel, uint32_t largePrime) {
+	std::lock_guard<std::mutex> lock(ctx.guard);
+	if (ctx.done) return;
+	if (largePrime == 1) {
+		if (!ctx.seen.insert(rel.Y).second) return;
+		ctx.relations.push_back(std::move(rel));
+	}
+	else {
+		auto it = ctx.partials.find(largePrime);
+		if (it == ctx.partials.end()) {
+			ctx.partials.emplace(largePrime, std::move(rel));
+			return;
+		}
+		if (it->second.Y == rel.Y) return;
+		qs_relation combined;
+		combined.Y = qs_mulmod(it->second.Y, rel.Y, ctx.N);
+		combined.factors = it->second.factors;
+		combined.factors.insert(combined.factors.end(), rel.factors.begin(), rel.factors.end());
+		combined.largePrimes.push_back(largePrime);
+		if (!ctx.seen.insert(combined.Y).second) return;
+		ctx.relations.push_back(std::move(combined));
+		++ctx.combined;
+	}
+	if (ctx.relations.size() >= ctx.target) ctx.done = true;
+}
+
+// sieve polynomials on one thread until enough relations have been collected
+inline void qs_sieve_thread(qs_context& ctx, unsigned threadId, uint64_t seed) {
+	const size_t fb = ctx.prime.size();
+	const size_t M = ctx.M;
+	constexpr size_t blockSize = 32768;
+	std::mt19937_64 engine(seed + 0x9e3779b97f4a7c15ull * (threadId + 1));
+	std::vector<uint8_t> sieve(blockSize);
+	std::vector<uint32_t> ainv(fb), soln1(fb), soln2(fb), next1(fb), next2(fb);
+	std::vector< std::vector<uint32_t> > Bainv2;
+	std::vector<uint8_t> isAFactor(fb, 0);
+	std::vector<limbs> B;
+
+	while (!ctx.done) {
+		// choose A = q_1 ... q_s close to sqrt(2kN)/M from the middle of the factor base
+		std::vector<uint32_t> q;
+		bool fresh = false;
+		for (int attempt = 0; attempt < 100 && !fresh; ++attempt) {
+			q.clear();
+			double log2A = 0.0;
+			std::uniform_int_distribution<size_t> pick(ctx.qLow, ctx.qHigh - 1);
+			while (q.size() + 1 < ctx.s) {
+				uint32_t i = uint32_t(pick(engine));
+				if (std::find(q.begin(), q.end(), i) != q.end()) continue;
+				q.push_back(i);
+				log2A += std::log2(double(ctx.prime[i]));
+			}
+			// the last factor brings A closest to its target
+			double want = std::exp2(ctx.log2TargetA - log2A);
+			uint32_t bestIndex = 0;
+			double bestDistance = 1.0e300;
+			for (uint32_t i = uint32_t(ctx.smallPrimes); i < fb; ++i) {
+				if (std::find(q.begin(), q.end(), i) != q.end() || ctx.root[i] == 0) continue;
+				double d = std::abs(double(ctx.prime[i]) - want);
+				if (d < bestDistance) { bestDistance = d; bestIndex = i; }
+			}
+			if (bestIndex == 0) continue;
+			q.push_back(bestIndex);
+			std::vector<uint32_t> key(q);
+			std::sort(key.begin(), key.end());
+			std::lock_guard<std::mutex> lock(ctx.guard);
+			fresh = ctx.usedA.insert(key).second;
+		}
+		if (!fresh) return;   // the factor base is too small to provide new polynomials
+		limbs A(1, 1);
+		for (uint32_t i : q) A = mul_small(A, ctx.prime[i]);
+		std::fill(isAFactor.begin(), isAFactor.end(), 0);
+		for (uint32_t i : q) isAFactor[i] = 1;
+
+		// B_l = (A / q_l) * gamma_l with gamma_l = t_l * (A / q_l)^-1 mod q_l, and b = sum B_l
+		const size_t s = q.size();
+		B.assign(s, limbs());
+		signed_limbs b;
+		for (size_t l = 0; l < s; ++l) {
+			uint32_t ql = ctx.prime[q[l]];
+			limbs Aq(A);
+			div_small(Aq, ql);
+			uint32_t gamma = uint32_t(uint64_t(ctx.root[q[l]]) * mod_inverse32(limb_mod_small(Aq, ql), ql) % ql);
+			if (gamma > ql / 2) gamma = ql - gamma;
+			B[l] = mul_small(Aq, gamma);
+			b.magnitude = add_magnitudes(b.magnitude, B[l]);
+		}
+		// the roots of the first polynomial and the Gray code increments 2 B_l A^-1 mod p
+		Bainv2.assign(s, std::vector<uint32_t>(fb, 0));
+		for (size_t i = 1; i < fb; ++i) {
+			uint32_t p = ctx.prime[i];
+			if (isAFactor[i]) continue;
+			uint32_t am = limb_mod_small(A, p);
+			ainv[i] = mod_inverse32(am, p);
+			for (size_t l = 0; l < s; ++l) Bainv2[l][i] = uint32_t(2ull * limb_mod_small(B[l], p) % p * ainv[i] % p);
+			uint32_t bm = limb_mod_small(b.magnitude, p);
+			if (b.negative && bm) bm = p - bm;
+			uint32_t t = ctx.root[i];
+			soln1[i] = uint32_t(uint64_t(ainv[i]) * ((t + p - bm) % p) % p);
+			soln2[i] = uint32_t(uint64_t(ainv[i]) * ((2ull * p - t - bm) % p) % p);
+		}
+
+		for (size_t poly = 0; poly < (size_t(1) << (s - 1)) && !ctx.done; ++poly) {
+			if (poly > 0) {
+				// Gray code: b += 2 e B_v, the roots move by -e * 2 B_v A^-1
+				size_t v = 0;
+				while (!((poly >> v) & 1)) ++v;
+				bool plus = (((poly >> (v + 1)) & 1) == 0) ? false : true;
+				signed_limbs twoB;
+				twoB.magnitude = mul_small(B[v], 2);
+				twoB.negative = !plus;
+				b = signed_add(b, twoB);
+				for (size_t i = 1; i < fb; ++i) {
+					if (isAFactor[i]) continue;
+					uint32_t p = ctx.prime[i], d = Bainv2[v][i];
+					if (plus) {
+						soln1[i] = (soln1[i] >= d ? soln1[i] - d : soln1[i] + p - d);
+						soln2[i] = (soln2[i] >= d ? soln2[i] - d : soln2[i] + p - d);
+					}
+					else {
+						soln1[i] = (soln1[i] + d) % p;
+						soln2[i] = (soln2[i] + d) % p;
+					}
+				}
+			}
+			++ctx.polynomials;
+			// c = (b^2 - kN) / A, negative since b < A < sqrt(kN)
+			signed_limbs c;
+			{
+				limbs b2 = limb_mul(b.magnitude, b.magnitude);
+				trim(b2);
+				signed_limbs diff = signed_add(signed_limbs{ b2, false }, signed_limbs{ ctx.kN, true });
+				limbs remainder;
+				limb_divmod(diff.magnitude, A, &c.magnitude, remainder);
+				c.negative = diff.negative && !c.magnitude.empty();
+				if (!remainder.empty()) break;   // b^2 != kN mod A, cannot happen for a correct Gray code
+			}
+			// offsets of the roots in the interval [0, 2M), index = x + M
+			for (size_t i = 1; i < fb; ++i) {
+				if (isAFactor[i]) continue;
+				uint32_t p = ctx.prime[i], mp = uint32_t(M % p);
+				next1[i] = (soln1[i] + mp) % p;
+				next2[i] = (soln2[i] + mp) % p;
+			}
+			for (size_t blockStart = 0; blockStart < 2 * M && !ctx.done; blockStart += blockSize) {
+				const size_t blockEnd = std::min(2 * M, blockStart + blockSize);
+				std::memset(sieve.data(), 0, blockSize);
+				for (size_t i = ctx.smallPrimes; i < fb; ++i) {
+					if (isAFactor[i]) continue;
+					const uint32_t p = ctx.prime[i];
+					const uint8_t lp = ctx.logp[i];
+					size_t r = next1[i];
+					for (; r < blockEnd; r += p) sieve[r - blockStart] += lp;
+					next1[i] = uint32_t(r);
+					if (ctx.root[i] != 0) {   // the primes dividing k have a single root
+						r = next2[i];
+						for (; r < blockEnd; r += p) sieve[r - blockStart] += lp;
+						next2[i] = uint32_t(r);
+					}
+				}
+				// the relative offsets stay below 2^32: roots start below p and advance past the block by less than p
+				for (size_t j = 0; j < blockEnd - blockStart; ++j) {
+					if (sieve[j] < ctx.threshold) continue;
+					int64_t x = int64_t(blockStart + j) - int64_t(M);
+					uint64_t ax = uint64_t(x < 0 ? -x : x);
+					// g(x) = A x^2 + 2 b x + c
+					signed_limbs g{ mul_small(mul_small(A, uint32_t(ax)), uint32_t(ax)), false };
+					signed_limbs bx{ mul_small(mul_small(b.magnitude, uint32_t(ax)), 2), b.negative != (x < 0) };
+					if (bx.magnitude.empty()) bx.negative = false;
+					g = signed_add(signed_add(g, bx), c);
+					if (g.magnitude.empty()) continue;
+					qs_relation rel;
+					if (g.negative) rel.factors.push_back(0);
+					for (uint32_t i : q) rel.factors.push_back(i);
+					limbs cofactor(g.magnitude);
+					size_t index = blockStart + j;
+					for (size_t i = 1; i < fb; ++i) {
+						uint32_t p = ctx.prime[i];
+						if (!isAFactor[i]) {
+							uint32_t rm = uint32_t(index % p), mp = uint32_t(M % p);
+							uint32_t r1 = (soln1[i] + mp) % p, r2 = (soln2[i] + mp) % p;
+							if (rm != r1 && rm != r2) continue;
+						}
+						else if (limb_mod_small(cofactor, p) != 0) {
+							continue;
+						}
+						for (;;) {
+							limbs t(cofactor);
+							if (div_small(t, p) != 0) break;
+							cofactor.swap(t);
+							rel.factors.push_back(uint32_t(i));
+						}
+					}
+					uint32_t largePrime = 0;
+					if (cofactor.size() == 1 && cofactor[0] == 1) largePrime = 1;
+					else if (cofactor.size() == 1 && cofactor[0] < ctx.largePrimeBound) largePrime = cofactor[0];
+					if (largePrime == 0) continue;
+					signed_limbs Y{ mul_small(A, uint32_t(ax)), x < 0 };
+					if (Y.magnitude.empty()) Y.negative = false;
+					rel.Y = qs_reduce(signed_add(Y, b), ctx.N);
+					qs_add_relation(ctx, std::move(rel), largePrime);
+				}
+			}
+		}
+	}
+}
+
+// the vectors of the null space of the relations modulo 2, by Gaussian elimination on the transposed matrix:
+// a row per factor base prime, a bit per relation
+inline std::vector< std::vector<size_t> > qs_null_space(const std::vector<qs_relation>& relations, size_t columns) {
+	const size_t R = relations.size();
+	const size_t words = (R + 63) / 64;
+	std::vector<uint64_t> matrix(columns * words, 0);
+	for (size_t r = 0; r < R; ++r) {
+		for (uint32_t f : relations[r].factors) matrix[f * words + r / 64] ^= (uint64_t(1) << (r % 64));
+	}
+	std::vector<size_t> pivotColumn;   // the relation of the pivot of each reduced row
+	std::vector<uint8_t> isPivot(R, 0);
+	size_t rank = 0;
+	for (size_t col = 0; col < R && rank < columns; ++col) {
+		const size_t w = col / 64;
+		const uint64_t bit = uint64_t(1) << (col % 64);
+		size_t pivot = rank;
+		while (pivot < columns && !(matrix[pivot * words + w] & bit)) ++pivot;
+		if (pivot == columns) continue;
+		if (pivot != rank) std::swap_ranges(matrix.begin() + pivot * words, matrix.begin() + (pivot + 1) * words, matrix.begin() + rank * words);
+		const uint64_t* prow = &matrix[rank * words];
+		for (size_t row = 0; row < columns; ++row) {
+			if (row == rank || !(matrix[row * words + w] & bit)) continue;
+			uint64_t* target = &matrix[row * words];
+			for (size_t k = 0; k < words; ++k) target[k] ^= prow[k];
+		}
+		pivotColumn.push_back(col);
+		isPivot[col] = 1;
+		++rank;
+	}
+	// every free relation combines with the pivot relations of the rows in which it appears
+	std::vector< std::vector<size_t> > dependencies;
+	for (size_t f = 0; f < R && dependencies.size() < 64; ++f) {
+		if (isPivot[f]) continue;
+		std::vector<size_t> dependency(1, f);
+		for (size_t row = 0; row < rank; ++row) {
+			if (matrix[row * words + f / 64] & (uint64_t(1) << (f % 64))) dependency.push_back(pivotColumn[row]);
+		}
+		dependencies.push_back(dependency);
+	}
+	return dependencies;
+}
+
+} // namespace impl
+
+// Factorization using the self-initializing quadratic sieve on nrThreads threads, 0 selects all hardware threads:
+// returns a proper factor of number, or 1 when number is prime or no factor was found.
+// Numbers below 2^64 and numbers with a factor below 1000 are delegated to trial division and Pollard rho,
+// a perfect power returns its root.
+template<size_t nbits, typename BlockType>
+integer<nbits, BlockType> quadraticSieveFactorization(const integer<nbits, BlockType>& number, unsigned nrThreads = 0, quadratic_sieve_report* report = nullptr, uint64_t seed = 0) {
+	using namespace impl;
+	using Integer = integer<nbits, BlockType>;
+	Integer one(1);
+	if (number.sign() || number <= Integer(3)) return one;
+	if (number.iseven()) return Integer(2);
+	if (miller_rabin(number)) return one;
+	limbs N = to_limbs(number);
+	for (uint32_t p : small_primes()) {
+		if (limb_mod_small(N, p) == 0) return Integer(p);
+	}
+	if (bit_length(N) <= 64) return pollardRhoFactorization(number);
+	limbs root = perfect_power_root(N);
+	if (!root.empty()) return from_limbs<nbits, BlockType>(root);
+
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	qs_context ctx;
+	ctx.N = N;
+	size_t factorBaseSize, interval;
+	{
+		std::vector<uint64_t> primes;
+		segmented_sieve(0, 2000, primes, 1);
+		ctx.k = qs_multiplier(N, primes);
+	}
+	ctx.kN = mul_small(N, ctx.k);
+	qs_parameters(log2_limbs(ctx.kN) * 0.30102999566398120, factorBaseSize, interval);
+	ctx.M = interval / 2;
+
+	// the factor base: -1, 2, and the odd primes p with (kN/p) = 1, or p | k
+	ctx.prime.push_back(0); ctx.root.push_back(0); ctx.logp.push_back(0);
+	ctx.prime.push_back(2); ctx.root.push_back(limb_mod_small(ctx.kN, 2)); ctx.logp.push_back(1);
+	for (uint64_t bound = 16 * factorBaseSize + 1024; ctx.prime.size() < factorBaseSize; bound *= 2) {
+		ctx.prime.resize(2); ctx.root.resize(2); ctx.logp.resize(2);
+		std::vector<uint64_t> primes;
+		segmented_sieve(3, bound, primes, 1);
+		for (uint64_t pp : primes) {
+			uint32_t p = uint32_t(pp);
+			uint32_t knp = limb_mod_small(ctx.kN, p);
+			if (knp != 0 && mod_pow32(knp, (p - 1) / 2, p) != 1) continue;
+			if (knp == 0 && ctx.k % p != 0) return Integer(p);   // p divides N
+			ctx.prime.push_back(p);
+			ctx.root.push_back(sqrt_mod32(knp, p));
+			ctx.logp.push_back(uint8_t(std::lround(std::log2(double(p)))));
+			if (ctx.prime.size() == factorBaseSize) break;
+		}
+	}
+	const size_t fb = ctx.prime.size();
+	const uint32_t pmax = ctx.prime.back();
+	while (ctx.smallPrimes < fb && ctx.prime[ctx.smallPrimes] < 50) ++ctx.smallPrimes;
+	ctx.largePrimeBound = uint64_t(pmax) * 64;
+	ctx.target = fb + 64;
+
+	// log2 |g(x)| is at most log2(M sqrt(kN / 2)); the threshold leaves room for a large prime and the unsieved small primes
+	double log2kN = log2_limbs(ctx.kN);
+	double log2g = std::log2(double(ctx.M)) + 0.5 * log2kN - 0.5;
+	double t = log2g - std::log2(double(ctx.largePrimeBound)) - 4.0;
+	ctx.threshold = unsigned(std::max(10.0, std::min(250.0, t)));
+
+	// the factors of A: s primes of about 2^(log2(sqrt(2kN)/M)/s), near 2000 when the factor base reaches that far
+	ctx.log2TargetA = 0.5 * (log2kN + 1.0) - std::log2(double(ctx.M));
+	double preferred = std::log2(std::min(2000.0, double(ctx.prime[fb / 2])));
+	ctx.s = size_t(std::max(2.0, std::round(ctx.log2TargetA / preferred)));
+	double qTarget = std::exp2(ctx.log2TargetA / double(ctx.s));
+	ctx.qLow = ctx.smallPrimes;
+	while (ctx.qLow + 1 < fb && ctx.prime[ctx.qLow] < qTarget / 1.5) ++ctx.qLow;
+	ctx.qHigh = ctx.qLow;
+	while (ctx.qHigh < fb && ctx.prime[ctx.qHigh] < qTarget * 1.5) ++ctx.qHigh;
+	while (ctx.qHigh - ctx.qLow < 2 * ctx.s + 8 && (ctx.qLow > ctx.smallPrimes || ctx.qHigh < fb)) {
+		if (ctx.qLow > ctx.smallPrimes) --ctx.qLow;
+		if (ctx.qHigh < fb) ++ctx.qHigh;
+	}
+
+	if (nrThreads == 0) nrThreads = hardware_concurrency();
+	parallel_blocks(0, nrThreads, [&](unsigned threadId, size_t, size_t) {
+		qs_sieve_thread(ctx, threadId, seed);
+	}, nrThreads);
+	std::chrono::steady_clock::time_point sieved = std::chrono::steady_clock::now();
+
+	// congruences of squares X^2 = Y^2 mod N from the null space
+	std::vector<qs_relation>& relations = ctx.relations;
+	std::vector< std::vector<size_t> > dependencies = qs_null_space(relations, fb);
+	Integer factor = one;
+	size_t tried = 0;
+	for (const std::vector<size_t>& dependency : dependencies) {
+		++tried;
+		limbs X(1, 1), Y(1, 1);
+		std::vector<uint32_t> exponent(fb, 0);
+		// Y accumulates small factors and is reduced when it outgrows N by a limb
+		auto accumulate = [&](uint32_t f) {
+			Y = mul_small(Y, f);
+			if (Y.size() > N.size()) { Y = limb_mod(Y, N); trim(Y); }
+		};
+		for (size_t r : dependency) {
+			X = qs_mulmod(X, relations[r].Y, N);
+			for (uint32_t f : relations[r].factors) ++exponent[f];
+			for (uint32_t L : relations[r].largePrimes) accumulate(L);
+		}
+		for (size_t i = 1; i < fb; ++i) {
+			for (uint32_t e = 0; e < exponent[i] / 2; ++e) accumulate(ctx.prime[i]);
+		}
+		Y = limb_mod(Y, N);
+		trim(Y);
+		limbs d = (limb_compare(X, Y) >= 0 ? sub_magnitudes(X, Y) : sub_magnitudes(Y, X));
+		limbs g = limb_gcd(d, N);
+		if (!(g.size() == 1 && g[0] == 1) && limb_compare(g, N) != 0) {
+			factor = from_limbs<nbits, BlockType>(g);
+			break;
+		}
+	}
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+	if (report) {
+		report->multiplier = ctx.k;
+		report->factorBaseSize = fb;
+		report->sieveInterval = 2 * ctx.M;
+		report->polynomials = ctx.polynomials;
+		report->fullRelations = relations.size() - ctx.combined;
+		report->combinedRelations = ctx.combined;
+		report->dependencies = tried;
+		report->sieveSeconds = std::chrono::duration<double>(sieved - begin).count();
+		report->linearAlgebraSeconds = std::chrono::duration<double>(end - sieved).count();
+	}
+	return factor;
+}
+
+}} // namespace sw::unum
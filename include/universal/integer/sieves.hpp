@@ -4,7 +4,12 @@
 // Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
 //
 // This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
 #include <vector>
+#include <universal/utility/parallel_for.hpp>
 #include "./integer_exceptions.hpp"
 
 #if defined(__clang__)
@@ -40,6 +45,176 @@
 namespace sw {
 namespace unum {
 
+/*
+Segmented sieve of Eratosthenes on 64-bit ranges.
+
+The sieve stores odd numbers only, one bit each, in segments of segmentBytes that stay resident in the
+L1 or L2 cache while the primes up to sqrt(high) cross off their multiples. A segment starts as a copy of a
+pre-sieved pattern of the wheel primes 3, 5, 7, 11, and 13, which clears 62% of the odd numbers before the first
+crossing-off. The segments are independent and are distributed across a pool of worker threads.
+The sieving primes up to sqrt(high) are held in memory, which makes ranges up to about 2^50 practical.
+*/
+
+// size of a segment of the sieve in bytes, 32KB fits the L1 data cache of most cores
+constexpr size_t sieve_segment_bytes = 32 * 1024;
+
+namespace impl {
+
+// population count and number of trailing zeros of a 64-bit word
+inline unsigned popcount64(uint64_t w) {
+#if defined(__GNUC__) || defined(__clang__)
+	return unsigned(__builtin_popcountll(w));
+#else
+	unsigned c = 0;
+	for (; w; w &= w - 1) ++c;
+	return c;
+#endif
+}
+inline unsigned ctz64(uint64_t w) {   // w != 0
+#if defined(__GNUC__) || defined(__clang__)
+	return unsigned(__builtin_ctzll(w));
+#else
+	unsigned c = 0;
+	while (!(w & 1)) { w >>= 1; ++c; }
+	return c;
+#endif
+}
+
+// the pre-sieved wheel: a bit pattern over the odd numbers with the multiples of 3, 5, 7, 11, 13 cleared
+struct sieve_wheel {
+	static constexpr uint64_t period = 3 * 5 * 7 * 11 * 13;  // in odd numbers
+	std::vector<uint64_t> words;                             // 64 periods, so that the pattern repeats on a word boundary
+
+	sieve_wheel() : words(period + 1, ~uint64_t(0)) {
+		for (uint64_t p : { 3u, 5u, 7u, 11u, 13u }) {
+			// the odd number 2i + 1 is a multiple of p for i = (p - 1) / 2 + k p
+			for (uint64_t i = (p - 1) / 2; i < 64 * period; i += p) words[i / 64] &= ~(uint64_t(1) << (i % 64));
+		}
+		words[period] = words[0];   // one word of wrap around for unaligned reads
+	}
+	// 64 bits of the pattern starting at the odd number with index i, 2i + 1
+	uint64_t bits(uint64_t i) const {
+		i %= 64 * period;
+		uint64_t w = i / 64, shift = i % 64;
+		return (shift == 0 ? words[w] : (words[w] >> shift) | (words[w + 1] << (64 - shift)));
+	}
+};
+
+inline const sieve_wheel& wheel() {
+	static const sieve_wheel w;
+	return w;
+}
+
+// the odd primes below limit, by a plain sieve of Eratosthenes
+inline std::vector<uint32_t> sieving_primes(uint64_t limit) {
+	std::vector<uint32_t> primes;
+	if (limit <= 3) return primes;
+	std::vector<bool> composite(size_t(limit / 2), false);   // index i is the odd number 2i + 1
+	for (uint64_t i = 1; i < composite.size(); ++i) {
+		if (composite[size_t(i)]) continue;
+		uint64_t p = 2 * i + 1;
+		primes.push_back(uint32_t(p));
+		for (uint64_t j = p * p / 2; j < composite.size(); j += p) composite[size_t(j)] = true;
+	}
+	return primes;
+}
+
+// integer square root of a 64-bit value
+inline uint64_t isqrt64(uint64_t n) {
+	uint64_t r = uint64_t(std::sqrt(double(n)));
+	while (r > 0 && r * r > n) --r;
+	while ((r + 1) * (r + 1) <= n) ++r;
+	return r;
+}
+
+// sieve the odd numbers 2i + 1 for i in [first, first + 64 * words.size()) with the primes above the wheel,
+// bits at or beyond the index end are cleared
+inline void sieve_segment(uint64_t first, uint64_t end, const std::vector<uint32_t>& primes, std::vector<uint64_t>& words) {
+	const sieve_wheel& w = wheel();
+	for (size_t k = 0; k < words.size(); ++k) words[k] = w.bits(first + 64 * k);
+	uint64_t last = first + 64 * words.size();   // exclusive index
+	if (first == 0) words[0] &= ~uint64_t(1);    // 1 is not prime
+	for (uint32_t p : primes) {
+		if (p <= 13) continue;
+		uint64_t pp = uint64_t(p) * p;
+		if (pp / 2 >= last) break;
+		// first odd multiple of p at or after 2 * first + 1, and not below p^2
+		uint64_t lowNumber = 2 * first + 1;
+		uint64_t start = (pp >= lowNumber ? pp : ((lowNumber + p - 1) / p) * p);
+		if ((start & 1) == 0) start += p;
+		for (uint64_t i = start / 2 - first; i < 64 * words.size(); i += p) words[size_t(i / 64)] &= ~(uint64_t(1) << (i % 64));
+	}
+	// clear the bits beyond the end of the range
+	if (end < last) {
+		for (uint64_t i = end - first; i < 64 * words.size(); ++i) words[size_t(i / 64)] &= ~(uint64_t(1) << (i % 64));
+	}
+}
+
+// the odd numbers 2i + 1 in [low, high) have the indices [first, end), which split into segments of span indices
+struct sieve_layout {
+	uint64_t first, end, span;
+	size_t   nrSegments;
+	sieve_layout(uint64_t low, uint64_t high, size_t segmentBytes) {
+		first = low / 2;
+		end = (high > low ? high / 2 : first);
+		if (end < first) end = first;
+		span = std::max<uint64_t>(64, 8 * uint64_t(segmentBytes) / 64 * 64);
+		nrSegments = size_t((end - first + span - 1) / span);
+	}
+};
+
+// call visit(segment, first, words) for every segment of the layout on nrThreads threads, first is the index of the odd number of the first bit
+template<typename Visit>
+void sieve_segments(const sieve_layout& layout, uint64_t high, unsigned nrThreads, Visit&& visit) {
+	if (layout.nrSegments == 0) return;
+	std::vector<uint32_t> primes = sieving_primes(isqrt64(high - 1) + 1);
+	parallel_tasks(layout.nrSegments, [&](size_t s) {
+		uint64_t segFirst = layout.first + s * layout.span;
+		uint64_t segEnd = std::min(layout.end, segFirst + layout.span);
+		std::vector<uint64_t> words(size_t((segEnd - segFirst + 63) / 64));
+		sieve_segment(segFirst, segEnd, primes, words);
+		visit(s, segFirst, words);
+	}, nrThreads);
+}
+
+// the wheel primes, which the pre-sieved pattern removes, in [low, high)
+template<typename IntegerType>
+void wheel_primes(uint64_t low, uint64_t high, std::vector<IntegerType>& primes) {
+	for (uint64_t p : { 2u, 3u, 5u, 7u, 11u, 13u }) if (p >= low && p < high) primes.push_back(IntegerType(p));
+}
+
+} // namespace impl
+
+// the primes in [low, high) in increasing order, as native integers or integer<nbits>, on nrThreads threads, 0 selects all hardware threads
+template<typename IntegerType>
+void segmented_sieve(uint64_t low, uint64_t high, std::vector<IntegerType>& primes, unsigned nrThreads = 0, size_t segmentBytes = sieve_segment_bytes) {
+	impl::wheel_primes(low, high, primes);
+	// every segment collects its primes, which concatenate in order
+	impl::sieve_layout layout(low, high, segmentBytes);
+	std::vector< std::vector<IntegerType> > found(layout.nrSegments);
+	impl::sieve_segments(layout, high, nrThreads, [&](size_t s, uint64_t first, const std::vector<uint64_t>& words) {
+		std::vector<IntegerType>& segmentPrimes = found[s];
+		for (size_t k = 0; k < words.size(); ++k) {
+			for (uint64_t w = words[k]; w; w &= w - 1) {
+				segmentPrimes.push_back(IntegerType(2 * (first + 64 * k + impl::ctz64(w)) + 1));
+			}
+		}
+	});
+	for (std::vector<IntegerType>& f : found) primes.insert(primes.end(), f.begin(), f.end());
+}
+
+// the number of primes in [low, high), on nrThreads threads, 0 selects all hardware threads
+inline uint64_t prime_count(uint64_t low, uint64_t high, unsigned nrThreads = 0, size_t segmentBytes = sieve_segment_bytes) {
+	std::vector<uint64_t> small;
+	impl::wheel_primes(low, high, small);
+	std::atomic<uint64_t> count(small.size());
+	impl::sieve_segments(impl::sieve_layout(low, high, segmentBytes), high, nrThreads, [&](size_t, uint64_t, const std::vector<uint64_t>& words) {
+		uint64_t c = 0;
+		for (uint64_t w : words) c += impl::popcount64(w);
+		count += c;
+	});
+	return count;
+}
 
 } // namespace unum
 } // namespace sw
@@ -0,0 +1,34 @@
+#pragma once
+// uint128.hpp: 64 x 64 -> 128-bit unsigned multiplication on native integers
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <cstdint>
+
+namespace sw {
+namespace unum {
+
+#if defined(__SIZEOF_INT128__)
+// __extension__ keeps -Wpedantic quiet about the compiler-specific 128-bit integer
+__extension__ typedef unsigned __int128 native_uint128;
+#endif
+
+// the 128-bit product a * b as hi:lo
+constexpr void umul128(uint64_t a, uint64_t b, uint64_t& hi, uint64_t& lo) {
+#if defined(__SIZEOF_INT128__)
+	native_uint128 p = native_uint128(a) * b;
+	hi = uint64_t(p >> 64);
+	lo = uint64_t(p);
+#else
+	// schoolbook product of the 32-bit halves
+	uint64_t a0 = a & 0xFFFFFFFFull, a1 = a >> 32, b0 = b & 0xFFFFFFFFull, b1 = b >> 32;
+	uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+	uint64_t mid = (p00 >> 32) + (p01 & 0xFFFFFFFFull) + (p10 & 0xFFFFFFFFull);
+	hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+	lo = (mid << 32) | (p00 & 0xFFFFFFFFull);
+#endif
+}
+
+} // namespace unum
+} // namespace sw
@@ -0,0 +1,202 @@
+#pragma once
+// event_counters.hpp: per-thread counters of posit arithmetic events, rounding statistics, and quire usage
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// POSIT_ENABLE_EVENT_COUNTERS
+// when set counts the arithmetic operations, NaR and saturation events, inexact roundings, and quire accumulations
+// of the posit<nbits,es> arithmetic. When not set the counting hooks are empty inline functions and compile to nothing.
+// The fast posit specializations do not go through the generic arithmetic and are not counted.
+#ifndef POSIT_ENABLE_EVENT_COUNTERS
+#define POSIT_ENABLE_EVENT_COUNTERS 0
+#endif
+
+namespace sw { namespace unum {
+
+constexpr bool _count_events = (POSIT_ENABLE_EVENT_COUNTERS != 0);
+
+enum class posit_event : unsigned {
+	add,
+	sub,
+	mul,
+	div,
+	reciprocate,
+	sqrt,
+	conversion,        // assignment of a native integer or floating-point value, except floating-point zero, inf and NaN
+	nar,               // an arithmetic operation that produced NaR
+	saturation,        // a result that was projected onto minpos or maxpos
+	inexact,           // a result that was rounded
+	quire_accumulate,  // a value added to or subtracted from a quire
+	nrEvents
+};
+
+constexpr unsigned nrPositEvents = unsigned(posit_event::nrEvents);
+
+inline const char* to_string(posit_event e) {
+	static const char* names[nrPositEvents] = {
+		"add", "sub", "mul", "div", "reciprocate", "sqrt", "conversion", "nar", "saturation", "inexact", "quire_accumulate"
+	};
+	return (unsigned(e) < nrPositEvents ? names[unsigned(e)] : "unknown");
+}
+
+// the sum of the event counters of all threads at one point in time
+struct event_snapshot {
+	uint64_t count[nrPositEvents] = {};
+	int max_quire_scale = INT_MIN;     // largest scale of a quire after an accumulation, INT_MIN when there was none
+
+	uint64_t operator[](posit_event e) const { return count[unsigned(e)]; }
+	uint64_t operations() const {
+		uint64_t n = 0;
+		for (unsigned e = 0; e <= unsigned(posit_event::sqrt); ++e) n += count[e];
+		return n;
+	}
+	event_snapshot& operator+=(const event_snapshot& rhs) {
+		for (unsigned e = 0; e < nrPositEvents; ++e) count[e] += rhs.count[e];
+		if (rhs.max_quire_scale > max_quire_scale) max_quire_scale = rhs.max_quire_scale;
+		return *this;
+	}
+};
+
+// events between two snapshots, the maximum quire scale is the one of the later snapshot
+inline event_snapshot operator-(const event_snapshot& later, const event_snapshot& earlier) {
+	event_snapshot delta;
+	for (unsigned e = 0; e < nrPositEvents; ++e) delta.count[e] = later.count[e] - earlier.count[e];
+	delta.max_quire_scale = later.max_quire_scale;
+	return delta;
+}
+
+// JSON object with one member per event, and max_quire_scale, which is null when no quire was used
+inline std::ostream& write_json(std::ostream& ostr, const event_snapshot& s) {
+	ostr << '{';
+	for (unsigned e = 0; e < nrPositEvents; ++e) {
+		ostr << '"' << to_string(posit_event(e)) << "\": " << s.count[e] << ", ";
+	}
+	ostr << "\"max_quire_scale\": ";
+	if (s.max_quire_scale == INT_MIN) ostr << "null"; else ostr << s.max_quire_scale;
+	return ostr << '}';
+}
+
+inline std::string to_json(const event_snapshot& s) {
+	std::stringstream ss;
+	write_json(ss, s);
+	return ss.str();
+}
+
+namespace impl {
+
+// the counters of one thread: only the owning thread increments them, so relaxed loads and stores suffice,
+// and each thread owns whole cache lines so that counting does not cause false sharing
+struct alignas(64) thread_event_counters {
+	std::atomic<uint64_t> count[nrPositEvents];
+	std::atomic<int> max_quire_scale;
+
+	thread_event_counters() { clear(); }
+	void clear() {
+		for (unsigned e = 0; e < nrPositEvents; ++e) count[e].store(0, std::memory_order_relaxed);
+		max_quire_scale.store(INT_MIN, std::memory_order_relaxed);
+	}
+	void read(event_snapshot& s) const {
+		for (unsigned e = 0; e < nrPositEvents; ++e) s.count[e] = count[e].load(std::memory_order_relaxed);
+		s.max_quire_scale = max_quire_scale.load(std::memory_order_relaxed);
+	}
+};
+
+// registry of the counters of the live threads and the totals of the threads that have exited
+class event_registry {
+public:
+	static event_registry& instance() {
+		static event_registry registry;
+		return registry;
+	}
+	thread_event_counters* attach() {
+		thread_event_counters* counters = new thread_event_counters;
+		std::lock_guard<std::mutex> lock(_mutex);
+		_live.push_back(counters);
+		return counters;
+	}
+	void detach(thread_event_counters* counters) {
+		std::lock_guard<std::mutex> lock(_mutex);
+		event_snapshot s;
+		counters->read(s);
+		_retired += s;
+		for (size_t i = 0; i < _live.size(); ++i) {
+			if (_live[i] == counters) {
+				_live[i] = _live.back();
+				_live.pop_back();
+				break;
+			}
+		}
+		delete counters;
+	}
+	event_snapshot snapshot() {
+		std::lock_guard<std::mutex> lock(_mutex);
+		event_snapshot total = _retired;
+		for (const thread_event_counters* counters : _live) {
+			event_snapshot s;
+			counters->read(s);
+			total += s;
+		}
+		return total;
+	}
+	void reset() {
+		std::lock_guard<std::mutex> lock(_mutex);
+		_retired = event_snapshot();
+		for (thread_event_counters* counters : _live) counters->clear();
+	}
+private:
+	std::mutex _mutex;
+	std::vector<thread_event_counters*> _live;
+	event_snapshot _retired;
+};
+
+// registers the counters of a thread on first use, and folds them into the totals when the thread exits
+struct thread_event_slot {
+	thread_event_counters* counters;
+	thread_event_slot() : counters(event_registry::instance().attach()) {}
+	~thread_event_slot() { event_registry::instance().detach(counters); }
+};
+
+inline thread_event_counters& local_event_counters() {
+	thread_local thread_event_slot slot;
+	return *slot.counters;
+}
+
+} // namespace impl
+
+// sum of the counters of all threads, including the threads that have exited
+inline event_snapshot event_counters_snapshot() {
+	return impl::event_registry::instance().snapshot();
+}
+
+// clear all counters; increments that race with the reset may survive it, so reset between parallel phases
+inline void reset_event_counters() {
+	impl::event_registry::instance().reset();
+}
+
+// counting hooks of the arithmetic
+#if POSIT_ENABLE_EVENT_COUNTERS
+inline void count_event(posit_event e) {
+	std::atomic<uint64_t>& c = impl::local_event_counters().count[unsigned(e)];
+	c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+inline void count_quire_scale(int scale) {
+	std::atomic<int>& m = impl::local_event_counters().max_quire_scale;
+	if (scale > m.load(std::memory_order_relaxed)) m.store(scale, std::memory_order_relaxed);
+}
+#else
+// constexpr so that the constant-evaluable paths of the posit remain so when the counters are compiled out
+constexpr void count_event(posit_event) {}
+constexpr void count_quire_scale(int) {}
+#endif
+
+}} // namespace sw::unum
@@ -124,3 +124,9 @@ struct operand_too_small_for_quire
 	operand_too_small_for_quire(const std::string& error = "operand value too small for quire") : quire_exception(error) {}
 };
 
+struct quire_encoding_error
+	: public quire_exception
+{
+	quire_encoding_error(const std::string& error = "malformed or incompatible serialized quire") : quire_exception(error) {}
+};
+
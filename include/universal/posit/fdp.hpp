@@ -14,7 +14,7 @@ namespace sw { namespace unum {
 /// fused dot product operators
 /// fdp_qc         fused dot product with quire continuation
 /// fdp_stride     fused dot product with non-negative stride
-/// fdp            fused dot product of two vectors
+/// fdp            fused dot product of two vectors, optionally with an explicit rounding mode
 
 // Fused dot product with quire continuation
 template<typename Qy, typename Vector>
@@ -43,48 +43,36 @@ fdp_stride(size_t n, const Vector& x, size_t incx, const Vector& y, size_t incy)
 	return sum;
 }
 
-#if defined(_MSC_VER)
-/* Microsoft Visual Studio. --------------------------------- */
-// Specialized resolved fused dot product that assumes unit stride and a standard vector
-template<typename Vector>
-enable_if_posit<value_type<Vector>, value_type<Vector> > // as return type
-fdp(const Vector& x, const Vector& y) {
-	constexpr size_t nbits = Vector::value_type::nbits;
-	constexpr size_t es = Vector::value_type::es;
-	constexpr size_t capacity = 20; // support vectors up to 1M elements
-	quire<nbits, es, capacity> q(0);
-	size_t ix, iy, n = size(x);
-	for (ix = 0, iy = 0; ix < n && iy < n; ++ix, ++iy) {
-		q += sw::unum::quire_mul(x[ix], y[iy]);
-	}
-	typename Vector::value_type sum;
-	convert(q.to_value(), sum);     // one and only rounding step of the fused-dot product
-	return sum;
-}
-#else
+#if !defined(_MSC_VER)
+// Microsoft Visual Studio finds std::size through argument dependent lookup
 template<typename Scalar>
 constexpr auto size(const std::vector<Scalar>& v) -> decltype(v.size())
 {
 	return (v.size());
 }
+#endif
 
-// Specialized resolved fused dot product that assumes unit stride and a standard vector
+// Resolved fused dot product that assumes unit stride, with an explicit rounding mode for the one and only rounding step,
+// i.e. fdp(x, y, posit_rounding::stochastic) resolves the quire with stochastic rounding
 template<typename Vector>
 enable_if_posit<value_type<Vector>, value_type<Vector> > // as return type
-fdp(const Vector& x, const Vector& y) {
+fdp(const Vector& x, const Vector& y, posit_rounding mode) {
 	constexpr size_t nbits = Vector::value_type::nbits;
 	constexpr size_t es = Vector::value_type::es;
 	constexpr size_t capacity = 20; // support vectors up to 1M elements
 	quire<nbits, es, capacity> q(0);
-	size_t ix, iy, n = size(x);
-	for (ix = 0, iy = 0; ix < n && iy < n; ++ix, ++iy) {
-		q += sw::unum::quire_mul(x[ix], y[iy]);
-	}
+	fdp_qc(q, size(x), x, 1, y, 1);
 	typename Vector::value_type sum;
-	convert(q.to_value(), sum);     // one and only rounding step of the fused-dot product
+	convert(q.to_value(), sum, mode);     // one and only rounding step of the fused-dot product
 	return sum;
 }
-#endif
+
+// Specialized resolved fused dot product that assumes unit stride and a standard vector
+template<typename Vector>
+enable_if_posit<value_type<Vector>, value_type<Vector> > // as return type
+fdp(const Vector& x, const Vector& y) {
+	return fdp(x, y, default_rounding());
+}
 
 }} // namespace sw::unum
 
@@ -164,9 +164,11 @@ namespace sw { namespace unum {
 	// sqrt for arbitrary posit
 	template<size_t nbits, size_t es>
 	inline posit<nbits, es> sqrt(const posit<nbits, es>& a) {
+		count_event(posit_event::sqrt);
 		posit<nbits, es> p;
 		if (a.isneg() || a.isnar()) {
 			p.setnar();
+			count_event(posit_event::nar);
 			return p;
 		}
 
@@ -183,6 +185,7 @@ namespace sw { namespace unum {
 #else
 	template<size_t nbits, size_t es>
 	inline posit<nbits, es> sqrt(const posit<nbits, es>& a) {
+		count_event(posit_event::sqrt);
 		return posit<nbits, es>(std::sqrt((double)a));
 	}
 #endif
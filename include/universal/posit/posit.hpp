@@ -81,6 +81,8 @@ typedef __128bitdd double_double;
 #include <universal/native/bit_functions.hpp>
 #include <universal/bitblock/bitblock.hpp>
 #include <universal/posit/trace_constants.hpp>
+#include <universal/posit/event_counters.hpp>
+#include <universal/posit/posit_rounding.hpp>
 #include <universal/value/value.hpp>
 #include <universal/posit/fraction.hpp>
 #include <universal/posit/exponent.hpp>
@@ -261,7 +263,7 @@ void decode(const bitblock<nbits>& raw_bits, bool& _sign, regime<nbits, es>& _re
 
 // needed to avoid double rounding situations during arithmetic: TODO: does that mean the condensed version below should be removed?
 template<size_t nbits, size_t es, size_t fbits>
-inline bitblock<nbits>& convert_to_bb(bool _sign, int _scale, const bitblock<fbits>& fraction_in, bitblock<nbits>& ptt) {
+inline bitblock<nbits>& convert_to_bb(bool _sign, int _scale, const bitblock<fbits>& fraction_in, bitblock<nbits>& ptt, posit_rounding mode) {
 	if (_trace_conversion) std::cout << "------------------- CONVERT ------------------" << std::endl;
 	if (_trace_conversion) std::cout << "sign " << (_sign ? "-1 " : " 1 ") << "scale " << std::setw(3) << _scale << " fraction " << fraction_in << std::endl;
 
@@ -320,7 +322,9 @@ inline bitblock<nbits>& convert_to_bb(bool _sign, int _scale, const bitblock<fbi
 		bool bafter = pt_bits.test(len - nbits - 1);
 		bool bsticky = anyAfter(pt_bits, int(len) - static_cast<int>(nbits) - 1 - 1);
 
-		bool rb = (blast & bafter) | (bafter & bsticky);
+		bool rb = (mode == posit_rounding::stochastic)
+			? stochastic_round_up(pt_bits, int(len) - static_cast<int>(nbits) - 1, fraction_in, static_cast<int>(fbits) - 1 - int(nf))
+			: (blast & bafter) | (bafter & bsticky);
 
 		pt_bits <<= pt_len - len;
 		truncate(pt_bits, ptt);
@@ -329,10 +333,14 @@ inline bitblock<nbits>& convert_to_bb(bool _sign, int _scale, const bitblock<fbi
 	}
 	return ptt;
 }
+template<size_t nbits, size_t es, size_t fbits>
+inline bitblock<nbits>& convert_to_bb(bool _sign, int _scale, const bitblock<fbits>& fraction_in, bitblock<nbits>& ptt) {
+	return convert_to_bb<nbits, es, fbits>(_sign, _scale, fraction_in, ptt, default_rounding());
+}
 
 // needed to avoid double rounding situations during arithmetic: TODO: does that mean the condensed version below should be removed?
 template<size_t nbits, size_t es, size_t fbits>
-inline posit<nbits, es>& convert_(bool _sign, int _scale, const bitblock<fbits>& fraction_in, posit<nbits, es>& p) {
+inline posit<nbits, es>& convert_(bool _sign, int _scale, const bitblock<fbits>& fraction_in, posit<nbits, es>& p, posit_rounding mode) {
 	if (_trace_conversion) std::cout << "------------------- CONVERT ------------------" << std::endl;
 	if (_trace_conversion) std::cout << "sign " << (_sign ? "-1 " : " 1 ") << "scale " << std::setw(3) << _scale << " fraction " << fraction_in << std::endl;
 
@@ -344,6 +352,8 @@ inline posit<nbits, es>& convert_(bool _sign, int _scale, const bitblock<fbits>&
 		// we are projecting to minpos/maxpos
 		int k = calculate_unconstrained_k<nbits, es>(_scale);
 		k < 0 ? p.set(minpos_pattern<nbits, es>(_sign)) : p.set(maxpos_pattern<nbits, es>(_sign));
+		count_event(posit_event::saturation);
+		count_event(posit_event::inexact);
 		// we are done
 		if (_trace_rounding) std::cout << "projection  rounding ";
 	}
@@ -394,7 +404,11 @@ inline posit<nbits, es>& convert_(bool _sign, int _scale, const bitblock<fbits>&
 		bool bafter = pt_bits.test(len - nbits - 1);
 		bool bsticky = anyAfter(pt_bits, int(len) - static_cast<int>(nbits) - 1 - 1);
 
-		bool rb = (blast & bafter) | (bafter & bsticky);
+		bool rb = (mode == posit_rounding::stochastic)
+			? stochastic_round_up(pt_bits, int(len) - static_cast<int>(nbits) - 1, fraction_in, static_cast<int>(fbits) - 1 - int(nf))
+			: (blast & bafter) | (bafter & bsticky);
+
+		if (bafter || bsticky) count_event(posit_event::inexact);
 
 		bitblock<nbits> ptt;
 		pt_bits <<= pt_len - len;
@@ -405,10 +419,14 @@ inline posit<nbits, es>& convert_(bool _sign, int _scale, const bitblock<fbits>&
 	}
 	return p;
 }
+template<size_t nbits, size_t es, size_t fbits>
+inline posit<nbits, es>& convert_(bool _sign, int _scale, const bitblock<fbits>& fraction_in, posit<nbits, es>& p) {
+	return convert_<nbits, es, fbits>(_sign, _scale, fraction_in, p, default_rounding());
+}
 
-// convert a floating point value to a specific posit configuration. Semantically, p = v, return reference to p
+// convert a floating point value to a specific posit configuration using the given rounding mode. Semantically, p = v, return reference to p
 template<size_t nbits, size_t es, size_t fbits>
-inline posit<nbits, es>& convert(const value<fbits>& v, posit<nbits, es>& p) {
+inline posit<nbits, es>& convert(const value<fbits>& v, posit<nbits, es>& p, posit_rounding mode) {
 	if (_trace_conversion) std::cout << "------------------- CONVERT ------------------" << std::endl;
 	if (_trace_conversion) std::cout << "sign " << (v.sign() ? "-1 " : " 1 ") << "scale " << std::setw(3) << v.scale() << " fraction " << v.fraction() << std::endl;
 
@@ -420,7 +438,23 @@ inline posit<nbits, es>& convert(const value<fbits>& v, posit<nbits, es>& p) {
 		p.setnar();
 		return p;
 	}
-	return convert_<nbits, es, fbits>(v.sign(), v.scale(), v.fraction(), p);
+	return convert_<nbits, es, fbits>(v.sign(), v.scale(), v.fraction(), p, mode);
+}
+
+// convert a floating point value to a specific posit configuration. Semantically, p = v, return reference to p
+// The rounding mode is round-to-nearest-even, or the mode of the calling thread when POSIT_ENABLE_STOCHASTIC_ROUNDING is set
+template<size_t nbits, size_t es, size_t fbits>
+inline posit<nbits, es>& convert(const value<fbits>& v, posit<nbits, es>& p) {
+	return convert(v, p, default_rounding());
+}
+
+// convert a native floating point value to a specific posit configuration using the given rounding mode
+template<size_t nbits, size_t es, typename Real>
+inline typename std::enable_if<std::is_floating_point<Real>::value, posit<nbits, es>&>::type
+convert(Real rhs, posit<nbits, es>& p, posit_rounding mode) {
+	constexpr size_t dfbits = std::numeric_limits<Real>::digits - 1;
+	value<dfbits> v(rhs);
+	return convert(v, p, mode);
 }
 	
 // quadrant returns a two character string indicating the quadrant of the projective reals the posit resides: from 0, SE, NE, NaR, NW, SW
@@ -539,6 +573,7 @@ public:
 	// assignment operators for native types
 	posit& operator=(signed char rhs) {
 		value<8*sizeof(signed char)-1> v(rhs);
+		count_event(posit_event::conversion);
 		if (v.iszero()) {
 			setzero();
 			return *this;
@@ -550,6 +585,7 @@ public:
 	}
 	posit& operator=(short rhs) {
 		value<8*sizeof(short)-1> v(rhs);
+		count_event(posit_event::conversion);
 		if (v.iszero()) {
 			setzero();
 			return *this;
@@ -561,6 +597,7 @@ public:
 	}
 	posit& operator=(int rhs) {
 		value<8*sizeof(int)-1> v(rhs);
+		count_event(posit_event::conversion);
 		if (v.iszero()) {
 			setzero();
 			return *this;
@@ -572,6 +609,7 @@ public:
 	}
 	posit& operator=(long rhs) {
 		value<8*sizeof(long)> v(rhs);
+		count_event(posit_event::conversion);
 		if (v.iszero()) {
 			setzero();
 			return *this;
@@ -583,6 +621,7 @@ public:
 	}
 	posit& operator=(long long rhs) {
 		value<8*sizeof(long long)-1> v(rhs);
+		count_event(posit_event::conversion);
 		if (v.iszero()) {
 			setzero();
 			return *this;
@@ -594,6 +633,7 @@ public:
 	}
 	posit& operator=(char rhs) {
 		value<8*sizeof(char)> v(rhs);
+		count_event(posit_event::conversion);
 		if (v.iszero()) {
 			setzero();
 			return *this;
@@ -605,6 +645,7 @@ public:
 	}
 	posit& operator=(unsigned short rhs) {
 		value<8*sizeof(unsigned short)> v(rhs);
+		count_event(posit_event::conversion);
 		if (v.iszero()) {
 			setzero();
 			return *this;
@@ -616,6 +657,7 @@ public:
 	}
 	posit& operator=(unsigned int rhs) {
 		value<8*sizeof(unsigned int)> v(rhs);
+		count_event(posit_event::conversion);
 		if (v.iszero()) {
 			setzero();
 			return *this;
@@ -627,6 +669,7 @@ public:
 	}
 	posit& operator=(unsigned long rhs) {
 		value<8*sizeof(unsigned long)> v(rhs);
+		count_event(posit_event::conversion);
 		if (v.iszero()) {
 			setzero();
 			return *this;
@@ -638,6 +681,7 @@ public:
 	}
 	posit& operator=(unsigned long long rhs) {
 		value<8*sizeof(unsigned long long)> v(rhs);
+		count_event(posit_event::conversion);
 		if (v.iszero()) {
 			setzero();
 			return *this;
@@ -712,6 +756,7 @@ public:
 	// we model a hw pipeline with register assignments, functional block, and conversion
 	posit& operator+=(const posit& rhs) {
 		if (_trace_add) std::cout << "---------------------- ADD -------------------" << std::endl;
+		count_event(posit_event::add);
 		// special case handling of the inputs
 #if POSIT_THROW_ARITHMETIC_EXCEPTION
 		if (isnar() || rhs.isnar()) {
@@ -720,6 +765,7 @@ public:
 #else
 		if (isnar() || rhs.isnar()) {
 			setnar();
+			count_event(posit_event::nar);
 			return *this;
 		}
 #endif
@@ -728,32 +774,14 @@ public:
 			return *this;
 		}
 		if (rhs.iszero()) return *this;
-
-		// arithmetic operation
-		value<abits + 1> sum;
-		value<fbits> a, b;
-		// transform the inputs into (sign,scale,fraction) triples
-		normalize(a);
-		rhs.normalize(b);
-		module_add<fbits,abits>(a, b, sum);		// add the two inputs
-
-		// special case handling of the result
-		if (sum.iszero()) {
-			setzero();
-		}
-		else if (sum.isinf()) {
-			setnar();
-		}
-		else {
-			convert(sum, *this);
-		}
-		return *this;                
+		return finite_add(rhs);
 	}
 	posit& operator+=(double rhs) {
 		return *this += posit<nbits, es>(rhs);
 	}
 	posit& operator-=(const posit& rhs) {
 		if (_trace_sub) std::cout << "---------------------- SUB -------------------" << std::endl;
+		count_event(posit_event::sub);
 		// special case handling of the inputs
 #if POSIT_THROW_ARITHMETIC_EXCEPTION
 		if (isnar() || rhs.isnar()) {
@@ -762,6 +790,7 @@ public:
 #else
 		if (isnar() || rhs.isnar()) {
 			setnar();
+			count_event(posit_event::nar);
 			return *this;
 		}
 #endif
@@ -770,26 +799,7 @@ public:
 			return *this;
 		}
 		if (rhs.iszero()) return *this;
-
-		// arithmetic operation
-		value<abits + 1> difference;
-		value<fbits> a, b;
-		// transform the inputs into (sign,scale,fraction) triples
-		normalize(a);
-		rhs.normalize(b);
-		module_subtract<fbits, abits>(a, b, difference);	// add the two inputs
-
-		// special case handling of the result
-		if (difference.iszero()) {
-			setzero();
-		}
-		else if (difference.isinf()) {
-			setnar();
-		}
-		else {
-			convert(difference, *this);
-		}
-		return *this;
+		return finite_sub(rhs);
 	}
 	posit& operator-=(double rhs) {
 		return *this -= posit<nbits, es>(rhs);
@@ -797,6 +807,7 @@ public:
 	posit& operator*=(const posit& rhs) {
 		static_assert(fhbits > 0, "posit configuration does not support multiplication");
 		if (_trace_mul) std::cout << "---------------------- MUL -------------------" << std::endl;
+		count_event(posit_event::mul);
 		// special case handling of the inputs
 #if POSIT_THROW_ARITHMETIC_EXCEPTION
 		if (isnar() || rhs.isnar()) {
@@ -805,6 +816,7 @@ public:
 #else
 		if (isnar() || rhs.isnar()) {
 			setnar();
+			count_event(posit_event::nar);
 			return *this;
 		}
 #endif
@@ -812,33 +824,14 @@ public:
 			setzero();
 			return *this;
 		}
-
-		// arithmetic operation
-		value<mbits> product;
-		value<fbits> a, b;
-		// transform the inputs into (sign,scale,fraction) triples
-		normalize(a);
-		rhs.normalize(b);
-
-		module_multiply(a, b, product);    // multiply the two inputs
-
-		// special case handling on the output
-		if (product.iszero()) {
-			setzero();
-		}
-		else if (product.isinf()) {
-			setnar();
-		}
-		else {
-			convert(product, *this);
-		}
-		return *this;
+		return finite_mul(rhs);
 	}
 	posit& operator*=(double rhs) {
 		return *this *= posit<nbits, es>(rhs);
 	}
 	posit& operator/=(const posit& rhs) {
 		if (_trace_div) std::cout << "---------------------- DIV -------------------" << std::endl;
+		count_event(posit_event::div);
 #if POSIT_THROW_ARITHMETIC_EXCEPTION
 		if (rhs.iszero()) {
 			throw divide_by_zero{};    // not throwing is a quiet signalling NaR
@@ -856,16 +849,92 @@ public:
 		// not throwing is a quiet signalling NaR
 		if (rhs.iszero()) {
 			setnar();
+			count_event(posit_event::nar);
 			return *this;
 		}
 		if (rhs.isnar()) {
 			setnar();
+			count_event(posit_event::nar);
 			return *this;
 		}
 		if (iszero() || isnar()) {
+			if (isnar()) count_event(posit_event::nar);
 			return *this;
 		}
 #endif
+		return finite_div(rhs);
+	}
+	posit& operator/=(double rhs) {
+		return *this /= posit<nbits, es>(rhs);
+	}
+
+	// arithmetic of the operators without the special case handling of the inputs:
+	// both operands must be finite and non-zero, for those inputs the results are identical to the operators
+	posit& finite_add(const posit& rhs) {
+		value<abits + 1> sum;
+		value<fbits> a, b;
+		// transform the inputs into (sign,scale,fraction) triples
+		normalize(a);
+		rhs.normalize(b);
+		module_add<fbits,abits>(a, b, sum);		// add the two inputs
+
+		// special case handling of the result
+		if (sum.iszero()) {
+			setzero();
+		}
+		else if (sum.isinf()) {
+			setnar();
+			count_event(posit_event::nar);
+		}
+		else {
+			convert(sum, *this);
+		}
+		return *this;
+	}
+	posit& finite_sub(const posit& rhs) {
+		value<abits + 1> difference;
+		value<fbits> a, b;
+		// transform the inputs into (sign,scale,fraction) triples
+		normalize(a);
+		rhs.normalize(b);
+		module_subtract<fbits, abits>(a, b, difference);	// subtract the two inputs
+
+		// special case handling of the result
+		if (difference.iszero()) {
+			setzero();
+		}
+		else if (difference.isinf()) {
+			setnar();
+			count_event(posit_event::nar);
+		}
+		else {
+			convert(difference, *this);
+		}
+		return *this;
+	}
+	posit& finite_mul(const posit& rhs) {
+		value<mbits> product;
+		value<fbits> a, b;
+		// transform the inputs into (sign,scale,fraction) triples
+		normalize(a);
+		rhs.normalize(b);
+
+		module_multiply(a, b, product);    // multiply the two inputs
+
+		// special case handling on the output
+		if (product.iszero()) {
+			setzero();
+		}
+		else if (product.isinf()) {
+			setnar();
+			count_event(posit_event::nar);
+		}
+		else {
+			convert(product, *this);
+		}
+		return *this;
+	}
+	posit& finite_div(const posit& rhs) {
 		value<divbits> ratio;
 		value<fbits> a, b;
 		// transform the inputs into (sign,scale,fraction) triples
@@ -891,6 +960,7 @@ public:
 		}
 		else if (ratio.isinf()) {
 			setnar();  // this shouldn't happen as we should project back onto maxpos
+			count_event(posit_event::nar);
 		}
 		else {
 			convert<nbits, es, divbits>(ratio, *this);
@@ -899,20 +969,20 @@ public:
 
 		return *this;
 	}
-	posit& operator/=(double rhs) {
-		return *this /= posit<nbits, es>(rhs);
-	}
-	
+
 	posit reciprocate() const {
 		if (_trace_reciprocate) std::cout << "-------------------- RECIPROCATE ----------------" << std::endl;
+		count_event(posit_event::reciprocate);
 		posit<nbits, es> p;
 		// special case of NaR (Not a Real)
 		if (isnar()) {
 			p.setnar();
+			count_event(posit_event::nar);
 			return p;
 		}
 		if (iszero()) {
 			p.setnar();
+			count_event(posit_event::nar);
 			return p;
 		}
 		// compute the reciprocal
@@ -1205,6 +1275,8 @@ private:
 			return *this;
 		}
 
+		// the counting hook stays on the rounding path, which is not constant-evaluable anyway
+		count_event(posit_event::conversion);
 		convert(v, *this);
 		return *this;
 	}
@@ -0,0 +1,516 @@
+#pragma once
+// posit_charconv.hpp: shortest round-trip decimal formatting and exact decimal parsing of posits
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <charconv>       // std::to_chars_result, std::from_chars_result
+#include <system_error>
+#include <universal/posit/posit_fwd.hpp>
+#include <universal/bitblock/bitblock.hpp>
+
+namespace sw { namespace unum {
+
+// to_chars/from_chars operate directly on the posit encoding with exact integer arithmetic,
+// so they do not round through long double and they work for every posit configuration.
+//
+// A posit p rounds every real in the open interval (L, U) to itself, where L and U are the values of the
+// posit<nbits+1, es> encodings that sit between p and its neighbors: rounding a posit is rounding its
+// bit string, and the tie points of that rounding are the bit strings extended with a 1.
+// to_chars emits the shortest decimal in (L, U), from_chars rounds a decimal by locating it between
+// consecutive tie points with a binary search over the encodings. Neither allocates: the big integers
+// are fixed-size arrays sized from nbits and es.
+//
+// Output format follows the ECMAScript Number to string conversion: fixed notation for decimal exponents
+// in [-7, 21), scientific notation 'd.ddde+x' otherwise, "0" for zero, and "nar" for NaR.
+// A buffer of nbits + 32 characters is always large enough.
+
+namespace impl {
+
+// fixed capacity unsigned integer with 32-bit limbs, only the used limbs are touched
+template<size_t nrLimbs>
+class charconv_bignum {
+public:
+	charconv_bignum() : _size{ 0 } {}
+	charconv_bignum(const charconv_bignum& rhs) : _size{ rhs._size } {
+		for (size_t i = 0; i < _size; ++i) _limb[i] = rhs._limb[i];
+	}
+	charconv_bignum& operator=(const charconv_bignum& rhs) {
+		_size = rhs._size;
+		for (size_t i = 0; i < _size; ++i) _limb[i] = rhs._limb[i];
+		return *this;
+	}
+	charconv_bignum& operator=(uint64_t v) {
+		_size = 0;
+		while (v) { _limb[_size++] = uint32_t(v); v >>= 32; }
+		return *this;
+	}
+
+	// the low nrBits bits of the little-endian words
+	void assign(const uint32_t* words, size_t nrBits) {
+		_size = (nrBits + 31) / 32;
+		for (size_t i = 0; i < _size; ++i) _limb[i] = words[i];
+		if (nrBits % 32) _limb[_size - 1] &= (uint32_t(1) << (nrBits % 32)) - 1;
+		normalize();
+	}
+
+	bool iszero() const { return _size == 0; }
+	size_t size() const { return _size; }
+	uint32_t top() const { return _size ? _limb[_size - 1] : 0; }
+	size_t bits() const {
+		if (_size == 0) return 0;
+		size_t b = 32 * (_size - 1);
+		for (uint32_t top = _limb[_size - 1]; top; top >>= 1) ++b;
+		return b;
+	}
+	void setbit(size_t i) {
+		size_t w = i / 32;
+		while (_size <= w) _limb[_size++] = 0;
+		_limb[w] |= uint32_t(1) << (i % 32);
+	}
+
+	void mul_small(uint32_t m) {
+		uint64_t carry = 0;
+		for (size_t i = 0; i < _size; ++i) {
+			uint64_t t = uint64_t(_limb[i]) * m + carry;
+			_limb[i] = uint32_t(t);
+			carry = t >> 32;
+		}
+		if (carry && _size < nrLimbs) _limb[_size++] = uint32_t(carry);
+		normalize();
+	}
+	void add_small(uint32_t a) {
+		uint64_t carry = a;
+		for (size_t i = 0; i < _size && carry; ++i) {
+			uint64_t t = uint64_t(_limb[i]) + carry;
+			_limb[i] = uint32_t(t);
+			carry = t >> 32;
+		}
+		if (carry && _size < nrLimbs) _limb[_size++] = uint32_t(carry);
+	}
+	void mul_pow10(size_t n) {
+		static constexpr uint32_t pow10[10] = { 1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u };
+		for (; n >= 9; n -= 9) mul_small(pow10[9]);
+		if (n) mul_small(pow10[n]);
+	}
+	void shl(size_t n) {
+		if (_size == 0 || n == 0) return;
+		size_t w = n / 32, b = n % 32;
+		size_t newSize = _size + w + 1;
+		if (newSize > nrLimbs) newSize = nrLimbs;
+		for (size_t i = newSize; i-- > 0; ) {
+			uint32_t hi = (i >= w && i - w < _size) ? _limb[i - w] : 0;
+			uint32_t lo = (b && i >= w + 1 && i - w - 1 < _size) ? _limb[i - w - 1] : 0;
+			_limb[i] = b ? (hi << b) | (lo >> (32 - b)) : hi;
+		}
+		_size = newSize;
+		normalize();
+	}
+	charconv_bignum& operator+=(const charconv_bignum& rhs) {
+		size_t n = (_size > rhs._size ? _size : rhs._size);
+		uint64_t carry = 0;
+		for (size_t i = 0; i < n; ++i) {
+			uint64_t t = carry + (i < _size ? _limb[i] : 0) + (i < rhs._size ? rhs._limb[i] : 0);
+			_limb[i] = uint32_t(t);
+			carry = t >> 32;
+		}
+		_size = n;
+		if (carry && _size < nrLimbs) _limb[_size++] = uint32_t(carry);
+		return *this;
+	}
+	// requires *this >= rhs
+	charconv_bignum& operator-=(const charconv_bignum& rhs) {
+		int64_t borrow = 0;
+		for (size_t i = 0; i < _size; ++i) {
+			int64_t t = int64_t(_limb[i]) - (i < rhs._size ? int64_t(rhs._limb[i]) : 0) - borrow;
+			borrow = (t < 0);
+			_limb[i] = uint32_t(t + (borrow << 32));
+		}
+		normalize();
+		return *this;
+	}
+	// requires *this < 10 * S and the top limb of S in [2^27, 2^28): returns the quotient digit, *this becomes the remainder
+	uint32_t divide_digit(const charconv_bignum& S) {
+		if (_size < S._size) return 0;
+		size_t n = S._size;
+		uint32_t q = _limb[n - 1] / (S._limb[n - 1] + 1);   // exact or one too small
+		if (q) {
+			uint64_t carry = 0, borrow = 0;
+			for (size_t i = 0; i < n; ++i) {
+				uint64_t product = uint64_t(S._limb[i]) * q + carry;
+				carry = product >> 32;
+				uint64_t difference = uint64_t(_limb[i]) - uint32_t(product) - borrow;
+				_limb[i] = uint32_t(difference);
+				borrow = (difference >> 32) & 1;
+			}
+			normalize();
+		}
+		while (compare(*this, S) >= 0) { *this -= S; ++q; }
+		return q;
+	}
+	// *this = a * b, *this must not alias a or b
+	void mul(const charconv_bignum& a, const charconv_bignum& b) {
+		_size = a._size + b._size;
+		if (_size > nrLimbs) _size = nrLimbs;
+		for (size_t i = 0; i < _size; ++i) _limb[i] = 0;
+		for (size_t i = 0; i < a._size; ++i) {
+			uint64_t carry = 0;
+			for (size_t j = 0; j < b._size && i + j < _size; ++j) {
+				uint64_t t = uint64_t(a._limb[i]) * b._limb[j] + _limb[i + j] + carry;
+				_limb[i + j] = uint32_t(t);
+				carry = t >> 32;
+			}
+			if (i + b._size < _size) _limb[i + b._size] = uint32_t(carry);
+		}
+		normalize();
+	}
+
+	friend int compare(const charconv_bignum& a, const charconv_bignum& b) {
+		if (a._size != b._size) return a._size < b._size ? -1 : 1;
+		for (size_t i = a._size; i-- > 0; ) {
+			if (a._limb[i] != b._limb[i]) return a._limb[i] < b._limb[i] ? -1 : 1;
+		}
+		return 0;
+	}
+
+private:
+	uint32_t _limb[nrLimbs];
+	size_t   _size;        // number of limbs in use, the top limb is nonzero
+
+	void normalize() { while (_size > 0 && _limb[_size - 1] == 0) --_size; }
+};
+
+// capacities of the exact arithmetic for a posit<nbits, es>
+template<size_t nbits, size_t es>
+struct posit_charconv_traits {
+	// largest scale of the tie points, which are posit<nbits+1, es> values
+	static constexpr size_t maxScale = (nbits - 1) << es;
+	// decimal exponents beyond this bound saturate to maxpos or minpos
+	static constexpr long   maxDecimalExponent = long((maxScale * 30103) / 100000) + 2;
+	// every tie point has fewer significant decimal digits, so truncating a longer input behind a sticky digit is exact
+	static constexpr size_t maxSignificantDigits = maxScale + nbits + 4;
+	static constexpr size_t maxOutputDigits = nbits + 4;
+	static constexpr size_t formatLimbs = (3 * maxScale + 2 * nbits + 128) / 32 + 1;
+	static constexpr size_t parseLimbs = (4 * maxSignificantDigits + 3 * maxScale + 2 * nbits + 128) / 32 + 1;
+};
+
+// decode a positive, nonzero posit encoding c into M * 2^E, returning E.
+// With appendOne set, the encoding is extended with a trailing 1 and decoded as a posit<nbits+1, es>.
+template<size_t nbits, size_t es, typename Bignum>
+int decode_posit_encoding(const bitblock<nbits>& c, bool appendOne, Bignum& M) {
+	constexpr size_t nrWords = (nbits + 1 + 31) / 32;
+	uint32_t w[nrWords] = { 0 };
+	const size_t shift = appendOne ? 1 : 0;
+	if (nbits < 64) {
+		uint64_t raw = (uint64_t(c.to_ullong()) << shift) | shift;
+		for (size_t i = 0; i < nrWords; ++i, raw >>= 32) w[i] = uint32_t(raw);
+	}
+	else {
+		w[0] = uint32_t(shift);
+		for (size_t i = 0; i < nbits; ++i) if (c[i]) w[(i + shift) / 32] |= uint32_t(1) << ((i + shift) % 32);
+	}
+	auto bit = [&](int i) { return bool((w[i / 32] >> (i % 32)) & 1); };
+	int i = int(nbits + shift) - 2;
+	bool r = bit(i);
+	int m = 0;
+	while (i >= 0 && bit(i) == r) { ++m; --i; }
+	int k = r ? m - 1 : -m;
+	if (i >= 0) --i;   // regime terminator
+	int e = 0;
+	for (size_t j = 0; j < es; ++j) {
+		e <<= 1;
+		if (i >= 0) { e |= int(bit(i)); --i; }
+	}
+	int fbits = i + 1;
+	M.assign(w, size_t(fbits));
+	M.setbit(size_t(fbits));
+	return k * (1 << es) + e - fbits;
+}
+
+template<size_t nbits>
+inline void decrement_encoding(bitblock<nbits>& c) {
+	for (size_t i = 0; i < nbits; ++i) {
+		if (c[i]) { c[i] = false; return; }
+		c[i] = true;
+	}
+}
+
+// write the decimal digits[0..nrDigits) * 10^(decimalExponent - nrDigits) in ECMAScript format
+inline std::to_chars_result format_decimal(char* first, char* last, bool negative, const char* digits, int nrDigits, long decimalExponent) {
+	long x = decimalExponent - 1;   // exponent of the scientific notation
+	auto put = [&](char ch) { if (first == last) return false; *first++ = ch; return true; };
+	bool ok = true;
+	if (negative) ok = put('-');
+	if (x >= -7 && x < 21) {
+		if (x < 0) {
+			ok = ok && put('0') && put('.');
+			for (long z = 0; ok && z < -x - 1; ++z) ok = put('0');
+			for (int d = 0; ok && d < nrDigits; ++d) ok = put(digits[d]);
+		}
+		else {
+			for (long d = 0; ok && d <= x; ++d) ok = put(d < nrDigits ? digits[d] : '0');
+			if (nrDigits > x + 1) {
+				ok = ok && put('.');
+				for (long d = x + 1; ok && d < nrDigits; ++d) ok = put(digits[d]);
+			}
+		}
+	}
+	else {
+		ok = ok && put(digits[0]);
+		if (nrDigits > 1) {
+			ok = ok && put('.');
+			for (int d = 1; ok && d < nrDigits; ++d) ok = put(digits[d]);
+		}
+		ok = ok && put('e') && put(x < 0 ? '-' : '+');
+		char exponent[24];
+		int n = 0;
+		for (unsigned long ux = (unsigned long)(x < 0 ? -x : x); ux || n == 0; ux /= 10) exponent[n++] = char('0' + ux % 10);
+		while (ok && n > 0) ok = put(exponent[--n]);
+	}
+	if (!ok) return { last, std::errc::value_too_large };
+	return { first, std::errc() };
+}
+
+} // namespace impl
+
+// write the shortest decimal representation of p that reads back as p
+template<size_t nbits, size_t es>
+std::to_chars_result to_chars(char* first, char* last, const posit<nbits, es>& p) {
+	using traits = impl::posit_charconv_traits<nbits, es>;
+	using Bignum = impl::charconv_bignum<traits::formatLimbs>;
+	if (p.isnar() || p.iszero()) {
+		const char* txt = p.isnar() ? "nar" : "0";
+		for (; *txt; ++txt) {
+			if (first == last) return { last, std::errc::value_too_large };
+			*first++ = *txt;
+		}
+		return { first, std::errc() };
+	}
+	bool negative = p.isneg();
+	posit<nbits, es> a(negative ? -p : p);
+	bitblock<nbits> c = a.get();
+	bitblock<nbits> cprev(c);
+	impl::decrement_encoding(cprev);
+
+	// v = M * 2^E and its rounding interval (L, U) on a common binary scale
+	Bignum R, lo, hi, S;
+	int ev = impl::decode_posit_encoding<nbits, es>(c, false, R);
+	int el = impl::decode_posit_encoding<nbits, es>(cprev, true, lo);
+	int eu = impl::decode_posit_encoding<nbits, es>(c, true, hi);
+	long floorLog2 = long(ev) + long(R.bits()) - 1;
+	int base = ev;
+	if (el < base) base = el;
+	if (eu < base) base = eu;
+	if (base > 0) base = 0;
+	R.shl(size_t(ev - base));
+	lo.shl(size_t(el - base));
+	hi.shl(size_t(eu - base));
+	S = 1;
+	S.shl(size_t(-base));
+	Bignum mlo(R), mhi(hi), t;
+	mlo -= lo;      // v - L
+	mhi -= R;       // U - v
+
+	// scale to R/S in [0, 1) with U/S < 1 <= 10 U/S
+	long k = long(std::floor(double(floorLog2) * 0.30102999566398120)) + 1;
+	if (k >= 0) {
+		S.mul_pow10(size_t(k));
+	}
+	else {
+		R.mul_pow10(size_t(-k));
+		mlo.mul_pow10(size_t(-k));
+		mhi.mul_pow10(size_t(-k));
+	}
+	for (;;) {
+		t = R; t += mhi;
+		if (compare(t, S) >= 0) { S.mul_small(10); ++k; continue; }
+		t.mul_small(10);
+		if (compare(t, S) < 0) { R.mul_small(10); mlo.mul_small(10); mhi.mul_small(10); --k; continue; }
+		break;
+	}
+
+	// align the top limb of S to [2^27, 2^28) so that the quotient digits can be estimated from the top limbs
+	size_t topBits = 0;
+	for (uint32_t top = S.top(); top; top >>= 1) ++topBits;
+	size_t align = (topBits <= 28) ? 28 - topBits : 60 - topBits;
+	R.shl(align);
+	S.shl(align);
+	mlo.shl(align);
+	mhi.shl(align);
+
+	// free-format digit generation (Steele & White): stop as soon as the digits identify the interval.
+	// Ties round to the even encoding, so an even encoding owns the end points of its interval.
+	bool inclusive = !c[0];
+	char digits[traits::maxOutputDigits];
+	int nrDigits = 0;
+	for (;;) {
+		R.mul_small(10);
+		mlo.mul_small(10);
+		mhi.mul_small(10);
+		int digit = int(R.divide_digit(S));
+		t = R; t += mhi;
+		bool low = inclusive ? compare(R, mlo) <= 0 : compare(R, mlo) < 0;
+		bool high = inclusive ? compare(t, S) >= 0 : compare(t, S) > 0;
+		if (!low && !high && nrDigits + 1 < int(traits::maxOutputDigits)) {
+			if (digit == 0 && nrDigits == 0) { --k; continue; }
+			digits[nrDigits++] = char('0' + digit);
+			continue;
+		}
+		if (low && high) {
+			t = R; t += R;
+			if (compare(t, S) > 0) ++digit;
+		}
+		else if (high) {
+			++digit;
+		}
+		digits[nrDigits++] = char('0' + digit);
+		break;
+	}
+	while (nrDigits > 1 && digits[nrDigits - 1] == '0') --nrDigits;
+	return impl::format_decimal(first, last, negative, digits, nrDigits, k);
+}
+
+// parse a decimal number, [-](digits[.digits]|.digits)[(e|E)[+|-]digits], or "nar", and round it to the nearest posit
+template<size_t nbits, size_t es>
+std::from_chars_result from_chars(const char* first, const char* last, posit<nbits, es>& p) {
+	using traits = impl::posit_charconv_traits<nbits, es>;
+	using Bignum = impl::charconv_bignum<traits::parseLimbs>;
+	const char* s = first;
+	if (last - s >= 3 && (s[0] | 0x20) == 'n' && (s[1] | 0x20) == 'a' && (s[2] | 0x20) == 'r') {
+		p.setnar();
+		return { s + 3, std::errc() };
+	}
+	bool negative = false;
+	if (s != last && *s == '-') { negative = true; ++s; }
+
+	// significand: D holds up to maxSignificantDigits digits, a sticky digit represents the rest
+	Bignum D;
+	uint32_t chunk = 0;
+	size_t chunkDigits = 0, nrDigits = 0, pendingZeros = 0;
+	long exponent = 0;
+	bool anyDigit = false, point = false, sticky = false;
+	auto push = [&](uint32_t d) {
+		chunk = chunk * 10 + d;
+		if (++chunkDigits == 9) {
+			D.mul_pow10(9);
+			D.add_small(chunk);
+			chunk = 0; chunkDigits = 0;
+		}
+	};
+	for (; s != last; ++s) {
+		if (*s == '.' && !point) { point = true; continue; }
+		if (*s < '0' || *s > '9') break;
+		anyDigit = true;
+		if (point) --exponent;
+		uint32_t d = uint32_t(*s - '0');
+		if (d == 0) {
+			if (nrDigits > 0) ++pendingZeros;
+			continue;
+		}
+		if (nrDigits + pendingZeros < traits::maxSignificantDigits) {
+			nrDigits += pendingZeros + 1;
+			for (; pendingZeros > 0; --pendingZeros) push(0);
+			push(d);
+		}
+		else {
+			// keep maxSignificantDigits digits, so the sticky digit sits below the resolution of every tie point
+			for (; nrDigits < traits::maxSignificantDigits; ++nrDigits, --pendingZeros) push(0);
+			sticky = true;
+			exponent += long(pendingZeros) + 1;
+			pendingZeros = 0;
+		}
+	}
+	if (!anyDigit) return { first, std::errc::invalid_argument };
+	exponent += long(pendingZeros);
+	if (chunkDigits) {
+		D.mul_pow10(chunkDigits);
+		D.add_small(chunk);
+	}
+	// optional exponent, only consumed when it has digits
+	if (s != last && (*s == 'e' || *s == 'E')) {
+		const char* e = s + 1;
+		bool eneg = false;
+		if (e != last && (*e == '+' || *e == '-')) { eneg = (*e == '-'); ++e; }
+		if (e != last && *e >= '0' && *e <= '9') {
+			long x = 0;
+			for (; e != last && *e >= '0' && *e <= '9'; ++e) {
+				if (x < 100000000) x = x * 10 + (*e - '0');
+			}
+			exponent += eneg ? -x : x;
+			s = e;
+		}
+	}
+	if (D.iszero()) {
+		p.setzero();
+		return { s, std::errc() };
+	}
+	if (sticky) {
+		D.mul_small(10);
+		D.add_small(1);
+		--exponent;
+	}
+
+	// the value is D * 10^exponent: saturate outside of the dynamic range, no posit rounds to zero or NaR
+	bitblock<nbits> c;
+	long decimalExponent = exponent + long(nrDigits) + (sticky ? 1 : 0);
+	if (decimalExponent > traits::maxDecimalExponent) {
+		for (size_t i = 0; i < nbits - 1; ++i) c[i] = true;
+	}
+	else if (decimalExponent < -traits::maxDecimalExponent) {
+		c[0] = true;
+	}
+	else {
+		// compare D * 10^exponent against tie points M * 2^E with integers only
+		Bignum X, P, M, lhs, rhs;
+		if (exponent >= 0) {
+			X = D;
+			X.mul_pow10(size_t(exponent));
+		}
+		else {
+			P = 1;
+			P.mul_pow10(size_t(-exponent));
+		}
+		auto cmp = [&](const bitblock<nbits>& enc) {   // sign of D * 10^exponent - tie point above enc
+			int E = impl::decode_posit_encoding<nbits, es>(enc, true, M);
+			if (exponent >= 0) {
+				lhs = X;
+				rhs = M;
+			}
+			else {
+				lhs = D;
+				rhs.mul(M, P);
+			}
+			if (E >= 0) rhs.shl(size_t(E)); else lhs.shl(size_t(-E));
+			return compare(lhs, rhs);
+		};
+		// largest encoding c whose lower tie point is below the value
+		bitblock<nbits> t;
+		for (size_t b = nbits - 1; b-- > 0; ) {
+			t = c;
+			t[b] = true;
+			bitblock<nbits> below(t);
+			impl::decrement_encoding(below);
+			if (below.none() || cmp(below) > 0) c = t;
+		}
+		if (c.none()) {
+			c[0] = true;
+		}
+		else if (c[0] && c.count() < nbits - 1 && cmp(c) == 0) {
+			// tie with the next encoding: round to even
+			t = c;
+			for (size_t i = 0; i < nbits; ++i) {
+				if (!t[i]) { t[i] = true; break; }
+				t[i] = false;
+			}
+			c = t;
+		}
+	}
+	p.set(c);
+	if (negative) p = -p;
+	return { s, std::errc() };
+}
+
+}} // namespace sw::unum
@@ -0,0 +1,145 @@
+#pragma once
+// posit_rounding.hpp: rounding mode selection and stochastic rounding support for posit conversion
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <universal/bitblock/bitblock.hpp>
+
+// calling environment should define behavioral flags
+// typically set in the library aggregation include file <posit>
+// - define to non-zero if you want to select the rounding mode per thread
+// #define POSIT_ENABLE_STOCHASTIC_ROUNDING 1
+// When the flag is not set, the default rounding of conversions, arithmetic, and quire resolution
+// is a compile-time constant round-to-nearest-even, and the per-thread state is never consulted.
+// When it is set, the default rounding is the mode of the calling thread, and the fast specializations,
+// which round to nearest even in their integer kernels, are disabled so that all posits follow it.
+// The flag must have the same value in all translation units of a program.
+// Stochastic rounding remains available per call through the explicit rounding mode arguments.
+
+namespace sw { namespace unum {
+
+// rounding modes of the posit conversion path
+enum class posit_rounding {
+	nearest_even,    // IEEE-style round to nearest, ties to even: the posit standard rounding
+	stochastic       // round up with a probability equal to the fraction of the ulp that is discarded
+};
+
+// xoshiro128+ generator: small state, no divisions, and statistically strong enough in the upper bits
+// to drive rounding decisions. Seeded through splitmix64 so that any 64-bit seed yields a valid state.
+class rounding_rng {
+public:
+	explicit rounding_rng(uint64_t seed = 0x5DEECE66Dull) { this->seed(seed); }
+
+	void seed(uint64_t seed) {
+		for (int i = 0; i < 4; i += 2) {
+			uint64_t z = splitmix64(seed);
+			s[i]     = uint32_t(z);
+			s[i + 1] = uint32_t(z >> 32);
+		}
+		if ((s[0] | s[1] | s[2] | s[3]) == 0) s[0] = 1;  // the all-zero state is a fixed point
+	}
+
+	// return the next 32 random bits
+	inline uint32_t operator()() {
+		uint32_t result = s[0] + s[3];
+		uint32_t t = s[1] << 9;
+		s[2] ^= s[0];
+		s[3] ^= s[1];
+		s[1] ^= s[2];
+		s[0] ^= s[3];
+		s[2] ^= t;
+		s[3] = (s[3] << 11) | (s[3] >> 21);
+		return result;
+	}
+
+private:
+	uint32_t s[4];
+
+	static uint64_t splitmix64(uint64_t& state) {
+		uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+};
+
+// per-thread rounding state: each thread owns its generator, so no synchronization is needed
+struct posit_rounding_state {
+	posit_rounding_state()
+		: mode{ posit_rounding::nearest_even },
+		  rng{ 0x5DEECE66Dull ^ uint64_t(std::hash<std::thread::id>{}(std::this_thread::get_id())) } {}
+	posit_rounding mode;
+	rounding_rng   rng;
+};
+
+inline posit_rounding_state& thread_rounding_state() {
+	static thread_local posit_rounding_state state;
+	return state;
+}
+
+// select the rounding mode of the calling thread
+// Only effective when POSIT_ENABLE_STOCHASTIC_ROUNDING is set, otherwise conversions stay round-to-nearest-even
+inline void set_rounding_mode(posit_rounding mode) { thread_rounding_state().mode = mode; }
+inline posit_rounding get_rounding_mode() { return thread_rounding_state().mode; }
+
+// seed the stochastic rounding generator of the calling thread to make a computation reproducible
+inline void seed_stochastic_rounding(uint64_t seed) { thread_rounding_state().rng.seed(seed); }
+
+// the rounding mode used by conversions that do not specify one explicitly
+// Each configuration defines it in its own inline namespace, so the two definitions have different names.
+#if POSIT_ENABLE_STOCHASTIC_ROUNDING
+inline namespace thread_rounding {
+inline posit_rounding default_rounding() { return thread_rounding_state().mode; }
+}
+#else
+inline namespace nearest_even_rounding {
+constexpr posit_rounding default_rounding() { return posit_rounding::nearest_even; }
+}
+#endif
+
+// translation units compiled with different values of the flag do not link
+#if defined(_MSC_VER)
+#if POSIT_ENABLE_STOCHASTIC_ROUNDING
+#pragma detect_mismatch("POSIT_ENABLE_STOCHASTIC_ROUNDING", "1")
+#else
+#pragma detect_mismatch("POSIT_ENABLE_STOCHASTIC_ROUNDING", "0")
+#endif
+#endif
+
+// scoped selection of the rounding mode of the calling thread, restores the previous mode on exit
+class rounding_mode_guard {
+public:
+	explicit rounding_mode_guard(posit_rounding mode) : previous{ get_rounding_mode() } { set_rounding_mode(mode); }
+	~rounding_mode_guard() { set_rounding_mode(previous); }
+	rounding_mode_guard(const rounding_mode_guard&) = delete;
+	rounding_mode_guard& operator=(const rounding_mode_guard&) = delete;
+private:
+	posit_rounding previous;
+};
+
+// stochastic rounding decision for the conversion pipeline
+// pt_bits holds the untruncated posit, its bits [msb, 1] are the bits that fall below the lsb of the result,
+// and fraction_in[fmsb, 0] are the input fraction bits that were collapsed into the sticky bit.
+// The first 32 discarded bits are compared against a uniform random number, yielding a round up
+// with a probability equal to the discarded fraction of an ulp (to within 2^-32).
+template<size_t pt_len, size_t fbits>
+inline bool stochastic_round_up(const bitblock<pt_len>& pt_bits, int msb, const bitblock<fbits>& fraction_in, int fmsb) {
+	constexpr int residue_bits = 32;
+	uint64_t residue = 0;
+	int taken = 0;
+	for (int i = msb; i >= 1 && taken < residue_bits; --i, ++taken) {
+		residue = (residue << 1) | uint64_t(pt_bits.test(size_t(i)));
+	}
+	for (int i = fmsb; i >= 0 && taken < residue_bits; --i, ++taken) {
+		residue = (residue << 1) | uint64_t(fraction_in.test(size_t(i)));
+	}
+	if (residue == 0) return false;  // exact: nothing to round
+	residue <<= (residue_bits - taken);
+	return uint64_t(thread_rounding_state().rng()) < residue;
+}
+
+}} // namespace sw::unum
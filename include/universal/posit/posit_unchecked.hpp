@@ -0,0 +1,134 @@
+#pragma once
+// posit_unchecked.hpp: posit arithmetic policy that skips the special case handling of NaR and zero inputs
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <iostream>
+
+namespace sw { namespace unum {
+
+/*
+posit_unchecked<nbits, es> is a posit<nbits, es> whose arithmetic operators go straight to the
+finite_add, finite_sub, finite_mul, and finite_div kernels of the posit and skip the NaR and zero
+tests on the inputs. It is meant for inner loops, such as stencil sweeps or normalized tensors,
+where all operands are known to be finite and non-zero.
+
+For such operands the results are bit-identical to the checked posit arithmetic. A zero or NaR operand
+is a precondition violation and yields an unspecified value, so the result of an operation that can
+cancel to zero must not feed another unchecked operation. Configurations without finite kernels,
+such as the table-based specializations, fall back to the checked operators.
+*/
+
+namespace impl {
+
+// dispatch to the finite kernels of the posit when it has them, to the checked operators otherwise
+template<typename Posit>
+auto finite_add(Posit& lhs, const Posit& rhs, int) -> decltype(lhs.finite_add(rhs)) { return lhs.finite_add(rhs); }
+template<typename Posit>
+Posit& finite_add(Posit& lhs, const Posit& rhs, long) { return lhs += rhs; }
+template<typename Posit>
+auto finite_sub(Posit& lhs, const Posit& rhs, int) -> decltype(lhs.finite_sub(rhs)) { return lhs.finite_sub(rhs); }
+template<typename Posit>
+Posit& finite_sub(Posit& lhs, const Posit& rhs, long) { return lhs -= rhs; }
+template<typename Posit>
+auto finite_mul(Posit& lhs, const Posit& rhs, int) -> decltype(lhs.finite_mul(rhs)) { return lhs.finite_mul(rhs); }
+template<typename Posit>
+Posit& finite_mul(Posit& lhs, const Posit& rhs, long) { return lhs *= rhs; }
+template<typename Posit>
+auto finite_div(Posit& lhs, const Posit& rhs, int) -> decltype(lhs.finite_div(rhs)) { return lhs.finite_div(rhs); }
+template<typename Posit>
+Posit& finite_div(Posit& lhs, const Posit& rhs, long) { return lhs /= rhs; }
+
+} // namespace impl
+
+template<size_t nbits, size_t es>
+class posit_unchecked {
+public:
+	typedef posit<nbits, es> checked_type;
+
+	posit_unchecked() : _p() {}
+	posit_unchecked(const posit_unchecked&) = default;
+	posit_unchecked& operator=(const posit_unchecked&) = default;
+
+	// conversions to and from the checked posit are free
+	posit_unchecked(const checked_type& p) : _p(p) {}
+	explicit posit_unchecked(double initial_value) : _p(initial_value) {}
+	posit_unchecked& operator=(const checked_type& rhs) { _p = rhs; return *this; }
+	operator checked_type() const { return _p; }
+	explicit operator double() const { return double(_p); }
+	explicit operator float() const { return float(_p); }
+
+	const checked_type& get() const { return _p; }
+
+	posit_unchecked operator-() const { return posit_unchecked(-_p); }
+
+	posit_unchecked& operator+=(const posit_unchecked& rhs) {
+		count_event(posit_event::add);
+		impl::finite_add(_p, rhs._p, 0);
+		return *this;
+	}
+	posit_unchecked& operator-=(const posit_unchecked& rhs) {
+		count_event(posit_event::sub);
+		impl::finite_sub(_p, rhs._p, 0);
+		return *this;
+	}
+	posit_unchecked& operator*=(const posit_unchecked& rhs) {
+		count_event(posit_event::mul);
+		impl::finite_mul(_p, rhs._p, 0);
+		return *this;
+	}
+	posit_unchecked& operator/=(const posit_unchecked& rhs) {
+		count_event(posit_event::div);
+		impl::finite_div(_p, rhs._p, 0);
+		return *this;
+	}
+
+	bool isnar() const  { return _p.isnar(); }
+	bool iszero() const { return _p.iszero(); }
+	bool isneg() const  { return _p.isneg(); }
+
+private:
+	checked_type _p;
+};
+
+template<size_t nbits, size_t es>
+inline posit_unchecked<nbits, es> operator+(const posit_unchecked<nbits, es>& lhs, const posit_unchecked<nbits, es>& rhs) {
+	posit_unchecked<nbits, es> sum(lhs);
+	return sum += rhs;
+}
+template<size_t nbits, size_t es>
+inline posit_unchecked<nbits, es> operator-(const posit_unchecked<nbits, es>& lhs, const posit_unchecked<nbits, es>& rhs) {
+	posit_unchecked<nbits, es> difference(lhs);
+	return difference -= rhs;
+}
+template<size_t nbits, size_t es>
+inline posit_unchecked<nbits, es> operator*(const posit_unchecked<nbits, es>& lhs, const posit_unchecked<nbits, es>& rhs) {
+	posit_unchecked<nbits, es> product(lhs);
+	return product *= rhs;
+}
+template<size_t nbits, size_t es>
+inline posit_unchecked<nbits, es> operator/(const posit_unchecked<nbits, es>& lhs, const posit_unchecked<nbits, es>& rhs) {
+	posit_unchecked<nbits, es> ratio(lhs);
+	return ratio /= rhs;
+}
+
+template<size_t nbits, size_t es>
+inline bool operator==(const posit_unchecked<nbits, es>& lhs, const posit_unchecked<nbits, es>& rhs) { return lhs.get() == rhs.get(); }
+template<size_t nbits, size_t es>
+inline bool operator!=(const posit_unchecked<nbits, es>& lhs, const posit_unchecked<nbits, es>& rhs) { return lhs.get() != rhs.get(); }
+template<size_t nbits, size_t es>
+inline bool operator< (const posit_unchecked<nbits, es>& lhs, const posit_unchecked<nbits, es>& rhs) { return lhs.get() < rhs.get(); }
+template<size_t nbits, size_t es>
+inline bool operator> (const posit_unchecked<nbits, es>& lhs, const posit_unchecked<nbits, es>& rhs) { return lhs.get() > rhs.get(); }
+template<size_t nbits, size_t es>
+inline bool operator<=(const posit_unchecked<nbits, es>& lhs, const posit_unchecked<nbits, es>& rhs) { return lhs.get() <= rhs.get(); }
+template<size_t nbits, size_t es>
+inline bool operator>=(const posit_unchecked<nbits, es>& lhs, const posit_unchecked<nbits, es>& rhs) { return lhs.get() >= rhs.get(); }
+
+template<size_t nbits, size_t es>
+inline std::ostream& operator<<(std::ostream& ostr, const posit_unchecked<nbits, es>& p) {
+	return ostr << p.get();
+}
+
+}} // namespace sw::unum
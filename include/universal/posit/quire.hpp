@@ -11,6 +11,7 @@ namespace sw {
 // Forward definitions
 template<size_t nbits, size_t es, size_t capacity> class quire;
 template<size_t nbits, size_t es, size_t capacity> quire<nbits, es, capacity> abs(const quire<nbits, es, capacity>& q);
+template<size_t nbits, size_t es, size_t capacity> quire<nbits, es, capacity>& merge(quire<nbits, es, capacity>& acc, const quire<nbits, es, capacity>& q);
 //template<size_t nbits, size_t es, size_t capacity> value<(size_t(1) << es)*(4*nbits-8)+capacity> abs(const quire<nbits, es, capacity>& q);
 
 template<size_t nbits, size_t es, size_t capacity> 
@@ -252,6 +253,7 @@ public:
 	// Add a normalized value to the quire value. 
 	template<size_t fbits>
 	quire& operator+=(const value<fbits>& rhs) {
+		count_event(posit_event::quire_accumulate);
 		if (rhs.iszero()) return *this;
 
 		if (rhs.scale() > int(half_range)) {
@@ -290,6 +292,7 @@ public:
 				_sign = false;
 			}
 		}
+		if (_count_events) count_quire_scale(scale());
 		return *this;
 	}
 	// Subtract a normalized value from the quire value
@@ -307,13 +310,15 @@ public:
 		return operator-=(rhs.to_value());
 	}
 
-	// add two quires
+	// add two quires: exact, see merge()
 	quire& operator+=(const quire& q) {
-		return operator+=(q.to_value());
+		return merge(*this, q);
 	}
 	// subtract two quires
 	quire& operator-=(const quire& q) {
-		return operator-=(q.to_value());
+		quire negated(q);
+		negated.set_sign(!q.sign());
+		return merge(*this, negated);
 	}
 	
 	// bit addressing operator
@@ -507,6 +512,20 @@ public:
 		}
 		return value<qbits>(_sign, scale, fraction, isZero, isNaR);
 	}
+	// the magnitude as little-endian 64-bit limbs: bit i of the limbs is bit i of get()
+	static constexpr size_t nrLimbs = (qbits + 1 + 63) / 64;
+	void to_limbs(uint64_t* limbs) const {
+		for (size_t i = 0; i < nrLimbs; ++i) limbs[i] = 0;
+		for (size_t i = 0; i < half_range; ++i) if (_lower[i]) limbs[i / 64] |= uint64_t(1) << (i % 64);
+		for (size_t i = 0, b = half_range; i < upper_range; ++i, ++b) if (_upper[i]) limbs[b / 64] |= uint64_t(1) << (b % 64);
+		for (size_t i = 0, b = half_range + upper_range; i < capacity; ++i, ++b) if (_capacity[i]) limbs[b / 64] |= uint64_t(1) << (b % 64);
+	}
+	void from_limbs(bool sign, const uint64_t* limbs) {
+		for (size_t i = 0; i < half_range; ++i) _lower[i] = (limbs[i / 64] >> (i % 64)) & 1;
+		for (size_t i = 0, b = half_range; i < upper_range; ++i, ++b) _upper[i] = (limbs[b / 64] >> (b % 64)) & 1;
+		for (size_t i = 0, b = half_range + upper_range; i < capacity; ++i, ++b) _capacity[i] = (limbs[b / 64] >> (b % 64)) & 1;
+		_sign = sign && !iszero();
+	}
 	bool anyAfter(int index) const {
 		for (int i = index; i >= 0; i--) {
 			if (this->operator[](i)) return true;
@@ -794,6 +813,58 @@ value<(size_t(1) << es)*(4 * nbits - 8) + capacity> abs(const quire<nbits, es, c
 }
 #endif
 
+// Exact sum of two quires: the accumulators are added as fixed-point integers, so merging is associative
+// and commutative, and a dot product that is partitioned over threads or processes reproduces
+// the bits of the serial accumulation no matter how the partial quires are combined.
+template<size_t nbits, size_t es, size_t capacity>
+quire<nbits, es, capacity>& merge(quire<nbits, es, capacity>& acc, const quire<nbits, es, capacity>& q) {
+	constexpr size_t nrLimbs = quire<nbits, es, capacity>::nrLimbs;
+	constexpr size_t topBits = (quire<nbits, es, capacity>::qbits + 1) % 64;
+	if (q.iszero()) return acc;
+	uint64_t a[nrLimbs], b[nrLimbs];
+	acc.to_limbs(a);
+	q.to_limbs(b);
+	bool sign = acc.sign();
+	if (acc.iszero() || acc.sign() == q.sign()) {
+		sign = q.sign();
+		uint64_t carry = 0;
+		for (size_t i = 0; i < nrLimbs; ++i) {
+			uint64_t sum = a[i] + carry;
+			carry = (sum < carry);
+			sum += b[i];
+			carry += (sum < b[i]);
+			a[i] = sum;
+		}
+		if (carry || (topBits && (a[nrLimbs - 1] >> topBits))) {
+			throw operand_too_large_for_quire("merged value exceeds the capacity of the quire");
+		}
+	}
+	else {
+		// subtract the smaller magnitude from the larger, the result takes the sign of the larger
+		size_t i = nrLimbs;
+		while (i-- > 0 && a[i] == b[i]);
+		if (i == size_t(-1)) {
+			acc.reset();
+			return acc;
+		}
+		uint64_t* larger = a;
+		uint64_t* smaller = b;
+		if (a[i] < b[i]) {
+			larger = b;
+			smaller = a;
+			sign = q.sign();
+		}
+		uint64_t borrow = 0;
+		for (size_t j = 0; j < nrLimbs; ++j) {
+			uint64_t difference = larger[j] - smaller[j] - borrow;
+			borrow = (larger[j] < smaller[j]) || (larger[j] - smaller[j] < borrow);
+			a[j] = difference;
+		}
+	}
+	acc.from_limbs(sign, a);
+	return acc;
+}
+
 // QUIRE BINARY ARITHMETIC OPERATORS
 template<size_t nbits, size_t es, size_t capacity>
 inline quire<nbits, es, capacity> operator+(const quire<nbits, es, capacity>& lhs, const quire<nbits, es, capacity>& rhs) {
@@ -0,0 +1,180 @@
+#pragma once
+// quire_serialization.hpp: compact binary encoding of quires and exact reduction of serialized partial sums
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <universal/utility/parallel_for.hpp>
+
+namespace sw { namespace unum {
+
+// A serialized quire stores only the range of nonzero 64-bit limbs of the accumulator, all fields little-endian:
+//   offset  size  field
+//        0     4  magic "QUIR"
+//        4     2  nbits
+//        6     1  es
+//        7     1  flags: bit 0 is the sign
+//        8     2  capacity
+//       10     2  index of the first nonzero limb
+//       12     2  number of limbs that follow
+//       14   8*n  limbs
+// A quire that holds a handful of products of similar scale serializes to a few dozen bytes,
+// independent of the size of the quire, and the encoding is exact: deserialize(serialize(q)) == q.
+
+constexpr size_t QUIRE_SERIALIZATION_HEADER_SIZE = 14;
+
+namespace impl {
+
+inline void store_le(uint8_t* p, uint64_t v, size_t bytes) {
+	for (size_t i = 0; i < bytes; ++i, v >>= 8) p[i] = uint8_t(v);
+}
+inline uint64_t load_le(const uint8_t* p, size_t bytes) {
+	uint64_t v = 0;
+	for (size_t i = bytes; i-- > 0; ) v = (v << 8) | p[i];
+	return v;
+}
+
+// range [first, last) of the nonzero limbs
+inline void nonzero_limb_range(const uint64_t* limbs, size_t nrLimbs, size_t& first, size_t& last) {
+	first = 0;
+	last = nrLimbs;
+	while (last > 0 && limbs[last - 1] == 0) --last;
+	while (first < last && limbs[first] == 0) ++first;
+}
+
+} // namespace impl
+
+// number of bytes of the serialized quire
+template<size_t nbits, size_t es, size_t capacity>
+size_t serialized_size(const quire<nbits, es, capacity>& q) {
+	uint64_t limbs[quire<nbits, es, capacity>::nrLimbs];
+	q.to_limbs(limbs);
+	size_t first, last;
+	impl::nonzero_limb_range(limbs, quire<nbits, es, capacity>::nrLimbs, first, last);
+	return QUIRE_SERIALIZATION_HEADER_SIZE + 8 * (last - first);
+}
+
+// serialize into buffer[0, bufferSize), returns the number of bytes written, or 0 when the buffer is too small
+template<size_t nbits, size_t es, size_t capacity>
+size_t serialize(const quire<nbits, es, capacity>& q, uint8_t* buffer, size_t bufferSize) {
+	constexpr size_t nrLimbs = quire<nbits, es, capacity>::nrLimbs;
+	static_assert(nbits < 65536 && capacity < 65536 && nrLimbs < 65536, "quire configuration does not fit the serialization header");
+	uint64_t limbs[nrLimbs];
+	q.to_limbs(limbs);
+	size_t first, last;
+	impl::nonzero_limb_range(limbs, nrLimbs, first, last);
+	size_t size = QUIRE_SERIALIZATION_HEADER_SIZE + 8 * (last - first);
+	if (bufferSize < size) return 0;
+	buffer[0] = 'Q'; buffer[1] = 'U'; buffer[2] = 'I'; buffer[3] = 'R';
+	impl::store_le(buffer + 4, nbits, 2);
+	buffer[6] = uint8_t(es);
+	buffer[7] = uint8_t(q.sign() ? 1 : 0);
+	impl::store_le(buffer + 8, capacity, 2);
+	impl::store_le(buffer + 10, (first < last ? first : 0), 2);
+	impl::store_le(buffer + 12, last - first, 2);
+	uint8_t* p = buffer + QUIRE_SERIALIZATION_HEADER_SIZE;
+	for (size_t i = first; i < last; ++i, p += 8) impl::store_le(p, limbs[i], 8);
+	return size;
+}
+
+template<size_t nbits, size_t es, size_t capacity>
+std::vector<uint8_t> serialize(const quire<nbits, es, capacity>& q) {
+	std::vector<uint8_t> buffer(serialized_size(q));
+	serialize(q, buffer.data(), buffer.size());
+	return buffer;
+}
+
+// deserialize from buffer[0, bufferSize), returns the number of bytes consumed.
+// Throws quire_encoding_error when the record is truncated, malformed, or of a different quire configuration.
+template<size_t nbits, size_t es, size_t capacity>
+size_t deserialize(const uint8_t* buffer, size_t bufferSize, quire<nbits, es, capacity>& q) {
+	constexpr size_t nrLimbs = quire<nbits, es, capacity>::nrLimbs;
+	if (bufferSize < QUIRE_SERIALIZATION_HEADER_SIZE) throw quire_encoding_error("truncated quire header");
+	if (buffer[0] != 'Q' || buffer[1] != 'U' || buffer[2] != 'I' || buffer[3] != 'R') throw quire_encoding_error("not a serialized quire");
+	size_t inNbits = size_t(impl::load_le(buffer + 4, 2));
+	size_t inEs = buffer[6];
+	size_t inCapacity = size_t(impl::load_le(buffer + 8, 2));
+	if (inNbits != nbits || inEs != es || inCapacity != capacity) {
+		throw quire_encoding_error("serialized quire<" + std::to_string(inNbits) + "," + std::to_string(inEs) + "," + std::to_string(inCapacity)
+			+ "> does not match quire<" + std::to_string(nbits) + "," + std::to_string(es) + "," + std::to_string(capacity) + ">");
+	}
+	if (buffer[7] > 1) throw quire_encoding_error("unknown quire flags");
+	size_t first = size_t(impl::load_le(buffer + 10, 2));
+	size_t count = size_t(impl::load_le(buffer + 12, 2));
+	if (first + count > nrLimbs) throw quire_encoding_error("serialized quire limbs exceed the quire");
+	size_t size = QUIRE_SERIALIZATION_HEADER_SIZE + 8 * count;
+	if (bufferSize < size) throw quire_encoding_error("truncated quire limbs");
+	uint64_t limbs[nrLimbs] = { 0 };
+	const uint8_t* p = buffer + QUIRE_SERIALIZATION_HEADER_SIZE;
+	for (size_t i = 0; i < count; ++i, p += 8) limbs[first + i] = impl::load_le(p, 8);
+	constexpr size_t topBits = (quire<nbits, es, capacity>::qbits + 1) % 64;
+	if (topBits && (limbs[nrLimbs - 1] >> topBits)) throw quire_encoding_error("serialized quire has bits beyond its capacity");
+	q.from_limbs(buffer[7] == 1, limbs);
+	return size;
+}
+
+// write one serialized quire to a binary stream, such as a file or a pipe
+template<size_t nbits, size_t es, size_t capacity>
+std::ostream& write_binary(std::ostream& ostr, const quire<nbits, es, capacity>& q) {
+	std::vector<uint8_t> buffer = serialize(q);
+	ostr.write(reinterpret_cast<const char*>(buffer.data()), std::streamsize(buffer.size()));
+	return ostr;
+}
+
+// read the next serialized quire from a binary stream: returns false at the end of the stream,
+// and throws quire_encoding_error when the stream ends inside a record or the record is malformed
+template<size_t nbits, size_t es, size_t capacity>
+bool read_binary(std::istream& istr, quire<nbits, es, capacity>& q) {
+	uint8_t buffer[QUIRE_SERIALIZATION_HEADER_SIZE + 8 * quire<nbits, es, capacity>::nrLimbs];
+	istr.read(reinterpret_cast<char*>(buffer), std::streamsize(QUIRE_SERIALIZATION_HEADER_SIZE));
+	if (istr.gcount() == 0) return false;
+	if (size_t(istr.gcount()) != QUIRE_SERIALIZATION_HEADER_SIZE) throw quire_encoding_error("truncated quire header");
+	size_t count = size_t(impl::load_le(buffer + 12, 2));
+	if (count > quire<nbits, es, capacity>::nrLimbs) throw quire_encoding_error("serialized quire limbs exceed the quire");
+	istr.read(reinterpret_cast<char*>(buffer + QUIRE_SERIALIZATION_HEADER_SIZE), std::streamsize(8 * count));
+	if (size_t(istr.gcount()) != 8 * count) throw quire_encoding_error("truncated quire limbs");
+	deserialize(buffer, QUIRE_SERIALIZATION_HEADER_SIZE + 8 * count, q);
+	return true;
+}
+
+// pairwise tree reduction of partial quires, each level of the tree is merged in parallel.
+// merge is exact, so the result is bit-identical to any other order of accumulation.
+template<size_t nbits, size_t es, size_t capacity>
+quire<nbits, es, capacity> tree_reduce(std::vector< quire<nbits, es, capacity> > partials, unsigned nrThreads = 0) {
+	if (partials.empty()) return quire<nbits, es, capacity>();
+	for (size_t stride = 1; stride < partials.size(); stride *= 2) {
+		size_t nrPairs = (partials.size() + 2 * stride - 1) / (2 * stride);
+		parallel_for(0, nrPairs, [&](size_t pair) {
+			size_t i = 2 * stride * pair;
+			if (i + stride < partials.size()) merge(partials[i], partials[i + stride]);
+		}, nrThreads);
+	}
+	return partials[0];
+}
+
+// merge every serialized quire on a stream, for example the output of worker processes on a pipe
+template<size_t nbits, size_t es, size_t capacity>
+quire<nbits, es, capacity> reduce_serialized(std::istream& istr) {
+	quire<nbits, es, capacity> sum, q;
+	while (read_binary(istr, q)) merge(sum, q);
+	return sum;
+}
+
+// merge every serialized quire in a set of files: the files are reduced in parallel and combined with a tree reduction
+template<size_t nbits, size_t es, size_t capacity>
+quire<nbits, es, capacity> reduce_serialized(const std::vector<std::string>& paths, unsigned nrThreads = 0) {
+	std::vector< quire<nbits, es, capacity> > partials(paths.size());
+	parallel_for(0, paths.size(), [&](size_t i) {
+		std::ifstream in(paths[i], std::ios::binary);
+		if (!in) throw quire_encoding_error("unable to open " + paths[i]);
+		partials[i] = reduce_serialized<nbits, es, capacity>(in);
+	}, nrThreads);
+	return tree_reduce(std::move(partials), nrThreads);
+}
+
+}} // namespace sw::unum
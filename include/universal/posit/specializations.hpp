@@ -12,7 +12,32 @@
 // For example, POSIT_FAST_POSIT_8_0, when set to 1, will enable the fast implementation of posit<8,0>.
 // The individual POSIT_FAST_### macros enable fine grain control over which configurations
 // use fast code.
-#ifdef POSIT_FAST_SPECIALIZATION
+#if POSIT_ENABLE_STOCHASTIC_ROUNDING
+// the fast specializations round to nearest even and ignore the rounding mode of the thread,
+// so all posits take the generic path when the rounding mode is selected per thread
+#undef POSIT_FAST_POSIT_2_0
+#undef POSIT_FAST_POSIT_3_0
+#undef POSIT_FAST_POSIT_3_1
+#undef POSIT_FAST_POSIT_4_0
+#undef POSIT_FAST_POSIT_8_0
+#undef POSIT_FAST_POSIT_8_1
+#undef POSIT_FAST_POSIT_16_1
+#undef POSIT_FAST_POSIT_32_2
+#undef POSIT_FAST_POSIT_64_3
+#undef POSIT_FAST_POSIT_128_4
+#undef POSIT_FAST_POSIT_256_5
+#define POSIT_FAST_POSIT_2_0   0
+#define POSIT_FAST_POSIT_3_0   0
+#define POSIT_FAST_POSIT_3_1   0
+#define POSIT_FAST_POSIT_4_0   0
+#define POSIT_FAST_POSIT_8_0   0
+#define POSIT_FAST_POSIT_8_1   0
+#define POSIT_FAST_POSIT_16_1  0
+#define POSIT_FAST_POSIT_32_2  0
+#define POSIT_FAST_POSIT_64_3  0
+#define POSIT_FAST_POSIT_128_4 0
+#define POSIT_FAST_POSIT_256_5 0
+#elif defined(POSIT_FAST_SPECIALIZATION)
 #define POSIT_FAST_POSIT_2_0   1
 #define POSIT_FAST_POSIT_3_0   1
 #define POSIT_FAST_POSIT_3_1   1
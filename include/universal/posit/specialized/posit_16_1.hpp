@@ -110,7 +110,11 @@ public:
 #endif
 		if (b.iszero()) return *this;
 		if (iszero()) {	_bits = b._bits; return *this; }
-		if (isneg() != b.isneg()) return *this -= b.twosComplement();
+		return finite_add(b);
+	}
+	// arithmetic of operator+= without the special case handling: both operands must be finite and non-zero
+	posit& finite_add(const posit& b) {
+		if (isneg() != b.isneg()) return finite_sub(b.twosComplement());
 
 		uint16_t lhs = _bits;
 		uint16_t rhs = b._bits;
@@ -176,8 +180,12 @@ public:
 #endif
 		if (b.iszero()) return *this;
 		if (iszero()) { _bits = -int16_t(b._bits) & 0xFFFF; return *this; }
+		return finite_sub(b);
+	}
+	// arithmetic of operator-= without the special case handling: both operands must be finite and non-zero
+	posit& finite_sub(const posit& b) {
 		posit bComplement = b.twosComplement();
-		if (isneg() != b.isneg()) return *this += bComplement;
+		if (isneg() != b.isneg()) return finite_add(bComplement);
 
 		uint16_t lhs = _bits;
 		uint16_t rhs = bComplement._bits;
@@ -257,6 +265,10 @@ public:
 			_bits = 0x0000;
 			return *this;
 		}
+		return finite_mul(b);
+	}
+	// arithmetic of operator*= without the special case handling: both operands must be finite and non-zero
+	posit& finite_mul(const posit& b) {
 		uint16_t lhs = _bits;
 		uint16_t rhs = b._bits;
 		// calculate the sign of the result
@@ -316,13 +328,16 @@ public:
 			return *this;
 		}
 #endif // POSIT_THROW_ARITHMETIC_EXCEPTION
-
-		uint16_t lhs = _bits;
-		uint16_t rhs = b._bits; 
 		if (iszero()) {
 			_bits = 0x0000;
 			return *this;
 		}
+		return finite_div(b);
+	}
+	// arithmetic of operator/= without the special case handling: both operands must be finite and non-zero
+	posit& finite_div(const posit& b) {
+		uint16_t lhs = _bits;
+		uint16_t rhs = b._bits;
 
 		// calculate the sign of the result
 		bool sign = bool(lhs & sign_mask) ^ bool(rhs & sign_mask);
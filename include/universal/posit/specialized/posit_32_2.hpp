@@ -109,7 +109,11 @@ public:
 #endif
 		if (b.iszero()) return *this;
 		if (iszero()) { _bits = b._bits; return *this; }
-		if (isneg() != b.isneg()) return *this -= b.twosComplement();
+		return finite_add(b);
+	}
+	// arithmetic of operator+= without the special case handling: both operands must be finite and non-zero
+	posit& finite_add(const posit& b) {
+		if (isneg() != b.isneg()) return finite_sub(b.twosComplement());
 
 		uint32_t lhs = _bits;
 		uint32_t rhs = b._bits;
@@ -174,8 +178,12 @@ public:
 #endif
 		if (b.iszero()) return *this;
 		if (iszero()) { _bits = -int32_t(b._bits) & 0xFFFFFFFF; return *this; }
+		return finite_sub(b);
+	}
+	// arithmetic of operator-= without the special case handling: both operands must be finite and non-zero
+	posit& finite_sub(const posit& b) {
 		posit bComplement = b.twosComplement();
-		if (isneg() != b.isneg()) return *this += bComplement;
+		if (isneg() != b.isneg()) return finite_add(bComplement);
 
 		uint32_t lhs = _bits;
 		uint32_t rhs = bComplement._bits;
@@ -264,6 +272,10 @@ public:
 			_bits = 0;
 			return *this;
 		}
+		return finite_mul(b);
+	}
+	// arithmetic of operator*= without the special case handling: both operands must be finite and non-zero
+	posit& finite_mul(const posit& b) {
 		uint32_t lhs = _bits;
 		uint32_t rhs = b._bits;
 		// calculate the sign of the result
@@ -330,7 +342,10 @@ public:
 			setzero();
 			return *this;
 		}
-
+		return finite_div(b);
+	}
+	// arithmetic of operator/= without the special case handling: both operands must be finite and non-zero
+	posit& finite_div(const posit& b) {
 		uint32_t lhs = _bits;
 		uint32_t rhs = b._bits;
 		// calculate the sign of the result
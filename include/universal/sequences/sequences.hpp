@@ -5,7 +5,10 @@
 //
 // This file is part of the universal numbers project, which is released under an MIT Open Source license.
 
+#include <cassert>
 #include <tuple>
+#include <vector>
+#include <universal/functions/product_tree.hpp>
 
 namespace sw {
 namespace sequences {
@@ -27,7 +30,188 @@ std::pair<Ty, Ty> Fibonacci(unsigned terms) {
     return std::pair<Ty, Ty>(first, second);
 }
 
+/*
+The single terms below take O(log n) steps instead of the n additions of Fibonacci(): fast doubling for
+the Fibonacci and Lucas numbers, and powers of the companion matrix for a general linear recurrence.
+The terms of large integers are dominated by the last few products, so the arithmetic runs on
+sw::function::product_arithmetic<Ty>: integer<nbits> specializes it to compute on trimmed limb vectors
+with the Karatsuba product, and converts only the final terms back.
+
+The ranges seed every block of consecutive terms with a single jump and continue with the recurrence,
+so the blocks of nrThreads threads are independent, 0 selects all hardware threads.
+*/
+
+namespace impl {
+
+// (F(n), F(n+1)) by fast doubling, F(2k) = F(k) (2 F(k+1) - F(k)) and F(2k+1) = F(k)^2 + F(k+1)^2
+template<typename Arithmetic>
+std::pair<typename Arithmetic::value_type, typename Arithmetic::value_type> fibonacci_pair(unsigned long long n) {
+	using Value = typename Arithmetic::value_type;
+	Value a = Arithmetic::from_native(0), b = Arithmetic::from_native(1);
+	int msb = 63;
+	while (msb >= 0 && !((n >> msb) & 1)) --msb;
+	for (int i = msb; i >= 0; --i) {
+		Value c = Arithmetic::multiply(a, Arithmetic::subtract(Arithmetic::add(b, b), a));
+		Value d = Arithmetic::add(Arithmetic::multiply(a, a), Arithmetic::multiply(b, b));
+		if ((n >> i) & 1) {
+			a = d;
+			b = Arithmetic::add(c, d);
+		}
+		else {
+			a = std::move(c);
+			b = std::move(d);
+		}
+	}
+	return std::make_pair(std::move(a), std::move(b));
+}
+
+// (L(n), L(n+1)) from L(n) = 2 F(n+1) - F(n) and L(n+1) = 2 F(n) + F(n+1)
+template<typename Arithmetic>
+std::pair<typename Arithmetic::value_type, typename Arithmetic::value_type> lucas_pair(unsigned long long n) {
+	auto f = fibonacci_pair<Arithmetic>(n);
+	return std::make_pair(Arithmetic::add(f.second, Arithmetic::subtract(f.second, f.first)), Arithmetic::add(Arithmetic::add(f.first, f.first), f.second));
+}
+
+// the terms first, ..., first + count - 1 of a sequence with t(n+2) = t(n+1) + t(n), seed(n) yields (t(n), t(n+1))
+template<typename Ty, typename Arithmetic, typename Seed>
+std::vector<Ty> additive_range(unsigned long long first, size_t count, Seed&& seed, unsigned nrThreads) {
+	using Value = typename Arithmetic::value_type;
+	std::vector<Ty> terms(count);
+	sw::unum::parallel_blocks(0, count, [&](unsigned, size_t begin, size_t end) {
+		std::pair<Value, Value> t = seed(first + begin);
+		for (size_t i = begin; i < end; ++i) {
+			terms[i] = Arithmetic::to_scalar(t.first);
+			if (i + 1 < end) {
+				Value next = Arithmetic::add(t.first, t.second);
+				t.first = std::move(t.second);
+				t.second = std::move(next);
+			}
+		}
+	}, nrThreads);
+	return terms;
+}
+
+// the state (a(n), ..., a(n+k-1)) of a(n) = c[0] a(n-1) + ... + c[k-1] a(n-k) from the initial state (a(0), ..., a(k-1)).
+// The power P = M^n of the companion matrix M accumulates from the most significant bit of n by squaring,
+// and by the multiplication with M, which shifts the rows of P and needs products for its first row only.
+template<typename Arithmetic>
+std::vector<typename Arithmetic::value_type> recurrence_state(const std::vector<typename Arithmetic::value_type>& c, const std::vector<typename Arithmetic::value_type>& initial, unsigned long long n) {
+	using Value = typename Arithmetic::value_type;
+	using Matrix = std::vector< std::vector<Value> >;
+	size_t k = c.size();
+	// P acts on the state (a(n+k-1), ..., a(n)) with the latest term first
+	Matrix P(k, std::vector<Value>(k, Arithmetic::from_native(0)));
+	for (size_t i = 0; i < k; ++i) P[i][i] = Arithmetic::from_native(1);
+	int msb = 63;
+	while (msb >= 0 && !((n >> msb) & 1)) --msb;
+	for (int bit = msb; bit >= 0; --bit) {
+		Matrix S(k, std::vector<Value>(k));
+		for (size_t i = 0; i < k; ++i) {
+			for (size_t j = 0; j < k; ++j) {
+				Value s = Arithmetic::multiply(P[i][0], P[0][j]);
+				for (size_t l = 1; l < k; ++l) s = Arithmetic::add(s, Arithmetic::multiply(P[i][l], P[l][j]));
+				S[i][j] = std::move(s);
+			}
+		}
+		P.swap(S);
+		if ((n >> bit) & 1) {
+			std::vector<Value> top(k);
+			for (size_t j = 0; j < k; ++j) {
+				Value s = Arithmetic::multiply(c[0], P[0][j]);
+				for (size_t l = 1; l < k; ++l) s = Arithmetic::add(s, Arithmetic::multiply(c[l], P[l][j]));
+				top[j] = std::move(s);
+			}
+			for (size_t i = k - 1; i > 0; --i) P[i].swap(P[i - 1]);
+			P[0].swap(top);
+		}
+	}
+	std::vector<Value> state(k);
+	for (size_t i = 0; i < k; ++i) {
+		// row k-1-i of P yields a(n+i)
+		const std::vector<Value>& row = P[k - 1 - i];
+		Value s = Arithmetic::multiply(row[0], initial[k - 1]);
+		for (size_t j = 1; j < k; ++j) s = Arithmetic::add(s, Arithmetic::multiply(row[j], initial[k - 1 - j]));
+		state[i] = std::move(s);
+	}
+	return state;
+}
+
+template<typename Arithmetic, typename Ty>
+std::vector<typename Arithmetic::value_type> from_scalars(const std::vector<Ty>& v) {
+	std::vector<typename Arithmetic::value_type> r;
+	r.reserve(v.size());
+	for (const Ty& s : v) r.push_back(Arithmetic::from_scalar(s));
+	return r;
+}
+
+} // namespace impl
+
+// the Fibonacci number F(n), F(0) = 0, F(1) = 1
+template<typename Ty>
+Ty FibonacciNumber(unsigned long long n) {
+	using Arithmetic = sw::function::product_arithmetic<Ty>;
+	return Arithmetic::to_scalar(impl::fibonacci_pair<Arithmetic>(n).first);
+}
+
+// the Lucas number L(n), L(0) = 2, L(1) = 1
+template<typename Ty>
+Ty LucasNumber(unsigned long long n) {
+	using Arithmetic = sw::function::product_arithmetic<Ty>;
+	return Arithmetic::to_scalar(impl::lucas_pair<Arithmetic>(n).first);
+}
+
+// the Fibonacci numbers F(first), ..., F(first + count - 1)
+template<typename Ty>
+std::vector<Ty> FibonacciRange(unsigned long long first, size_t count, unsigned nrThreads = 1) {
+	using Arithmetic = sw::function::product_arithmetic<Ty>;
+	return impl::additive_range<Ty, Arithmetic>(first, count, [](unsigned long long n) { return impl::fibonacci_pair<Arithmetic>(n); }, nrThreads);
+}
+
+// the Lucas numbers L(first), ..., L(first + count - 1)
+template<typename Ty>
+std::vector<Ty> LucasRange(unsigned long long first, size_t count, unsigned nrThreads = 1) {
+	using Arithmetic = sw::function::product_arithmetic<Ty>;
+	return impl::additive_range<Ty, Arithmetic>(first, count, [](unsigned long long n) { return impl::lucas_pair<Arithmetic>(n); }, nrThreads);
+}
+
+// the term a(n) of the linear recurrence a(n) = coefficients[0] a(n-1) + ... + coefficients[k-1] a(n-k)
+// with the k initial terms a(0), ..., a(k-1)
+template<typename Ty>
+Ty LinearRecurrence(const std::vector<Ty>& coefficients, const std::vector<Ty>& initial, unsigned long long n) {
+	using Arithmetic = sw::function::product_arithmetic<Ty>;
+	assert(!coefficients.empty() && initial.size() == coefficients.size());
+	if (n < initial.size()) return initial[size_t(n)];
+	auto c = impl::from_scalars<Arithmetic>(coefficients);
+	auto state = impl::recurrence_state<Arithmetic>(c, impl::from_scalars<Arithmetic>(initial), n);
+	return Arithmetic::to_scalar(state[0]);
+}
+
+// the terms a(first), ..., a(first + count - 1) of the linear recurrence of LinearRecurrence()
+template<typename Ty>
+std::vector<Ty> LinearRecurrenceRange(const std::vector<Ty>& coefficients, const std::vector<Ty>& initial, unsigned long long first, size_t count, unsigned nrThreads = 1) {
+	using Arithmetic = sw::function::product_arithmetic<Ty>;
+	using Value = typename Arithmetic::value_type;
+	assert(!coefficients.empty() && initial.size() == coefficients.size());
+	size_t k = coefficients.size();
+	auto c = impl::from_scalars<Arithmetic>(coefficients);
+	auto a = impl::from_scalars<Arithmetic>(initial);
+	std::vector<Ty> terms(count);
+	sw::unum::parallel_blocks(0, count, [&](unsigned, size_t begin, size_t end) {
+		// a window of the k latest terms, window[0] is the oldest
+		std::vector<Value> window = impl::recurrence_state<Arithmetic>(c, a, first + begin);
+		for (size_t i = begin; i < end; ++i) {
+			terms[i] = Arithmetic::to_scalar(window[0]);
+			if (i + 1 < end) {
+				Value next = Arithmetic::multiply(c[0], window[k - 1]);
+				for (size_t l = 1; l < k; ++l) next = Arithmetic::add(next, Arithmetic::multiply(c[l], window[k - 1 - l]));
+				for (size_t l = 0; l + 1 < k; ++l) window[l] = std::move(window[l + 1]);
+				window[k - 1] = std::move(next);
+			}
+		}
+	}, nrThreads);
+	return terms;
+}
+
 }  // namespace sequences
 
 }  // namespace sw
-
@@ -0,0 +1,129 @@
+#pragma once
+// parallel_for.hpp: minimal fork-join loop parallelism on top of std::thread
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace sw { namespace unum {
+
+// number of hardware threads available to the process, at least 1
+inline unsigned hardware_concurrency() {
+	unsigned n = std::thread::hardware_concurrency();
+	return (n == 0 ? 1u : n);
+}
+
+// the block of [begin, end) that thread t of nrThreads works on: contiguous blocks whose sizes differ by at most one
+inline std::pair<size_t, size_t> block_range(size_t begin, size_t end, unsigned t, unsigned nrThreads) {
+	size_t n = (end > begin ? end - begin : 0);
+	size_t chunk = n / nrThreads;
+	size_t remainder = n % nrThreads;
+	auto blockBegin = [=](unsigned i) { return begin + i * chunk + (i < remainder ? i : remainder); };
+	return { blockBegin(t), blockBegin(t + 1) };
+}
+
+// reusable barrier for the nrThreads threads of a team, for algorithms that run their steps on one set of
+// threads instead of forking and joining per step. wait() returns true once all threads have arrived, and
+// false when a thread abandoned the team with abort(), so that the others return instead of waiting forever.
+class thread_barrier {
+public:
+	explicit thread_barrier(unsigned nrThreads) : _nrThreads{ nrThreads }, _waiting{ 0 }, _generation{ 0 }, _aborted{ false } {}
+	thread_barrier(const thread_barrier&) = delete;
+	thread_barrier& operator=(const thread_barrier&) = delete;
+
+	bool wait() {
+		std::unique_lock<std::mutex> lock(_mutex);
+		if (_aborted) return false;
+		unsigned generation = _generation;
+		if (++_waiting == _nrThreads) {
+			_waiting = 0;
+			++_generation;
+			_arrived.notify_all();
+			return true;
+		}
+		_arrived.wait(lock, [&] { return _generation != generation || _aborted; });
+		return !_aborted;
+	}
+	void abort() {
+		std::lock_guard<std::mutex> lock(_mutex);
+		_aborted = true;
+		_arrived.notify_all();
+	}
+
+private:
+	std::mutex              _mutex;
+	std::condition_variable _arrived;
+	unsigned                _nrThreads;
+	unsigned                _waiting;
+	unsigned                _generation;
+	bool                    _aborted;
+};
+
+// partition the iteration space [begin, end) into nrThreads contiguous blocks and call
+// body(threadId, blockBegin, blockEnd) for each block on its own thread.
+// The calling thread executes the first block. A nrThreads of 0 selects all hardware threads.
+// The first exception thrown by any block is rethrown on the calling thread after all blocks have joined.
+template<typename Body>
+void parallel_blocks(size_t begin, size_t end, Body&& body, unsigned nrThreads = 0) {
+	if (end <= begin) return;
+	size_t n = end - begin;
+	if (nrThreads == 0) nrThreads = hardware_concurrency();
+	if (size_t(nrThreads) > n) nrThreads = unsigned(n);
+	if (nrThreads <= 1) {
+		body(0u, begin, end);
+		return;
+	}
+	std::vector<std::exception_ptr> errors(nrThreads);
+	std::vector<std::thread> workers;
+	workers.reserve(nrThreads - 1);
+	for (unsigned t = 1; t < nrThreads; ++t) {
+		workers.emplace_back([&, t]() {
+			try {
+				std::pair<size_t, size_t> block = block_range(begin, end, t, nrThreads);
+				body(t, block.first, block.second);
+			}
+			catch (...) {
+				errors[t] = std::current_exception();
+			}
+		});
+	}
+	try {
+		std::pair<size_t, size_t> block = block_range(begin, end, 0u, nrThreads);
+		body(0u, block.first, block.second);
+	}
+	catch (...) {
+		errors[0] = std::current_exception();
+	}
+	for (auto& w : workers) w.join();
+	for (auto& e : errors) if (e) std::rethrow_exception(e);
+}
+
+// call body(i) for every i in [begin, end), distributing contiguous blocks of iterations across threads
+template<typename Body>
+void parallel_for(size_t begin, size_t end, Body&& body, unsigned nrThreads = 0) {
+	parallel_blocks(begin, end, [&body](unsigned, size_t b, size_t e) {
+		for (size_t i = b; i < e; ++i) body(i);
+	}, nrThreads);
+}
+
+// call task(t) for every t in [0, nrTasks) on a pool of nrThreads worker threads that take the next task
+// as soon as they finish one, so tasks of very different cost balance across the workers.
+// The calling thread is one of the workers. A nrThreads of 0 selects all hardware threads.
+// The first exception thrown by any task is rethrown on the calling thread after all workers have joined.
+template<typename Task>
+void parallel_tasks(size_t nrTasks, Task&& task, unsigned nrThreads = 0) {
+	std::atomic<size_t> next(0);
+	parallel_blocks(0, nrTasks, [&](unsigned, size_t, size_t) {
+		for (size_t t = next++; t < nrTasks; t = next++) task(t);
+	}, nrThreads);
+}
+
+}} // namespace sw::unum
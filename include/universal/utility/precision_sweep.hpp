@@ -0,0 +1,268 @@
+#pragma once
+// precision_sweep.hpp: run one numerical kernel in many number systems concurrently and compare against a reference type
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+#include <universal/utility/parallel_for.hpp>
+
+namespace sw { namespace unum {
+
+/*
+A precision sweep runs the same kernel for a list of number systems and a reference type:
+
+    auto kernel = [](auto tag) {
+        using Scalar = typename decltype(tag)::type;
+        std::vector<Scalar> result;
+        ... compute in Scalar and append the outputs ...
+        return result;
+    };
+    precision_sweep_report report = precision_sweep<long double>(kernel, type_list<float, double, posit<32,2>>());
+    report.write_csv(std::cout);
+
+Every instantiation, including the reference, is a task on a pool of worker threads. The outputs of each
+type are converted to the reference type and compared element by element against the outputs of the
+reference, and the errors are accumulated in the reference type, so that the precision of the reference
+is not lost before the comparison. The report holds the errors rounded to double. The instantiations
+of the kernel run concurrently, so it must not modify shared state. A kernel that throws is
+reported with the message of the exception and does not stop the other types. The times are wall clock
+times of concurrent tasks, so they include the contention of the other tasks: use nrThreads = 1 when the
+timings need to be comparable.
+*/
+
+// list of the number systems of a sweep
+template<typename... Types> struct type_list {};
+
+// the kernel receives a scalar_tag<Scalar> to select its number system
+template<typename Scalar> struct scalar_tag { typedef Scalar type; };
+
+// outcome of one number system in a sweep
+struct precision_sweep_result {
+	std::string type;          // name of the number system
+	bool        reference;     // this is the reference run
+	bool        valid;         // the kernel completed and produced as many outputs as the reference
+	std::string message;       // reason of an invalid run
+	double      seconds;       // wall clock time of the kernel
+	size_t      samples;       // number of outputs
+	double      max_abs_error; // max |x - ref|
+	double      max_rel_error; // max |x - ref| / max |ref|, normwise so that outputs close to zero do not dominate
+	double      rms_error;     // sqrt(mean (x - ref)^2)
+	double      digits;        // -log10(max_rel_error), the number of correct decimal digits relative to the largest output
+};
+
+class precision_sweep_report {
+public:
+	std::vector<precision_sweep_result> results;
+
+	const precision_sweep_result& operator[](const std::string& type) const {
+		for (const precision_sweep_result& r : results) if (r.type == type) return r;
+		throw std::runtime_error("precision_sweep_report: no result for type " + type);
+	}
+
+	void write_csv(std::ostream& ostr) const {
+		ostr << "type,reference,valid,seconds,samples,max_abs_error,max_rel_error,rms_error,digits,message\n";
+		for (const precision_sweep_result& r : results) {
+			ostr << quoted_csv(r.type) << ',' << (r.reference ? 1 : 0) << ',' << (r.valid ? 1 : 0) << ','
+				<< number(r.seconds) << ',' << r.samples << ',' << number(r.max_abs_error) << ',' << number(r.max_rel_error) << ','
+				<< number(r.rms_error) << ',' << number(r.digits) << ',' << quoted_csv(r.message) << '\n';
+		}
+	}
+	void write_json(std::ostream& ostr) const {
+		ostr << "[\n";
+		for (size_t i = 0; i < results.size(); ++i) {
+			const precision_sweep_result& r = results[i];
+			ostr << "  { \"type\": " << quoted_json(r.type)
+				<< ", \"reference\": " << (r.reference ? "true" : "false")
+				<< ", \"valid\": " << (r.valid ? "true" : "false")
+				<< ", \"seconds\": " << json_number(r.seconds)
+				<< ", \"samples\": " << r.samples
+				<< ", \"max_abs_error\": " << json_number(r.max_abs_error)
+				<< ", \"max_rel_error\": " << json_number(r.max_rel_error)
+				<< ", \"rms_error\": " << json_number(r.rms_error)
+				<< ", \"digits\": " << json_number(r.digits)
+				<< ", \"message\": " << quoted_json(r.message) << " }" << (i + 1 < results.size() ? "," : "") << '\n';
+		}
+		ostr << "]\n";
+	}
+
+private:
+	static std::string number(double v) {
+		std::stringstream s;
+		s << std::setprecision(std::numeric_limits<double>::max_digits10) << v;
+		return s.str();
+	}
+	// JSON has no representation of inf and NaN
+	static std::string json_number(double v) {
+		return (std::isfinite(v) ? number(v) : std::string("null"));
+	}
+	static std::string quoted_csv(const std::string& s) {
+		std::string q = "\"";
+		for (char c : s) {
+			if (c == '"') q += '"';
+			q += c;
+		}
+		return q + '"';
+	}
+	static std::string quoted_json(const std::string& s) {
+		std::string q = "\"";
+		for (char c : s) {
+			switch (c) {
+			case '"':  q += "\\\""; break;
+			case '\\': q += "\\\\"; break;
+			case '\n': q += "\\n"; break;
+			case '\t': q += "\\t"; break;
+			default:
+				if ((unsigned char)c < 0x20) {
+					char buf[8];
+					std::snprintf(buf, sizeof(buf), "\\u%04x", unsigned(c));
+					q += buf;
+				}
+				else {
+					q += c;
+				}
+			}
+		}
+		return q + '"';
+	}
+};
+
+// the results as an aligned table
+inline std::ostream& operator<<(std::ostream& ostr, const precision_sweep_report& report) {
+	ostr << std::setw(20) << std::left << "type" << std::right << std::setw(12) << "seconds" << std::setw(10) << "samples"
+		<< std::setw(15) << "max abs error" << std::setw(15) << "max rel error" << std::setw(15) << "rms error" << std::setw(8) << "digits" << '\n';
+	for (const precision_sweep_result& r : report.results) {
+		ostr << std::setw(20) << std::left << r.type << std::right << std::setw(12) << std::setprecision(4) << r.seconds << std::setw(10) << r.samples;
+		if (!r.valid) {
+			ostr << "   " << r.message << '\n';
+			continue;
+		}
+		if (r.reference) {
+			ostr << "   reference\n";
+			continue;
+		}
+		ostr << std::setw(15) << std::setprecision(5) << r.max_abs_error << std::setw(15) << r.max_rel_error << std::setw(15) << r.rms_error
+			<< std::setw(8) << std::setprecision(3) << r.digits << '\n';
+	}
+	return ostr;
+}
+
+namespace impl {
+
+// the name of a number system: its type_tag when it has one, the name of the native types, the RTTI name otherwise
+template<typename Scalar>
+auto sweep_type_name(const Scalar& v, int) -> decltype(std::string(type_tag(v))) { return type_tag(v); }
+template<typename Scalar>
+std::string sweep_type_name(const Scalar&, long) { return typeid(Scalar).name(); }
+inline std::string sweep_type_name(const float&, int)       { return "float"; }
+inline std::string sweep_type_name(const double&, int)      { return "double"; }
+inline std::string sweep_type_name(const long double&, int) { return "long double"; }
+
+// run the kernel of one number system and record its outputs, converted to the reference type, and time
+template<typename Scalar, typename Reference, typename Kernel>
+void sweep_task(Kernel& kernel, precision_sweep_result& result, std::vector<Reference>& outputs) {
+	result.type = sweep_type_name(Scalar(), 0);
+	try {
+		std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+		auto y = kernel(scalar_tag<Scalar>());
+		result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+		outputs.clear();
+		outputs.reserve(y.size());
+		for (const auto& v : y) outputs.push_back(static_cast<Reference>(v));
+		result.samples = outputs.size();
+		result.valid = true;
+	}
+	catch (const std::exception& e) {
+		result.message = std::string("exception: ") + e.what();
+	}
+	catch (const char* msg) {
+		result.message = std::string("exception: ") + msg;
+	}
+	catch (...) {
+		result.message = "unknown exception";
+	}
+}
+
+// compare the outputs of a number system against the outputs of the reference, in the reference type
+template<typename Reference>
+void sweep_errors(precision_sweep_result& result, const std::vector<Reference>& y, const std::vector<Reference>& ref) {
+	using std::abs;
+	if (!result.valid) return;
+	if (y.size() != ref.size()) {
+		result.valid = false;
+		result.message = "produced " + std::to_string(y.size()) + " outputs, the reference " + std::to_string(ref.size());
+		return;
+	}
+	const Reference zero(0);
+	Reference maxAbs(zero), maxRef(zero), sumSquares(zero);
+	bool invalidOutput = false;
+	for (size_t i = 0; i < y.size(); ++i) {
+		Reference e = abs(y[i] - ref[i]);
+		double d = static_cast<double>(e);
+		if (d != d) {
+			invalidOutput = true;    // a NaN output is an infinite error
+			continue;
+		}
+		if (maxAbs < e) maxAbs = e;
+		Reference r = abs(ref[i]);
+		if (maxRef < r) maxRef = r;
+		sumSquares += e * e;
+	}
+	const double infinity = std::numeric_limits<double>::infinity();
+	double maxRel = (invalidOutput ? infinity : static_cast<double>(maxRef == zero ? maxAbs : maxAbs / maxRef));
+	result.max_abs_error = (invalidOutput ? infinity : static_cast<double>(maxAbs));
+	result.max_rel_error = maxRel;
+	result.rms_error = (invalidOutput ? infinity : (y.empty() ? 0.0 : std::sqrt(static_cast<double>(sumSquares / Reference(double(y.size()))))));
+	result.digits = (maxRel == 0.0 ? std::numeric_limits<double>::infinity() : -std::log10(maxRel));
+}
+
+template<typename Reference, typename Kernel, typename... Types>
+std::vector<void(*)(Kernel&, precision_sweep_result&, std::vector<Reference>&)> sweep_tasks(type_list<Types...>) {
+	return { &sweep_task<Types, Reference, Kernel>... };
+}
+
+} // namespace impl
+
+// run kernel(scalar_tag<Scalar>()) for the Reference type and every type in the list on nrThreads worker threads,
+// 0 selects all hardware threads, and report the error of every type against the reference.
+// The first result is the reference, the others follow in the order of the type list.
+template<typename Reference, typename Kernel, typename... Types>
+precision_sweep_report precision_sweep(Kernel kernel, type_list<Types...>, unsigned nrThreads = 0) {
+	auto tasks = impl::sweep_tasks<Reference, Kernel>(type_list<Reference, Types...>());
+	size_t nrTasks = tasks.size();
+	precision_sweep_report report;
+	report.results.assign(nrTasks, precision_sweep_result{ "", false, false, "", 0.0, 0, 0.0, 0.0, 0.0, 0.0 });
+	std::vector< std::vector<Reference> > outputs(nrTasks);
+	parallel_tasks(nrTasks, [&](size_t t) {
+		tasks[t](kernel, report.results[t], outputs[t]);
+	}, nrThreads);
+
+	report.results[0].reference = true;
+	report.results[0].digits = std::numeric_limits<double>::infinity();
+	if (!report.results[0].valid) {
+		for (size_t t = 1; t < nrTasks; ++t) {
+			if (report.results[t].valid) {
+				report.results[t].valid = false;
+				report.results[t].message = "no reference: " + report.results[0].message;
+			}
+		}
+		return report;
+	}
+	for (size_t t = 1; t < nrTasks; ++t) impl::sweep_errors(report.results[t], outputs[t], outputs[0]);
+	return report;
+}
+
+}} // namespace sw::unum
@@ -0,0 +1,173 @@
+// math_functions.cpp: test suite of the fixed-point elementary functions against the double precision reference
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+// Configure the fixpnt template environment
+// first: enable general or specialized fixed-point configurations
+#define FIXPNT_FAST_SPECIALIZATION
+// second: enable/disable fixpnt arithmetic exceptions
+#define FIXPNT_THROW_ARITHMETIC_EXCEPTION 1
+
+// minimum set of include files to reflect source code dependencies
+#include <cmath>
+#include <random>
+#include <universal/fixpnt/fixed_point.hpp>
+// fixed-point type manipulators such as pretty printers
+#include <universal/fixpnt/fixpnt_manipulators.hpp>
+#include <universal/fixpnt/math_functions.hpp>
+// test helpers, such as, ReportTestResults
+#include "../utils/test_helpers.hpp"
+
+// the fixpnt of the raw bits raw
+template<size_t nbits, size_t rbits, bool arithmetic>
+sw::unum::fixpnt<nbits, rbits, arithmetic> FromRaw(long long raw) {
+	sw::unum::fixpnt<nbits, rbits, arithmetic> a;
+	a.set_raw_bits(uint64_t(raw));
+	return a;
+}
+
+// a result r is correct when it is within an ulp of the reference saturated to [maxneg, maxpos],
+// widened by the 53-bit precision of the reference for large values
+template<size_t nbits, size_t rbits, bool arithmetic>
+bool WithinUlp(const sw::unum::fixpnt<nbits, rbits, arithmetic>& r, double reference) {
+	double ulp = std::ldexp(1.0, -int(rbits));
+	double maxpos = std::ldexp(1.0, int(nbits - rbits - 1)) - ulp, maxneg = -std::ldexp(1.0, int(nbits - rbits - 1));
+	double expected = (reference > maxpos ? maxpos : (reference < maxneg ? maxneg : reference));
+	return std::fabs(double(r) - expected) <= ulp + std::ldexp(std::fabs(expected), -50);
+}
+
+// all encodings of small configurations and random samples of larger ones, with at most 53 significant bits
+// so that the arguments convert to double exactly
+template<size_t nbits, size_t rbits, bool arithmetic = sw::unum::Modulo>
+int VerifyElementaryFunctions(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	using Fixed = fixpnt<nbits, rbits, arithmetic>;
+	constexpr size_t sampleBits = (nbits - 1 < 52 ? nbits - 1 : 52);
+	int nrOfFailedTests = 0;
+	std::mt19937_64 engine(nbits * 64 + rbits);
+	size_t nrSamples = (nbits <= 16 ? (size_t(1) << nbits) : 20000);
+	auto sample = [&](size_t i) {
+		if (nbits <= 16) return FromRaw<nbits, rbits, arithmetic>((long long)(i));
+		// spread the samples over the binades of the range
+		long long raw = (long long)(engine() >> (64 - sampleBits + (engine() % sampleBits)));
+		return FromRaw<nbits, rbits, arithmetic>(engine() & 1 ? -raw : raw);
+	};
+	auto check = [&](const char* function, const Fixed& x, const Fixed& r, double reference) {
+		if (!WithinUlp(r, reference)) {
+			++nrOfFailedTests;
+			if (bReportIndividualTestCases) std::cout << tag << " FAIL " << function << '(' << double(x) << ") = " << double(r) << " reference " << reference << '\n';
+		}
+	};
+	for (size_t i = 0; i < nrSamples; ++i) {
+		Fixed x = sample(i), y = sample(nrSamples - 1 - i);
+		double dx = double(x), dy = double(y);
+		check("sin", x, sin(x), std::sin(dx));
+		check("cos", x, cos(x), std::cos(dx));
+		check("atan", x, atan(x), std::atan(dx));
+		check("atan2", x, atan2(y, x), std::atan2(dy, dx));
+		check("hypot", x, hypot(x, y), std::hypot(dx, dy));
+		check("exp", x, exp(x), std::exp(dx));
+		if (dx > 0) {
+			check("log", x, log(x), std::log(dx));
+			check("rsqrt", x, rsqrt(x), 1.0 / std::sqrt(dx));
+		}
+		if (dx >= 0) check("sqrt", x, sqrt(x), std::sqrt(dx));
+	}
+	// the arguments outside of the domain
+	Fixed zero(0), minusOne(-1), mp, mn;
+	maxpos(mp);
+	maxneg(mn);
+	if (!(log(zero) == mn) || !(rsqrt(zero) == mp)) ++nrOfFailedTests;
+	if (!(sqrt(minusOne) == zero) || !(atan2(zero, zero) == zero) || !(hypot(zero, zero) == zero)) ++nrOfFailedTests;
+	return nrOfFailedTests;
+}
+
+// the square roots are correctly rounded
+template<size_t nbits, size_t rbits>
+int VerifyCorrectlyRoundedSqrt(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	int nrOfFailedTests = 0;
+	std::mt19937_64 engine(7);
+	for (int t = 0; t < 20000; ++t) {
+		long long raw = (long long)(engine() >> (65 - nbits + (engine() % (nbits - 1)))) | 1;
+		fixpnt<nbits, rbits> x = FromRaw<nbits, rbits, Modulo>(raw);
+		long long r = (long long)sqrt(x).getbb().to_long_long();
+		// r - 1/2 < sqrt(raw 2^rbits) <= r + 1/2 in raw units
+		long double n = std::ldexp((long double)raw, int(rbits));
+		long double lower = (long double)r * r - r, upper = (long double)r * r + r;
+		if (!(lower < n && n <= upper)) {
+			++nrOfFailedTests;
+			if (bReportIndividualTestCases) std::cout << tag << " FAIL sqrt of raw " << raw << " = raw " << r << '\n';
+		}
+	}
+	return nrOfFailedTests;
+}
+
+#define MANUAL_TESTING 0
+#define STRESS_TESTING 0
+
+int main()
+try {
+	using namespace std;
+	using namespace sw::unum;
+
+	std::string tag = "fixed-point elementary functions failed";
+
+#if MANUAL_TESTING
+
+	int nrOfFailedTestCases = 0;
+	using Fixed = fixpnt<32, 16>;
+	Fixed x(0.5);
+	cout << "sin(0.5)  = " << sin(x) << " reference " << std::sin(0.5) << '\n';
+	cout << "exp(0.5)  = " << exp(x) << " reference " << std::exp(0.5) << '\n';
+	cout << "log(0.5)  = " << log(x) << " reference " << std::log(0.5) << '\n';
+	cout << "sqrt(0.5) = " << sqrt(x) << " reference " << std::sqrt(0.5) << '\n';
+	nrOfFailedTestCases += ReportTestResult(VerifyElementaryFunctions<32, 16>(tag, true), "fixpnt<32,16>", "elementary functions");
+
+	cout << "done" << endl;
+
+	return EXIT_SUCCESS;
+#else
+	std::cout << "Fixed-point elementary function verification" << std::endl;
+
+	bool bReportIndividualTestCases = false;
+	int nrOfFailedTestCases = 0;
+
+	nrOfFailedTestCases += ReportTestResult(VerifyElementaryFunctions<8, 4>(tag, bReportIndividualTestCases), "fixpnt<8,4>", "elementary functions");
+	nrOfFailedTestCases += ReportTestResult(VerifyElementaryFunctions<12, 0>(tag, bReportIndividualTestCases), "fixpnt<12,0>", "elementary functions");
+	nrOfFailedTestCases += ReportTestResult(VerifyElementaryFunctions<16, 8>(tag, bReportIndividualTestCases), "fixpnt<16,8>", "elementary functions");
+	nrOfFailedTestCases += ReportTestResult(VerifyElementaryFunctions<16, 14, Saturating>(tag, bReportIndividualTestCases), "fixpnt<16,14,Saturating>", "elementary functions");
+	nrOfFailedTestCases += ReportTestResult(VerifyElementaryFunctions<32, 16>(tag, bReportIndividualTestCases), "fixpnt<32,16>", "elementary functions");
+	nrOfFailedTestCases += ReportTestResult(VerifyElementaryFunctions<32, 28, Saturating>(tag, bReportIndividualTestCases), "fixpnt<32,28,Saturating>", "elementary functions");
+	nrOfFailedTestCases += ReportTestResult(VerifyElementaryFunctions<64, 32>(tag, bReportIndividualTestCases), "fixpnt<64,32>", "elementary functions");
+	nrOfFailedTestCases += ReportTestResult(VerifyCorrectlyRoundedSqrt<32, 16>(tag, bReportIndividualTestCases), "fixpnt<32,16>", "correctly rounded sqrt");
+	nrOfFailedTestCases += ReportTestResult(VerifyCorrectlyRoundedSqrt<40, 30>(tag, bReportIndividualTestCases), "fixpnt<40,30>", "correctly rounded sqrt");
+
+#if STRESS_TESTING
+
+	nrOfFailedTestCases += ReportTestResult(VerifyElementaryFunctions<20, 10>(tag, bReportIndividualTestCases), "fixpnt<20,10>", "elementary functions");
+	nrOfFailedTestCases += ReportTestResult(VerifyElementaryFunctions<48, 40>(tag, bReportIndividualTestCases), "fixpnt<48,40>", "elementary functions");
+
+#endif // STRESS_TESTING
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+
+#endif // MANUAL_TESTING
+}
+catch (char const* msg) {
+	std::cerr << msg << '\n';
+	return EXIT_FAILURE;
+}
+catch (const sw::unum::fixpnt_arithmetic_exception& err) {
+	std::cerr << "Uncaught fixpnt arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const std::runtime_error& err) {
+	std::cerr << "Uncaught runtime exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << '\n';
+	return EXIT_FAILURE;
+}
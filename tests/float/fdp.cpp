@@ -0,0 +1,278 @@
+// fdp.cpp: test suite for the Kulisch accumulator and exact fused dot products of IEEE float and double
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <universal/float/fdp.hpp>
+#include "../utils/test_helpers.hpp"
+
+// correctly rounded sum of a sequence of doubles with Shewchuk's non-overlapping partials
+double ReferenceSum(const std::vector<double>& v) {
+	std::vector<double> partials;
+	for (double x : v) {
+		size_t i = 0;
+		for (double y : partials) {
+			if (std::abs(x) < std::abs(y)) std::swap(x, y);
+			double hi = x + y;
+			double lo = y - (hi - x);
+			if (lo != 0.0) partials[i++] = lo;
+			x = hi;
+		}
+		partials.resize(i);
+		partials.push_back(x);
+	}
+	// round the partials, including the half-way correction
+	if (partials.empty()) return 0.0;
+	size_t n = partials.size() - 1;
+	double hi = partials[n], lo = 0.0;
+	while (n > 0) {
+		double x = hi, y = partials[--n];
+		hi = x + y;
+		lo = y - (hi - x);
+		if (lo != 0.0) break;
+	}
+	if (n > 0 && ((lo < 0.0 && partials[n - 1] < 0.0) || (lo > 0.0 && partials[n - 1] > 0.0))) {
+		double y = lo * 2.0;
+		double x = hi + y;
+		if (y == x - hi) hi = x;
+	}
+	return hi;
+}
+
+// correctly rounded dot product: each product is split exactly with an fma, valid away from underflow
+double ReferenceDot(const std::vector<double>& x, const std::vector<double>& y) {
+	std::vector<double> terms;
+	for (size_t i = 0; i < x.size(); ++i) {
+		double p = x[i] * y[i];
+		terms.push_back(p);
+		terms.push_back(std::fma(x[i], y[i], -p));
+	}
+	return ReferenceSum(terms);
+}
+
+bool SameBits(double a, double b) {
+	return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+// hand-picked cancellation and range cases with known results
+int VerifyKnownCases(bool bReportIndividualTestCases) {
+	using namespace sw::ieee;
+	int nrOfFailedTests = 0;
+	struct Case { std::vector<double> x, y; double expected; };
+	double minsub = std::numeric_limits<double>::denorm_min();
+	double maxd = std::numeric_limits<double>::max();
+	std::vector<Case> cases = {
+		{ { 1e300, 1.0, -1e300 }, { 1e300, 1.0, 1e300 }, 1.0 },
+		{ { 1.0, 1e-300, -1.0 }, { 1.0, 1e-300, 1.0 }, 0.0 },                                           // 1e-600 rounds to zero
+		{ { maxd, maxd, -maxd }, { 1.0, 1.0, 1.0 }, maxd },
+		{ { minsub, 1.0 }, { minsub, -1.0 }, -1.0 },
+		{ { minsub, minsub, minsub }, { 1.0, 1.0, -1.0 }, minsub },
+		{ { 1.0, std::ldexp(1.0, -53) }, { 1.0, 1.0 }, 1.0 },                                     // tie, rounds to even
+		{ { 1.0, std::ldexp(1.0, -53), minsub }, { 1.0, 1.0, -minsub }, 1.0 },                    // below the tie by minsub^2
+		{ { 1.0, std::ldexp(1.0, -53), minsub }, { 1.0, 1.0, 1.0 }, 1.0 + std::ldexp(1.0, -52) }, // above the tie by minsub
+		{ { 0.1, 0.2, -0.3 }, { 3.0, 3.0, 3.0 }, ReferenceDot({ 0.1, 0.2, -0.3 }, { 3.0, 3.0, 3.0 }) },
+	};
+	for (const Case& c : cases) {
+		double result = fdp(c.x, c.y);
+		if (!SameBits(result, c.expected)) {
+			++nrOfFailedTests;
+			if (bReportIndividualTestCases) std::cerr << "FAIL: fdp = " << std::setprecision(17) << result << " expected " << c.expected << std::endl;
+		}
+	}
+
+	// products below the subnormal range are held exactly: a lone one rounds to zero, but it is not lost
+	kulisch_accumulator<double> acc;
+	acc.add_product(minsub, minsub);
+	if (acc.value() != 0.0 || acc.iszero()) ++nrOfFailedTests;
+	acc.add_product(-minsub, minsub);
+	if (!acc.iszero()) ++nrOfFailedTests;
+
+	// IEEE special values
+	acc.clear();
+	acc += std::numeric_limits<double>::infinity();
+	acc += 1.0;
+	if (acc.value() != std::numeric_limits<double>::infinity()) ++nrOfFailedTests;
+	acc += -std::numeric_limits<double>::infinity();
+	if (!std::isnan(acc.value())) ++nrOfFailedTests;
+	acc.clear();
+	acc.add_product(0.0, std::numeric_limits<double>::infinity());
+	if (!std::isnan(acc.value())) ++nrOfFailedTests;
+
+	// overflow of the rounded result
+	acc.clear();
+	acc += maxd;
+	acc += maxd;
+	if (acc.value() != std::numeric_limits<double>::infinity()) ++nrOfFailedTests;
+	return nrOfFailedTests;
+}
+
+// random vectors with a wide exponent range and heavy cancellation against the correctly rounded reference
+int VerifyRandomDotProducts(bool bReportIndividualTestCases, size_t nrOfTests, size_t n) {
+	using namespace sw::ieee;
+	int nrOfFailedTests = 0;
+	std::mt19937_64 rng(0x5eed);
+	std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+	std::uniform_int_distribution<int> exponent(-200, 200);
+	for (size_t t = 0; t < nrOfTests; ++t) {
+		std::vector<double> x(n), y(n);
+		for (size_t i = 0; i < n; i += 2) {
+			x[i] = std::ldexp(mantissa(rng), exponent(rng));
+			y[i] = std::ldexp(mantissa(rng), exponent(rng));
+			if (i + 1 < n) { x[i + 1] = -x[i]; y[i + 1] = y[i] * (1.0 + std::ldexp(mantissa(rng), -40)); }
+		}
+		double expected = ReferenceDot(x, y);
+		double result = fdp(x, y);
+		if (!SameBits(result, expected)) {
+			++nrOfFailedTests;
+			if (bReportIndividualTestCases) std::cerr << "FAIL: fdp = " << std::setprecision(17) << result << " expected " << expected << std::endl;
+		}
+		double sumExpected = ReferenceSum(x);
+		double sumResult = exact_sum(x);
+		if (!SameBits(sumResult, sumExpected)) {
+			++nrOfFailedTests;
+			if (bReportIndividualTestCases) std::cerr << "FAIL: exact_sum = " << std::setprecision(17) << sumResult << " expected " << sumExpected << std::endl;
+		}
+	}
+	return nrOfFailedTests;
+}
+
+// float accumulation: every product of two floats is exact in double, so a double reference is available
+int VerifyFloatDotProducts(bool bReportIndividualTestCases, size_t nrOfTests, size_t n) {
+	using namespace sw::ieee;
+	int nrOfFailedTests = 0;
+	std::mt19937 rng(17);
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+	for (size_t t = 0; t < nrOfTests; ++t) {
+		std::vector<float> x(n), y(n);
+		std::vector<double> dx(n), dy(n);
+		for (size_t i = 0; i < n; ++i) {
+			x[i] = std::ldexp(dist(rng), int(rng() % 60) - 30);
+			y[i] = std::ldexp(dist(rng), int(rng() % 60) - 30);
+			dx[i] = x[i]; dy[i] = y[i];
+		}
+		// the double reference is rounded twice, so compare the exact sum with a tolerance of half a float ulp
+		double reference = ReferenceDot(dx, dy);
+		float result = fdp(x, y);
+		if (std::abs(double(result) - reference) > 0.5 * std::abs(double(std::nextafter(result, 2.0f * result) - result))) {
+			++nrOfFailedTests;
+			if (bReportIndividualTestCases) std::cerr << "FAIL: fdp<float> = " << std::setprecision(9) << result << " expected " << reference << std::endl;
+		}
+	}
+	return nrOfFailedTests;
+}
+
+// the parallel result must be bit-identical for any number of threads
+int VerifyThreadIndependence(bool bReportIndividualTestCases, size_t n) {
+	using namespace sw::ieee;
+	int nrOfFailedTests = 0;
+	std::mt19937_64 rng(42);
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+	std::vector<double> x(n), y(n);
+	for (size_t i = 0; i < n; ++i) {
+		x[i] = std::ldexp(dist(rng), int(rng() % 100) - 50);
+		y[i] = dist(rng);
+	}
+	double serial = fdp(x, y);
+	double serialSum = exact_sum(x);
+	for (unsigned nrThreads : { 1u, 2u, 3u, 7u, 16u }) {
+		double result = parallel_fdp(x, y, nrThreads);
+		double sum = parallel_exact_sum(x, nrThreads);
+		if (!SameBits(result, serial) || !SameBits(sum, serialSum)) {
+			++nrOfFailedTests;
+			if (bReportIndividualTestCases) std::cerr << "FAIL: " << nrThreads << " threads " << std::setprecision(17) << result << " != " << serial << std::endl;
+		}
+	}
+	return nrOfFailedTests;
+}
+
+// best time of a number of runs of a kernel
+template<typename Kernel>
+double BestTime(size_t nrOfRuns, Kernel kernel) {
+	using namespace std::chrono;
+	double best = 1.0e30;
+	for (size_t r = 0; r < nrOfRuns; ++r) {
+		auto begin = steady_clock::now();
+		kernel();
+		double elapsed = duration<double>(steady_clock::now() - begin).count();
+		if (elapsed < best) best = elapsed;
+	}
+	return best;
+}
+
+// throughput of the exact dot product relative to a plain double dot product
+void ReportPerformance(size_t n, size_t nrOfRuns) {
+	std::vector<double> x(n), y(n);
+	std::mt19937_64 rng(3);
+	std::uniform_real_distribution<double> dist(-1.0, 1.0);
+	for (size_t i = 0; i < n; ++i) { x[i] = dist(rng); y[i] = dist(rng); }
+
+	volatile double sink = 0.0;
+	double plain = BestTime(nrOfRuns, [&]() {
+		double s = 0.0;
+		for (size_t i = 0; i < n; ++i) s += x[i] * y[i];
+		sink = s;
+	});
+	double exact = BestTime(nrOfRuns, [&]() { sink = sw::ieee::fdp(x, y); });
+	double parallel = BestTime(nrOfRuns, [&]() { sink = sw::ieee::parallel_fdp(x, y); });
+	(void)sink;
+	std::cout << "dot product of " << n << " doubles, best of " << nrOfRuns << " runs\n";
+	std::cout << "plain dot     " << std::setw(10) << n / plain / 1.0e6 << " MFMA/s\n";
+	std::cout << "fdp           " << std::setw(10) << n / exact / 1.0e6 << " MFMA/s  (" << exact / plain << "x plain)\n";
+	std::cout << "parallel_fdp  " << std::setw(10) << n / parallel / 1.0e6 << " MFMA/s  (" << sw::unum::hardware_concurrency() << " threads)\n";
+}
+
+#define MANUAL_TESTING 0
+#define STRESS_TESTING 0
+
+int main()
+try {
+	using namespace std;
+
+	bool bReportIndividualTestCases = true;
+	int nrOfFailedTestCases = 0;
+
+	std::string tag = "fdp";
+
+#if MANUAL_TESTING
+
+	ReportPerformance(1000000, 10);
+
+#else
+
+	cout << "Exact fused dot product validation" << endl;
+
+	nrOfFailedTestCases += ReportTestResult(VerifyKnownCases(bReportIndividualTestCases), tag, "known cases");
+	nrOfFailedTestCases += ReportTestResult(VerifyRandomDotProducts(bReportIndividualTestCases, 200, 101), tag, "random double dot products");
+	nrOfFailedTestCases += ReportTestResult(VerifyFloatDotProducts(bReportIndividualTestCases, 200, 100), tag, "random float dot products");
+	nrOfFailedTestCases += ReportTestResult(VerifyThreadIndependence(bReportIndividualTestCases, 100000), tag, "thread independence");
+
+#if STRESS_TESTING
+	ReportPerformance(10000000, 10);
+#endif // STRESS_TESTING
+
+#endif // MANUAL_TESTING
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << '\n';
+	return EXIT_FAILURE;
+}
+catch (const std::runtime_error& err) {
+	std::cerr << "Uncaught runtime exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << '\n';
+	return EXIT_FAILURE;
+}
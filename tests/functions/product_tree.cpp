@@ -0,0 +1,177 @@
+// product_tree.cpp: test suite of the product trees, binary splitting factorials, binomial coefficients, and subproduct tree lcm/gcd
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <universal/integer/integer>
+#include <universal/decimal/decimal.hpp>
+#include <universal/functions/functions.hpp>
+// test helpers, such as, ReportTestResults
+#include "../utils/test_helpers.hpp"
+
+// binary splitting factorials against the iterative factorial
+template<typename Scalar>
+int VerifyFactorial(const std::string& tag, unsigned long long upperbound, bool bReportIndividualTestCases) {
+	int nrOfFailedTests = 0;
+	Scalar expected(1);
+	for (unsigned long long n = 0; n <= upperbound; ++n) {
+		if (n > 1) expected *= Scalar(n);
+		Scalar result = sw::function::binary_split_factorial<Scalar>(n, unsigned(1 + n % 3));
+		if (!(result == expected)) {
+			++nrOfFailedTests;
+			if (bReportIndividualTestCases) std::cout << tag << " FAIL " << n << "! = " << result << " expected " << expected << '\n';
+		}
+	}
+	return nrOfFailedTests;
+}
+
+// binomial coefficients against Pascal's triangle
+template<typename Scalar>
+int VerifyBinomial(const std::string& tag, unsigned long long upperbound, bool bReportIndividualTestCases) {
+	int nrOfFailedTests = 0;
+	std::vector<Scalar> row(1, Scalar(1));
+	for (unsigned long long n = 0; n <= upperbound; ++n) {
+		for (unsigned long long k = 0; k <= n + 1; ++k) {
+			Scalar expected = (k <= n ? row[k] : Scalar(0));
+			Scalar result = sw::function::binomial_coefficient<Scalar>(n, k);
+			if (!(result == expected)) {
+				++nrOfFailedTests;
+				if (bReportIndividualTestCases) std::cout << tag << " FAIL (" << n << " over " << k << ") = " << result << " expected " << expected << '\n';
+			}
+		}
+		std::vector<Scalar> next(row.size() + 1, Scalar(1));
+		for (size_t k = 1; k < row.size(); ++k) next[k] = row[k - 1] + row[k];
+		row.swap(next);
+	}
+	return nrOfFailedTests;
+}
+
+// the subproduct tree lcm and gcd against a left to right fold, on sequences whose lcm fits the type
+template<typename Scalar>
+int VerifyLcmGcd(const std::string& tag, unsigned long long maxSize, bool bReportIndividualTestCases) {
+	int nrOfFailedTests = 0;
+	for (unsigned long long size = 1; size <= maxSize; size += 3) {
+		std::vector<Scalar> v;
+		for (unsigned long long i = 0; i < size; ++i) v.push_back(Scalar((i * 37 + 11) % 60 + 2) * Scalar(6));
+		Scalar lcm = v[0], gcd = v[0];
+		for (size_t i = 1; i < v.size(); ++i) {
+			lcm = (v[i] * lcm) / sw::function::gcd(v[i], lcm);
+			gcd = sw::function::gcd(gcd, v[i]);
+		}
+		for (unsigned nrThreads : { 1u, 4u }) {
+			Scalar treeLcm = sw::function::findlcm(v, nrThreads), treeGcd = sw::function::findgcd(v, nrThreads);
+			if (!(treeLcm == lcm) || !(treeGcd == gcd)) {
+				++nrOfFailedTests;
+				if (bReportIndividualTestCases) std::cout << tag << " FAIL " << size << " elements: lcm " << treeLcm << " expected " << lcm << ", gcd " << treeGcd << " expected " << gcd << '\n';
+			}
+		}
+	}
+	return nrOfFailedTests;
+}
+
+// large results do not depend on the number of threads, and agree with independent identities
+int VerifyLargeIntegers(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	constexpr size_t nbits = 32768;
+	using Integer = integer<nbits, uint32_t>;
+	int nrOfFailedTests = 0;
+	// 2000! has 5736 decimal digits, 19053 bits
+	Integer f1 = factorial<nbits, uint32_t>(2000, 1), f4 = factorial<nbits, uint32_t>(2000, 4);
+	// (2000 over 1000) = 2000! / (1000!)^2
+	Integer g = factorial<nbits, uint32_t>(1000);
+	Integer c = binomial<nbits, uint32_t>(2000, 1000, 3);
+	std::vector<Integer> factors = { c, g, g };
+	if (!(f1 == f4) || !(product(factors, 2) == f1)) {
+		++nrOfFailedTests;
+		if (bReportIndividualTestCases) std::cout << tag << " FAIL 2000! = (2000 over 1000) * 1000! * 1000!\n";
+	}
+	// 100 = 2^2 5^2 adds no new prime power to lcm(1..99), the prime 101 does
+	std::vector<Integer> range;
+	for (int i = 1; i <= 100; ++i) range.push_back(Integer(i));
+	Integer l100 = lcm(range, 4);
+	range.pop_back();
+	if (!(l100 == lcm(range))) ++nrOfFailedTests;
+	range.push_back(Integer(101));
+	if (!(lcm(range) == product(std::vector<Integer>{ l100, Integer(101) }))) ++nrOfFailedTests;
+	Integer g7 = product(std::vector<Integer>{ g, Integer(7) });
+	if (!(gcd(std::vector<Integer>{ f1, g7, c }) == gcd(g7, c))) ++nrOfFailedTests;
+	return nrOfFailedTests;
+}
+
+#define MANUAL_TESTING 0
+#define STRESS_TESTING 0
+
+int main()
+try {
+	using namespace std;
+	using namespace sw::unum;
+
+	std::string tag = "product tree failed";
+
+#if MANUAL_TESTING
+
+	// the time of 100000! with binary splitting on 1 and all hardware threads against the iterative factorial of a smaller argument
+	constexpr size_t nbits = 1600000;
+	using Integer = integer<nbits, uint32_t>;
+	for (unsigned nrThreads : { 1u, hardware_concurrency() }) {
+		chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+		Integer f = factorial<nbits, uint32_t>(100000, nrThreads);
+		double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+		cout << "100000! on " << nrThreads << " threads in " << elapsed << " sec\n";
+	}
+	{
+		using Integer = integer<4096, uint32_t>;
+		chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+		Integer f = sw::function::factoriali(Integer(400));
+		double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+		cout << "400! iterative in integer<4096> in " << elapsed << " sec\n";
+		begin = chrono::steady_clock::now();
+		Integer g = factorial<4096, uint32_t>(400);
+		elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+		cout << "400! binary splitting in integer<4096> in " << elapsed << " sec " << (f == g ? "PASS" : "FAIL") << '\n';
+	}
+
+	cout << "done" << endl;
+
+	return EXIT_SUCCESS;
+#else
+	std::cout << "Product tree verification" << std::endl;
+
+	bool bReportIndividualTestCases = false;
+	int nrOfFailedTestCases = 0;
+
+	nrOfFailedTestCases += ReportTestResult(VerifyFactorial<unsigned long long>(tag, 20, bReportIndividualTestCases), "unsigned long long", "factorial");
+	nrOfFailedTestCases += ReportTestResult(VerifyFactorial< integer<1024, uint32_t> >(tag, 150, bReportIndividualTestCases), "integer<1024, uint32_t>", "factorial");
+	nrOfFailedTestCases += ReportTestResult(VerifyFactorial<decimal>(tag, 40, bReportIndividualTestCases), "decimal", "factorial");
+	nrOfFailedTestCases += ReportTestResult(VerifyBinomial<unsigned long long>(tag, 60, bReportIndividualTestCases), "unsigned long long", "binomial");
+	nrOfFailedTestCases += ReportTestResult(VerifyBinomial< integer<256, uint8_t> >(tag, 120, bReportIndividualTestCases), "integer<256, uint8_t>", "binomial");
+	nrOfFailedTestCases += ReportTestResult(VerifyBinomial<decimal>(tag, 30, bReportIndividualTestCases), "decimal", "binomial");
+	nrOfFailedTestCases += ReportTestResult(VerifyLcmGcd<unsigned long long>(tag, 7, bReportIndividualTestCases), "unsigned long long", "lcm/gcd");
+	nrOfFailedTestCases += ReportTestResult(VerifyLcmGcd< integer<512, uint32_t> >(tag, 40, bReportIndividualTestCases), "integer<512, uint32_t>", "lcm/gcd");
+	nrOfFailedTestCases += ReportTestResult(VerifyLargeIntegers(tag, bReportIndividualTestCases), "integer<32768, uint32_t>", "large products");
+
+#if STRESS_TESTING
+
+	nrOfFailedTestCases += ReportTestResult(VerifyFactorial< integer<16384, uint32_t> >(tag, 1500, bReportIndividualTestCases), "integer<16384, uint32_t>", "factorial");
+
+#endif // STRESS_TESTING
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+
+#endif // MANUAL_TESTING
+}
+catch (char const* msg) {
+	std::cerr << msg << '\n';
+	return EXIT_FAILURE;
+}
+catch (const std::runtime_error& err) {
+	std::cerr << "Uncaught runtime exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << '\n';
+	return EXIT_FAILURE;
+}
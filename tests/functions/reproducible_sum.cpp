@@ -0,0 +1,203 @@
+// reproducible_sum.cpp: test suite for the reproducible sum and dot product kernels of float and double
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+// route the blas L1 reductions of native types through the reproducible kernels
+#define BLAS_L1_REPRODUCIBLE 1
+#include <universal/blas/blas.hpp>
+#include <universal/functions/reproducible_sum.hpp>
+#include <universal/float/fdp.hpp>
+#include "../utils/test_helpers.hpp"
+
+template<typename Real>
+bool SameBits(Real a, Real b) {
+	return std::memcmp(&a, &b, sizeof(Real)) == 0;
+}
+
+// values with a wide exponent range and mixed signs
+template<typename Real>
+std::vector<Real> GenerateValues(size_t n, unsigned seed, int exponentRange) {
+	std::mt19937_64 rng(seed);
+	std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+	std::uniform_int_distribution<int> exponent(-exponentRange, exponentRange);
+	std::vector<Real> v(n);
+	for (auto& e : v) e = Real(std::ldexp(mantissa(rng), exponent(rng)));
+	return v;
+}
+
+// sum, asum and dot must not change with the thread count or the order of the elements
+template<typename Real>
+int VerifyReproducibility(bool bReportIndividualTestCases, size_t n) {
+	using namespace sw::function;
+	int nrOfFailedTests = 0;
+	std::vector<Real> x = GenerateValues<Real>(n, 1, 20), y = GenerateValues<Real>(n, 2, 20);
+	Real sum = reproducible_sum(x), asum = reproducible_asum(n, x.data()), dot = reproducible_dot(x, y);
+	std::mt19937_64 rng(3);
+	std::vector<size_t> permutation(n);
+	for (size_t i = 0; i < n; ++i) permutation[i] = i;
+	for (unsigned nrThreads : { 1u, 2u, 3u, 5u, 8u, 13u }) {
+		std::shuffle(permutation.begin(), permutation.end(), rng);
+		std::vector<Real> px(n), py(n);
+		for (size_t i = 0; i < n; ++i) { px[i] = x[permutation[i]]; py[i] = y[permutation[i]]; }
+		Real s = reproducible_sum(px, nrThreads);
+		Real a = reproducible_asum(n, px.data(), 1, nrThreads);
+		Real d = reproducible_dot(px, py, nrThreads);
+		if (!SameBits(s, sum) || !SameBits(a, asum) || !SameBits(d, dot)) {
+			++nrOfFailedTests;
+			if (bReportIndividualTestCases) {
+				std::cerr << "FAIL: " << nrThreads << " threads " << std::setprecision(17)
+					<< s << " vs " << sum << ", " << a << " vs " << asum << ", " << d << " vs " << dot << std::endl;
+			}
+		}
+	}
+	return nrOfFailedTests;
+}
+
+// against the exact result of the Kulisch accumulator: well-conditioned reductions are within an ulp
+template<typename Real>
+int VerifyAccuracy(bool bReportIndividualTestCases, size_t nrOfTests, size_t n) {
+	using namespace sw::function;
+	int nrOfFailedTests = 0;
+	for (size_t t = 0; t < nrOfTests; ++t) {
+		std::vector<Real> x = GenerateValues<Real>(n, unsigned(10 + t), 30), y = GenerateValues<Real>(n, unsigned(100 + t), 30);
+		for (auto& e : y) e = std::abs(e);
+		std::vector<Real> ax(n);
+		for (size_t i = 0; i < n; ++i) ax[i] = std::abs(x[i]);
+		Real asum = reproducible_asum(n, x.data());
+		Real exactAsum = sw::ieee::exact_sum(ax);
+		Real dot = reproducible_dot(ax, y);
+		Real exactDot = sw::ieee::fdp(ax, y);
+		Real ulpAsum = std::nextafter(exactAsum, std::numeric_limits<Real>::infinity()) - exactAsum;
+		Real ulpDot = std::nextafter(exactDot, std::numeric_limits<Real>::infinity()) - exactDot;
+		if (std::abs(asum - exactAsum) > ulpAsum || std::abs(dot - exactDot) > ulpDot) {
+			++nrOfFailedTests;
+			if (bReportIndividualTestCases) {
+				std::cerr << "FAIL: asum " << std::setprecision(17) << asum << " exact " << exactAsum
+					<< ", dot " << dot << " exact " << exactDot << std::endl;
+			}
+		}
+	}
+	return nrOfFailedTests;
+}
+
+// cancellation, scaling, and IEEE special values
+int VerifySpecialCases(bool bReportIndividualTestCases) {
+	using namespace sw::function;
+	int nrOfFailedTests = 0;
+	double inf = std::numeric_limits<double>::infinity();
+	double maxd = std::numeric_limits<double>::max();
+	struct Case { std::vector<double> x; double expected; };
+	std::vector<Case> cases = {
+		{ { 1.0e16, 1.0, -1.0e16 }, 1.0 },
+		{ { 1.0, 1.0e-20, -1.0 }, 1.0e-20 },
+		{ { maxd, maxd, -maxd }, maxd },
+		{ { 0.0, 0.0 }, 0.0 },
+		{ { }, 0.0 },
+		{ { inf, 1.0, maxd }, inf },
+		{ { maxd, -inf, 1.0 }, -inf },
+	};
+	for (const Case& c : cases) {
+		double result = reproducible_sum(c.x);
+		if (!SameBits(result, c.expected)) {
+			++nrOfFailedTests;
+			if (bReportIndividualTestCases) std::cerr << "FAIL: reproducible_sum = " << std::setprecision(17) << result << " expected " << c.expected << std::endl;
+		}
+	}
+	if (!std::isnan(reproducible_sum(std::vector<double>{ inf, -inf, 1.0 }))) ++nrOfFailedTests;
+	if (!std::isnan(reproducible_sum(std::vector<double>{ 1.0, std::numeric_limits<double>::quiet_NaN() }))) ++nrOfFailedTests;
+	// the rounding error of the products is recovered: (1 + 2^-30)^2 - 1 - 2^-29 = 2^-60
+	double a = 1.0 + std::ldexp(1.0, -30);
+	double dot = reproducible_dot(std::vector<double>{ a, 1.0, 1.0 }, std::vector<double>{ a, -1.0, -std::ldexp(1.0, -29) });
+	if (dot != std::ldexp(1.0, -60)) {
+		++nrOfFailedTests;
+		if (bReportIndividualTestCases) std::cerr << "FAIL: reproducible_dot = " << dot << " expected " << std::ldexp(1.0, -60) << std::endl;
+	}
+	return nrOfFailedTests;
+}
+
+// blas::sum, blas::asum and blas::dot of native vectors use the reproducible kernels when BLAS_L1_REPRODUCIBLE is set
+int VerifyBlasIntegration(bool bReportIndividualTestCases, size_t n) {
+	using namespace sw::unum::blas;
+	int nrOfFailedTests = 0;
+	std::vector<double> sx = GenerateValues<double>(n, 7, 25), sy = GenerateValues<double>(n, 8, 25);
+	vector<double> x(n), y(n);
+	for (size_t i = 0; i < n; ++i) { x[i] = sx[i]; y[i] = sy[i]; }
+	std::vector<double> rx(sx.rbegin(), sx.rend()), ry(sy.rbegin(), sy.rend());
+	if (!SameBits(sum(x), sw::function::reproducible_sum(rx))) ++nrOfFailedTests;
+	if (!SameBits(asum(n, x, 1), sw::function::reproducible_asum(n, rx.data()))) ++nrOfFailedTests;
+	if (!SameBits(dot(x, y), sw::function::reproducible_dot(rx, ry))) ++nrOfFailedTests;
+	if (!SameBits(dot(n, x, 1, y, 1), reproducible_dot(x, y, 4))) ++nrOfFailedTests;
+	if (!SameBits(dot(n / 2, x, 2, y, 2), sw::function::reproducible_dot(n / 2, sx.data(), 2, sy.data(), 2, 3))) ++nrOfFailedTests;
+	if (nrOfFailedTests && bReportIndividualTestCases) std::cerr << "FAIL: blas L1 reductions are not reproducible" << std::endl;
+	return nrOfFailedTests;
+}
+
+#define MANUAL_TESTING 0
+#define STRESS_TESTING 0
+
+int main()
+try {
+	using namespace std;
+
+	bool bReportIndividualTestCases = true;
+	int nrOfFailedTestCases = 0;
+
+	std::string tag = "reproducible sum";
+
+#if MANUAL_TESTING
+
+	nrOfFailedTestCases += ReportTestResult(VerifySpecialCases(bReportIndividualTestCases), tag, "special cases");
+
+#else
+
+	cout << "Reproducible summation validation" << endl;
+
+	nrOfFailedTestCases += ReportTestResult(VerifySpecialCases(bReportIndividualTestCases), tag, "special cases");
+	nrOfFailedTestCases += ReportTestResult(VerifyReproducibility<float>(bReportIndividualTestCases, 10007), tag, "float thread and order independence");
+	nrOfFailedTestCases += ReportTestResult(VerifyReproducibility<double>(bReportIndividualTestCases, 10007), tag, "double thread and order independence");
+	nrOfFailedTestCases += ReportTestResult(VerifyAccuracy<float>(bReportIndividualTestCases, 20, 1000), tag, "float accuracy");
+	nrOfFailedTestCases += ReportTestResult(VerifyAccuracy<double>(bReportIndividualTestCases, 20, 1000), tag, "double accuracy");
+	nrOfFailedTestCases += ReportTestResult(VerifyBlasIntegration(bReportIndividualTestCases, 1000), tag, "blas integration");
+
+#if STRESS_TESTING
+	nrOfFailedTestCases += ReportTestResult(VerifyReproducibility<double>(bReportIndividualTestCases, 10000000), tag, "double thread and order independence");
+#endif // STRESS_TESTING
+
+#endif // MANUAL_TESTING
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,264 @@
+// charconv.cpp: test suite of the radix conversion of arbitrary integers with to_chars and from_chars
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <universal/integer/integer>
+// test helpers, such as, ReportTestResults
+#include "../utils/test_helpers.hpp"
+
+// the number of allocations of the program, to verify that the conversions do not allocate
+static size_t nrOfAllocations = 0;
+void* operator new(std::size_t size) {
+	++nrOfAllocations;
+	if (void* p = std::malloc(size ? size : 1)) return p;
+	throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// the digits of a magnitude by repeated division by the base, the schoolbook reference of the conversion
+std::string ReferenceDigits(sw::unum::impl::limbs a, unsigned base) {
+	std::string digits;
+	do {
+		uint32_t d = sw::unum::impl::div_small(a, base);
+		digits.insert(digits.begin(), char(d < 10 ? '0' + d : 'a' + d - 10));
+	} while (!a.empty());
+	return digits;
+}
+
+// a random integer of nrBits significant bits and a random sign
+template<size_t nbits, typename BlockType>
+sw::unum::integer<nbits, BlockType> RandomInteger(std::mt19937_64& engine, size_t nrBits) {
+	using namespace sw::unum;
+	impl::limbs a((nrBits + 31) / 32);
+	for (uint32_t& l : a) l = uint32_t(engine());
+	if (nrBits % 32) a.back() &= (1u << (nrBits % 32)) - 1;
+	if (nrBits > 0) a.back() |= (1u << ((nrBits - 1) % 32));
+	integer<nbits, BlockType> v = impl::from_limbs<nbits, BlockType>(a);
+	return (engine() & 1 ? -v : v);
+}
+
+// 64-bit integers against the std::to_chars and std::from_chars of long long in every base
+int VerifyNative(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	using Integer = integer<64, uint32_t>;
+	int nrOfFailedTests = 0;
+	std::mt19937_64 engine(1);
+	for (int t = 0; t < 2000; ++t) {
+		long long v = (long long)(engine() >> (engine() % 64));
+		if (t & 1) v = -v;
+		if (t == 0) v = 0;
+		if (t == 1) v = (long long)(1ull << 63);
+		Integer a(v);
+		for (int base = 2; base <= 36; ++base) {
+			char expected[72], buffer[72];
+			std::to_chars_result e = std::to_chars(expected, expected + sizeof(expected), v, base);
+			std::to_chars_result r = to_chars(buffer, buffer + sizeof(buffer), a, base);
+			Integer b;
+			std::from_chars_result f = from_chars(buffer, r.ptr, b, base);
+			if (r.ec != std::errc() || std::string(buffer, r.ptr) != std::string(expected, e.ptr) || f.ec != std::errc() || f.ptr != r.ptr || b != a) {
+				++nrOfFailedTests;
+				if (bReportIndividualTestCases) std::cout << tag << " FAIL " << v << " base " << base << ": " << std::string(buffer, r.ptr) << " expected " << std::string(expected, e.ptr) << '\n';
+			}
+		}
+	}
+	return nrOfFailedTests;
+}
+
+// values above the divide and conquer threshold against the schoolbook conversion, and their round trip
+template<size_t nbits, typename BlockType>
+int VerifyLargeValues(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	using Integer = integer<nbits, BlockType>;
+	int nrOfFailedTests = 0;
+	std::mt19937_64 engine(nbits);
+	std::vector<char> buffer(nbits + 2);
+	for (int t = 0; t < 40; ++t) {
+		size_t nrBits = (t < 4 ? nbits - 1 : 1 + size_t(engine() % (nbits - 1)));
+		Integer a = RandomInteger<nbits, BlockType>(engine, nrBits);
+		bool negative;
+		impl::limbs magnitude = impl::to_limbs(a, negative);
+		for (int base : { 10, 16, 2, 7, 36 }) {
+			std::string expected = (negative ? "-" : "") + ReferenceDigits(magnitude, unsigned(base));
+			std::to_chars_result r = to_chars(buffer.data(), buffer.data() + buffer.size(), a, base);
+			Integer b;
+			std::from_chars_result f = from_chars(buffer.data(), r.ptr, b, base);
+			if (r.ec != std::errc() || std::string(buffer.data(), r.ptr) != expected || f.ec != std::errc() || f.ptr != r.ptr || b != a) {
+				++nrOfFailedTests;
+				if (bReportIndividualTestCases) std::cout << tag << " FAIL " << nrBits << " bits in base " << base << '\n';
+			}
+		}
+	}
+	return nrOfFailedTests;
+}
+
+// the conversions above the divide and conquer threshold do not allocate, also not the first one in a base
+template<size_t nbits, typename BlockType>
+int VerifyAllocationFree(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	using Integer = integer<nbits, BlockType>;
+	int nrOfFailedTests = 0;
+	std::mt19937_64 engine(5);
+	std::vector<char> buffer(nbits + 2);
+	for (int t = 0; t < 8; ++t) {
+		Integer a = RandomInteger<nbits, BlockType>(engine, nbits - 1 - size_t(t));
+		for (int base : { 10, 3, 36, 16 }) {
+			Integer b;
+			size_t before = nrOfAllocations;
+			std::to_chars_result r = to_chars(buffer.data(), buffer.data() + buffer.size(), a, base);
+			std::from_chars_result f = from_chars(buffer.data(), r.ptr, b, base);
+			if (nrOfAllocations != before || r.ec != std::errc() || f.ec != std::errc() || b != a) {
+				++nrOfFailedTests;
+				if (bReportIndividualTestCases) std::cout << tag << " FAIL " << (nrOfAllocations - before) << " allocations in base " << base << '\n';
+			}
+		}
+	}
+	return nrOfFailedTests;
+}
+
+// buffer sizes, invalid and out of range text, leading zeros, and the stream operators
+template<size_t nbits, typename BlockType>
+int VerifyEdgeCases(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	using Integer = integer<nbits, BlockType>;
+	int nrOfFailedTests = 0;
+	std::mt19937_64 engine(3);
+	Integer maxneg(1);
+	maxneg <<= int(nbits - 1);
+	Integer maxpos = maxneg - Integer(1);
+	std::vector<char> buffer(nbits + 2);
+	for (int base : { 10, 16, 3 }) {
+		for (const Integer& v : { maxpos, maxneg, Integer(0), Integer(-1), RandomInteger<nbits, BlockType>(engine, nbits / 2) }) {
+			std::to_chars_result r = to_chars(buffer.data(), buffer.data() + buffer.size(), v, base);
+			size_t size = size_t(r.ptr - buffer.data());
+			// the exact size fits, one character less does not
+			std::to_chars_result exact = to_chars(buffer.data(), buffer.data() + size, v, base);
+			std::to_chars_result small = to_chars(buffer.data(), buffer.data() + size - 1, v, base);
+			if (exact.ec != std::errc() || exact.ptr != r.ptr || small.ec != std::errc::value_too_large) ++nrOfFailedTests;
+			Integer w(7);
+			std::from_chars_result f = from_chars(buffer.data(), r.ptr, w, base);
+			if (f.ec != std::errc() || w != v) ++nrOfFailedTests;
+			// one beyond the most positive and most negative values is out of range, and leaves the value unmodified
+			if (v == maxpos || v == maxneg) {
+				std::string txt(buffer.data(), r.ptr);
+				size_t last = txt.size() - 1;
+				while (txt[last] == char(base == 16 ? 'f' : '0' + base - 1)) txt[last--] = '0';
+				++txt[last];
+				if (txt[last] == '9' + 1) txt[last] = 'a';
+				w = Integer(7);
+				f = from_chars(txt.data(), txt.data() + txt.size(), w, base);
+				if (f.ec != std::errc::result_out_of_range || f.ptr != txt.data() + txt.size() || w != Integer(7)) {
+					++nrOfFailedTests;
+					if (bReportIndividualTestCases) std::cout << tag << " FAIL out of range " << txt << " base " << base << '\n';
+				}
+			}
+		}
+	}
+	// invalid text, the end of the digits, and leading zeros
+	Integer v(5);
+	for (std::string txt : { "", "-", "+1", "x1", "-x" }) {
+		std::from_chars_result f = from_chars(txt.data(), txt.data() + txt.size(), v);
+		if (f.ec != std::errc::invalid_argument || f.ptr != txt.data() || v != Integer(5)) ++nrOfFailedTests;
+	}
+	std::string txt = "-00123ab";
+	std::from_chars_result f = from_chars(txt.data(), txt.data() + txt.size(), v);
+	if (f.ec != std::errc() || f.ptr != txt.data() + 6 || v != Integer(-123)) ++nrOfFailedTests;
+	f = from_chars(txt.data(), txt.data() + txt.size(), v, 16);
+	if (f.ec != std::errc() || f.ptr != txt.data() + txt.size() || v != Integer(-0x123ab)) ++nrOfFailedTests;
+	txt = std::string(5000, '0') + "42";
+	f = from_chars(txt.data(), txt.data() + txt.size(), v);
+	if (f.ec != std::errc() || v != Integer(42)) ++nrOfFailedTests;
+	// the stream operators and parse() of integer.hpp agree with to_chars
+	for (const Integer& a : { RandomInteger<nbits, BlockType>(engine, nbits - 3), maxpos, maxneg, Integer(0), Integer(-1) }) {
+		std::stringstream ss;
+		ss << a;
+		std::to_chars_result r = to_chars(buffer.data(), buffer.data() + buffer.size(), a);
+		Integer b;
+		if (ss.str() != std::string(buffer.data(), r.ptr) || !parse(ss.str(), b) || b != a) {
+			++nrOfFailedTests;
+			if (bReportIndividualTestCases) std::cout << tag << " FAIL stream " << ss.str() << '\n';
+		}
+		if (a != maxneg && (!parse("+" + ss.str(), b) || b != a || !parse("-" + ss.str(), b) || b != -a)) ++nrOfFailedTests;
+	}
+	// parse() rejects one beyond the most positive value
+	Integer b;
+	std::stringstream ss;
+	ss << maxneg;
+	if (parse(ss.str().substr(1), b)) ++nrOfFailedTests;
+	return nrOfFailedTests;
+}
+
+#define MANUAL_TESTING 0
+#define STRESS_TESTING 0
+
+int main()
+try {
+	using namespace std;
+	using namespace sw::unum;
+
+	std::string tag = "charconv failed";
+
+#if MANUAL_TESTING
+
+	// the time of the decimal conversions of integer<nbits> in both directions
+	constexpr size_t nbits = 65536;
+	using Integer = integer<nbits, uint32_t>;
+	std::mt19937_64 engine(1);
+	Integer a = RandomInteger<nbits, uint32_t>(engine, nbits - 1);
+	std::vector<char> buffer(nbits);
+	chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+	std::to_chars_result r = to_chars(buffer.data(), buffer.data() + buffer.size(), a);
+	double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+	cout << "to_chars of " << (r.ptr - buffer.data()) << " digits in " << elapsed << " sec\n";
+	begin = chrono::steady_clock::now();
+	Integer b;
+	from_chars(buffer.data(), r.ptr, b);
+	elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+	cout << "from_chars in " << elapsed << " sec " << (a == b ? "PASS" : "FAIL") << '\n';
+
+	cout << "done" << endl;
+
+	return EXIT_SUCCESS;
+#else
+	std::cout << "Radix conversion verification" << std::endl;
+
+	bool bReportIndividualTestCases = false;
+	int nrOfFailedTestCases = 0;
+
+	nrOfFailedTestCases += ReportTestResult(VerifyNative(tag, bReportIndividualTestCases), "integer<64, uint32_t>", "std::to_chars");
+	nrOfFailedTestCases += ReportTestResult(VerifyLargeValues<4096, uint32_t>(tag, bReportIndividualTestCases), "integer<4096, uint32_t>", "large values");
+	nrOfFailedTestCases += ReportTestResult(VerifyLargeValues<12000, uint8_t>(tag, bReportIndividualTestCases), "integer<12000, uint8_t>", "large values");
+	nrOfFailedTestCases += ReportTestResult(VerifyAllocationFree<8192, uint32_t>(tag, bReportIndividualTestCases), "integer<8192, uint32_t>", "allocation free");
+	nrOfFailedTestCases += ReportTestResult(VerifyEdgeCases<20, uint8_t>(tag, bReportIndividualTestCases), "integer<20, uint8_t>", "edge cases");
+	nrOfFailedTestCases += ReportTestResult(VerifyEdgeCases<4096, uint32_t>(tag, bReportIndividualTestCases), "integer<4096, uint32_t>", "edge cases");
+
+#if STRESS_TESTING
+
+	nrOfFailedTestCases += ReportTestResult(VerifyLargeValues<65536, uint32_t>(tag, bReportIndividualTestCases), "integer<65536, uint32_t>", "large values");
+
+#endif // STRESS_TESTING
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+
+#endif // MANUAL_TESTING
+}
+catch (char const* msg) {
+	std::cerr << msg << '\n';
+	return EXIT_FAILURE;
+}
+catch (const std::runtime_error& err) {
+	std::cerr << "Uncaught runtime exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << '\n';
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,226 @@
+// modular.cpp: test suite of the Montgomery and Barrett modular arithmetic, Miller-Rabin, and Pollard rho on arbitrary precision integers
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <universal/integer/integer>
+// test helpers, such as, ReportTestResults
+#include "../utils/test_helpers.hpp"
+
+// 2^p
+template<typename Integer>
+Integer PowerOfTwo(int p) {
+	Integer r(1);
+	r <<= p;
+	return r;
+}
+
+// Karatsuba against the schoolbook product, and quotient * divisor + remainder == dividend with remainder < divisor,
+// for random operands of lengths around the Karatsuba threshold and divisors with sparse and dense leading limbs
+int VerifyLimbKernels(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum::impl;
+	int nrOfFailedTests = 0;
+	std::mt19937_64 engine(1);
+	auto random_limbs = [&](size_t n) {
+		limbs r(n);
+		for (uint32_t& l : r) l = uint32_t(engine());
+		if (n > 0 && engine() % 4 == 0) r.back() = 1;              // a divisor that needs the full normalization shift
+		if (n > 1 && engine() % 4 == 0) r[n / 2] = 0xffffffffu;
+		trim(r);
+		return r;
+	};
+	const size_t lengths[] = { 0, 1, 2, 3, 17, 31, 32, 33, 47, 64, 65, 100, 250 };
+	for (size_t na : lengths) {
+		for (size_t nb : lengths) {
+			limbs a = random_limbs(na), b = random_limbs(nb);
+			limbs expected = limb_mul(a, b);
+			trim(expected);
+			limbs product = karatsuba_mul(a, b);
+			if (product != expected) {
+				++nrOfFailedTests;
+				if (bReportIndividualTestCases) std::cout << tag << " FAIL karatsuba " << na << " x " << nb << " limbs\n";
+			}
+			if (b.empty()) continue;
+			limbs q, r;
+			limb_divmod(a, b, &q, r);
+			limbs back = add_magnitudes(karatsuba_mul(q, b), r);
+			limbs a_trimmed(a);
+			trim(a_trimmed);
+			if (back != a_trimmed || limb_compare(r, b) >= 0) {
+				++nrOfFailedTests;
+				if (bReportIndividualTestCases) std::cout << tag << " FAIL divmod " << na << " / " << nb << " limbs\n";
+			}
+		}
+	}
+	return nrOfFailedTests;
+}
+
+// compare modexp and mulmod against 64-bit native arithmetic for all small operands, odd and even moduli, and negative bases
+template<size_t nbits, typename BlockType>
+int VerifyModexp(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	using Integer = integer<nbits, BlockType>;
+	int nrOfFailedTests = 0;
+	for (long long m = 1; m < 40; ++m) {
+		for (long long a = -20; a < 60; a += 3) {
+			for (long long e = 0; e < 20; ++e) {
+				long long expected = 1 % m, b = ((a % m) + m) % m;
+				for (long long k = 0; k < e; ++k) expected = (expected * b) % m;
+				Integer result = modexp(Integer(a), Integer(e), Integer(m));
+				if (result != Integer(expected)) {
+					++nrOfFailedTests;
+					if (bReportIndividualTestCases) std::cout << tag << " FAIL " << a << "^" << e << " mod " << m << " = " << result << " expected " << expected << '\n';
+				}
+			}
+			long long product = (((a % m) + m) % m) * (((a + 7) % m + m) % m) % m;
+			if (mulmod(Integer(a), Integer(a + 7), Integer(m)) != Integer(product)) {
+				++nrOfFailedTests;
+				if (bReportIndividualTestCases) std::cout << tag << " FAIL mulmod " << a << " * " << a + 7 << " mod " << m << '\n';
+			}
+		}
+	}
+	return nrOfFailedTests;
+}
+
+// Fermat's little theorem for Mersenne primes, and Montgomery and Barrett agree on multi-limb operands
+template<size_t nbits, typename BlockType>
+int VerifyMultiLimb(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	using Integer = integer<nbits, BlockType>;
+	int nrOfFailedTests = 0;
+	for (int p : { 61, 89, 107, 127, 521 }) {
+		if (size_t(p) + 2 > nbits) continue;
+		Integer one(1);
+		Integer mersenne = PowerOfTwo<Integer>(p) - one;
+		Integer a = Integer(1234567891) * Integer(987654321) + Integer(p);
+		montgomery_context<nbits, BlockType> montgomery(mersenne);
+		barrett_context<nbits, BlockType> barrett(mersenne);
+		Integer m1 = montgomery.pow(a, mersenne - one);
+		Integer b1 = barrett.pow(a, mersenne - one);
+		Integer half = mersenne;
+		half >>= 1;
+		Integer mHalf = montgomery.pow(a, half), bHalf = barrett.pow(a, half);
+		if (m1 != one || b1 != one || mHalf != bHalf || montgomery.mul(a, a) != barrett.mul(a, a)) {
+			++nrOfFailedTests;
+			if (bReportIndividualTestCases) std::cout << tag << " FAIL 2^" << p << " - 1 : " << m1 << " " << b1 << '\n';
+		}
+	}
+	return nrOfFailedTests;
+}
+
+// Miller-Rabin against trial division, strong pseudoprimes, and large primes and composites
+template<size_t nbits, typename BlockType>
+int VerifyMillerRabin(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	using Integer = integer<nbits, BlockType>;
+	int nrOfFailedTests = 0;
+	auto check = [&](const Integer& n, bool prime) {
+		if (miller_rabin(n) != prime) {
+			++nrOfFailedTests;
+			if (bReportIndividualTestCases) std::cout << tag << " FAIL " << n << (prime ? " is prime" : " is composite") << '\n';
+		}
+	};
+	for (long long n = -5; n < 5000; ++n) {
+		bool prime = n > 1;
+		for (long long d = 2; d * d <= n && prime; ++d) prime = (n % d != 0);
+		check(Integer(n), prime);
+	}
+	check(Integer(561), false);                    // Carmichael number
+	check(Integer(1194649), false);                // 1093^2, a Wieferich square
+	check(Integer(3215031751ll), false);           // strong pseudoprime to the bases 2, 3, 5, 7
+	check(Integer(3825123056546413051ll), false);  // strong pseudoprime to the bases 2 to 23
+	check(Integer(1000000007), true);
+	check(Integer(2305843009213693951ll), true);   // 2^61 - 1
+	Integer one(1);
+	check(PowerOfTwo<Integer>(89) - one, true);
+	check(PowerOfTwo<Integer>(67) - one, false);  // 193707721 * 761838257287
+	check(PowerOfTwo<Integer>(127) - one, true);
+	check(PowerOfTwo<Integer>(128) + one, false);  // Fermat number F7
+	if (nbits > 600) {
+		check(PowerOfTwo<Integer>(521) - one, true);
+		check(PowerOfTwo<Integer>(523) - one, false);
+	}
+	return nrOfFailedTests;
+}
+
+// Pollard rho with Brent's cycle detection finds a proper factor of composites
+template<size_t nbits, typename BlockType>
+int VerifyPollardRho(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	using Integer = integer<nbits, BlockType>;
+	int nrOfFailedTests = 0;
+	Integer one(1);
+	std::vector<Integer> composites = { Integer(8051), Integer(10403), Integer(1000000016000000063ll), PowerOfTwo<Integer>(67) - one, Integer(1000000007) * Integer(998244353) };
+	for (const Integer& n : composites) {
+		Integer factor = pollardRhoFactorization(n);
+		if (factor <= one || factor >= n || !(n % factor).iszero()) {
+			++nrOfFailedTests;
+			if (bReportIndividualTestCases) std::cout << tag << " FAIL " << n << " factor " << factor << '\n';
+		}
+	}
+	if (pollardRhoFactorization(Integer(1000000007)) != one) ++nrOfFailedTests;
+	return nrOfFailedTests;
+}
+
+#define MANUAL_TESTING 0
+#define STRESS_TESTING 0
+
+int main()
+try {
+	using namespace std;
+	using namespace sw::unum;
+
+	std::string tag = "modular arithmetic failed";
+
+#if MANUAL_TESTING
+
+	using Integer = integer<256, uint32_t>;
+	Integer m = PowerOfTwo<Integer>(127) - Integer(1);
+	cout << "3^(2^127 - 2) mod 2^127 - 1 = " << modexp(Integer(3), m - Integer(1), m) << endl;
+	cout << "2^67 - 1 has factor " << pollardRhoFactorization(PowerOfTwo<Integer>(67) - Integer(1)) << endl;
+
+	ReportTestResult(VerifyModexp<16, uint8_t>(tag, true), "integer<16, uint8_t>", "modexp");
+
+	cout << "done" << endl;
+
+	return EXIT_SUCCESS;
+#else
+	std::cout << "Modular arithmetic verification" << std::endl;
+
+	bool bReportIndividualTestCases = false;
+	int nrOfFailedTestCases = 0;
+
+	nrOfFailedTestCases += ReportTestResult(VerifyLimbKernels(tag, bReportIndividualTestCases), "limbs", "karatsuba/divmod");
+	nrOfFailedTestCases += ReportTestResult(VerifyModexp<16, uint8_t>(tag, bReportIndividualTestCases), "integer<16, uint8_t>", "modexp");
+	nrOfFailedTestCases += ReportTestResult(VerifyModexp<128, uint32_t>(tag, bReportIndividualTestCases), "integer<128, uint32_t>", "modexp");
+	nrOfFailedTestCases += ReportTestResult(VerifyMultiLimb<256, uint32_t>(tag, bReportIndividualTestCases), "integer<256, uint32_t>", "montgomery/barrett");
+	nrOfFailedTestCases += ReportTestResult(VerifyMultiLimb<1024, uint32_t>(tag, bReportIndividualTestCases), "integer<1024, uint32_t>", "montgomery/barrett");
+	nrOfFailedTestCases += ReportTestResult(VerifyMillerRabin<160, uint32_t>(tag, bReportIndividualTestCases), "integer<160, uint32_t>", "miller-rabin");
+	nrOfFailedTestCases += ReportTestResult(VerifyMillerRabin<1024, uint32_t>(tag, bReportIndividualTestCases), "integer<1024, uint32_t>", "miller-rabin");
+	nrOfFailedTestCases += ReportTestResult(VerifyPollardRho<128, uint32_t>(tag, bReportIndividualTestCases), "integer<128, uint32_t>", "pollard rho");
+
+#if STRESS_TESTING
+
+	nrOfFailedTestCases += ReportTestResult(VerifyMillerRabin<4096, uint32_t>(tag, bReportIndividualTestCases), "integer<4096, uint32_t>", "miller-rabin");
+
+#endif // STRESS_TESTING
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+
+#endif // MANUAL_TESTING
+}
+catch (char const* msg) {
+	std::cerr << msg << '\n';
+	return EXIT_FAILURE;
+}
+catch (const std::runtime_error& err) {
+	std::cerr << "Uncaught runtime exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << '\n';
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,124 @@
+// quadratic_sieve.cpp: test suite of the self-initializing quadratic sieve factorization
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <iostream>
+#include <random>
+#include <string>
+#include <universal/integer/integer>
+// test helpers, such as, ReportTestResults
+#include "../utils/test_helpers.hpp"
+
+// the smallest prime >= n
+template<typename Integer>
+Integer NextPrime(Integer n) {
+	if (n.iseven()) n += Integer(1);
+	while (!sw::unum::miller_rabin(n)) n += Integer(2);
+	return n;
+}
+
+// the factorization returns a proper factor of n
+template<typename Integer>
+bool IsProperFactor(const Integer& factor, const Integer& n) {
+	return !(factor <= Integer(1)) && factor < n && (n % factor).iszero();
+}
+
+// semiprimes of random 33 to 58 bit primes, on 1 to 3 threads and with different seeds
+template<size_t nbits, typename BlockType>
+int VerifySemiprimes(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	using Integer = integer<nbits, BlockType>;
+	int nrOfFailedTests = 0;
+	std::mt19937_64 engine(7);
+	for (unsigned t = 0; t < 100; ++t) {
+		int bits1 = 33 + int(engine() % 26), bits2 = 33 + int(engine() % 26);
+		Integer p = NextPrime(Integer((long long)((engine() >> (64 - bits1)) | (1ull << (bits1 - 1)))));
+		Integer q = NextPrime(Integer((long long)((engine() >> (64 - bits2)) | (1ull << (bits2 - 1)))));
+		Integer n = p * q;
+		Integer factor = quadraticSieveFactorization(n, 1 + t % 3, nullptr, t);
+		if (!IsProperFactor(factor, n)) {
+			++nrOfFailedTests;
+			if (bReportIndividualTestCases) std::cout << tag << " FAIL " << n << " = " << p << " * " << q << " factor " << factor << '\n';
+		}
+	}
+	return nrOfFailedTests;
+}
+
+// primes, perfect powers, small factors, and a 40 digit semiprime with its statistics
+template<size_t nbits, typename BlockType>
+int VerifySpecialCases(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	using Integer = integer<nbits, BlockType>;
+	int nrOfFailedTests = 0;
+	Integer one(1);
+	Integer p = NextPrime(Integer(1000000000000ll)), q = NextPrime(Integer(3000000000000ll));
+	if (quadraticSieveFactorization(p * q * p * q) != p * q) ++nrOfFailedTests;
+	if (quadraticSieveFactorization(p * p * p) != p) ++nrOfFailedTests;
+	if (quadraticSieveFactorization(p * q * Integer(997)) != Integer(997)) ++nrOfFailedTests;
+	if (quadraticSieveFactorization(NextPrime(p * q)) != one) ++nrOfFailedTests;
+	if (!IsProperFactor(quadraticSieveFactorization(p * p * q), p * p * q)) ++nrOfFailedTests;
+
+	Integer ten(10), a(1);
+	for (int i = 0; i < 20; ++i) a *= ten;
+	Integer n = NextPrime(a + Integer(12345)) * NextPrime(a * Integer(3) + Integer(6789));
+	quadratic_sieve_report report;
+	Integer factor = quadraticSieveFactorization(n, 2, &report);
+	if (!IsProperFactor(factor, n) || report.fullRelations + report.combinedRelations < report.factorBaseSize) {
+		++nrOfFailedTests;
+		if (bReportIndividualTestCases) std::cout << tag << " FAIL " << n << " factor " << factor << '\n';
+	}
+	return nrOfFailedTests;
+}
+
+#define MANUAL_TESTING 0
+#define STRESS_TESTING 0
+
+int main()
+try {
+	using namespace std;
+	using namespace sw::unum;
+
+	std::string tag = "quadratic sieve failed";
+
+#if MANUAL_TESTING
+
+	using Integer = integer<256, uint32_t>;
+	Integer n;
+	parse("340282366920938463463374607431768211457", n);   // the Fermat number F7 = 2^128 + 1
+	quadratic_sieve_report report;
+	cout << n << " has factor " << quadraticSieveFactorization(n, 0, &report) << " in " << report.sieveSeconds + report.linearAlgebraSeconds << " sec" << endl;
+
+	cout << "done" << endl;
+
+	return EXIT_SUCCESS;
+#else
+	std::cout << "Quadratic sieve verification" << std::endl;
+
+	bool bReportIndividualTestCases = false;
+	int nrOfFailedTestCases = 0;
+
+	nrOfFailedTestCases += ReportTestResult(VerifySemiprimes<128, uint32_t>(tag, bReportIndividualTestCases), "integer<128, uint32_t>", "semiprimes");
+	nrOfFailedTestCases += ReportTestResult(VerifySpecialCases<256, uint8_t>(tag, bReportIndividualTestCases), "integer<256, uint8_t>", "special cases");
+
+#if STRESS_TESTING
+
+	nrOfFailedTestCases += ReportTestResult(VerifySemiprimes<256, uint32_t>(tag, bReportIndividualTestCases), "integer<256, uint32_t>", "semiprimes");
+
+#endif // STRESS_TESTING
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+
+#endif // MANUAL_TESTING
+}
+catch (char const* msg) {
+	std::cerr << msg << '\n';
+	return EXIT_FAILURE;
+}
+catch (const std::runtime_error& err) {
+	std::cerr << "Uncaught runtime exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << '\n';
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,187 @@
+// sequences.cpp: test suite of the fast doubling Fibonacci and Lucas numbers, linear recurrences, and their ranges
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <universal/integer/integer>
+#include <universal/decimal/decimal.hpp>
+#include <universal/sequences/sequences.hpp>
+// test helpers, such as, ReportTestResults
+#include "../utils/test_helpers.hpp"
+
+// single terms and ranges against the terms generated by additions
+template<typename Ty>
+int VerifyFibonacciLucas(const std::string& tag, unsigned long long upperbound, bool bReportIndividualTestCases) {
+	using namespace sw::sequences;
+	int nrOfFailedTests = 0;
+	std::vector<Ty> F = { Ty(0), Ty(1) }, L = { Ty(2), Ty(1) };
+	for (unsigned long long n = 2; n <= upperbound; ++n) {
+		F.push_back(F[n - 1] + F[n - 2]);
+		L.push_back(L[n - 1] + L[n - 2]);
+	}
+	for (unsigned long long n = 0; n <= upperbound; ++n) {
+		Ty f = FibonacciNumber<Ty>(n), l = LucasNumber<Ty>(n);
+		if (!(f == F[n]) || !(l == L[n])) {
+			++nrOfFailedTests;
+			if (bReportIndividualTestCases) std::cout << tag << " FAIL F(" << n << ") = " << f << " expected " << F[n] << ", L(" << n << ") = " << l << " expected " << L[n] << '\n';
+		}
+	}
+	for (unsigned long long first : { 0ull, 1ull, upperbound / 3 }) {
+		size_t count = size_t(upperbound + 1 - first);
+		for (unsigned nrThreads : { 1u, 3u }) {
+			std::vector<Ty> f = FibonacciRange<Ty>(first, count, nrThreads), l = LucasRange<Ty>(first, count, nrThreads);
+			for (size_t i = 0; i < count; ++i) {
+				if (!(f[i] == F[first + i]) || !(l[i] == L[first + i])) {
+					++nrOfFailedTests;
+					if (bReportIndividualTestCases) std::cout << tag << " FAIL range from " << first << " on " << nrThreads << " threads at " << first + i << '\n';
+					break;
+				}
+			}
+		}
+	}
+	return nrOfFailedTests;
+}
+
+// linear recurrences with positive and negative coefficients against the terms generated by the recurrence
+template<typename Ty>
+int VerifyLinearRecurrence(const std::string& tag, unsigned long long upperbound, bool bReportIndividualTestCases) {
+	using namespace sw::sequences;
+	int nrOfFailedTests = 0;
+	std::vector< std::vector<Ty> > coefficients = {
+		{ Ty(1), Ty(1) },                 // Fibonacci
+		{ Ty(1), Ty(1), Ty(1) },          // Tribonacci
+		{ Ty(3), Ty(-2) },                // 2^n - 1
+		{ Ty(2) },                        // 3 * 2^n
+		{ Ty(0), Ty(1), Ty(1) },          // Padovan
+		{ Ty(4), Ty(-5), Ty(2), Ty(-1) },
+	};
+	std::vector< std::vector<Ty> > initials = {
+		{ Ty(0), Ty(1) },
+		{ Ty(0), Ty(0), Ty(1) },
+		{ Ty(0), Ty(1) },
+		{ Ty(3) },
+		{ Ty(1), Ty(1), Ty(1) },
+		{ Ty(1), Ty(-2), Ty(0), Ty(7) },
+	};
+	for (size_t r = 0; r < coefficients.size(); ++r) {
+		const std::vector<Ty>& c = coefficients[r];
+		std::vector<Ty> a = initials[r];
+		size_t k = c.size();
+		while (a.size() <= upperbound) {
+			Ty next(0);
+			for (size_t l = 0; l < k; ++l) next += c[l] * a[a.size() - 1 - l];
+			a.push_back(next);
+		}
+		for (unsigned long long n = 0; n <= upperbound; ++n) {
+			Ty t = LinearRecurrence(c, initials[r], n);
+			if (!(t == a[n])) {
+				++nrOfFailedTests;
+				if (bReportIndividualTestCases) std::cout << tag << " FAIL recurrence " << r << " a(" << n << ") = " << t << " expected " << a[n] << '\n';
+			}
+		}
+		unsigned long long first = upperbound / 4;
+		std::vector<Ty> range = LinearRecurrenceRange(c, initials[r], first, size_t(upperbound + 1 - first), 4);
+		for (size_t i = 0; i < range.size(); ++i) {
+			if (!(range[i] == a[first + i])) {
+				++nrOfFailedTests;
+				if (bReportIndividualTestCases) std::cout << tag << " FAIL recurrence " << r << " range at " << first + i << '\n';
+				break;
+			}
+		}
+	}
+	return nrOfFailedTests;
+}
+
+// identities of terms far beyond the reach of the additions: F(2n) = F(n) L(n), L(n)^2 - 5 F(n)^2 = 4 (-1)^n,
+// and the Fibonacci numbers from the companion matrix of the general recurrence
+int VerifyLargeTerms(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	using namespace sw::sequences;
+	constexpr size_t nbits = 16384;
+	using Integer = integer<nbits, uint32_t>;
+	using Arithmetic = sw::function::product_arithmetic<Integer>;
+	int nrOfFailedTests = 0;
+	// F(10000) has 2090 decimal digits
+	for (unsigned long long n : { 5000ull, 5001ull, 10000ull }) {
+		auto f = Arithmetic::from_scalar(FibonacciNumber<Integer>(n)), l = Arithmetic::from_scalar(LucasNumber<Integer>(n));
+		Integer f2n = FibonacciNumber<Integer>(2 * n);
+		if (!(Arithmetic::to_scalar(Arithmetic::multiply(f, l)) == f2n)) ++nrOfFailedTests;
+		auto d = Arithmetic::subtract(Arithmetic::multiply(l, l), Arithmetic::multiply(Arithmetic::from_native(5), Arithmetic::multiply(f, f)));
+		if (!(Arithmetic::to_scalar(d) == Integer(n & 1 ? -4 : 4))) ++nrOfFailedTests;
+		Integer m = LinearRecurrence(std::vector<Integer>{ Integer(1), Integer(1) }, std::vector<Integer>{ Integer(0), Integer(1) }, 2 * n);
+		if (!(m == f2n)) ++nrOfFailedTests;
+		if (bReportIndividualTestCases && nrOfFailedTests) std::cout << tag << " FAIL identities of F(" << n << ")\n";
+	}
+	std::vector<Integer> range = FibonacciRange<Integer>(20000, 16, 4);
+	for (size_t i = 0; i + 2 < range.size(); ++i) if (!(range[i + 2] == range[i + 1] + range[i])) ++nrOfFailedTests;
+	if (!(range[0] == FibonacciNumber<Integer>(20000))) ++nrOfFailedTests;
+	return nrOfFailedTests;
+}
+
+#define MANUAL_TESTING 0
+#define STRESS_TESTING 0
+
+int main()
+try {
+	using namespace std;
+	using namespace sw::unum;
+	using namespace sw::sequences;
+
+	std::string tag = "sequences failed";
+
+#if MANUAL_TESTING
+
+	// the time of F(n) by fast doubling against the iterative Fibonacci()
+	constexpr size_t nbits = 8192;
+	using Integer = integer<nbits, uint32_t>;
+	chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+	pair<Integer, Integer> iterative = Fibonacci<Integer>(5002);
+	double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+	cout << "F(5000) iterative in " << elapsed << " sec\n";
+	begin = chrono::steady_clock::now();
+	Integer f = FibonacciNumber<Integer>(5000);
+	elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+	cout << "F(5000) fast doubling in " << elapsed << " sec " << (f == iterative.first ? "PASS" : "FAIL") << '\n';
+
+	cout << "done" << endl;
+
+	return EXIT_SUCCESS;
+#else
+	std::cout << "Sequences verification" << std::endl;
+
+	bool bReportIndividualTestCases = false;
+	int nrOfFailedTestCases = 0;
+
+	nrOfFailedTestCases += ReportTestResult(VerifyFibonacciLucas<unsigned long long>(tag, 90, bReportIndividualTestCases), "unsigned long long", "Fibonacci/Lucas");
+	nrOfFailedTestCases += ReportTestResult(VerifyFibonacciLucas< integer<1024, uint32_t> >(tag, 1400, bReportIndividualTestCases), "integer<1024, uint32_t>", "Fibonacci/Lucas");
+	nrOfFailedTestCases += ReportTestResult(VerifyFibonacciLucas<decimal>(tag, 200, bReportIndividualTestCases), "decimal", "Fibonacci/Lucas");
+	nrOfFailedTestCases += ReportTestResult(VerifyLinearRecurrence<long long>(tag, 40, bReportIndividualTestCases), "long long", "linear recurrence");
+	nrOfFailedTestCases += ReportTestResult(VerifyLinearRecurrence< integer<512, uint32_t> >(tag, 200, bReportIndividualTestCases), "integer<512, uint32_t>", "linear recurrence");
+	nrOfFailedTestCases += ReportTestResult(VerifyLinearRecurrence<decimal>(tag, 60, bReportIndividualTestCases), "decimal", "linear recurrence");
+	nrOfFailedTestCases += ReportTestResult(VerifyLargeTerms(tag, bReportIndividualTestCases), "integer<16384, uint32_t>", "large terms");
+
+#if STRESS_TESTING
+
+	nrOfFailedTestCases += ReportTestResult(VerifyFibonacciLucas< integer<8192, uint32_t> >(tag, 10000, bReportIndividualTestCases), "integer<8192, uint32_t>", "Fibonacci/Lucas");
+
+#endif // STRESS_TESTING
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+
+#endif // MANUAL_TESTING
+}
+catch (char const* msg) {
+	std::cerr << msg << '\n';
+	return EXIT_FAILURE;
+}
+catch (const std::runtime_error& err) {
+	std::cerr << "Uncaught runtime exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << '\n';
+	return EXIT_FAILURE;
+}
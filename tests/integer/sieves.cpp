@@ -0,0 +1,149 @@
+// sieves.cpp: test suite of the segmented sieve of Eratosthenes
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <universal/integer/integer>
+// test helpers, such as, ReportTestResults
+#include "../utils/test_helpers.hpp"
+
+// compare the sieve against trial division on ranges that start and end on and around primes and segment boundaries
+int VerifySieveAgainstTrialDivision(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	int nrOfFailedTests = 0;
+	std::vector<uint64_t> bounds = { 0, 1, 2, 3, 4, 13, 14, 17, 1000, 16384, 16385, 32768, 999983, 2000003 };
+	std::vector<uint64_t> reference;
+	for (uint64_t n = 2; n < bounds.back(); ++n) {
+		bool prime = true;
+		for (uint64_t d = 2; d * d <= n && prime; ++d) prime = (n % d != 0);
+		if (prime) reference.push_back(n);
+	}
+	for (uint64_t low : bounds) {
+		for (uint64_t high : bounds) {
+			std::vector<uint64_t> expected;
+			for (uint64_t p : reference) if (p >= low && p < high) expected.push_back(p);
+			// small segments so that the ranges cross many segment boundaries
+			std::vector<uint64_t> primes;
+			segmented_sieve(low, high, primes, 3, 1024);
+			if (primes != expected || prime_count(low, high, 2, 2048) != expected.size()) {
+				++nrOfFailedTests;
+				if (bReportIndividualTestCases) std::cout << tag << " FAIL [" << low << ", " << high << ") " << primes.size() << " primes, expected " << expected.size() << '\n';
+			}
+		}
+	}
+	return nrOfFailedTests;
+}
+
+// the prime counting function at powers of 10, and a window far from the origin against Miller-Rabin
+int VerifyPrimeCounts(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	int nrOfFailedTests = 0;
+	const uint64_t pi[] = { 0, 4, 25, 168, 1229, 9592, 78498, 664579, 5761455, 50847534 };
+	uint64_t n = 1;
+	for (uint64_t expected : pi) {
+		uint64_t count = prime_count(0, n + 1);
+		if (count != expected) {
+			++nrOfFailedTests;
+			if (bReportIndividualTestCases) std::cout << tag << " FAIL pi(" << n << ") = " << count << " expected " << expected << '\n';
+		}
+		n *= 10;
+	}
+	using Integer = integer<64, uint32_t>;
+	const uint64_t low = 1000000000000ull, high = low + 20000;
+	std::vector<Integer> primes;
+	segmented_sieve(low, high, primes);
+	size_t k = 0;
+	for (uint64_t c = low; c < high; ++c) {
+		bool prime = miller_rabin(Integer(c));
+		bool sieved = (k < primes.size() && primes[k] == Integer(c));
+		if (sieved) ++k;
+		if (prime != sieved) {
+			++nrOfFailedTests;
+			if (bReportIndividualTestCases) std::cout << tag << " FAIL " << c << (prime ? " is prime" : " is composite") << '\n';
+		}
+	}
+	return nrOfFailedTests;
+}
+
+// the primes do not depend on the number of threads, and primeNumbersInRange on integer<nbits> agrees with the sieve
+int VerifyThreadsAndIntegerRanges(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	int nrOfFailedTests = 0;
+	std::vector<uint32_t> serial, concurrent;
+	segmented_sieve(12345678, 23456789, serial, 1);
+	segmented_sieve(12345678, 23456789, concurrent, 4);
+	if (serial != concurrent) {
+		++nrOfFailedTests;
+		if (bReportIndividualTestCases) std::cout << tag << " FAIL 1 thread vs 4 threads\n";
+	}
+	using Integer = integer<128, uint32_t>;
+	std::vector<Integer> primes;
+	primeNumbersInRange(Integer(1000000), Integer(1100000), primes);
+	std::vector<uint64_t> reference;
+	segmented_sieve(1000000, 1100000, reference);
+	bool same = (primes.size() == reference.size());
+	for (size_t i = 0; same && i < primes.size(); ++i) same = (primes[i] == Integer(reference[i]));
+	if (!same) {
+		++nrOfFailedTests;
+		if (bReportIndividualTestCases) std::cout << tag << " FAIL primeNumbersInRange\n";
+	}
+	return nrOfFailedTests;
+}
+
+#define MANUAL_TESTING 0
+#define STRESS_TESTING 0
+
+int main()
+try {
+	using namespace std;
+	using namespace sw::unum;
+
+	std::string tag = "segmented sieve failed";
+
+#if MANUAL_TESTING
+
+	for (unsigned nrThreads = 1; nrThreads <= hardware_concurrency(); nrThreads *= 2) {
+		chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+		uint64_t count = prime_count(0, 10000000000ull, nrThreads);
+		double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+		cout << "pi(1e10) = " << count << " on " << nrThreads << " threads in " << elapsed << " sec\n";
+	}
+
+	cout << "done" << endl;
+
+	return EXIT_SUCCESS;
+#else
+	std::cout << "Segmented sieve verification" << std::endl;
+
+	bool bReportIndividualTestCases = false;
+	int nrOfFailedTestCases = 0;
+
+	nrOfFailedTestCases += ReportTestResult(VerifySieveAgainstTrialDivision(tag, bReportIndividualTestCases), "uint64_t", "segmented sieve");
+	nrOfFailedTestCases += ReportTestResult(VerifyPrimeCounts(tag, bReportIndividualTestCases), "uint64_t", "prime count");
+	nrOfFailedTestCases += ReportTestResult(VerifyThreadsAndIntegerRanges(tag, bReportIndividualTestCases), "integer<128, uint32_t>", "primes in range");
+
+#if STRESS_TESTING
+
+	if (prime_count(0, 10000000000ull) != 455052511ull) ++nrOfFailedTestCases;
+
+#endif // STRESS_TESTING
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+
+#endif // MANUAL_TESTING
+}
+catch (char const* msg) {
+	std::cerr << msg << '\n';
+	return EXIT_FAILURE;
+}
+catch (const std::runtime_error& err) {
+	std::cerr << "Uncaught runtime exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << '\n';
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,146 @@
+// fixpnt_math.cpp: accuracy and performance of the fixed-point elementary functions against the round trip through double
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+// Configure the fixpnt template environment
+// first: enable general or specialized fixed-point configurations
+#define FIXPNT_FAST_SPECIALIZATION
+// second: disable fixpnt arithmetic exceptions
+#define FIXPNT_THROW_ARITHMETIC_EXCEPTION 0
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <universal/fixpnt/fixpnt>
+
+// the error in ulps of the fixed-point result r against the long double reference saturated to the range of the fixpnt
+template<size_t nbits, size_t rbits>
+double UlpError(const sw::unum::fixpnt<nbits, rbits, sw::unum::Saturating>& r, long double reference) {
+	long double ulp = std::ldexp(1.0L, -int(rbits));
+	long double maxpos = std::ldexp(1.0L, int(nbits - rbits - 1)) - ulp, maxneg = -std::ldexp(1.0L, int(nbits - rbits - 1));
+	long double expected = (reference > maxpos ? maxpos : (reference < maxneg ? maxneg : reference));
+	// the conversion to long double is exact for nbits <= 64
+	long double value = (long double)r.getbb().to_long_long() * ulp;
+	return double(std::fabs(value - expected) / ulp);
+}
+
+// the fastest of nrRuns evaluations of f over the arguments, in seconds per call
+template<typename Fixed, typename Function>
+double TimePerCall(const std::vector<Fixed>& x, const std::vector<Fixed>& y, Function&& f, std::vector<Fixed>& r, size_t nrRuns) {
+	double fastest = 1.0e30;
+	for (size_t run = 0; run < nrRuns; ++run) {
+		auto begin = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < x.size(); ++i) r[i] = f(x[i], y[i]);
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+		if (elapsed < fastest) fastest = elapsed;
+	}
+	return fastest / double(x.size());
+}
+
+// the fixed-point function f against the round trip of the double function g through double, with the long double
+// reference function ref, on n random arguments in [lo, hi] clipped to the range of the fixpnt
+template<size_t nbits, size_t rbits, typename FixedFunction, typename DoubleFunction, typename ReferenceFunction>
+void CompareFunction(std::ostream& ostr, const std::string& header, const std::string& name, double lo, double hi,
+	FixedFunction&& f, DoubleFunction&& g, ReferenceFunction&& ref, size_t n, size_t nrRuns) {
+	using Fixed = sw::unum::fixpnt<nbits, rbits, sw::unum::Saturating>;
+	double range = std::ldexp(1.0, int(nbits - rbits - 1)) - std::ldexp(1.0, -int(rbits));
+	lo = (lo < -range ? -range : lo);
+	hi = (hi > range ? range : hi);
+	std::mt19937_64 engine(n);
+	std::uniform_real_distribution<double> distribution(lo, hi);
+	std::vector<Fixed> x(n), y(n), fixed(n), viaDouble(n);
+	for (size_t i = 0; i < n; ++i) {
+		x[i] = distribution(engine);
+		y[i] = distribution(engine);
+	}
+	double tFixed = TimePerCall(x, y, f, fixed, nrRuns);
+	double tDouble = TimePerCall(x, y, g, viaDouble, nrRuns);
+	double eFixed = 0.0, eDouble = 0.0;
+	for (size_t i = 0; i < n; ++i) {
+		long double reference = ref((long double)double(x[i]), (long double)double(y[i]));
+		eFixed = std::max(eFixed, UlpError(fixed[i], reference));
+		eDouble = std::max(eDouble, UlpError(viaDouble[i], reference));
+	}
+	ostr << std::setw(16) << std::left << header << std::setw(6) << name << std::right << std::fixed
+		<< " fixed-point " << std::setw(9) << std::setprecision(1) << tFixed * 1.0e9 << " ns  max " << std::setw(6) << std::setprecision(2) << eFixed << " ulp"
+		<< "   via double " << std::setw(9) << std::setprecision(1) << tDouble * 1.0e9 << " ns  max " << std::setw(6) << std::setprecision(2) << eDouble << " ulp"
+		<< "   speedup " << std::setprecision(2) << tDouble / tFixed << '\n';
+}
+
+template<size_t nbits, size_t rbits>
+void CompareElementaryFunctions(std::ostream& ostr, const std::string& header, size_t n, size_t nrRuns) {
+	using namespace sw::unum;
+	using Fixed = fixpnt<nbits, rbits, Saturating>;
+	double ulp = std::ldexp(1.0, -int(rbits));
+	// exp up to half a unit below the overflow to maxpos, and below the large values that the conversion
+	// from double does not reach for 64-bit configurations
+	double maxExponent = std::min(std::log(std::ldexp(1.0, int(nbits - rbits - 1))) - 0.5, 14.0);
+	CompareFunction<nbits, rbits>(ostr, header, "sin", -16.0, 16.0,
+		[](const Fixed& a, const Fixed&) { return sin(a); },
+		[](const Fixed& a, const Fixed&) { return Fixed(std::sin(double(a))); },
+		[](long double a, long double) { return std::sin(a); }, n, nrRuns);
+	CompareFunction<nbits, rbits>(ostr, header, "cos", -16.0, 16.0,
+		[](const Fixed& a, const Fixed&) { return cos(a); },
+		[](const Fixed& a, const Fixed&) { return Fixed(std::cos(double(a))); },
+		[](long double a, long double) { return std::cos(a); }, n, nrRuns);
+	CompareFunction<nbits, rbits>(ostr, header, "atan", -16.0, 16.0,
+		[](const Fixed& a, const Fixed&) { return atan(a); },
+		[](const Fixed& a, const Fixed&) { return Fixed(std::atan(double(a))); },
+		[](long double a, long double) { return std::atan(a); }, n, nrRuns);
+	CompareFunction<nbits, rbits>(ostr, header, "atan2", -16.0, 16.0,
+		[](const Fixed& a, const Fixed& b) { return atan2(b, a); },
+		[](const Fixed& a, const Fixed& b) { return Fixed(std::atan2(double(b), double(a))); },
+		[](long double a, long double b) { return std::atan2(b, a); }, n, nrRuns);
+	CompareFunction<nbits, rbits>(ostr, header, "hypot", -16.0, 16.0,
+		[](const Fixed& a, const Fixed& b) { return hypot(a, b); },
+		[](const Fixed& a, const Fixed& b) { return Fixed(std::hypot(double(a), double(b))); },
+		[](long double a, long double b) { return std::hypot(a, b); }, n, nrRuns);
+	CompareFunction<nbits, rbits>(ostr, header, "exp", -8.0, maxExponent,
+		[](const Fixed& a, const Fixed&) { return exp(a); },
+		[](const Fixed& a, const Fixed&) { return Fixed(std::exp(double(a))); },
+		[](long double a, long double) { return std::exp(a); }, n, nrRuns);
+	CompareFunction<nbits, rbits>(ostr, header, "log", ulp, 64.0,
+		[](const Fixed& a, const Fixed&) { return log(a); },
+		[](const Fixed& a, const Fixed&) { return Fixed(std::log(double(a))); },
+		[](long double a, long double) { return std::log(a); }, n, nrRuns);
+	CompareFunction<nbits, rbits>(ostr, header, "sqrt", ulp, 64.0,
+		[](const Fixed& a, const Fixed&) { return sqrt(a); },
+		[](const Fixed& a, const Fixed&) { return Fixed(std::sqrt(double(a))); },
+		[](long double a, long double) { return std::sqrt(a); }, n, nrRuns);
+	CompareFunction<nbits, rbits>(ostr, header, "rsqrt", ulp, 64.0,
+		[](const Fixed& a, const Fixed&) { return rsqrt(a); },
+		[](const Fixed& a, const Fixed&) { return Fixed(1.0 / std::sqrt(double(a))); },
+		[](long double a, long double) { return 1.0L / std::sqrt(a); }, n, nrRuns);
+}
+
+int main()
+try {
+	using namespace std;
+	using namespace sw::unum;
+
+	cout << "Fixed-point elementary functions against the conversion to double and back\n";
+
+	constexpr size_t n = 10000;
+	CompareElementaryFunctions<16, 8>(cout, "fixpnt<16,8>", n, 5);
+	CompareElementaryFunctions<32, 16>(cout, "fixpnt<32,16>", n, 5);
+	CompareElementaryFunctions<32, 28>(cout, "fixpnt<32,28>", n, 5);
+	CompareElementaryFunctions<64, 32>(cout, "fixpnt<64,32>", n / 10, 3);
+
+	return EXIT_SUCCESS;
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const std::runtime_error& err) {
+	std::cerr << "Uncaught runtime exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
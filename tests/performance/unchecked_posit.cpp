@@ -0,0 +1,102 @@
+// unchecked_posit.cpp: performance of the posit arithmetic with and without special case handling of NaR and zero inputs
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+// Configure the posit template environment
+// first: enable fast specialized posit<16,1> and posit<32,2>
+#define POSIT_FAST_POSIT_16_1 1
+#define POSIT_FAST_POSIT_32_2 1
+// second: disable posit arithmetic exceptions
+#define POSIT_THROW_ARITHMETIC_EXCEPTION 0
+#include <chrono>
+#include <iomanip>
+#include <vector>
+#include <universal/posit/posit>
+
+// one Jacobi smoothing sweep of a 1D three-point stencil, all values finite and non-zero
+template<typename Scalar>
+double StencilSweep(std::vector<Scalar>& u, std::vector<Scalar>& v) {
+	const Scalar w(0.25), c(0.5);
+	size_t n = u.size();
+	auto begin = std::chrono::steady_clock::now();
+	for (size_t i = 1; i + 1 < n; ++i) {
+		v[i] = w * (u[i - 1] + u[i + 1]) + c * u[i];
+	}
+	auto end = std::chrono::steady_clock::now();
+	std::swap(u, v);
+	return std::chrono::duration<double>(end - begin).count();
+}
+
+template<size_t nbits, size_t es>
+void CompareStencilPerformance(std::ostream& ostr, const std::string& header, size_t n, size_t nrSweeps) {
+	using namespace sw::unum;
+	using Checked = posit<nbits, es>;
+	using Unchecked = posit_unchecked<nbits, es>;
+	std::vector<Checked> u(n), v(n);
+	std::vector<Unchecked> uu(n), vu(n);
+	for (size_t i = 0; i < n; ++i) {
+		u[i] = 1.0 + double(i % 97) / 64.0;
+		v[i] = u[i];
+		uu[i] = u[i];
+		vu[i] = v[i];
+	}
+	// alternate the two variants so that both see the same machine load, and keep the fastest sweep of each
+	double checked = 1.0e30, unchecked = 1.0e30;
+	for (size_t s = 0; s < nrSweeps; ++s) {
+		double t = StencilSweep(u, v);
+		if (t < checked) checked = t;
+		t = StencilSweep(uu, vu);
+		if (t < unchecked) unchecked = t;
+	}
+	bool identical = true;
+	for (size_t i = 0; i < n; ++i) identical = identical && (u[i] == uu[i].get());
+
+	// 3 additions and 2 multiplications per point
+	double ops = 5.0 * double(n - 2);
+	ostr << std::setw(14) << std::left << header
+		<< " checked " << std::setw(8) << std::right << std::fixed << std::setprecision(2) << ops / checked / 1.0e6 << " MPOPS"
+		<< "   unchecked " << std::setw(8) << ops / unchecked / 1.0e6 << " MPOPS"
+		<< "   speedup " << std::setprecision(2) << checked / unchecked
+		<< (identical ? "   bit-identical" : "   RESULTS DIFFER") << '\n';
+}
+
+int main()
+try {
+	using namespace std;
+	using namespace sw::unum;
+
+	cout << "Posit stencil performance with and without special case handling of the inputs\n";
+
+	constexpr size_t n = 100000;
+	CompareStencilPerformance<16, 1>(cout, "posit<16,1>", n, 50);
+	CompareStencilPerformance<32, 2>(cout, "posit<32,2>", n, 50);
+	CompareStencilPerformance<24, 1>(cout, "posit<24,1>", n / 10, 10);
+
+	return EXIT_SUCCESS;
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const std::runtime_error& err) {
+	std::cerr << "Uncaught runtime exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
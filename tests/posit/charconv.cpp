@@ -0,0 +1,281 @@
+// charconv.cpp: functional tests for the shortest round-trip to_chars and exact from_chars of posits
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <universal/posit/posit>
+// test helpers, such as, ReportTestResults
+#include "../utils/test_helpers.hpp"
+
+#define MANUAL_TESTING 0
+#define STRESS_TESTING 0
+
+// split a to_chars result into its significant digits and the decimal exponent k of 0.ddd x 10^k
+bool DecimalDigits(const std::string& txt, std::string& digits, long& k) {
+	digits.clear();
+	long pointPosition = -1, nrIntegerDigits = 0, leadingZeros = 0;
+	size_t i = (!txt.empty() && txt[0] == '-') ? 1 : 0;
+	for (; i < txt.size() && txt[i] != 'e'; ++i) {
+		if (txt[i] == '.') { pointPosition = nrIntegerDigits; continue; }
+		if (pointPosition < 0) ++nrIntegerDigits;
+		if (digits.empty() && txt[i] == '0') { ++leadingZeros; continue; }
+		digits.push_back(txt[i]);
+	}
+	if (digits.empty()) return false;
+	while (digits.size() > 1 && digits.back() == '0') digits.pop_back();
+	k = nrIntegerDigits - leadingZeros;
+	if (i < txt.size()) k += std::stol(txt.substr(i + 1));
+	return true;
+}
+
+// every posit must survive to_chars -> from_chars, and no decimal with fewer digits may round to it
+template<size_t nbits, size_t es>
+int VerifyRoundTrip(const std::string& tag, const sw::unum::posit<nbits, es>& p, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	char buffer[nbits + 32];
+	std::to_chars_result out = to_chars(buffer, buffer + sizeof(buffer), p);
+	if (out.ec != std::errc()) {
+		if (bReportIndividualTestCases) std::cout << tag << " to_chars failed for " << hex_format(p) << '\n';
+		return 1;
+	}
+	posit<nbits, es> q;
+	std::from_chars_result in = from_chars(buffer, out.ptr, q);
+	if (in.ec != std::errc() || in.ptr != out.ptr || q != p) {
+		if (bReportIndividualTestCases) std::cout << tag << ' ' << hex_format(p) << " -> " << std::string(buffer, out.ptr) << " -> " << hex_format(q) << '\n';
+		return 1;
+	}
+	if (p.iszero() || p.isnar()) return 0;
+
+	std::string digits;
+	long k;
+	if (!DecimalDigits(std::string(buffer, out.ptr), digits, k)) return 1;
+	if (digits.size() < 2) return 0;
+	// the two candidates with one digit less: truncated and truncated + 1ulp
+	std::string shorter = digits.substr(0, digits.size() - 1);
+	std::string candidates[2] = { shorter, shorter };
+	size_t d = shorter.size();
+	while (d > 0 && candidates[1][d - 1] == '9') candidates[1][--d] = '0';
+	if (d == 0) { candidates[1].insert(candidates[1].begin(), '1'); } else { ++candidates[1][d - 1]; }
+	long kUp = k + (d == 0 ? 1 : 0);
+	int nrOfFailedTests = 0;
+	for (int c = 0; c < 2; ++c) {
+		std::string txt = std::string(p.isneg() ? "-" : "") + "0." + candidates[c] + 'e' + std::to_string(c == 0 ? k : kUp);
+		from_chars(txt.data(), txt.data() + txt.size(), q);
+		if (q == p) {
+			if (bReportIndividualTestCases) std::cout << tag << ' ' << hex_format(p) << " -> " << std::string(buffer, out.ptr) << " is not the shortest: " << txt << '\n';
+			++nrOfFailedTests;
+		}
+	}
+	return nrOfFailedTests;
+}
+
+template<size_t nbits, size_t es>
+int ValidateExhaustiveRoundTrip(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	constexpr size_t NR_POSITS = (size_t(1) << nbits);
+	int nrOfFailedTests = 0;
+	posit<nbits, es> p;
+	for (size_t i = 0; i < NR_POSITS; ++i) {
+		p.set_raw_bits(i);
+		nrOfFailedTests += VerifyRoundTrip(tag, p, bReportIndividualTestCases);
+	}
+	return nrOfFailedTests;
+}
+
+template<size_t nbits, size_t es>
+int ValidateSampledRoundTrip(const std::string& tag, size_t nrSamples, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	std::mt19937_64 rng(nbits * 1000 + es);
+	int nrOfFailedTests = 0;
+	posit<nbits, es> p;
+	bitblock<nbits> raw;
+	for (size_t s = 0; s < nrSamples; ++s) {
+		uint64_t bits = 0;
+		for (size_t i = 0; i < nbits; ++i) {
+			if (i % 64 == 0) bits = rng();
+			raw[i] = (bits & 1);
+			bits >>= 1;
+		}
+		p.set(raw);
+		nrOfFailedTests += VerifyRoundTrip(tag, p, bReportIndividualTestCases);
+	}
+	return nrOfFailedTests;
+}
+
+// from_chars must agree with the conversion from double, including ties, which are posit<nbits+1, es> values
+template<size_t nbits, size_t es>
+int ValidateParseAgainstConversion(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	constexpr size_t NR_POSITS = (size_t(1) << nbits);
+	int nrOfFailedTests = 0;
+	posit<nbits + 1, es> tie;
+	posit<nbits, es> pref, presult;
+	char txt[2048];
+	for (size_t i = 1; i < NR_POSITS; ++i) {
+		tie.set_raw_bits(i);
+		if (tie.isnar()) continue;
+		double d = double(tie);
+		std::snprintf(txt, sizeof(txt), "%.1100f", d);   // exact decimal expansion of the double
+		pref = d;
+		from_chars(txt, txt + std::strlen(txt), presult);
+		if (presult != pref) {
+			if (bReportIndividualTestCases) std::cout << tag << ' ' << hex_format(tie) << ' ' << d << " from_chars " << hex_format(presult) << " != " << hex_format(pref) << '\n';
+			++nrOfFailedTests;
+		}
+	}
+	return nrOfFailedTests;
+}
+
+int ValidateFormat(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	int nrOfFailedTests = 0;
+	auto check = [&](const std::string& result, const std::string& golden) {
+		if (result != golden) {
+			if (bReportIndividualTestCases) std::cout << tag << ' ' << result << " != " << golden << '\n';
+			++nrOfFailedTests;
+		}
+	};
+	auto format = [](const auto& p) {
+		char buffer[128];
+		std::to_chars_result r = to_chars(buffer, buffer + sizeof(buffer), p);
+		return std::string(buffer, r.ptr);
+	};
+	posit<32, 2> p;
+	p = 0;       check(format(p), "0");
+	p.setnar();  check(format(p), "nar");
+	p = 1.5;     check(format(p), "1.5");
+	p = -0.1;    check(format(p), "-0.1");
+	p = 1000;    check(format(p), "1000");
+	p = 1.0e-3;  check(format(p), "0.001");
+	p = 1.0e30;  check(format(p), "1e+30");
+	p = 2.5e-9;  check(format(p), "2.5e-9");
+	posit<8, 0> p8;
+	p8 = 0.5;    check(format(p8), "0.5");
+	p8 = 0.75;   check(format(p8), "0.75");
+	p8.set_raw_bits(0x01); check(format(p8), "0.02");
+
+	// a buffer that is too small
+	char small[3];
+	p = 1.25;
+	std::to_chars_result r = to_chars(small, small + sizeof(small), p);
+	if (r.ec != std::errc::value_too_large || r.ptr != small + sizeof(small)) ++nrOfFailedTests;
+	return nrOfFailedTests;
+}
+
+int ValidateParse(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	int nrOfFailedTests = 0;
+	auto check = [&](const char* txt, std::errc ec, size_t consumed, double golden) {
+		posit<32, 2> p(-7), ref(golden);
+		std::from_chars_result r = from_chars(txt, txt + std::strlen(txt), p);
+		bool ok = (r.ec == ec) && (size_t(r.ptr - txt) == consumed) && (ec != std::errc() || p == ref);
+		if (!ok) {
+			if (bReportIndividualTestCases) std::cout << tag << " parse of '" << txt << "' failed: " << p << '\n';
+			++nrOfFailedTests;
+		}
+	};
+	check("1.5", std::errc(), 3, 1.5);
+	check("-0.125", std::errc(), 6, -0.125);
+	check(".5e1", std::errc(), 4, 5.0);
+	check("00012.50e-1", std::errc(), 11, 1.25);
+	check("3.25xyz", std::errc(), 4, 3.25);
+	check("2e", std::errc(), 1, 2.0);
+	check("2e+", std::errc(), 1, 2.0);
+	check("1e400", std::errc(), 5, double(std::numeric_limits< posit<32, 2> >::max()));
+	check("1e-400", std::errc(), 6, double(std::numeric_limits< posit<32, 2> >::min()));
+	check("0.000", std::errc(), 5, 0.0);
+	check("", std::errc::invalid_argument, 0, 0.0);
+	check("-", std::errc::invalid_argument, 0, 0.0);
+	check(".", std::errc::invalid_argument, 0, 0.0);
+	check("abc", std::errc::invalid_argument, 0, 0.0);
+
+	posit<32, 2> p;
+	const char* nar = "NaR";
+	from_chars(nar, nar + 3, p);
+	if (!p.isnar()) ++nrOfFailedTests;
+
+	// many more digits than any tie point has: the sticky digit keeps the rounding exact
+	std::string longInput = "1.0000000" + std::string(400, '0') + "1";
+	from_chars(longInput.data(), longInput.data() + longInput.size(), p);
+	if (p != posit<32, 2>(1)) ++nrOfFailedTests;
+	return nrOfFailedTests;
+}
+
+int main(int argc, char** argv)
+try {
+	using namespace std;
+	using namespace sw::unum;
+
+	bool bReportIndividualTestCases = false;
+	int nrOfFailedTestCases = 0;
+
+	std::string tag = "charconv failed: ";
+
+#if MANUAL_TESTING
+	posit<64, 3> p(3.14159265358979323846);
+	char buffer[96];
+	to_chars_result r = sw::unum::to_chars(buffer, buffer + sizeof(buffer), p);
+	cout << string(buffer, r.ptr) << " " << to_string(p, 25) << endl;
+
+	nrOfFailedTestCases += ReportTestResult(ValidateExhaustiveRoundTrip<8, 2>(tag, true), "posit<8,2>", "round trip");
+
+#else
+
+	cout << "Posit to_chars/from_chars validation" << endl;
+
+	nrOfFailedTestCases += ReportTestResult(ValidateFormat(tag, bReportIndividualTestCases), "posit", "to_chars format");
+	nrOfFailedTestCases += ReportTestResult(ValidateParse(tag, bReportIndividualTestCases), "posit", "from_chars grammar");
+
+	nrOfFailedTestCases += ReportTestResult(ValidateExhaustiveRoundTrip<2, 0>(tag, bReportIndividualTestCases), "posit<2,0>", "round trip");
+	nrOfFailedTestCases += ReportTestResult(ValidateExhaustiveRoundTrip<5, 1>(tag, bReportIndividualTestCases), "posit<5,1>", "round trip");
+	nrOfFailedTestCases += ReportTestResult(ValidateExhaustiveRoundTrip<8, 0>(tag, bReportIndividualTestCases), "posit<8,0>", "round trip");
+	nrOfFailedTestCases += ReportTestResult(ValidateExhaustiveRoundTrip<8, 1>(tag, bReportIndividualTestCases), "posit<8,1>", "round trip");
+	nrOfFailedTestCases += ReportTestResult(ValidateExhaustiveRoundTrip<8, 2>(tag, bReportIndividualTestCases), "posit<8,2>", "round trip");
+	nrOfFailedTestCases += ReportTestResult(ValidateExhaustiveRoundTrip<10, 1>(tag, bReportIndividualTestCases), "posit<10,1>", "round trip");
+	nrOfFailedTestCases += ReportTestResult(ValidateExhaustiveRoundTrip<12, 3>(tag, bReportIndividualTestCases), "posit<12,3>", "round trip");
+
+	nrOfFailedTestCases += ReportTestResult(ValidateSampledRoundTrip<32, 2>(tag, 10000, bReportIndividualTestCases), "posit<32,2>", "round trip");
+	nrOfFailedTestCases += ReportTestResult(ValidateSampledRoundTrip<64, 3>(tag, 2000, bReportIndividualTestCases), "posit<64,3>", "round trip");
+	nrOfFailedTestCases += ReportTestResult(ValidateSampledRoundTrip<128, 4>(tag, 100, bReportIndividualTestCases), "posit<128,4>", "round trip");
+
+	nrOfFailedTestCases += ReportTestResult(ValidateParseAgainstConversion<8, 0>(tag, bReportIndividualTestCases), "posit<8,0>", "from_chars ties");
+	nrOfFailedTestCases += ReportTestResult(ValidateParseAgainstConversion<8, 1>(tag, bReportIndividualTestCases), "posit<8,1>", "from_chars ties");
+	nrOfFailedTestCases += ReportTestResult(ValidateParseAgainstConversion<10, 2>(tag, bReportIndividualTestCases), "posit<10,2>", "from_chars ties");
+
+#if STRESS_TESTING
+	nrOfFailedTestCases += ReportTestResult(ValidateExhaustiveRoundTrip<16, 1>(tag, bReportIndividualTestCases), "posit<16,1>", "round trip");
+	nrOfFailedTestCases += ReportTestResult(ValidateSampledRoundTrip<256, 5>(tag, 100, bReportIndividualTestCases), "posit<256,5>", "round trip");
+#endif // STRESS_TESTING
+
+#endif // MANUAL_TESTING
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const std::runtime_error& err) {
+	std::cerr << "Uncaught runtime exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
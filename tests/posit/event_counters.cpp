@@ -0,0 +1,184 @@
+// event_counters.cpp: functional tests for the per-thread posit arithmetic event counters
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+// enable the event counters of the posit arithmetic
+#define POSIT_ENABLE_EVENT_COUNTERS 1
+#include <universal/posit/posit>
+#include <universal/utility/parallel_for.hpp>
+// test helpers, such as, ReportTestResults
+#include "../utils/test_helpers.hpp"
+
+#define MANUAL_TESTING 0
+#define STRESS_TESTING 0
+
+// compare one counter of a snapshot against its expected value
+int CheckEvent(bool bReportIndividualTestCases, const sw::unum::event_snapshot& s, sw::unum::posit_event e, uint64_t expected) {
+	if (s[e] == expected) return 0;
+	if (bReportIndividualTestCases) std::cerr << "FAIL: " << to_string(e) << " count " << s[e] << " expected " << expected << std::endl;
+	return 1;
+}
+
+// each kind of operation and event is counted once per occurrence
+template<size_t nbits, size_t es>
+int VerifyOperationCounts(bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	int nrOfFailedTests = 0;
+
+	reset_event_counters();
+	posit<nbits, es> one(1), three(3), zero(0), minusOne(-1);  // 4 conversions
+	posit<nbits, es> third = one / three;                   // div, inexact
+	posit<nbits, es> sum = one + three;                     // add
+	posit<nbits, es> difference = three - one;              // sub
+	posit<nbits, es> big = maxpos<nbits, es>() * maxpos<nbits, es>();  // mul, saturation, inexact
+	posit<nbits, es> inf = one / zero;                      // div, nar
+	posit<nbits, es> root = sqrt(minusOne);                 // sqrt, and nar for the native sqrt
+	posit<nbits, es> reciprocal = three.reciprocate();      // reciprocate, inexact
+	// the counting hooks stay out of the constant-evaluable assignment of floating-point zero
+	constexpr posit<nbits, es> constantZero(0.0);
+	(void)third; (void)sum; (void)difference; (void)big; (void)inf; (void)root; (void)reciprocal; (void)constantZero;
+
+	event_snapshot s = event_counters_snapshot();
+	nrOfFailedTests += CheckEvent(bReportIndividualTestCases, s, posit_event::conversion, 4);
+	nrOfFailedTests += CheckEvent(bReportIndividualTestCases, s, posit_event::add, 1);
+	nrOfFailedTests += CheckEvent(bReportIndividualTestCases, s, posit_event::sub, 1);
+	nrOfFailedTests += CheckEvent(bReportIndividualTestCases, s, posit_event::mul, 1);
+	nrOfFailedTests += CheckEvent(bReportIndividualTestCases, s, posit_event::div, 2);
+	nrOfFailedTests += CheckEvent(bReportIndividualTestCases, s, posit_event::sqrt, 1);
+	nrOfFailedTests += CheckEvent(bReportIndividualTestCases, s, posit_event::reciprocate, 1);
+	nrOfFailedTests += CheckEvent(bReportIndividualTestCases, s, posit_event::nar, 1 + POSIT_NATIVE_SQRT);
+	nrOfFailedTests += CheckEvent(bReportIndividualTestCases, s, posit_event::saturation, 1);
+	nrOfFailedTests += CheckEvent(bReportIndividualTestCases, s, posit_event::inexact, 3);
+	nrOfFailedTests += CheckEvent(bReportIndividualTestCases, s, posit_event::quire_accumulate, 0);
+	if (s.operations() != 7) ++nrOfFailedTests;
+	if (s.max_quire_scale != INT_MIN) ++nrOfFailedTests;
+	return nrOfFailedTests;
+}
+
+// quire accumulations and the largest quire scale
+template<size_t nbits, size_t es>
+int VerifyQuireCounts(bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	int nrOfFailedTests = 0;
+	posit<nbits, es> a(1.5), b(2.25);
+	reset_event_counters();
+	quire<nbits, es, 2> q;
+	for (int i = 0; i < 3; ++i) q += quire_mul(a, b);      // 3.375, 6.75, 10.125
+	q -= quire_mul(a, b);                                   // 6.75
+	event_snapshot s = event_counters_snapshot();
+	nrOfFailedTests += CheckEvent(bReportIndividualTestCases, s, posit_event::quire_accumulate, 4);
+	if (s.max_quire_scale != 3) {
+		++nrOfFailedTests;
+		if (bReportIndividualTestCases) std::cerr << "FAIL: max quire scale " << s.max_quire_scale << " expected 3" << std::endl;
+	}
+	return nrOfFailedTests;
+}
+
+// counts of all threads are summed, including threads that have exited, and reset clears them
+template<size_t nbits, size_t es>
+int VerifyThreadCounts(bool bReportIndividualTestCases, size_t n) {
+	using namespace sw::unum;
+	int nrOfFailedTests = 0;
+	posit<nbits, es> a(0.125), b(0.25);
+	reset_event_counters();
+	parallel_blocks(0, n, [&](unsigned, size_t begin, size_t end) {
+		posit<nbits, es> sum(a);
+		for (size_t i = begin; i < end; ++i) sum += b;
+	}, 4);
+	event_snapshot s = event_counters_snapshot();
+	nrOfFailedTests += CheckEvent(bReportIndividualTestCases, s, posit_event::add, n);
+
+	event_snapshot before = event_counters_snapshot();
+	posit<nbits, es> c = a * b;
+	(void)c;
+	event_snapshot delta = event_counters_snapshot() - before;
+	nrOfFailedTests += CheckEvent(bReportIndividualTestCases, delta, posit_event::mul, 1);
+	nrOfFailedTests += CheckEvent(bReportIndividualTestCases, delta, posit_event::add, 0);
+
+	reset_event_counters();
+	s = event_counters_snapshot();
+	if (s.operations() != 0 || s[posit_event::conversion] != 0) {
+		++nrOfFailedTests;
+		if (bReportIndividualTestCases) std::cerr << "FAIL: reset did not clear the counters" << std::endl;
+	}
+	return nrOfFailedTests;
+}
+
+// the JSON dump holds every counter
+int VerifyJson(bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	int nrOfFailedTests = 0;
+	event_snapshot s;
+	s.count[unsigned(posit_event::add)] = 42;
+	s.count[unsigned(posit_event::inexact)] = 7;
+	std::string json = to_json(s);
+	if (json.find("\"add\": 42") == std::string::npos) ++nrOfFailedTests;
+	if (json.find("\"inexact\": 7") == std::string::npos) ++nrOfFailedTests;
+	if (json.find("\"max_quire_scale\": null") == std::string::npos) ++nrOfFailedTests;
+	if (json.front() != '{' || json.back() != '}') ++nrOfFailedTests;
+	s.max_quire_scale = -5;
+	if (to_json(s).find("\"max_quire_scale\": -5}") == std::string::npos) ++nrOfFailedTests;
+	if (nrOfFailedTests && bReportIndividualTestCases) std::cerr << "FAIL: " << json << std::endl;
+	return nrOfFailedTests;
+}
+
+int main()
+try {
+	using namespace std;
+	using namespace sw::unum;
+
+	bool bReportIndividualTestCases = true;
+	int nrOfFailedTestCases = 0;
+
+	std::string tag = "event counters";
+
+#if MANUAL_TESTING
+
+	posit<20, 1> a(1.0), b(3.0);
+	reset_event_counters();
+	a /= b;
+	write_json(cout, event_counters_snapshot()) << endl;
+
+#else
+
+	cout << "Posit arithmetic event counter validation" << endl;
+
+	nrOfFailedTestCases += ReportTestResult(VerifyOperationCounts<20, 1>(bReportIndividualTestCases), tag, "posit<20,1> operations");
+	nrOfFailedTestCases += ReportTestResult(VerifyQuireCounts<20, 1>(bReportIndividualTestCases), tag, "quire<20,1,2> accumulations");
+	nrOfFailedTestCases += ReportTestResult(VerifyThreadCounts<20, 1>(bReportIndividualTestCases, 4000), tag, "per-thread counters");
+	nrOfFailedTestCases += ReportTestResult(VerifyJson(bReportIndividualTestCases), tag, "json");
+
+#if STRESS_TESTING
+	nrOfFailedTestCases += ReportTestResult(VerifyThreadCounts<20, 1>(bReportIndividualTestCases, 10000000), tag, "per-thread counters");
+#endif // STRESS_TESTING
+
+#endif // MANUAL_TESTING
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,272 @@
+// quire_serialization.cpp: functional tests for the exact merge, binary serialization, and reduction of quires
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <universal/posit/posit>
+// test helpers, such as, ReportTestResults
+#include "../utils/test_helpers.hpp"
+
+#define MANUAL_TESTING 0
+#define STRESS_TESTING 0
+
+// random products of posits with a wide range of scales and both signs
+template<size_t nbits, size_t es>
+void GenerateProducts(size_t n, std::vector< sw::unum::posit<nbits, es> >& x, std::vector< sw::unum::posit<nbits, es> >& y, unsigned seed) {
+	std::mt19937_64 rng(seed);
+	std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+	std::uniform_int_distribution<int> exponent(-12, 12);
+	x.resize(n);
+	y.resize(n);
+	for (size_t i = 0; i < n; ++i) {
+		x[i] = std::ldexp(mantissa(rng), exponent(rng));
+		y[i] = std::ldexp(mantissa(rng), exponent(rng));
+	}
+}
+
+// partition a dot product, merge the partial quires in different orders, and compare against the serial quire
+template<size_t nbits, size_t es, size_t capacity>
+int ValidatePartitionedMerge(const std::string& tag, size_t n, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	using Quire = quire<nbits, es, capacity>;
+	std::vector< posit<nbits, es> > x, y;
+	GenerateProducts(n, x, y, unsigned(nbits + es));
+	Quire serial;
+	for (size_t i = 0; i < n; ++i) serial += quire_mul(x[i], y[i]);
+
+	int nrOfFailedTests = 0;
+	for (size_t nrParts : { size_t(1), size_t(3), size_t(7), size_t(16) }) {
+		std::vector<Quire> partials(nrParts);
+		for (size_t i = 0; i < n; ++i) partials[(i * 7919) % nrParts] += quire_mul(x[i], y[i]);
+		Quire forward, backward;
+		for (size_t p = 0; p < nrParts; ++p) merge(forward, partials[p]);
+		for (size_t p = nrParts; p-- > 0; ) backward += partials[p];
+		Quire tree = tree_reduce(partials, 4);
+		if (forward != serial || backward != serial || tree != serial) {
+			if (bReportIndividualTestCases) std::cout << tag << " merge of " << nrParts << " partitions differs from the serial quire\n";
+			++nrOfFailedTests;
+		}
+	}
+	return nrOfFailedTests;
+}
+
+// merging with opposite signs must cancel exactly, and overflow of the capacity must throw
+template<size_t nbits, size_t es, size_t capacity>
+int ValidateMergeSigns(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	using Quire = quire<nbits, es, capacity>;
+	int nrOfFailedTests = 0;
+	posit<nbits, es> a(3.5), b(-1.25);
+	Quire q1, q2, q3;
+	q1 += quire_mul(a, a);      // 12.25
+	q2 += quire_mul(a, b);      // -4.375
+	q3 = q1;
+	merge(q3, q2);
+	if (q3.to_value().to_double() != 7.875) ++nrOfFailedTests;
+	Quire q4 = q2;
+	merge(q4, q1);
+	if (q4 != q3) ++nrOfFailedTests;
+	q3 -= q1;
+	if (q3 != q2) ++nrOfFailedTests;
+	q3 -= q2;
+	if (!q3.iszero() || q3.sign()) ++nrOfFailedTests;
+
+	// the lowest and highest bits of the accumulator
+	posit<nbits, es> pmin, pmax;
+	minpos(pmin);
+	maxpos(pmax);
+	Quire lo, hi;
+	lo += quire_mul(pmin, pmin);
+	hi += quire_mul(pmax, pmax);
+	Quire both = hi;
+	merge(both, lo);
+	both -= hi;
+	if (both != lo) ++nrOfFailedTests;
+
+	bool caught = false;
+	try {
+		Quire big = hi;
+		for (size_t i = 0; i < capacity + 2; ++i) merge(big, Quire(big));
+	}
+	catch (const operand_too_large_for_quire&) {
+		caught = true;
+	}
+	if (!caught) ++nrOfFailedTests;
+	if (nrOfFailedTests && bReportIndividualTestCases) std::cout << tag << " signed merge failed\n";
+	return nrOfFailedTests;
+}
+
+template<size_t nbits, size_t es, size_t capacity>
+int ValidateSerialization(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	using Quire = quire<nbits, es, capacity>;
+	int nrOfFailedTests = 0;
+	std::vector< posit<nbits, es> > x, y;
+	GenerateProducts(64, x, y, 17);
+	std::vector<Quire> samples(4);
+	samples[1] += quire_mul(x[0], y[0]);                                     // a single product: a few limbs
+	for (size_t i = 0; i < 64; ++i) samples[2] += quire_mul(x[i], y[i]);
+	posit<nbits, es> pmin, pmax;
+	minpos(pmin);
+	maxpos(pmax);
+	samples[3] += quire_mul(pmax, pmax);
+	samples[3] -= quire_mul(pmin, pmin);                                // spans the whole accumulator
+	for (const Quire& q : samples) {
+		std::vector<uint8_t> buffer = serialize(q);
+		if (buffer.size() != serialized_size(q)) ++nrOfFailedTests;
+		Quire r(1);
+		size_t consumed = deserialize(buffer.data(), buffer.size(), r);
+		if (consumed != buffer.size() || r != q) {
+			if (bReportIndividualTestCases) std::cout << tag << " round trip failed for " << q << '\n';
+			++nrOfFailedTests;
+		}
+		if (buffer.size() > QUIRE_SERIALIZATION_HEADER_SIZE + 8 * Quire::nrLimbs) ++nrOfFailedTests;
+		// a buffer that is one byte short
+		if (serialize(q, buffer.data(), buffer.size() - 1) != 0) ++nrOfFailedTests;
+	}
+	if (serialized_size(samples[0]) != QUIRE_SERIALIZATION_HEADER_SIZE) ++nrOfFailedTests;
+	if (serialized_size(samples[1]) > QUIRE_SERIALIZATION_HEADER_SIZE + 16) ++nrOfFailedTests;
+
+	// malformed and mismatching records
+	std::vector<uint8_t> buffer = serialize(samples[2]);
+	auto expectError = [&](const std::vector<uint8_t>& record, size_t size) {
+		Quire r;
+		try {
+			deserialize(record.data(), size, r);
+		}
+		catch (const quire_encoding_error&) {
+			return;
+		}
+		if (bReportIndividualTestCases) std::cout << tag << " malformed record was accepted\n";
+		++nrOfFailedTests;
+	};
+	expectError(buffer, buffer.size() - 1);
+	expectError(buffer, 5);
+	std::vector<uint8_t> bad(buffer);
+	bad[0] = 'X';
+	expectError(bad, bad.size());
+	bad = buffer;
+	bad[6] = uint8_t(es + 1);
+	expectError(bad, bad.size());
+	quire<nbits, es, capacity + 1> other;
+	other += quire_mul(x[0], y[0]);
+	std::vector<uint8_t> mismatch = serialize(other);
+	expectError(mismatch, mismatch.size());
+	return nrOfFailedTests;
+}
+
+// stream and file reduction, as used to combine the results of worker processes
+template<size_t nbits, size_t es, size_t capacity>
+int ValidateReduction(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	using Quire = quire<nbits, es, capacity>;
+	int nrOfFailedTests = 0;
+	constexpr size_t n = 1000, nrWorkers = 5;
+	std::vector< posit<nbits, es> > x, y;
+	GenerateProducts(n, x, y, 42);
+	Quire serial;
+	for (size_t i = 0; i < n; ++i) serial += quire_mul(x[i], y[i]);
+
+	// every worker emits a partial quire per block of 50 products
+	std::stringstream pipe;
+	std::vector<std::string> paths;
+	for (size_t w = 0; w < nrWorkers; ++w) {
+		std::string path = "quire_serialization_worker_" + std::to_string(w) + ".bin";
+		std::ofstream file(path, std::ios::binary);
+		paths.push_back(path);
+		for (size_t block = w * 50; block < n; block += nrWorkers * 50) {
+			Quire partial;
+			for (size_t i = block; i < block + 50; ++i) partial += quire_mul(x[i], y[i]);
+			write_binary(pipe, partial);
+			write_binary(file, partial);
+		}
+	}
+	Quire fromPipe = reduce_serialized<nbits, es, capacity>(pipe);
+	Quire fromFiles = reduce_serialized<nbits, es, capacity>(paths, 3);
+	for (const std::string& path : paths) std::remove(path.c_str());
+	if (fromPipe != serial || fromFiles != serial) {
+		if (bReportIndividualTestCases) std::cout << tag << " reduction of serialized quires differs from the serial quire\n";
+		++nrOfFailedTests;
+	}
+
+	// a stream that ends inside a record
+	std::stringstream truncated;
+	write_binary(truncated, serial);
+	std::string record = truncated.str();
+	std::stringstream partial(record.substr(0, record.size() - 3));
+	try {
+		reduce_serialized<nbits, es, capacity>(partial);
+		++nrOfFailedTests;
+	}
+	catch (const quire_encoding_error&) {}
+	return nrOfFailedTests;
+}
+
+int main(int argc, char** argv)
+try {
+	using namespace std;
+	using namespace sw::unum;
+
+	bool bReportIndividualTestCases = false;
+	int nrOfFailedTestCases = 0;
+
+	std::string tag = "quire serialization failed: ";
+
+#if MANUAL_TESTING
+	quire<16, 1, 2> q;
+	q += quire_mul(posit<16, 1>(1.5), posit<16, 1>(-2.25));
+	std::vector<uint8_t> buffer = serialize(q);
+	cout << q << " serializes to " << buffer.size() << " bytes" << endl;
+
+#else
+
+	cout << "Quire merge and serialization validation" << endl;
+
+	nrOfFailedTestCases += ReportTestResult(ValidateMergeSigns<8, 0, 4>(tag, bReportIndividualTestCases), "quire<8,0,4>", "signed merge");
+	nrOfFailedTestCases += ReportTestResult(ValidateMergeSigns<16, 1, 8>(tag, bReportIndividualTestCases), "quire<16,1,8>", "signed merge");
+	nrOfFailedTestCases += ReportTestResult(ValidateMergeSigns<32, 2, 30>(tag, bReportIndividualTestCases), "quire<32,2,30>", "signed merge");
+
+	nrOfFailedTestCases += ReportTestResult(ValidatePartitionedMerge<16, 1, 30>(tag, 500, bReportIndividualTestCases), "quire<16,1,30>", "partitioned merge");
+	nrOfFailedTestCases += ReportTestResult(ValidatePartitionedMerge<32, 2, 30>(tag, 500, bReportIndividualTestCases), "quire<32,2,30>", "partitioned merge");
+
+	nrOfFailedTestCases += ReportTestResult(ValidateSerialization<8, 0, 4>(tag, bReportIndividualTestCases), "quire<8,0,4>", "serialization");
+	nrOfFailedTestCases += ReportTestResult(ValidateSerialization<16, 1, 30>(tag, bReportIndividualTestCases), "quire<16,1,30>", "serialization");
+	nrOfFailedTestCases += ReportTestResult(ValidateSerialization<32, 2, 30>(tag, bReportIndividualTestCases), "quire<32,2,30>", "serialization");
+
+	nrOfFailedTestCases += ReportTestResult(ValidateReduction<16, 1, 30>(tag, bReportIndividualTestCases), "quire<16,1,30>", "reduction");
+
+#if STRESS_TESTING
+	nrOfFailedTestCases += ReportTestResult(ValidatePartitionedMerge<64, 3, 30>(tag, 2000, bReportIndividualTestCases), "quire<64,3,30>", "partitioned merge");
+#endif // STRESS_TESTING
+
+#endif // MANUAL_TESTING
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const std::runtime_error& err) {
+	std::cerr << "Uncaught runtime exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,214 @@
+// stochastic_rounding.cpp : functional tests for the stochastic rounding mode of posit conversion, arithmetic, and quire resolution
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+// enable the per-thread rounding mode selection
+#define POSIT_ENABLE_STOCHASTIC_ROUNDING 1
+// request the fast specializations, which the per-thread rounding mode replaces by the generic posits
+#define POSIT_FAST_SPECIALIZATION
+#include <universal/posit/posit>
+// test helpers, such as, ReportTestResults
+#include "../utils/test_helpers.hpp"
+#include "../utils/posit_test_helpers.hpp"
+
+// verify that a value that is exactly representable never rounds away under stochastic rounding
+template<size_t nbits, size_t es>
+int ValidateStochasticExactConversion(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	constexpr size_t NR_POSITS = (size_t(1) << nbits);
+	int nrOfFailedTests = 0;
+	posit<nbits, es> pref, presult;
+	for (size_t i = 0; i < NR_POSITS; ++i) {
+		pref.set_raw_bits(i);
+		if (pref.isnar()) continue;
+		convert(pref.to_value(), presult, posit_rounding::stochastic);
+		if (presult != pref) {
+			++nrOfFailedTests;
+			if (bReportIndividualTestCases) ReportConversionError(tag, "=", double(pref), double(pref), presult);
+		}
+	}
+	return nrOfFailedTests;
+}
+
+// verify that the rounding is unbiased: the expected value of the rounded result is the input
+// We pick an input at 1/4 ulp above a posit, so that 1/4 of the conversions must round up
+template<size_t nbits, size_t es>
+int ValidateStochasticExpectation(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	constexpr int NR_SAMPLES = 100000;
+	int nrOfFailedTests = 0;
+	posit<nbits, es> lo(1.0), hi(lo);
+	++hi;
+	double dlo = double(lo), dhi = double(hi);
+	double input = dlo + 0.25 * (dhi - dlo);
+	seed_stochastic_rounding(12345);
+	int nrRoundUps = 0;
+	posit<nbits, es> p;
+	for (int i = 0; i < NR_SAMPLES; ++i) {
+		convert(input, p, posit_rounding::stochastic);
+		if (p == hi) {
+			++nrRoundUps;
+		}
+		else if (p != lo) {
+			++nrOfFailedTests;   // stochastic rounding may only produce the two enclosing posits
+		}
+	}
+	double ratio = double(nrRoundUps) / double(NR_SAMPLES);
+	if (ratio < 0.24 || ratio > 0.26) ++nrOfFailedTests;
+	if (bReportIndividualTestCases) std::cout << tag << " round up ratio " << ratio << " expected 0.25\n";
+	return nrOfFailedTests;
+}
+
+// verify that the generator is reproducible when seeded
+template<size_t nbits, size_t es>
+int ValidateStochasticReproducibility(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	constexpr int NR_SAMPLES = 1000;
+	int nrOfFailedTests = 0;
+	std::vector< posit<nbits, es> > first(NR_SAMPLES), second(NR_SAMPLES);
+	seed_stochastic_rounding(0xC0FFEE);
+	for (int i = 0; i < NR_SAMPLES; ++i) convert(1.0 + i / 3.0, first[i], posit_rounding::stochastic);
+	seed_stochastic_rounding(0xC0FFEE);
+	for (int i = 0; i < NR_SAMPLES; ++i) convert(1.0 + i / 3.0, second[i], posit_rounding::stochastic);
+	for (int i = 0; i < NR_SAMPLES; ++i) {
+		if (first[i] != second[i]) {
+			++nrOfFailedTests;
+			if (bReportIndividualTestCases) ReportConversionError(tag, "=", 1.0 + i / 3.0, double(first[i]), second[i]);
+		}
+	}
+	return nrOfFailedTests;
+}
+
+// verify that the thread rounding mode applies to arithmetic results and that the default is round-to-nearest-even
+template<size_t nbits, size_t es>
+int ValidateThreadRoundingMode(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	constexpr int NR_SAMPLES = 10000;
+	int nrOfFailedTests = 0;
+	posit<nbits, es> a(1.0), b, nearest;
+	b = a;
+	++b;
+	// a + half an ulp is a tie, an increment smaller than half an ulp rounds to nearest a
+	posit<nbits, es> tiny = (b - a) / posit<nbits, es>(8);
+	nearest = a + tiny;
+	if (nearest != a) ++nrOfFailedTests;
+	{
+		rounding_mode_guard guard(posit_rounding::stochastic);
+		seed_stochastic_rounding(42);
+		int nrRoundUps = 0;
+		for (int i = 0; i < NR_SAMPLES; ++i) {
+			posit<nbits, es> sum = a + tiny;
+			if (sum == b) ++nrRoundUps;
+		}
+		// an eighth of an ulp should round up about an eighth of the time
+		double ratio = double(nrRoundUps) / double(NR_SAMPLES);
+		if (ratio < 0.10 || ratio > 0.15) ++nrOfFailedTests;
+		if (bReportIndividualTestCases) std::cout << tag << " round up ratio " << ratio << " expected 0.125\n";
+	}
+	if (get_rounding_mode() != posit_rounding::nearest_even) ++nrOfFailedTests;
+	nearest = a + tiny;
+	if (nearest != a) ++nrOfFailedTests;
+	return nrOfFailedTests;
+}
+
+// verify stochastic quire resolution: summing n copies of 1/4 ulp in the quire and resolving stochastically
+// must yield the exact answer on average
+template<size_t nbits, size_t es>
+int ValidateStochasticQuireResolution(const std::string& tag, bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	constexpr int NR_SAMPLES = 20000;
+	int nrOfFailedTests = 0;
+	posit<nbits, es> one(1.0), next(one);
+	++next;
+	std::vector< posit<nbits, es> > x = { one, posit<nbits, es>(0.25) }, y = { one, next - one };
+	seed_stochastic_rounding(7);
+	double average = 0.0;
+	for (int i = 0; i < NR_SAMPLES; ++i) {
+		average += double(fdp(x, y, posit_rounding::stochastic));
+	}
+	average /= NR_SAMPLES;
+	double exact = 1.0 + 0.25 * (double(next) - 1.0);
+	double ulp = double(next) - 1.0;
+	if (std::abs(average - exact) > 0.02 * ulp) ++nrOfFailedTests;
+	// round to nearest resolution of the same quire must yield 1
+	if (fdp(x, y) != one) ++nrOfFailedTests;
+	if (bReportIndividualTestCases) std::cout << tag << " average " << average << " exact " << exact << '\n';
+	return nrOfFailedTests;
+}
+
+#define MANUAL_TESTING 0
+#define STRESS_TESTING 0
+
+int main(int argc, char** argv)
+try {
+	using namespace std;
+	using namespace sw::unum;
+
+	bool bReportIndividualTestCases = false;
+	int nrOfFailedTestCases = 0;
+
+	std::string tag = "Stochastic rounding failed: ";
+
+#if MANUAL_TESTING
+	seed_stochastic_rounding(1);
+	posit<8, 0> p;
+	for (int i = 0; i < 10; ++i) {
+		convert(1.1, p, posit_rounding::stochastic);
+		cout << p << ' ' << color_print(p) << endl;
+	}
+
+#else
+
+	cout << "Posit stochastic rounding validation" << endl;
+
+	nrOfFailedTestCases += ReportTestResult(ValidateStochasticExactConversion<8, 0>(tag, bReportIndividualTestCases), "posit<8,0>", "exact conversion");
+	nrOfFailedTestCases += ReportTestResult(ValidateStochasticExactConversion<8, 1>(tag, bReportIndividualTestCases), "posit<8,1>", "exact conversion");
+	nrOfFailedTestCases += ReportTestResult(ValidateStochasticExactConversion<10, 1>(tag, bReportIndividualTestCases), "posit<10,1>", "exact conversion");
+
+	nrOfFailedTestCases += ReportTestResult(ValidateStochasticExpectation<8, 0>(tag, bReportIndividualTestCases), "posit<8,0>", "expectation");
+	nrOfFailedTestCases += ReportTestResult(ValidateStochasticExpectation<16, 1>(tag, bReportIndividualTestCases), "posit<16,1>", "expectation");
+	nrOfFailedTestCases += ReportTestResult(ValidateStochasticExpectation<32, 2>(tag, bReportIndividualTestCases), "posit<32,2>", "expectation");
+
+	nrOfFailedTestCases += ReportTestResult(ValidateStochasticReproducibility<8, 1>(tag, bReportIndividualTestCases), "posit<8,1>", "reproducibility");
+	nrOfFailedTestCases += ReportTestResult(ValidateStochasticReproducibility<16, 1>(tag, bReportIndividualTestCases), "posit<16,1>", "reproducibility");
+
+	nrOfFailedTestCases += ReportTestResult(ValidateThreadRoundingMode<12, 1>(tag, bReportIndividualTestCases), "posit<12,1>", "thread rounding mode");
+	nrOfFailedTestCases += ReportTestResult(ValidateThreadRoundingMode<16, 1>(tag, bReportIndividualTestCases), "posit<16,1>", "thread rounding mode");
+	nrOfFailedTestCases += ReportTestResult(ValidateThreadRoundingMode<32, 2>(tag, bReportIndividualTestCases), "posit<32,2>", "thread rounding mode");
+
+	nrOfFailedTestCases += ReportTestResult(ValidateStochasticQuireResolution<16, 1>(tag, bReportIndividualTestCases), "posit<16,1>", "quire resolution");
+
+#if STRESS_TESTING
+	nrOfFailedTestCases += ReportTestResult(ValidateStochasticExactConversion<16, 1>(tag, bReportIndividualTestCases), "posit<16,1>", "exact conversion");
+#endif // STRESS_TESTING
+
+#endif // MANUAL_TESTING
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const std::runtime_error& err) {
+	std::cerr << "Uncaught runtime exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,173 @@
+// unchecked_arithmetic.cpp: functional tests for the posit arithmetic without special case handling of NaR and zero inputs
+//
+// Copyright (C) 2017-2020 Stillwater Supercomputing, Inc.
+//
+// This file is part of the universal numbers project, which is released under an MIT Open Source license.
+
+// Configure the posit template environment
+// first: enable the fast specializations that have finite kernels, and one that falls back to the checked operators
+#define POSIT_FAST_POSIT_8_1 1
+#define POSIT_FAST_POSIT_16_1 1
+#define POSIT_FAST_POSIT_32_2 1
+// second: enable/disable posit arithmetic exceptions
+#define POSIT_THROW_ARITHMETIC_EXCEPTION 0
+#include <random>
+#include <vector>
+#include <universal/posit/posit>
+// test helpers, such as, ReportTestResults
+#include "../utils/test_helpers.hpp"
+
+#define MANUAL_TESTING 0
+#define STRESS_TESTING 0
+
+// compare the finite kernels against the checked operators for one pair of finite, non-zero operands
+template<size_t nbits, size_t es>
+int CompareFiniteKernels(bool bReportIndividualTestCases, const sw::unum::posit<nbits, es>& a, const sw::unum::posit<nbits, es>& b) {
+	using namespace sw::unum;
+	int nrOfFailedTests = 0;
+	posit<nbits, es> checked, unchecked;
+	checked = a; checked += b; unchecked = a; unchecked.finite_add(b);
+	if (checked != unchecked) ++nrOfFailedTests;
+	checked = a; checked -= b; unchecked = a; unchecked.finite_sub(b);
+	if (checked != unchecked) ++nrOfFailedTests;
+	checked = a; checked *= b; unchecked = a; unchecked.finite_mul(b);
+	if (checked != unchecked) ++nrOfFailedTests;
+	checked = a; checked /= b; unchecked = a; unchecked.finite_div(b);
+	if (checked != unchecked) ++nrOfFailedTests;
+	if (nrOfFailedTests && bReportIndividualTestCases) {
+		std::cerr << "FAIL: " << type_tag(a) << " " << a << " op " << b << std::endl;
+	}
+	return nrOfFailedTests;
+}
+
+// all pairs of finite, non-zero encodings
+template<size_t nbits, size_t es>
+int VerifyExhaustive(bool bReportIndividualTestCases) {
+	using namespace sw::unum;
+	constexpr size_t NR_ENCODINGS = (size_t(1) << nbits);
+	int nrOfFailedTests = 0;
+	posit<nbits, es> a, b;
+	for (size_t i = 0; i < NR_ENCODINGS; ++i) {
+		a.set_raw_bits(i);
+		if (a.iszero() || a.isnar()) continue;
+		for (size_t j = 0; j < NR_ENCODINGS; ++j) {
+			b.set_raw_bits(j);
+			if (b.iszero() || b.isnar()) continue;
+			nrOfFailedTests += CompareFiniteKernels(bReportIndividualTestCases, a, b);
+		}
+	}
+	return nrOfFailedTests;
+}
+
+// random pairs of finite, non-zero encodings
+template<size_t nbits, size_t es>
+int VerifyRandom(bool bReportIndividualTestCases, size_t nrOfTests) {
+	using namespace sw::unum;
+	std::mt19937_64 rng(nbits);
+	int nrOfFailedTests = 0;
+	posit<nbits, es> a, b;
+	for (size_t t = 0; t < nrOfTests; ++t) {
+		a.set_raw_bits(rng());
+		b.set_raw_bits(rng());
+		if (a.iszero() || a.isnar() || b.iszero() || b.isnar()) continue;
+		nrOfFailedTests += CompareFiniteKernels(bReportIndividualTestCases, a, b);
+	}
+	return nrOfFailedTests;
+}
+
+// a three-point stencil sweep in posit_unchecked reproduces the checked sweep
+template<size_t nbits, size_t es>
+int VerifyStencilSweep(bool bReportIndividualTestCases, size_t n) {
+	using namespace sw::unum;
+	using Checked = posit<nbits, es>;
+	using Unchecked = posit_unchecked<nbits, es>;
+	std::vector<Checked> u(n), v(n);
+	std::vector<Unchecked> uu(n), vu(n);
+	for (size_t i = 0; i < n; ++i) {
+		u[i] = 1.0 + double(i % 17) / 16.0;
+		uu[i] = u[i];
+	}
+	Checked w(0.25), c(0.5);
+	Unchecked wu(w), cu(c);
+	for (size_t i = 1; i + 1 < n; ++i) {
+		v[i] = w * u[i - 1] + c * u[i] + w * u[i + 1];
+		vu[i] = wu * uu[i - 1] + cu * uu[i] + wu * uu[i + 1];
+	}
+	int nrOfFailedTests = 0;
+	for (size_t i = 1; i + 1 < n; ++i) {
+		if (v[i] != vu[i].get()) {
+			++nrOfFailedTests;
+			if (bReportIndividualTestCases) std::cerr << "FAIL: stencil " << type_tag(u[i]) << " at " << i << " : " << v[i] << " != " << vu[i] << std::endl;
+		}
+	}
+	Unchecked ratio = uu[1] / uu[2] - uu[3];
+	if (ratio.get() != u[1] / u[2] - u[3]) ++nrOfFailedTests;
+	return nrOfFailedTests;
+}
+
+int main()
+try {
+	using namespace std;
+	using namespace sw::unum;
+
+	bool bReportIndividualTestCases = false;
+	int nrOfFailedTestCases = 0;
+
+	std::string tag = "unchecked arithmetic";
+
+#if MANUAL_TESTING
+
+	posit<16, 1> a(1.5), b(-0.375);
+	a.finite_add(b);
+	cout << a << endl;
+	nrOfFailedTestCases += ReportTestResult(VerifyRandom<16, 1>(true, 1000), tag, "posit<16,1>");
+
+#else
+
+	cout << "Posit unchecked arithmetic validation" << endl;
+
+	nrOfFailedTestCases += ReportTestResult(VerifyExhaustive<8, 0>(bReportIndividualTestCases), tag, "posit<8,0>");
+	nrOfFailedTestCases += ReportTestResult(VerifyExhaustive<9, 1>(bReportIndividualTestCases), tag, "posit<9,1>");
+	nrOfFailedTestCases += ReportTestResult(VerifyExhaustive<10, 2>(bReportIndividualTestCases), tag, "posit<10,2>");
+	nrOfFailedTestCases += ReportTestResult(VerifyRandom<16, 1>(bReportIndividualTestCases, 100000), tag, "posit<16,1> fast");
+	nrOfFailedTestCases += ReportTestResult(VerifyRandom<32, 2>(bReportIndividualTestCases, 100000), tag, "posit<32,2> fast");
+	nrOfFailedTestCases += ReportTestResult(VerifyRandom<24, 1>(bReportIndividualTestCases, 10000), tag, "posit<24,1>");
+
+	nrOfFailedTestCases += ReportTestResult(VerifyStencilSweep<8, 1>(bReportIndividualTestCases, 100), tag, "posit<8,1> fast fallback");
+	nrOfFailedTestCases += ReportTestResult(VerifyStencilSweep<16, 1>(bReportIndividualTestCases, 100), tag, "posit<16,1> fast stencil");
+	nrOfFailedTestCases += ReportTestResult(VerifyStencilSweep<32, 2>(bReportIndividualTestCases, 100), tag, "posit<32,2> fast stencil");
+	nrOfFailedTestCases += ReportTestResult(VerifyStencilSweep<20, 1>(bReportIndividualTestCases, 100), tag, "posit<20,1> stencil");
+
+#if STRESS_TESTING
+	nrOfFailedTestCases += ReportTestResult(VerifyExhaustive<12, 1>(bReportIndividualTestCases), tag, "posit<12,1>");
+	nrOfFailedTestCases += ReportTestResult(VerifyExhaustive<16, 1>(bReportIndividualTestCases), tag, "posit<16,1> fast");
+#endif // STRESS_TESTING
+
+#endif // MANUAL_TESTING
+
+	return (nrOfFailedTestCases > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+catch (char const* msg) {
+	std::cerr << msg << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_arithmetic_exception& err) {
+	std::cerr << "Uncaught posit arithmetic exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const quire_exception& err) {
+	std::cerr << "Uncaught quire exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (const posit_internal_exception& err) {
+	std::cerr << "Uncaught posit internal exception: " << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (std::runtime_error& err) {
+	std::cerr << err.what() << std::endl;
+	return EXIT_FAILURE;
+}
+catch (...) {
+	std::cerr << "Caught unknown exception" << std::endl;
+	return EXIT_FAILURE;
+}